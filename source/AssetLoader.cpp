@@ -0,0 +1,69 @@
+#include "pch.h"
+#include "AssetLoader.h"
+#include "Effect.h"
+#include <iomanip>
+
+namespace dae
+{
+	AssetLoader::AssetLoader(uint32_t numThreads) :
+		m_ThreadPool(numThreads)
+	{
+	}
+
+	std::future<SDL_Surface*> AssetLoader::DecodeImage(const std::string& path)
+	{
+		return Submit("image " + path, [path]()
+		{
+			SDL_Surface* pSurface{ IMG_Load(path.c_str()) };
+			if (!pSurface)
+			{
+				std::cout << "AssetLoader: unable to decode " << path << "\n";
+			}
+			return pSurface;
+		});
+	}
+
+	std::future<ID3DBlob*> AssetLoader::CompileEffect(const std::wstring& path, const D3D_SHADER_MACRO* pDefines)
+	{
+		std::vector<D3D_SHADER_MACRO> defines{};
+		for (const D3D_SHADER_MACRO* pDefine = pDefines; pDefine && pDefine->Name; ++pDefine)
+		{
+			defines.push_back(*pDefine);
+		}
+		defines.push_back({ nullptr, nullptr });
+
+		return Submit("effect " + std::string{ path.begin(), path.end() }, [path, defines]()
+		{
+			return Effect::CompileEffect(path, defines.data());
+		});
+	}
+
+	void AssetLoader::RecordStage(const std::string& name, Clock::time_point start, Clock::time_point end, bool isWorker)
+	{
+		const std::lock_guard<std::mutex> lock{ m_TimingMutex };
+		m_Timings.push_back({ name, std::chrono::duration<double, std::milli>(start - m_StartTime).count(),
+			std::chrono::duration<double, std::milli>(end - m_StartTime).count(), isWorker });
+	}
+
+	void AssetLoader::PrintTimings() const
+	{
+		const std::lock_guard<std::mutex> lock{ m_TimingMutex };
+
+		std::vector<StageTiming> timings{ m_Timings };
+		std::sort(timings.begin(), timings.end(), [](const StageTiming& lhs, const StageTiming& rhs) { return lhs.startMs < rhs.startMs; });
+
+		double totalMs{}, sumMs{};
+		std::cout << "Startup stages (" << m_ThreadPool.GetNumThreads() << " worker threads), ms since start:\n" << std::fixed << std::setprecision(1);
+		for (const StageTiming& timing : timings)
+		{
+			std::cout << "  " << std::left << std::setw(44) << timing.name << std::right << (timing.isWorker ? " worker" : " main  ")
+				<< std::setw(9) << timing.startMs << " -> " << std::setw(7) << timing.endMs << std::setw(9) << timing.endMs - timing.startMs << " ms\n";
+
+			totalMs = std::max(totalMs, timing.endMs);
+			sumMs += timing.endMs - timing.startMs;
+		}
+
+		std::cout << "  startup " << totalMs << " ms, stages one after another would take " << sumMs << " ms ("
+			<< std::setprecision(2) << sumMs / std::max(totalMs, 1e-3) << "x)\n" << std::defaultfloat;
+	}
+}
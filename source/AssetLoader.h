@@ -0,0 +1,88 @@
+#pragma once
+#include "ThreadPool.h"
+#include <chrono>
+#include <string>
+
+namespace dae
+{
+	//Runs the device independent part of asset loading (OBJ parsing and tangents through the mesh cache, image decoding,
+	//effect compilation) on a worker pool and hands out futures, see Mesh::RequestVehicleAssets.
+	//Creating device objects from the results is left to the thread that owns the device.
+	//Every stage is timed so the overlap can be printed at the end of startup
+	class AssetLoader final
+	{
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		struct StageTiming
+		{
+			std::string name{};
+			double startMs{};
+			double endMs{};
+			bool isWorker{};
+		};
+
+		//0 threads: one per hardware thread
+		explicit AssetLoader(uint32_t numThreads = 0);
+		~AssetLoader() = default;
+
+		// -----------------------------------------------
+		// Copy/move constructors and assignment operators
+		// -----------------------------------------------
+		AssetLoader(const AssetLoader& other)					= delete;
+		AssetLoader(AssetLoader&& other) noexcept				= delete;
+		AssetLoader& operator=(const AssetLoader& other)		= delete;
+		AssetLoader& operator=(AssetLoader&& other) noexcept	= delete;
+
+		//------------------------------------------------
+		// Public member functions
+		//------------------------------------------------
+		//Runs function on the pool and records it as a stage
+		template <typename Function>
+		std::future<std::invoke_result_t<std::decay_t<Function>>> Submit(const std::string& name, Function&& function)
+		{
+			return m_ThreadPool.Submit([this, name, function = std::forward<Function>(function)]() mutable
+			{
+				const Clock::time_point start{ Clock::now() };
+				struct StageRecorder
+				{
+					AssetLoader* pLoader;
+					const std::string& name;
+					Clock::time_point start;
+					~StageRecorder() { pLoader->RecordStage(name, start, Clock::now(), true); }
+				} recorder{ this, name, start };
+
+				return function();
+			});
+		}
+
+		//Runs function on the calling thread and records it as a stage
+		template <typename Function>
+		void Measure(const std::string& name, Function&& function)
+		{
+			const Clock::time_point start{ Clock::now() };
+			function();
+			RecordStage(name, start, Clock::now(), false);
+		}
+
+		//Caller owns the surface, nullptr when the file can't be decoded
+		std::future<SDL_Surface*> DecodeImage(const std::string& path);
+		//Caller owns the blob, see Effect::CompileEffect. pDefines is copied, its strings must outlive the task
+		std::future<ID3DBlob*> CompileEffect(const std::wstring& path, const D3D_SHADER_MACRO* pDefines = nullptr);
+
+		void RecordStage(const std::string& name, Clock::time_point start, Clock::time_point end, bool isWorker);
+		void PrintTimings() const;
+
+	private:
+		//------------------------------------------------
+		// Member Variables
+		//------------------------------------------------
+		const Clock::time_point m_StartTime{ Clock::now() };
+
+		mutable std::mutex m_TimingMutex{};
+		std::vector<StageTiming> m_Timings{};
+
+		//Last member: its destructor finishes the queued tasks while everything they touch still exists
+		ThreadPool m_ThreadPool;
+	};
+}
@@ -0,0 +1,275 @@
+#include "pch.h"
+#include "BatchTransform.h"
+#include "Simd.h"
+
+namespace dae
+{
+	void Vector3Stream::Resize(uint32_t count)
+	{
+		x.resize(count);
+		y.resize(count);
+		z.resize(count);
+	}
+
+	void Vector3Stream::Set(uint32_t index, const Vector3& value)
+	{
+		x[index] = value.x;
+		y[index] = value.y;
+		z[index] = value.z;
+	}
+
+	Vector3 Vector3Stream::Get(uint32_t index) const
+	{
+		return Vector3{ x[index], y[index], z[index] };
+	}
+
+	uint32_t Vector3Stream::GetCount() const
+	{
+		return static_cast<uint32_t>(x.size());
+	}
+
+	namespace BatchTransform
+	{
+		namespace
+		{
+			//Row-major coefficients, m[r][c] multiplies input component r into output component c
+			struct Coefficients
+			{
+				float m[4][4]{};
+
+				explicit Coefficients(const Matrix& matrix)
+				{
+					for (int r{ 0 }; r < 4; ++r)
+					{
+						const Vector4 row{ matrix[r] };
+						m[r][0] = row.x;
+						m[r][1] = row.y;
+						m[r][2] = row.z;
+						m[r][3] = row.w;
+					}
+				}
+			};
+
+#if defined(DAE_SIMD_AVX)
+			//Eight SoA lanes to eight consecutive Vector4. Transposes both 128-bit halves at once (vertices 0-3 low, 4-7 high),
+			//then pairs the halves into full 256-bit stores: 128-bit stores of the halves measured slower once the output left L2
+			inline void StoreTransposed(__m256 x, __m256 y, __m256 z, __m256 w, Vector4* pResult)
+			{
+				const __m256 xy0{ _mm256_unpacklo_ps(x, y) };
+				const __m256 xy1{ _mm256_unpackhi_ps(x, y) };
+				const __m256 zw0{ _mm256_unpacklo_ps(z, w) };
+				const __m256 zw1{ _mm256_unpackhi_ps(z, w) };
+
+				const __m256 v0{ _mm256_shuffle_ps(xy0, zw0, _MM_SHUFFLE(1, 0, 1, 0)) };
+				const __m256 v1{ _mm256_shuffle_ps(xy0, zw0, _MM_SHUFFLE(3, 2, 3, 2)) };
+				const __m256 v2{ _mm256_shuffle_ps(xy1, zw1, _MM_SHUFFLE(1, 0, 1, 0)) };
+				const __m256 v3{ _mm256_shuffle_ps(xy1, zw1, _MM_SHUFFLE(3, 2, 3, 2)) };
+
+				_mm256_storeu_ps(&pResult[0].x, _mm256_permute2f128_ps(v0, v1, 0x20));
+				_mm256_storeu_ps(&pResult[2].x, _mm256_permute2f128_ps(v2, v3, 0x20));
+				_mm256_storeu_ps(&pResult[4].x, _mm256_permute2f128_ps(v0, v1, 0x31));
+				_mm256_storeu_ps(&pResult[6].x, _mm256_permute2f128_ps(v2, v3, 0x31));
+			}
+#endif
+
+#if defined(DAE_SIMD_SSE)
+			//Four SoA lanes to four consecutive Vector4
+			inline void StoreTransposed(__m128 x, __m128 y, __m128 z, __m128 w, Vector4* pResult)
+			{
+				_MM_TRANSPOSE4_PS(x, y, z, w);
+				_mm_storeu_ps(&pResult[0].x, x);
+				_mm_storeu_ps(&pResult[1].x, y);
+				_mm_storeu_ps(&pResult[2].x, z);
+				_mm_storeu_ps(&pResult[3].x, w);
+			}
+#endif
+
+			template <bool IsProjected>
+			void TransformPoints(const Matrix& matrix, const float* pX, const float* pY, const float* pZ, uint32_t count, Vector4* pResult)
+			{
+				const Coefficients c{ matrix };
+				uint32_t i{ 0 };
+
+#if defined(DAE_SIMD_AVX)
+				__m256 m[4][4];
+				for (int r{ 0 }; r < 4; ++r)
+				{
+					for (int col{ 0 }; col < 4; ++col)
+					{
+						m[r][col] = _mm256_set1_ps(c.m[r][col]);
+					}
+				}
+
+				for (; i + 8 <= count; i += 8)
+				{
+					const __m256 x{ _mm256_loadu_ps(pX + i) };
+					const __m256 y{ _mm256_loadu_ps(pY + i) };
+					const __m256 z{ _mm256_loadu_ps(pZ + i) };
+
+					__m256 out[4];
+					for (int col{ 0 }; col < 4; ++col)
+					{
+						out[col] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, m[0][col]), _mm256_mul_ps(y, m[1][col])),
+							_mm256_add_ps(_mm256_mul_ps(z, m[2][col]), m[3][col]));
+					}
+
+					if constexpr (IsProjected)
+					{
+						const __m256 invW{ _mm256_div_ps(_mm256_set1_ps(1.f), out[3]) };
+						out[0] = _mm256_mul_ps(out[0], invW);
+						out[1] = _mm256_mul_ps(out[1], invW);
+						out[2] = _mm256_mul_ps(out[2], invW);
+					}
+
+					StoreTransposed(out[0], out[1], out[2], out[3], pResult + i);
+				}
+#endif
+
+#if defined(DAE_SIMD_SSE)
+				__m128 m4[4][4];
+				for (int r{ 0 }; r < 4; ++r)
+				{
+					for (int col{ 0 }; col < 4; ++col)
+					{
+						m4[r][col] = _mm_set1_ps(c.m[r][col]);
+					}
+				}
+
+				for (; i + 4 <= count; i += 4)
+				{
+					const __m128 x{ _mm_loadu_ps(pX + i) };
+					const __m128 y{ _mm_loadu_ps(pY + i) };
+					const __m128 z{ _mm_loadu_ps(pZ + i) };
+
+					__m128 out[4];
+					for (int col{ 0 }; col < 4; ++col)
+					{
+						out[col] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m4[0][col]), _mm_mul_ps(y, m4[1][col])),
+							_mm_add_ps(_mm_mul_ps(z, m4[2][col]), m4[3][col]));
+					}
+
+					if constexpr (IsProjected)
+					{
+						const __m128 invW{ _mm_div_ps(_mm_set1_ps(1.f), out[3]) };
+						out[0] = _mm_mul_ps(out[0], invW);
+						out[1] = _mm_mul_ps(out[1], invW);
+						out[2] = _mm_mul_ps(out[2], invW);
+					}
+
+					StoreTransposed(out[0], out[1], out[2], out[3], pResult + i);
+				}
+#endif
+
+				//Remainder, and everything on the scalar path. Same operation order as the SIMD lanes
+				for (; i < count; ++i)
+				{
+					const float x{ pX[i] }, y{ pY[i] }, z{ pZ[i] };
+
+					float out[4];
+					for (int col{ 0 }; col < 4; ++col)
+					{
+						out[col] = (x * c.m[0][col] + y * c.m[1][col]) + (z * c.m[2][col] + c.m[3][col]);
+					}
+
+					if constexpr (IsProjected)
+					{
+						const float invW{ 1.f / out[3] };
+						out[0] *= invW;
+						out[1] *= invW;
+						out[2] *= invW;
+					}
+
+					pResult[i] = Vector4{ out[0], out[1], out[2], out[3] };
+				}
+			}
+		}
+
+		void TransformPoints(const Matrix& matrix, const float* pX, const float* pY, const float* pZ, uint32_t count, Vector4* pResult)
+		{
+			TransformPoints<false>(matrix, pX, pY, pZ, count, pResult);
+		}
+
+		void TransformPoints(const Matrix& matrix, const Vector3Stream& points, Vector4* pResult)
+		{
+			TransformPoints<false>(matrix, points.x.data(), points.y.data(), points.z.data(), points.GetCount(), pResult);
+		}
+
+		void TransformPointsProjected(const Matrix& matrix, const float* pX, const float* pY, const float* pZ, uint32_t count, Vector4* pResult)
+		{
+			TransformPoints<true>(matrix, pX, pY, pZ, count, pResult);
+		}
+
+		void TransformPointsProjected(const Matrix& matrix, const Vector3Stream& points, Vector4* pResult)
+		{
+			TransformPoints<true>(matrix, points.x.data(), points.y.data(), points.z.data(), points.GetCount(), pResult);
+		}
+
+		void TransformVectors(const Matrix& matrix, const float* pX, const float* pY, const float* pZ, uint32_t count, float* pResultX, float* pResultY, float* pResultZ)
+		{
+			const Coefficients c{ matrix };
+			float* const pResults[3]{ pResultX, pResultY, pResultZ };
+			uint32_t i{ 0 };
+
+#if defined(DAE_SIMD_AVX)
+			__m256 m[3][3];
+			for (int r{ 0 }; r < 3; ++r)
+			{
+				for (int col{ 0 }; col < 3; ++col)
+				{
+					m[r][col] = _mm256_set1_ps(c.m[r][col]);
+				}
+			}
+
+			for (; i + 8 <= count; i += 8)
+			{
+				const __m256 x{ _mm256_loadu_ps(pX + i) };
+				const __m256 y{ _mm256_loadu_ps(pY + i) };
+				const __m256 z{ _mm256_loadu_ps(pZ + i) };
+
+				for (int col{ 0 }; col < 3; ++col)
+				{
+					_mm256_storeu_ps(pResults[col] + i, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, m[0][col]), _mm256_mul_ps(y, m[1][col])), _mm256_mul_ps(z, m[2][col])));
+				}
+			}
+#endif
+
+#if defined(DAE_SIMD_SSE)
+			__m128 m4[3][3];
+			for (int r{ 0 }; r < 3; ++r)
+			{
+				for (int col{ 0 }; col < 3; ++col)
+				{
+					m4[r][col] = _mm_set1_ps(c.m[r][col]);
+				}
+			}
+
+			for (; i + 4 <= count; i += 4)
+			{
+				const __m128 x{ _mm_loadu_ps(pX + i) };
+				const __m128 y{ _mm_loadu_ps(pY + i) };
+				const __m128 z{ _mm_loadu_ps(pZ + i) };
+
+				for (int col{ 0 }; col < 3; ++col)
+				{
+					_mm_storeu_ps(pResults[col] + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m4[0][col]), _mm_mul_ps(y, m4[1][col])), _mm_mul_ps(z, m4[2][col])));
+				}
+			}
+#endif
+
+			for (; i < count; ++i)
+			{
+				const float x{ pX[i] }, y{ pY[i] }, z{ pZ[i] };
+				for (int col{ 0 }; col < 3; ++col)
+				{
+					pResults[col][i] = (x * c.m[0][col] + y * c.m[1][col]) + z * c.m[2][col];
+				}
+			}
+		}
+
+		void TransformVectors(const Matrix& matrix, const Vector3Stream& vectors, Vector3Stream& result)
+		{
+			result.Resize(vectors.GetCount());
+			TransformVectors(matrix, vectors.x.data(), vectors.y.data(), vectors.z.data(), vectors.GetCount(), result.x.data(), result.y.data(), result.z.data());
+		}
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "Matrix.h"
+#include <cstdint>
+#include <vector>
+
+namespace dae
+{
+	//Structure of arrays copy of xyz data, the input layout of BatchTransform
+	struct Vector3Stream
+	{
+		std::vector<float> x{};
+		std::vector<float> y{};
+		std::vector<float> z{};
+
+		void Resize(uint32_t count);
+		void Set(uint32_t index, const Vector3& value);
+		Vector3 Get(uint32_t index) const;
+		uint32_t GetCount() const;
+	};
+
+	//Transforms count elements of separate x, y and z arrays at once, 8 wide with AVX, 4 wide with SSE (see Simd.h).
+	//Inputs and outputs need no particular alignment and may not overlap
+	namespace BatchTransform
+	{
+		//Points (w = 1) to homogeneous clip space
+		void TransformPoints(const Matrix& matrix, const float* pX, const float* pY, const float* pZ, uint32_t count, Vector4* pResult);
+		void TransformPoints(const Matrix& matrix, const Vector3Stream& points, Vector4* pResult);
+
+		//Points (w = 1) to normalized device coordinates: x, y and z divided by w, w kept for perspective correct interpolation.
+		//Points with w == 0 produce infinities, cull or clip against the near plane before using them
+		void TransformPointsProjected(const Matrix& matrix, const float* pX, const float* pY, const float* pZ, uint32_t count, Vector4* pResult);
+		void TransformPointsProjected(const Matrix& matrix, const Vector3Stream& points, Vector4* pResult);
+
+		//Directions (w = 0, no translation) into separate arrays, e.g. normals with the inverse transpose. Not renormalized
+		void TransformVectors(const Matrix& matrix, const float* pX, const float* pY, const float* pZ, uint32_t count, float* pResultX, float* pResultY, float* pResultZ);
+		void TransformVectors(const Matrix& matrix, const Vector3Stream& vectors, Vector3Stream& result);
+	}
+}
@@ -0,0 +1,167 @@
+#include "pch.h"
+#include "BatchTransform.h"
+#include "BenchmarkUtils.h"
+#include "ObjParser.h"
+#include "Simd.h"
+#include <filesystem>
+#include <iomanip>
+#include <string>
+
+using namespace dae;
+
+namespace
+{
+	float GetMaxRelativeDifference(const Vector4& reference, const Vector4& result)
+	{
+		float difference{};
+		for (int i{ 0 }; i < 4; ++i)
+		{
+			difference = std::max(difference, std::abs(reference[i] - result[i]) / std::max(1.f, std::abs(reference[i])));
+		}
+		return difference;
+	}
+
+	void PrintResult(const char* label, const Benchmark::Statistics& perVertex, const Benchmark::Statistics& batch, uint32_t numVertices, float maxDifference)
+	{
+		const double perVertexNs{ perVertex.median * 1e6 / numVertices };
+		const double batchNs{ batch.median * 1e6 / numVertices };
+		std::cout << "  " << std::left << std::setw(20) << label << std::right << std::fixed << std::setprecision(2)
+			<< std::setw(8) << perVertexNs << " ns" << std::setw(8) << batchNs << " ns" << std::setw(8) << perVertexNs / std::max(batchNs, 1e-9) << "x"
+			<< std::setw(9) << std::setprecision(0) << numVertices / (batch.median * 1e3) << " Mvert/s"
+			<< "  max difference " << std::scientific << std::setprecision(1) << maxDifference << "\n";
+	}
+}
+
+int main(int argc, char* args[])
+{
+	int numRuns{ 20 };
+	uint32_t numCopies{ 16 };
+	std::vector<std::string> files{};
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string argument{ args[i] };
+		if (argument == "--runs" && i + 1 < argc)
+			numRuns = std::max(1, std::stoi(args[++i]));
+		else if (argument == "--copies" && i + 1 < argc)
+			numCopies = static_cast<uint32_t>(std::max(1, std::stoi(args[++i])));
+		else
+			files.push_back(argument);
+	}
+
+	std::vector<uint32_t> copyCounts{ 1 };
+	if (numCopies > 1)
+		copyCounts.push_back(numCopies);
+
+	if (files.empty())
+	{
+		files.push_back(DAE_RESOURCE_DIR "vehicle.obj");
+		files.push_back(DAE_RESOURCE_DIR "fireFX.obj");
+	}
+
+	//Same transform chain Mesh::Render builds: world * view * projection
+	const Matrix world{ Matrix::CreateRotationY(0.7f) * Matrix::CreateTranslation(0.f, 0.f, 50.f) };
+	const Matrix view{ Matrix::Inverse(Matrix::CreateRotationX(0.2f) * Matrix::CreateTranslation(0.f, 5.f, -50.f)) };
+	const Matrix projection{ Matrix::CreatePerspectiveFovLH(std::tan(45.f * TO_RADIANS / 2.f), 640.f / 480.f, 0.1f, 100.f) };
+	const Matrix worldViewProjection{ world * view * projection };
+	const Matrix normalMatrix{ Matrix::Transpose(Matrix::Inverse(world)) };
+
+	std::cout << "Batched transforms (" << Simd::GetInstructionSet() << "), per vertex cost of Matrix::TransformPoint vs BatchTransform, median of "
+		<< numRuns << " runs\n";
+
+	for (const std::string& file : files)
+	{
+		std::vector<Vertex_Vehicle> vertices{};
+		std::vector<uint32_t> indices{};
+		if (!ObjParser::ParseObj(file, vertices, indices) || vertices.empty())
+		{
+			std::cout << file << ": unable to parse\n";
+			continue;
+		}
+
+		//One copy is a single mesh the way SoftwareRasterizer transforms it, small enough to stay in the caches.
+		//The copies stand in for a scene with more geometry than fits them, where both paths mostly wait on memory
+		for (const uint32_t copies : copyCounts)
+		{
+			const uint32_t numVertices{ static_cast<uint32_t>(vertices.size()) * copies };
+			std::vector<Vector3> positions(numVertices), normals(numVertices);
+			Vector3Stream positionStream{}, normalStream{}, transformedNormals{};
+			positionStream.Resize(numVertices);
+			normalStream.Resize(numVertices);
+			for (uint32_t i = 0; i < numVertices; ++i)
+			{
+				const Vertex_Vehicle& vertex{ vertices[i % vertices.size()] };
+				positions[i] = vertex.position;
+				normals[i] = vertex.normal;
+				positionStream.Set(i, vertex.position);
+				normalStream.Set(i, vertex.normal);
+			}
+
+			std::vector<Vector4> reference(numVertices), result(numVertices);
+			std::vector<Vector3> referenceNormals(numVertices);
+
+			std::cout << std::filesystem::path{ file }.filename().string() << " (" << vertices.size() << " vertices x " << copies << ")\n"
+				<< "  operation            per vertex   batch  speedup  throughput\n";
+
+			const auto compare = [&]()
+			{
+				float maxDifference{};
+				for (uint32_t i = 0; i < numVertices; ++i)
+					maxDifference = std::max(maxDifference, GetMaxRelativeDifference(reference[i], result[i]));
+				return maxDifference;
+			};
+
+			{
+				const Benchmark::Statistics perVertexStats{ Benchmark::Measure(numRuns, [&]()
+				{
+					for (uint32_t i = 0; i < numVertices; ++i)
+						reference[i] = worldViewProjection.TransformPoint(Vector4{ positions[i], 1.f });
+				}) };
+				const Benchmark::Statistics batchStats{ Benchmark::Measure(numRuns, [&]()
+				{
+					BatchTransform::TransformPoints(worldViewProjection, positionStream, result.data());
+				}) };
+				PrintResult("points to clip", perVertexStats, batchStats, numVertices, compare());
+			}
+
+			{
+				const Benchmark::Statistics perVertexStats{ Benchmark::Measure(numRuns, [&]()
+				{
+					for (uint32_t i = 0; i < numVertices; ++i)
+					{
+						Vector4 clip{ worldViewProjection.TransformPoint(Vector4{ positions[i], 1.f }) };
+						const float invW{ 1.f / clip.w };
+						clip.x *= invW;
+						clip.y *= invW;
+						clip.z *= invW;
+						reference[i] = clip;
+					}
+				}) };
+				const Benchmark::Statistics batchStats{ Benchmark::Measure(numRuns, [&]()
+				{
+					BatchTransform::TransformPointsProjected(worldViewProjection, positionStream, result.data());
+				}) };
+				PrintResult("points to NDC", perVertexStats, batchStats, numVertices, compare());
+			}
+
+			{
+				const Benchmark::Statistics perVertexStats{ Benchmark::Measure(numRuns, [&]()
+				{
+					for (uint32_t i = 0; i < numVertices; ++i)
+						referenceNormals[i] = normalMatrix.TransformVector(normals[i]);
+				}) };
+				const Benchmark::Statistics batchStats{ Benchmark::Measure(numRuns, [&]()
+				{
+					BatchTransform::TransformVectors(normalMatrix, normalStream, transformedNormals);
+				}) };
+
+				float maxDifference{};
+				for (uint32_t i = 0; i < numVertices; ++i)
+					maxDifference = std::max(maxDifference, (referenceNormals[i] - transformedNormals.Get(i)).Magnitude());
+				PrintResult("normals", perVertexStats, batchStats, numVertices, maxDifference);
+			}
+		}
+	}
+
+	return 0;
+}
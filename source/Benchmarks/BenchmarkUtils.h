@@ -0,0 +1,61 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+namespace dae
+{
+	namespace Benchmark
+	{
+		//All durations in milliseconds
+		struct Statistics
+		{
+			double min{};
+			double median{};
+			double mean{};
+			double stdDev{};
+		};
+
+		inline Statistics Summarize(std::vector<double> samples)
+		{
+			Statistics stats{};
+			if (samples.empty())
+				return stats;
+
+			std::sort(samples.begin(), samples.end());
+			stats.min = samples.front();
+			stats.median = samples[samples.size() / 2];
+
+			for (const double sample : samples)
+				stats.mean += sample;
+			stats.mean /= static_cast<double>(samples.size());
+
+			for (const double sample : samples)
+				stats.stdDev += (sample - stats.mean) * (sample - stats.mean);
+			stats.stdDev = std::sqrt(stats.stdDev / static_cast<double>(samples.size()));
+
+			return stats;
+		}
+
+		//Runs function numRuns times (after one untimed warm-up run) and summarizes the wall-clock time of each run
+		template<typename Function>
+		Statistics Measure(int numRuns, Function&& function)
+		{
+			function();
+
+			std::vector<double> samples{};
+			samples.reserve(numRuns);
+			for (int run = 0; run < numRuns; ++run)
+			{
+				const auto start{ std::chrono::steady_clock::now() };
+				function();
+				const auto end{ std::chrono::steady_clock::now() };
+
+				samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+			}
+
+			return Summarize(std::move(samples));
+		}
+	}
+}
@@ -0,0 +1,210 @@
+#include "pch.h"
+#include "BenchmarkUtils.h"
+#include "ColorBatch.h"
+#include "Simd.h"
+#include <bit>
+#include <cstring>
+#include <iomanip>
+#include <random>
+#include <string>
+
+using namespace dae;
+
+//ColorBatch against per-texel, per-channel ColorRGB code: every lane must match the scalar functions exactly,
+//then the throughput of the conversions a CPU sampler, blender or framebuffer write does. Exits with 1 on a mismatch
+namespace
+{
+	//What Texture::Sample did per texel: SDL_GetRGB style shifts and masks, then a division by 255
+	ColorRGB UnpackPerChannel(uint32_t texel)
+	{
+		ColorRGB color{ static_cast<float>(texel & 0xff), static_cast<float>((texel >> 8) & 0xff), static_cast<float>((texel >> 16) & 0xff) };
+		color /= 255.f;
+		return color;
+	}
+
+	//The usual framebuffer write: clamp and scale one channel at a time
+	uint32_t PackPerChannel(const ColorRGB& color)
+	{
+		const uint32_t r{ static_cast<uint32_t>(std::min(std::max(color.r, 0.f), 1.f) * 255.f + 0.5f) };
+		const uint32_t g{ static_cast<uint32_t>(std::min(std::max(color.g, 0.f), 1.f) * 255.f + 0.5f) };
+		const uint32_t b{ static_cast<uint32_t>(std::min(std::max(color.b, 0.f), 1.f) * 255.f + 0.5f) };
+		return r | (g << 8) | (b << 16) | 0xff000000u;
+	}
+
+	bool IsSame(float lhs, float rhs)
+	{
+		return std::memcmp(&lhs, &rhs, sizeof(float)) == 0;
+	}
+
+	bool IsSame(const ColorRGB& lhs, const ColorRGB& rhs)
+	{
+		return IsSame(lhs.r, rhs.r) && IsSame(lhs.g, rhs.g) && IsSame(lhs.b, rhs.b);
+	}
+
+	bool IsSame(const ColorRGBA8& lhs, const ColorRGBA8& rhs)
+	{
+		return lhs.r == rhs.r && lhs.g == rhs.g && lhs.b == rhs.b && lhs.a == rhs.a;
+	}
+
+	bool Check(const char* label, uint32_t numMismatches)
+	{
+		std::cout << "  " << std::left << std::setw(34) << label << std::right << std::setw(8) << numMismatches << " mismatches"
+			<< (numMismatches == 0 ? "" : "  FAILED") << "\n";
+		return numMismatches == 0;
+	}
+
+	void PrintResult(const char* label, const Benchmark::Statistics& scalar, const Benchmark::Statistics& batch, uint32_t numOps)
+	{
+		const double scalarNs{ scalar.median * 1e6 / numOps };
+		const double batchNs{ batch.median * 1e6 / numOps };
+		std::cout << "  " << std::left << std::setw(22) << label << std::right << std::fixed << std::setprecision(2)
+			<< std::setw(9) << scalarNs << " ns" << std::setw(9) << batchNs << " ns" << std::setw(8) << scalarNs / std::max(batchNs, 1e-9) << "x\n";
+	}
+}
+
+int main(int argc, char* args[])
+{
+	int numRuns{ 20 };
+	uint32_t count{ 1 << 18 };
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string argument{ args[i] };
+		if (argument == "--runs" && i + 1 < argc)
+			numRuns = std::max(1, std::stoi(args[++i]));
+		else if (argument == "--count" && i + 1 < argc)
+			count = static_cast<uint32_t>(std::max(1, std::stoi(args[++i])));
+	}
+
+	std::mt19937 random{ 2024 };
+	std::uniform_int_distribution<uint32_t> texel{};
+	//Shading results overshoot [0, 1] before MaxToOne and saturation
+	std::uniform_real_distribution<float> channel{ -0.25f, 2.f };
+	std::uniform_real_distribution<float> unit{ 0.f, 1.f };
+
+	std::vector<ColorRGBA8> texels(count);
+	std::vector<uint32_t> packedTexels(count);
+	std::vector<ColorRGB> colors(count), otherColors(count), results(count);
+	ColorRGBStream colorStream{}, otherColorStream{}, resultStream{};
+	colorStream.Resize(count);
+	otherColorStream.Resize(count);
+	std::vector<float> factors(count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		packedTexels[i] = texel(random);
+		texels[i] = std::bit_cast<ColorRGBA8>(packedTexels[i]);
+		colors[i] = { channel(random), channel(random), channel(random) };
+		otherColors[i] = { channel(random), channel(random), channel(random) };
+		colorStream.Set(i, colors[i]);
+		otherColorStream.Set(i, otherColors[i]);
+		factors[i] = unit(random);
+	}
+	//Edge cases in the first lanes: both ends, the rounding midpoints and NaN
+	const float edges[]{ 0.f, 1.f, -0.f, 0.5f / 255.f, 127.5f / 255.f, 1.00001f, -1e-8f, std::nanf("") };
+	for (uint32_t i = 0; i < std::min<uint32_t>(count, std::size(edges)); ++i)
+		colorStream.Set(i, ColorRGB{ edges[i], edges[(i + 1) % std::size(edges)], edges[(i + 2) % std::size(edges)] });
+
+	std::cout << "ColorBatch (" << Simd::GetInstructionSet() << "), " << count << " colors, median of " << numRuns << " runs\n";
+
+	//Exactness: the batch paths lane for lane against ColorRGB and ColorRGBA8
+	uint32_t unpackMismatches{}, divisionMismatches{}, packMismatches{}, roundTripMismatches{}, maxToOneMismatches{}, lerpMismatches{};
+
+	ColorBatch::Unpack(texels.data(), count, resultStream);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		unpackMismatches += !IsSame(resultStream.Get(i), texels[i].ToColor());
+		//x * (1 / 255) against x / 255 differs in the last bit for a few steps, neither rounds to another byte
+		const ColorRGB divided{ UnpackPerChannel(packedTexels[i]) };
+		divisionMismatches += ColorRGBA8::FromColor(divided).r != texels[i].r || std::abs(divided.r - resultStream.r[i]) > 1e-7f;
+	}
+
+	std::vector<ColorRGBA8> packed(count);
+	ColorBatch::Pack(colorStream, packed.data());
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const ColorRGBA8 expected{ ColorRGBA8::FromColor(colorStream.Get(i)) };
+		packMismatches += !IsSame(packed[i], expected);
+	}
+
+	//Every channel value survives unpack and pack
+	std::vector<ColorRGBA8> allSteps(256);
+	for (uint32_t i = 0; i < 256; ++i)
+		allSteps[i] = { static_cast<uint8_t>(i), static_cast<uint8_t>(255 - i), static_cast<uint8_t>(i * 7), 255 };
+	ColorRGBStream stepStream{};
+	ColorBatch::Unpack(allSteps.data(), 256, stepStream);
+	std::vector<ColorRGBA8> repacked(256);
+	ColorBatch::Pack(stepStream, repacked.data());
+	for (uint32_t i = 0; i < 256; ++i)
+		roundTripMismatches += !IsSame(repacked[i], allSteps[i]);
+
+	resultStream = colorStream;
+	ColorBatch::MaxToOne(resultStream);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		ColorRGB expected{ colorStream.Get(i) };
+		expected.MaxToOne();
+		maxToOneMismatches += !IsSame(resultStream.Get(i), expected) && !std::isnan(expected.r + expected.g + expected.b);
+	}
+
+	ColorBatch::Lerp(colorStream, otherColorStream, factors.data(), resultStream);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const ColorRGB expected{ ColorRGB::Lerp(colorStream.Get(i), otherColorStream.Get(i), factors[i]) };
+		lerpMismatches += !IsSame(resultStream.Get(i), expected) && !std::isnan(expected.r + expected.g + expected.b);
+	}
+
+	bool isPassed{ true };
+	isPassed &= Check("unpack vs ColorRGBA8::ToColor", unpackMismatches);
+	isPassed &= Check("unpack vs SDL_GetRGB / 255", divisionMismatches);
+	isPassed &= Check("pack vs ColorRGBA8::FromColor", packMismatches);
+	isPassed &= Check("unpack, pack round trip", roundTripMismatches);
+	isPassed &= Check("MaxToOne vs ColorRGB", maxToOneMismatches);
+	isPassed &= Check("Lerp vs ColorRGB", lerpMismatches);
+	std::cout << "\n  per color                      scalar     batch  speedup\n";
+
+	const auto measure = [&](const char* label, auto&& scalarKernel, auto&& batchKernel)
+	{
+		const Benchmark::Statistics scalarStats{ Benchmark::Measure(numRuns, scalarKernel) };
+		const Benchmark::Statistics batchStats{ Benchmark::Measure(numRuns, batchKernel) };
+		PrintResult(label, scalarStats, batchStats, count);
+	};
+
+	std::vector<uint32_t> framebuffer(count);
+	measure("unpack RGBA8",
+		[&]() { for (uint32_t i = 0; i < count; ++i) results[i] = UnpackPerChannel(packedTexels[i]); },
+		[&]() { ColorBatch::Unpack(texels.data(), count, resultStream); });
+	measure("pack RGBA8",
+		[&]() { for (uint32_t i = 0; i < count; ++i) framebuffer[i] = PackPerChannel(colors[i]); },
+		[&]() { ColorBatch::Pack(colorStream, packed.data()); });
+	measure("MaxToOne",
+		[&]() { for (uint32_t i = 0; i < count; ++i) { results[i] = colors[i]; results[i].MaxToOne(); } },
+		[&]() { resultStream = colorStream; ColorBatch::MaxToOne(resultStream); });
+	measure("Lerp",
+		[&]() { for (uint32_t i = 0; i < count; ++i) results[i] = ColorRGB::Lerp(colors[i], otherColors[i], factors[i]); },
+		[&]() { ColorBatch::Lerp(colorStream, otherColorStream, factors.data(), resultStream); });
+	measure("blend and write",
+		[&]()
+		{
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				ColorRGB color{ ColorRGB::Lerp(UnpackPerChannel(packedTexels[i]), colors[i], factors[i]) };
+				color.MaxToOne();
+				framebuffer[i] = PackPerChannel(color);
+			}
+		},
+		[&]()
+		{
+			ColorBatch::Unpack(texels.data(), count, resultStream);
+			ColorBatch::Lerp(resultStream, colorStream, factors.data(), resultStream);
+			ColorBatch::MaxToOne(resultStream);
+			ColorBatch::Pack(resultStream, packed.data());
+		});
+
+	//Keeps the results alive, past the NaN edge cases
+	float checksum{};
+	for (uint32_t i = static_cast<uint32_t>(std::size(edges)); i < count; ++i)
+		checksum += results[i].r + resultStream.g[i] + static_cast<float>(framebuffer[i] & 0xff) + packed[i].b;
+	std::cout << std::defaultfloat << "  (checksum " << checksum << ")\n";
+
+	return isPassed ? 0 : 1;
+}
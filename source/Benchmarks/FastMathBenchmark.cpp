@@ -0,0 +1,384 @@
+#include "pch.h"
+#include "BenchmarkUtils.h"
+#include "FastMath.h"
+#include <iomanip>
+#include <random>
+#include <string>
+
+using namespace dae;
+
+//Approximate shading math of FastMath.h against the exact versions: max error over the input range,
+//throughput per kernel, and the error it leaves in an 8-bit image shaded like Vehicle_Shader.fx
+namespace
+{
+	//The math of the Phong pixel shader, exact and approximate. Reciprocals and powers go over a whole image at once,
+	//the way a CPU shader that opts in to the batch kernels would structure it
+	struct ExactMath
+	{
+		static Vector3 Normalized(const Vector3& v)
+		{
+			const float m{ v.Magnitude() };
+			return { v.x / m, v.y / m, v.z / m };
+		}
+
+		static void Reciprocal(const float* pValues, uint32_t count, float* pResults)
+		{
+			for (uint32_t i = 0; i < count; ++i)
+				pResults[i] = 1.f / pValues[i];
+		}
+
+		static void Pow(const float* pCosines, const float* pExponents, uint32_t count, float* pResults)
+		{
+			for (uint32_t i = 0; i < count; ++i)
+				pResults[i] = std::pow(pCosines[i], pExponents[i]);
+		}
+	};
+
+	struct FastMathKernels
+	{
+		static Vector3 Normalized(const Vector3& v)
+		{
+			return v * FastMath::ReciprocalSqrt(v.SqrMagnitude());
+		}
+
+		static void Reciprocal(const float* pValues, uint32_t count, float* pResults)
+		{
+			FastMath::Reciprocal(pValues, count, pResults);
+		}
+
+		static void Pow(const float* pCosines, const float* pExponents, uint32_t count, float* pResults)
+		{
+			FastMath::SpecularPow(pCosines, pExponents, count, pResults);
+		}
+	};
+
+	//Per pixel values a rasterizer would interpolate for a sphere in front of the camera: attributes divided by w, and 1 / w
+	struct Fragments
+	{
+		std::vector<Vector3> positionsOverW{};
+		std::vector<Vector3> normalsOverW{};
+		std::vector<Vector2> uvsOverW{};
+		std::vector<float> invWs{};
+		std::vector<uint8_t> isCovered{};
+	};
+
+	//Procedural stand-ins for the vehicle maps, sampled with point filtering like PS_POINT
+	struct Maps
+	{
+		static constexpr int Size{ 256 };
+		std::vector<ColorRGB> diffuse{};
+		std::vector<Vector3> bump{};
+		std::vector<float> gloss{};
+
+		Maps()
+		{
+			diffuse.resize(Size * Size);
+			bump.resize(Size * Size);
+			gloss.resize(Size * Size);
+			for (int y = 0; y < Size; ++y)
+			{
+				for (int x = 0; x < Size; ++x)
+				{
+					const float u{ (x + 0.5f) / Size };
+					const float v{ (y + 0.5f) / Size };
+					const bool isChecker{ ((x / 16 + y / 32) & 1) != 0 };
+					diffuse[y * Size + x] = isChecker ? ColorRGB{ 0.8f, 0.45f, 0.2f } : ColorRGB{ 0.2f, 0.4f, 0.75f };
+					bump[y * Size + x] = Vector3{ std::sin(u * 80.f), std::sin(v * 60.f), std::cos(u * 80.f) } * 0.15f;
+					gloss[y * Size + x] = 0.5f + 0.5f * std::sin(v * 20.f);
+				}
+			}
+		}
+
+		int GetIndex(const Vector2& uv) const
+		{
+			const int x{ Clamp(static_cast<int>(uv.x * Size), 0, Size - 1) };
+			const int y{ Clamp(static_cast<int>(uv.y * Size), 0, Size - 1) };
+			return y * Size + x;
+		}
+	};
+
+	//Everything PS_POINT needs besides the power, then the power itself
+	struct ShadingTerms
+	{
+		std::vector<float> ws{};
+		std::vector<ColorRGB> lambertDiffuse{};
+		std::vector<float> lambertCosines{};
+		std::vector<float> cosines{};
+		std::vector<float> exponents{};
+		std::vector<float> powers{};
+	};
+
+	constexpr float Shininess{ 25.f };
+	constexpr float LightIntensity{ 7.f };
+	constexpr float Pi{ 3.1415f };
+	constexpr Vector3 LightDirection{ 0.577f, -0.577f, 0.577f };
+	constexpr ColorRGB Specular{ 0.6f, 0.6f, 0.6f };
+
+	Fragments CreateSphereFragments(int width, int height)
+	{
+		constexpr Vector3 Center{ 0.f, 0.f, 3.f };
+		constexpr float Radius{ 1.f };
+		const float tanHalfFov{ std::tan(30.f * TO_RADIANS) };
+		const float aspectRatio{ static_cast<float>(width) / height };
+
+		const size_t numPixels{ static_cast<size_t>(width) * height };
+		Fragments fragments{};
+		//Uncovered pixels are shaded too and thrown away, their defaults keep the math finite
+		fragments.positionsOverW.resize(numPixels, Vector3::UnitZ);
+		fragments.normalsOverW.resize(numPixels, -Vector3::UnitZ);
+		fragments.uvsOverW.resize(numPixels);
+		fragments.invWs.resize(numPixels, 1.f);
+		fragments.isCovered.resize(numPixels);
+
+		for (int py = 0; py < height; ++py)
+		{
+			for (int px = 0; px < width; ++px)
+			{
+				const Vector3 direction{ Vector3{ (2.f * (px + 0.5f) / width - 1.f) * aspectRatio * tanHalfFov, (1.f - 2.f * (py + 0.5f) / height) * tanHalfFov, 1.f }.Normalized() };
+
+				//Ray from the origin against the sphere
+				const float b{ Vector3::Dot(direction, Center) };
+				const float discriminant{ b * b - Center.SqrMagnitude() + Radius * Radius };
+				if (discriminant < 0.f)
+					continue;
+
+				const Vector3 position{ direction * (b - std::sqrt(discriminant)) };
+				const Vector3 normal{ (position - Center) / Radius };
+				const Vector2 uv{ std::atan2(normal.x, -normal.z) / PI_2 + 0.5f, std::acos(Clamp(normal.y, -1.f, 1.f)) / PI };
+
+				const size_t i{ static_cast<size_t>(py) * width + px };
+				const float invW{ 1.f / position.z };
+				fragments.positionsOverW[i] = position * invW;
+				fragments.normalsOverW[i] = normal * invW;
+				fragments.uvsOverW[i] = uv * invW;
+				fragments.invWs[i] = invW;
+				fragments.isCovered[i] = 1;
+			}
+		}
+		return fragments;
+	}
+
+	uint32_t ToPixel(const ColorRGB& color)
+	{
+		const auto toByte = [](float value) { return static_cast<uint32_t>(Saturate(value) * 255.f + 0.5f); };
+		return toByte(color.r) << 16 | toByte(color.g) << 8 | toByte(color.b);
+	}
+
+	//PS_POINT of Vehicle_Shader.fx on procedural maps, to 8-bit colors
+	template<typename Math>
+	void ShadeImage(const Fragments& fragments, const Maps& maps, ShadingTerms& terms, std::vector<uint32_t>& pixels)
+	{
+		const uint32_t numPixels{ static_cast<uint32_t>(fragments.invWs.size()) };
+
+		//Perspective correct interpolation
+		Math::Reciprocal(fragments.invWs.data(), numPixels, terms.ws.data());
+
+		for (uint32_t i = 0; i < numPixels; ++i)
+		{
+			const float w{ terms.ws[i] };
+			const Vector3 worldPosition{ fragments.positionsOverW[i] * w };
+			const int texel{ maps.GetIndex(fragments.uvsOverW[i] * w) };
+
+			//Bumped normal, renormalized
+			const Vector3 interpolatedNormal{ Math::Normalized(fragments.normalsOverW[i] * w) };
+			const Vector3 normal{ Math::Normalized(interpolatedNormal + maps.bump[texel]) };
+
+			const Vector3 reflected{ LightDirection - normal * (2.f * Vector3::Dot(normal, LightDirection)) };
+			const Vector3 viewDirection{ Math::Normalized(worldPosition) };
+
+			terms.lambertDiffuse[i] = maps.diffuse[texel] * LightIntensity / Pi;
+			terms.lambertCosines[i] = Saturate(Vector3::Dot(normal, -LightDirection));
+			terms.cosines[i] = Saturate(Vector3::Dot(reflected, -viewDirection));
+			terms.exponents[i] = maps.gloss[texel] * Shininess;
+		}
+
+		Math::Pow(terms.cosines.data(), terms.exponents.data(), numPixels, terms.powers.data());
+
+		for (uint32_t i = 0; i < numPixels; ++i)
+		{
+			const ColorRGB phong{ Specular * terms.powers[i] };
+			pixels[i] = fragments.isCovered[i] ? ToPixel((phong + terms.lambertDiffuse[i]) * terms.lambertCosines[i]) : 0;
+		}
+	}
+
+	void PrintError(const char* label, double error, const char* unit)
+	{
+		std::cout << "  " << std::left << std::setw(30) << label << std::right << std::scientific << std::setprecision(2) << error << " " << unit << "\n";
+	}
+
+	void PrintResult(const char* label, const Benchmark::Statistics& exact, const Benchmark::Statistics& fast, uint32_t numOps)
+	{
+		const double exactNs{ exact.median * 1e6 / numOps };
+		const double fastNs{ fast.median * 1e6 / numOps };
+		std::cout << "  " << std::left << std::setw(22) << label << std::right << std::fixed << std::setprecision(2)
+			<< std::setw(9) << exactNs << " ns" << std::setw(9) << fastNs << " ns" << std::setw(8) << exactNs / std::max(fastNs, 1e-9) << "x\n";
+	}
+}
+
+int main(int argc, char* args[])
+{
+	int numRuns{ 20 };
+	uint32_t count{ 1 << 16 };
+	int imageSize{ 512 };
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string argument{ args[i] };
+		if (argument == "--runs" && i + 1 < argc)
+			numRuns = std::max(1, std::stoi(args[++i]));
+		else if (argument == "--count" && i + 1 < argc)
+			count = static_cast<uint32_t>(std::max(1, std::stoi(args[++i])));
+		else if (argument == "--size" && i + 1 < argc)
+			imageSize = std::max(16, std::stoi(args[++i]));
+	}
+
+	std::cout << "Fast shading math (" << Simd::GetInstructionSet() << (FastMath::IsEnabled ? ", DAE_FAST_MATH on" : ", DAE_FAST_MATH off") << ")\n"
+		<< "  max error over the input range\n";
+
+	//Accuracy sweeps, against double precision references
+	{
+		double rsqrtError{}, reciprocalError{}, log2Error{}, exp2Error{}, powError{}, normalizeError{};
+		for (int i = 0; i <= 1000000; ++i)
+		{
+			//Log-uniform over 1e-6 .. 1e6
+			const float x{ static_cast<float>(std::pow(10.0, -6.0 + 12.0 * i / 1000000.0)) };
+			rsqrtError = std::max(rsqrtError, std::abs(FastMath::ReciprocalSqrt(x) * std::sqrt(static_cast<double>(x)) - 1.0));
+			reciprocalError = std::max(reciprocalError, std::abs(FastMath::Reciprocal(x) * static_cast<double>(x) - 1.0));
+			log2Error = std::max(log2Error, std::abs(FastMath::Log2(x) - std::log2(static_cast<double>(x))));
+
+			const float exponent{ -20.f + 40.f * i / 1000000.f };
+			exp2Error = std::max(exp2Error, std::abs(FastMath::Exp2(exponent) / std::exp2(static_cast<double>(exponent)) - 1.0));
+		}
+
+		for (int c = 0; c <= 2000; ++c)
+		{
+			const float cosine{ c / 2000.f };
+			for (int e = 0; e <= 250; ++e)
+			{
+				const float exponent{ e * 0.1f };
+				powError = std::max(powError, std::abs(FastMath::SpecularPow(cosine, exponent) - std::pow(static_cast<double>(cosine), static_cast<double>(exponent))));
+			}
+		}
+
+		std::mt19937 random{ 7 };
+		std::uniform_real_distribution<float> coordinate{ -100.f, 100.f };
+		for (int i = 0; i < 1000000; ++i)
+		{
+			const Vector3 v{ coordinate(random), coordinate(random), coordinate(random) };
+			const Vector3 exact{ ExactMath::Normalized(v) };
+			const Vector3 fast{ FastMathKernels::Normalized(v) };
+			normalizeError = std::max({ normalizeError, static_cast<double>(std::abs(fast.x - exact.x)), static_cast<double>(std::abs(fast.y - exact.y)), static_cast<double>(std::abs(fast.z - exact.z)) });
+		}
+
+		PrintError("ReciprocalSqrt", rsqrtError, "relative");
+		PrintError("Reciprocal", reciprocalError, "relative");
+		PrintError("Log2", log2Error, "absolute");
+		PrintError("Exp2", exp2Error, "relative");
+		PrintError("SpecularPow, exponent <= 25", powError, "absolute");
+		PrintError("Normalized", normalizeError, "absolute per component");
+	}
+
+	//Throughput, every kernel over the same random inputs
+	std::mt19937 random{ 42 };
+	std::uniform_real_distribution<float> positive{ 0.01f, 100.f };
+	std::uniform_real_distribution<float> unit{ 0.f, 1.f };
+	std::uniform_real_distribution<float> coordinate{ -100.f, 100.f };
+	std::vector<float> values(count), cosines(count), exponents(count), results(count);
+	std::vector<Vector3> vectors(count), normalized(count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		values[i] = positive(random);
+		cosines[i] = unit(random);
+		exponents[i] = unit(random) * Shininess;
+		vectors[i] = { coordinate(random), coordinate(random), coordinate(random) };
+	}
+
+	std::cout << "\n  kernel                    exact       fast  speedup\n";
+
+	const auto measure = [&](const char* label, auto&& exactKernel, auto&& fastKernel)
+	{
+		const Benchmark::Statistics exactStats{ Benchmark::Measure(numRuns, [&]() { for (uint32_t i = 0; i < count; ++i) exactKernel(i); }) };
+		const Benchmark::Statistics fastStats{ Benchmark::Measure(numRuns, [&]() { for (uint32_t i = 0; i < count; ++i) fastKernel(i); }) };
+		PrintResult(label, exactStats, fastStats, count);
+	};
+
+	measure("1 / sqrt(x)",
+		[&](uint32_t i) { results[i] = 1.f / std::sqrt(values[i]); },
+		[&](uint32_t i) { results[i] = FastMath::ReciprocalSqrt(values[i]); });
+	measure("1 / x",
+		[&](uint32_t i) { results[i] = 1.f / values[i]; },
+		[&](uint32_t i) { results[i] = FastMath::Reciprocal(values[i]); });
+	measure("pow(cosine, gloss)",
+		[&](uint32_t i) { results[i] = std::pow(cosines[i], exponents[i]); },
+		[&](uint32_t i) { results[i] = FastMath::SpecularPow(cosines[i], exponents[i]); });
+	measure("Normalized",
+		[&](uint32_t i) { normalized[i] = ExactMath::Normalized(vectors[i]); },
+		[&](uint32_t i) { normalized[i] = FastMathKernels::Normalized(vectors[i]); });
+
+	//Batch kernels: one call for all inputs against the exact loop, which the compiler is free to vectorize
+	const auto measureBatch = [&](const char* label, auto&& exactKernel, auto&& fastKernel)
+	{
+		const Benchmark::Statistics exactStats{ Benchmark::Measure(numRuns, exactKernel) };
+		const Benchmark::Statistics fastStats{ Benchmark::Measure(numRuns, fastKernel) };
+		PrintResult(label, exactStats, fastStats, count);
+	};
+
+	measureBatch("1 / sqrt(x), batch",
+		[&]() { for (uint32_t i = 0; i < count; ++i) results[i] = 1.f / std::sqrt(values[i]); },
+		[&]() { FastMath::ReciprocalSqrt(values.data(), count, results.data()); });
+	measureBatch("1 / x, batch",
+		[&]() { ExactMath::Reciprocal(values.data(), count, results.data()); },
+		[&]() { FastMath::Reciprocal(values.data(), count, results.data()); });
+	measureBatch("pow, batch",
+		[&]() { ExactMath::Pow(cosines.data(), exponents.data(), count, results.data()); },
+		[&]() { FastMath::SpecularPow(cosines.data(), exponents.data(), count, results.data()); });
+
+	//The shading of a whole image, and what the approximations change in it
+	const Fragments fragments{ CreateSphereFragments(imageSize, imageSize) };
+	const size_t numPixels{ fragments.invWs.size() };
+	const Maps maps{};
+	ShadingTerms terms{};
+	terms.ws.resize(numPixels);
+	terms.lambertDiffuse.resize(numPixels);
+	terms.lambertCosines.resize(numPixels);
+	terms.cosines.resize(numPixels);
+	terms.exponents.resize(numPixels);
+	terms.powers.resize(numPixels);
+	std::vector<uint32_t> exactPixels(numPixels), fastPixels(numPixels);
+
+	const Benchmark::Statistics exactShading{ Benchmark::Measure(numRuns, [&]() { ShadeImage<ExactMath>(fragments, maps, terms, exactPixels); }) };
+	const Benchmark::Statistics fastShading{ Benchmark::Measure(numRuns, [&]() { ShadeImage<FastMathKernels>(fragments, maps, terms, fastPixels); }) };
+
+	uint32_t maxDifference{}, numDifferent{};
+	double squaredError{};
+	for (size_t i = 0; i < numPixels; ++i)
+	{
+		uint32_t pixelDifference{};
+		for (int shift = 0; shift <= 16; shift += 8)
+		{
+			const int difference{ std::abs(static_cast<int>((exactPixels[i] >> shift) & 0xff) - static_cast<int>((fastPixels[i] >> shift) & 0xff)) };
+			pixelDifference = std::max(pixelDifference, static_cast<uint32_t>(difference));
+			squaredError += static_cast<double>(difference) * difference;
+		}
+		maxDifference = std::max(maxDifference, pixelDifference);
+		numDifferent += pixelDifference != 0;
+	}
+
+	const double meanSquaredError{ squaredError / (numPixels * 3.0) };
+	std::cout << "\n  " << imageSize << "x" << imageSize << " Phong shading: exact " << std::fixed << std::setprecision(2) << exactShading.median << " ms ("
+		<< numPixels / (exactShading.median * 1e3) << " Mpixels/s), fast " << fastShading.median << " ms (" << numPixels / (fastShading.median * 1e3) << " Mpixels/s), "
+		<< exactShading.median / std::max(fastShading.median, 1e-9) << "x\n"
+		<< "  image error: max " << maxDifference << "/255, " << numDifferent << " of " << numPixels << " pixels differ, PSNR ";
+	if (meanSquaredError > 0.0)
+		std::cout << 10.0 * std::log10(255.0 * 255.0 / meanSquaredError) << " dB\n";
+	else
+		std::cout << "inf (identical)\n";
+
+	//Keeps the results alive
+	float checksum{};
+	for (uint32_t i = 0; i < count; ++i)
+		checksum += results[i] + normalized[i].x;
+	std::cout << std::defaultfloat << "  (checksum " << checksum << ")\n";
+
+	return 0;
+}
@@ -0,0 +1,112 @@
+#include "pch.h"
+#include "BenchmarkUtils.h"
+#include "Frustum.h"
+#include "Simd.h"
+#include <iomanip>
+#include <random>
+#include <string>
+
+using namespace dae;
+
+//Whole-object frustum culling: Frustum::Cull against one IsVisible call per object, on a field of boxes around the camera.
+//Exits with 1 when the batch and scalar results differ or a transformed box does not contain its transformed corners
+namespace
+{
+	void PrintResult(const char* label, const Benchmark::Statistics& scalar, const Benchmark::Statistics& batch, uint32_t numOps)
+	{
+		const double scalarNs{ scalar.median * 1e6 / numOps };
+		const double batchNs{ batch.median * 1e6 / numOps };
+		std::cout << "  " << std::left << std::setw(22) << label << std::right << std::fixed << std::setprecision(2)
+			<< std::setw(9) << scalarNs << " ns" << std::setw(9) << batchNs << " ns" << std::setw(8) << scalarNs / std::max(batchNs, 1e-9) << "x\n";
+	}
+}
+
+int main(int argc, char* args[])
+{
+	int numRuns{ 20 };
+	uint32_t count{ 100000 };
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string argument{ args[i] };
+		if (argument == "--runs" && i + 1 < argc)
+			numRuns = std::max(1, std::stoi(args[++i]));
+		else if (argument == "--count" && i + 1 < argc)
+			count = static_cast<uint32_t>(std::max(1, std::stoi(args[++i])));
+	}
+
+	//Same camera setup as the application: 45 degree FOV, 0.1 to 100, looking down +z from the origin
+	const Matrix projection{ Matrix::CreatePerspectiveFovLH(std::tan(PI_DIV_4 / 2.f), 4.f / 3.f, 0.1f, 100.f) };
+	const Frustum frustum{ Frustum::FromMatrix(projection) };
+
+	std::mt19937 random{ 2024 };
+	std::uniform_real_distribution<float> coordinate{ -120.f, 120.f };
+	std::uniform_real_distribution<float> size{ 0.5f, 8.f };
+	std::uniform_real_distribution<float> angle{ -PI, PI };
+
+	//Mesh-like objects: a long box whose farthest vertex is well inside the half diagonal, then rotated and moved
+	BoundsStream bounds{};
+	bounds.Resize(count);
+	std::vector<Bounds> objects(count);
+	uint32_t numContainmentErrors{};
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const Vector3 extents{ size(random), size(random) * 0.5f, size(random) * 0.25f };
+		const Bounds object{ Vector3{}, extents, extents.Magnitude() * 0.8f };
+		const Matrix world{ Matrix::CreateRotation(angle(random), angle(random), angle(random))
+			* Matrix::CreateTranslation(coordinate(random), coordinate(random), coordinate(random)) };
+
+		objects[i] = object.Transform(world);
+		bounds.Set(i, objects[i]);
+
+		for (int corner{ 0 }; corner < 8; ++corner)
+		{
+			const Vector3 point{ world.TransformPoint({ corner & 1 ? extents.x : -extents.x, corner & 2 ? extents.y : -extents.y, corner & 4 ? extents.z : -extents.z }) };
+			const Vector3 offset{ point - objects[i].center };
+			for (int axis{ 0 }; axis < 3; ++axis)
+				numContainmentErrors += std::abs(offset[axis]) > objects[i].extents[axis] * 1.0001f + 1e-4f;
+		}
+	}
+
+	//Exactness and how much each test culls
+	std::vector<uint8_t> isVisible{};
+	FrustumCullStatistics statistics{};
+	frustum.Cull(bounds, isVisible, statistics);
+
+	uint32_t numMismatches{}, numSphereVisible{}, numBoxVisible{}, numHalfDiagonalVisible{};
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const Bounds& object{ objects[i] };
+		numMismatches += isVisible[i] != static_cast<uint8_t>(frustum.IsVisible(object));
+		numSphereVisible += frustum.IsSphereVisible(object.center, object.radius);
+		numBoxVisible += frustum.IsBoxVisible(object.center, object.extents);
+		numHalfDiagonalVisible += frustum.IsSphereVisible(object.center, object.extents.Magnitude());
+	}
+
+	std::cout << "Frustum culling (" << Simd::GetInstructionSet() << "), " << count << " objects, median of " << numRuns << " runs\n"
+		<< "  batch vs IsVisible: " << numMismatches << " mismatches" << (numMismatches == 0 ? "" : "  FAILED") << "\n"
+		<< "  transformed boxes missing a corner: " << numContainmentErrors << (numContainmentErrors == 0 ? "" : "  FAILED") << "\n"
+		<< "  visible: half-diagonal sphere " << numHalfDiagonalVisible << ", vertex sphere " << numSphereVisible << ", box " << numBoxVisible
+		<< ", box and sphere " << statistics.numVisible << " (" << statistics.numCulled << " of " << statistics.numTested << " culled)\n\n"
+		<< "  per object                     scalar     batch  speedup\n";
+
+	const auto measure = [&](const char* label, auto&& scalarKernel, auto&& batchKernel)
+	{
+		const Benchmark::Statistics scalarStats{ Benchmark::Measure(numRuns, scalarKernel) };
+		const Benchmark::Statistics batchStats{ Benchmark::Measure(numRuns, batchKernel) };
+		PrintResult(label, scalarStats, batchStats, count);
+	};
+
+	std::vector<uint8_t> scalarIsVisible(count);
+	measure("box and sphere",
+		[&]() { for (uint32_t i = 0; i < count; ++i) scalarIsVisible[i] = frustum.IsVisible(bounds.Get(i)); },
+		[&]() { frustum.Cull(bounds, isVisible, statistics); });
+
+	//Keeps the results alive
+	uint32_t checksum{};
+	for (uint32_t i = 0; i < count; ++i)
+		checksum += scalarIsVisible[i] + isVisible[i];
+	std::cout << "  (checksum " << checksum << ")\n";
+
+	return numMismatches == 0 && numContainmentErrors == 0 ? 0 : 1;
+}
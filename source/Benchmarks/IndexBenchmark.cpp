@@ -0,0 +1,125 @@
+#include "pch.h"
+#include "BenchmarkUtils.h"
+#include "IndexCodec.h"
+#include "MeshOptimizer.h"
+#include "ObjParser.h"
+#include <filesystem>
+#include <iomanip>
+#include <string>
+
+using namespace dae;
+
+namespace
+{
+	//The codec may rotate the corners of a triangle but must keep the triangle order and winding
+	bool AreSameTriangles(const std::vector<uint32_t>& original, const std::vector<uint32_t>& decoded)
+	{
+		if (original.size() != decoded.size())
+			return false;
+
+		for (size_t i = 0; i + 2 < original.size(); i += 3)
+		{
+			bool isRotation{ false };
+			for (size_t rotation = 0; rotation < 3 && !isRotation; ++rotation)
+			{
+				isRotation = decoded[i] == original[i + rotation]
+					&& decoded[i + 1] == original[i + (rotation + 1) % 3]
+					&& decoded[i + 2] == original[i + (rotation + 2) % 3];
+			}
+
+			if (!isRotation)
+				return false;
+		}
+
+		return true;
+	}
+}
+
+int main(int argc, char* args[])
+{
+	int numRuns{ 10 };
+	std::vector<std::string> files{};
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string argument{ args[i] };
+		if (argument == "--runs" && i + 1 < argc)
+			numRuns = std::max(1, std::stoi(args[++i]));
+		else
+			files.push_back(argument);
+	}
+
+	//Every mesh in Resources by default
+	if (files.empty())
+	{
+		for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator{ DAE_RESOURCE_DIR })
+		{
+			if (entry.path().extension() == ".obj")
+				files.push_back(entry.path().string());
+		}
+		std::sort(files.begin(), files.end());
+	}
+
+	uint64_t totalBytes32{}, totalBytesAuto{}, totalBytesCompressed{};
+
+	for (const std::string& file : files)
+	{
+		std::vector<Vertex_Vehicle> vertices{};
+		std::vector<uint32_t> indices{};
+
+		const Benchmark::Statistics parseStats{ Benchmark::Measure(numRuns, [&]() { ObjParser::ParseObj(file, vertices, indices); }) };
+		if (indices.empty())
+		{
+			std::cout << file << ": unable to parse\n";
+			continue;
+		}
+
+		//Same buffers the mesh cache stores
+		const uint32_t numVertices{ static_cast<uint32_t>(vertices.size()) };
+		MeshOptimizer::OptimizeVertexCache(indices, numVertices);
+		MeshOptimizer::OptimizeVertexFetch(vertices, indices);
+
+		const uint32_t indexStride{ numVertices <= 0x10000 ? 2u : 4u };
+		const uint32_t numIndices{ static_cast<uint32_t>(indices.size()) };
+
+		std::vector<uint8_t> encoded{};
+		const Benchmark::Statistics encodeStats{ Benchmark::Measure(numRuns, [&]() { encoded = IndexCodec::Encode(indices); }) };
+
+		std::vector<char> decoded(size_t(numIndices) * indexStride);
+		bool isDecoded{};
+		const Benchmark::Statistics decodeStats{ Benchmark::Measure(numRuns, [&]()
+		{
+			isDecoded = IndexCodec::Decode(encoded.data(), encoded.size(), decoded.data(), numIndices, indexStride, numVertices);
+		}) };
+
+		std::vector<uint32_t> decodedIndices(numIndices);
+		for (uint32_t i = 0; i < numIndices; ++i)
+		{
+			decodedIndices[i] = indexStride == 2 ? reinterpret_cast<const uint16_t*>(decoded.data())[i] : reinterpret_cast<const uint32_t*>(decoded.data())[i];
+		}
+		const bool isLossless{ isDecoded && AreSameTriangles(indices, decodedIndices) };
+
+		const uint64_t bytes32{ uint64_t(numIndices) * sizeof(uint32_t) };
+		const uint64_t bytesAuto{ uint64_t(numIndices) * indexStride };
+		totalBytes32 += bytes32;
+		totalBytesAuto += bytesAuto;
+		totalBytesCompressed += encoded.size();
+
+		std::cout << std::filesystem::path{ file }.filename().string() << " (" << numVertices << " vertices, " << numIndices / 3 << " triangles)\n"
+			<< std::fixed << std::setprecision(1)
+			<< "  32-bit     " << std::setw(9) << bytes32 / 1024.0 << " KiB\n"
+			<< "  " << indexStride * 8 << "-bit     " << std::setw(9) << bytesAuto / 1024.0 << " KiB  saves " << 100.0 * (bytes32 - bytesAuto) / bytes32 << "%\n"
+			<< "  compressed " << std::setw(9) << encoded.size() / 1024.0 << " KiB  saves " << 100.0 * (bytes32 - encoded.size()) / bytes32 << "%, "
+			<< std::setprecision(2) << encoded.size() * 8.0 / (numIndices / 3) << " bits/triangle, " << (isLossless ? "lossless" : "MISMATCH") << "\n"
+			<< std::setprecision(3) << "  encode " << encodeStats.median << " ms, decode " << decodeStats.median << " ms, parse " << parseStats.median
+			<< " ms (decode " << std::setprecision(1) << parseStats.median / std::max(decodeStats.median, 1e-6) << "x faster)\n";
+	}
+
+	if (totalBytes32 > 0)
+	{
+		std::cout << std::fixed << std::setprecision(1) << "total: 32-bit " << totalBytes32 / 1024.0 << " KiB, automatic " << totalBytesAuto / 1024.0
+			<< " KiB, compressed " << totalBytesCompressed / 1024.0 << " KiB (" << 100.0 * (totalBytes32 - totalBytesCompressed) / totalBytes32 << "% saved)\n";
+	}
+
+	return 0;
+}
@@ -0,0 +1,155 @@
+#include "pch.h"
+#include "BenchmarkUtils.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "ObjParser.h"
+#include <cmath>
+#include <iomanip>
+#include <string>
+
+using namespace dae;
+
+namespace
+{
+	constexpr float ScreenWidth{ 640.f };
+	constexpr float ScreenHeight{ 480.f };
+	constexpr float MaxLodPixelError{ 1.f };
+
+	//CPU stand-in for the GPU geometry stage: every referenced vertex is transformed once and every triangle is set up
+	//(perspective divide, viewport, signed area). Returns the number of front-facing triangles so nothing gets optimized away
+	uint32_t RunGeometryStage(const std::vector<Vertex_Vehicle>& vertices, const uint32_t* pIndices, uint32_t numIndices, const Matrix& worldViewProjection,
+		std::vector<Vector4>& screenPositions, std::vector<uint32_t>& transformedFrame, uint32_t frame)
+	{
+		uint32_t numFrontFacing{};
+		for (uint32_t i = 0; i + 2 < numIndices; i += 3)
+		{
+			Vector4 corners[3]{};
+			for (uint32_t corner = 0; corner < 3; ++corner)
+			{
+				const uint32_t index{ pIndices[i + corner] };
+				if (transformedFrame[index] != frame)
+				{
+					const Vector4 clip{ worldViewProjection.TransformPoint(Vector4{ vertices[index].position, 1.f }) };
+					const float inverseW{ 1.f / clip.w };
+					screenPositions[index] = { (clip.x * inverseW + 1.f) * 0.5f * ScreenWidth, (1.f - clip.y * inverseW) * 0.5f * ScreenHeight, clip.z * inverseW, inverseW };
+					transformedFrame[index] = frame;
+				}
+				corners[corner] = screenPositions[index];
+			}
+
+			const float area{ (corners[1].x - corners[0].x) * (corners[2].y - corners[0].y) - (corners[1].y - corners[0].y) * (corners[2].x - corners[0].x) };
+			numFrontFacing += area > 0.f ? 1 : 0;
+		}
+		return numFrontFacing;
+	}
+}
+
+int main(int argc, char* args[])
+{
+	int numRuns{ 50 };
+	std::vector<std::string> files{};
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string argument{ args[i] };
+		if (argument == "--runs" && i + 1 < argc)
+			numRuns = std::max(1, std::stoi(args[++i]));
+		else
+			files.push_back(argument);
+	}
+
+	if (files.empty())
+	{
+		files.push_back(DAE_RESOURCE_DIR "vehicle.obj");
+		files.push_back(DAE_RESOURCE_DIR "fireFX.obj");
+	}
+
+	//The renderer's camera, with the far plane pushed out so the sweep can go past its 100 units
+	const float fov{ std::tan(45.f * TO_RADIANS / 2.f) };
+	const Matrix projection{ Matrix::CreatePerspectiveFovLH(fov, ScreenWidth / ScreenHeight, 0.1f, 1000.f) };
+
+	for (const std::string& file : files)
+	{
+		std::vector<Vertex_Vehicle> vertices{};
+		std::vector<uint32_t> indices{};
+
+		if (!ObjParser::ParseObj(file, vertices, indices) || indices.empty())
+		{
+			std::cout << file << ": unable to parse\n";
+			continue;
+		}
+
+		//Same chain the mesh cache stores
+		MeshOptimizer::OptimizeVertexCache(indices, static_cast<uint32_t>(vertices.size()));
+		MeshOptimizer::OptimizeVertexFetch(vertices, indices);
+
+		std::vector<MeshSimplifier::Lod> lods{};
+		const Benchmark::Statistics buildStats{ Benchmark::Measure(std::min(numRuns, 5), [&]() { lods = MeshSimplifier::BuildLodChain(vertices, indices, 4, 0.05f); }) };
+
+		const float extent{ MeshSimplifier::GetMeshExtent(vertices) };
+		std::cout << file << " (" << vertices.size() << " vertices, extent " << extent << ")\n"
+			<< std::fixed << std::setprecision(1) << "  LOD chain built in " << buildStats.median << " ms\n"
+			<< "  LOD  triangles   reduction   error     % of extent   ACMR\n";
+
+		for (size_t lod = 0; lod < lods.size(); ++lod)
+		{
+			const uint32_t numTriangles{ static_cast<uint32_t>(lods[lod].indices.size() / 3) };
+			const float acmr{ MeshOptimizer::AnalyzeVertexCache(lods[lod].indices, static_cast<uint32_t>(vertices.size())).acmr };
+			std::cout << "  " << std::setw(3) << lod << std::setw(11) << numTriangles
+				<< std::setprecision(1) << std::setw(11) << 100.f * numTriangles / (indices.size() / 3) << "%"
+				<< std::setprecision(4) << std::setw(10) << lods[lod].error
+				<< std::setprecision(3) << std::setw(13) << 100.f * lods[lod].error / extent << "%"
+				<< std::setw(8) << acmr << "\n";
+		}
+
+		//Distance sweep, same selection rule as Mesh::Render
+		Vector3 boundsMin{ vertices.front().position }, boundsMax{ boundsMin };
+		for (const Vertex_Vehicle& vertex : vertices)
+		{
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				boundsMin[axis] = std::min(boundsMin[axis], vertex.position[axis]);
+				boundsMax[axis] = std::max(boundsMax[axis], vertex.position[axis]);
+			}
+		}
+		const Vector3 center{ (boundsMin + boundsMax) * 0.5f };
+		const float radius{ (boundsMax - boundsMin).Magnitude() * 0.5f };
+
+		std::vector<Vector4> screenPositions(vertices.size());
+		std::vector<uint32_t> transformedFrame(vertices.size(), 0);
+		uint32_t frame{};
+
+		std::cout << "  distance  LOD  triangles  error px   geometry ms   LOD 0 ms   speedup\n";
+		for (float distance = radius + 5.f; distance < 1000.f - radius; distance *= 1.5f)
+		{
+			const float surfaceDistance{ distance - radius };
+			uint32_t selected{};
+			for (uint32_t lod = static_cast<uint32_t>(lods.size()) - 1; lod > 0 && selected == 0; --lod)
+			{
+				if (MeshSimplifier::GetScreenSpaceError(lods[lod].error, surfaceDistance, 1.f / fov, ScreenHeight) <= MaxLodPixelError)
+					selected = lod;
+			}
+
+			const Matrix worldViewProjection{ Matrix::CreateTranslation(-center.x, -center.y, distance - center.z) * projection };
+
+			const auto measureLod = [&](uint32_t lod)
+			{
+				const std::vector<uint32_t>& lodIndices{ lods[lod].indices };
+				return Benchmark::Measure(numRuns, [&]()
+				{
+					RunGeometryStage(vertices, lodIndices.data(), static_cast<uint32_t>(lodIndices.size()), worldViewProjection, screenPositions, transformedFrame, ++frame);
+				});
+			};
+
+			const Benchmark::Statistics selectedStats{ measureLod(selected) };
+			const Benchmark::Statistics fullStats{ measureLod(0) };
+
+			std::cout << std::setprecision(1) << std::setw(10) << distance << std::setw(5) << selected << std::setw(11) << lods[selected].indices.size() / 3
+				<< std::setprecision(2) << std::setw(10) << MeshSimplifier::GetScreenSpaceError(lods[selected].error, surfaceDistance, 1.f / fov, ScreenHeight)
+				<< std::setprecision(4) << std::setw(14) << selectedStats.median << std::setw(11) << fullStats.median
+				<< std::setprecision(2) << std::setw(9) << fullStats.median / selectedStats.median << "x\n";
+		}
+	}
+
+	return 0;
+}
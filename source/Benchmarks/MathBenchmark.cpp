@@ -0,0 +1,220 @@
+#include "pch.h"
+#include "BenchmarkUtils.h"
+#include "Simd.h"
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <random>
+#include <string>
+
+using namespace dae;
+
+//Micro-benchmarks of the math routines over large randomized inputs.
+//usage: MathBenchmark [--runs N] [--count N] [--filter text] [--json file|-]
+namespace
+{
+	struct CaseResult
+	{
+		std::string name{};
+		std::string group{};
+		uint32_t numOps{};
+		//Per operation, in nanoseconds
+		Benchmark::Statistics nsPerOp{};
+	};
+
+	struct Inputs
+	{
+		std::vector<Vector3> vectors{};
+		std::vector<Vector3> otherVectors{};
+		std::vector<Vector4> vectors4{};
+		std::vector<Vector3> angles{};
+		std::vector<Matrix> matrices{};
+		std::vector<ColorRGB> colors{};
+		std::vector<ColorRGB> otherColors{};
+		std::vector<float> factors{};
+	};
+
+	//Everything a case writes, read back at the end so no case can be optimized away
+	struct Outputs
+	{
+		std::vector<Vector3> vectors{};
+		std::vector<float> scalars{};
+		std::vector<Matrix> matrices{};
+		std::vector<ColorRGB> colors{};
+	};
+
+	Inputs CreateInputs(uint32_t count, uint32_t seed)
+	{
+		std::mt19937 random{ seed };
+		std::uniform_real_distribution<float> coordinate{ -100.f, 100.f };
+		std::uniform_real_distribution<float> angle{ -PI, PI };
+		std::uniform_real_distribution<float> unit{ 0.f, 1.f };
+		std::uniform_real_distribution<float> radiance{ 0.f, 4.f };
+
+		Inputs inputs{};
+		inputs.vectors.resize(count);
+		inputs.otherVectors.resize(count);
+		inputs.vectors4.resize(count);
+		inputs.angles.resize(count);
+		inputs.matrices.resize(count);
+		inputs.colors.resize(count);
+		inputs.otherColors.resize(count);
+		inputs.factors.resize(count);
+
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			inputs.vectors[i] = { coordinate(random), coordinate(random), coordinate(random) };
+			inputs.otherVectors[i] = { coordinate(random), coordinate(random), coordinate(random) };
+			inputs.vectors4[i] = { inputs.vectors[i], unit(random) };
+			inputs.angles[i] = { angle(random), angle(random), angle(random) };
+			//Invertible: rotation and translation
+			inputs.matrices[i] = Matrix::CreateRotation(inputs.angles[i]) * Matrix::CreateTranslation(inputs.otherVectors[i]);
+			inputs.colors[i] = { radiance(random), radiance(random), radiance(random) };
+			inputs.otherColors[i] = { unit(random), unit(random), unit(random) };
+			inputs.factors[i] = unit(random);
+		}
+
+		return inputs;
+	}
+
+	std::string EscapeJson(const std::string& text)
+	{
+		std::string escaped{};
+		for (const char character : text)
+		{
+			if (character == '"' || character == '\\')
+				escaped += '\\';
+			escaped += character;
+		}
+		return escaped;
+	}
+
+	void WriteJson(std::ostream& stream, const std::vector<CaseResult>& results, int numRuns, uint32_t count)
+	{
+		stream << "{\n  \"instructionSet\": \"" << Simd::GetInstructionSet() << "\",\n  \"runs\": " << numRuns << ",\n  \"count\": " << count
+			<< ",\n  \"results\": [\n" << std::setprecision(6) << std::defaultfloat;
+
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			const CaseResult& result{ results[i] };
+			stream << "    { \"name\": \"" << EscapeJson(result.name) << "\", \"group\": \"" << EscapeJson(result.group) << "\", \"ops\": " << result.numOps
+				<< ", \"nsPerOp\": { \"min\": " << result.nsPerOp.min << ", \"median\": " << result.nsPerOp.median << ", \"mean\": " << result.nsPerOp.mean
+				<< ", \"stdDev\": " << result.nsPerOp.stdDev << " }, \"mopsPerSecond\": " << 1e3 / std::max(result.nsPerOp.median, 1e-9) << " }"
+				<< (i + 1 < results.size() ? ",\n" : "\n");
+		}
+
+		stream << "  ]\n}\n";
+	}
+}
+
+int main(int argc, char* args[])
+{
+	int numRuns{ 30 };
+	uint32_t count{ 1 << 16 };
+	std::string filter{};
+	std::string jsonPath{};
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string argument{ args[i] };
+		if (argument == "--runs" && i + 1 < argc)
+			numRuns = std::max(1, std::stoi(args[++i]));
+		else if (argument == "--count" && i + 1 < argc)
+			count = static_cast<uint32_t>(std::max(1, std::stoi(args[++i])));
+		else if (argument == "--filter" && i + 1 < argc)
+			filter = args[++i];
+		else if (argument == "--json" && i + 1 < argc)
+			jsonPath = args[++i];
+		else
+			std::cout << "Unknown argument " << argument << "\n";
+	}
+
+	const Inputs in{ CreateInputs(count, 1337) };
+	Outputs out{};
+	out.vectors.resize(count);
+	out.scalars.resize(count);
+	out.matrices.resize(count);
+	out.colors.resize(count);
+
+	std::vector<CaseResult> results{};
+
+	//A JSON document on stdout has to be the only output
+	const bool isQuiet{ jsonPath == "-" };
+	if (!isQuiet)
+	{
+		std::cout << "Math micro-benchmarks (" << Simd::GetInstructionSet() << "), " << count << " random inputs, " << numRuns << " runs\n"
+			<< "  routine                           median ns   min ns  stddev   Mops/s\n";
+	}
+
+	const auto run = [&](const char* group, const char* name, const std::function<void(uint32_t)>& kernel)
+	{
+		const std::string fullName{ std::string{ group } + "::" + name };
+		if (!filter.empty() && fullName.find(filter) == std::string::npos)
+			return;
+
+		//Every statistic scales linearly from milliseconds per pass to nanoseconds per operation
+		const Benchmark::Statistics pass{ Benchmark::Measure(numRuns, [&]() { kernel(count); }) };
+		const double nsPerOp{ 1e6 / count };
+		const CaseResult result{ name, group, count, { pass.min * nsPerOp, pass.median * nsPerOp, pass.mean * nsPerOp, pass.stdDev * nsPerOp } };
+		if (!isQuiet)
+		{
+			std::cout << "  " << std::left << std::setw(32) << fullName << std::right << std::fixed << std::setprecision(2)
+				<< std::setw(11) << result.nsPerOp.median << std::setw(9) << result.nsPerOp.min << std::setw(8) << result.nsPerOp.stdDev
+				<< std::setw(9) << std::setprecision(0) << 1e3 / std::max(result.nsPerOp.median, 1e-9) << "\n";
+		}
+		results.push_back(result);
+	};
+
+	//Every kernel loops over all inputs itself so the measured loop is the routine, not an indirect call per element
+	run("Vector3", "Magnitude", [&](uint32_t n) { for (uint32_t i = 0; i < n; ++i) out.scalars[i] = in.vectors[i].Magnitude(); });
+	run("Vector3", "Normalized", [&](uint32_t n) { for (uint32_t i = 0; i < n; ++i) out.vectors[i] = in.vectors[i].Normalized(); });
+	run("Vector3", "Normalize", [&](uint32_t n) { for (uint32_t i = 0; i < n; ++i) { out.vectors[i] = in.vectors[i]; out.scalars[i] = out.vectors[i].Normalize(); } });
+	run("Vector3", "Dot", [&](uint32_t n) { for (uint32_t i = 0; i < n; ++i) out.scalars[i] = Vector3::Dot(in.vectors[i], in.otherVectors[i]); });
+	run("Vector3", "Cross", [&](uint32_t n) { for (uint32_t i = 0; i < n; ++i) out.vectors[i] = Vector3::Cross(in.vectors[i], in.otherVectors[i]); });
+	run("Vector3", "Project", [&](uint32_t n) { for (uint32_t i = 0; i < n; ++i) out.vectors[i] = Vector3::Project(in.vectors[i], in.otherVectors[i]); });
+	run("Vector3", "Reject", [&](uint32_t n) { for (uint32_t i = 0; i < n; ++i) out.vectors[i] = Vector3::Reject(in.vectors[i], in.otherVectors[i]); });
+	run("Vector3", "Reflect", [&](uint32_t n) { for (uint32_t i = 0; i < n; ++i) out.vectors[i] = Vector3::Reflect(in.vectors[i], in.otherVectors[i]); });
+	run("Vector4", "Dot", [&](uint32_t n) { for (uint32_t i = 0; i < n; ++i) out.scalars[i] = Vector4::Dot(in.vectors4[i], in.vectors4[n - 1 - i]); });
+	run("Vector4", "Normalized", [&](uint32_t n) { for (uint32_t i = 0; i < n; ++i) out.vectors[i] = in.vectors4[i].Normalized(); });
+
+	run("Matrix", "CreateRotation", [&](uint32_t n) { for (uint32_t i = 0; i < n; ++i) out.matrices[i] = Matrix::CreateRotation(in.angles[i]); });
+	run("Matrix", "CreateRotationY", [&](uint32_t n) { for (uint32_t i = 0; i < n; ++i) out.matrices[i] = Matrix::CreateRotationY(in.angles[i].y); });
+	run("Matrix", "CreateTranslation", [&](uint32_t n) { for (uint32_t i = 0; i < n; ++i) out.matrices[i] = Matrix::CreateTranslation(in.vectors[i]); });
+	run("Matrix", "operator*", [&](uint32_t n) { for (uint32_t i = 0; i < n; ++i) out.matrices[i] = in.matrices[i] * in.matrices[n - 1 - i]; });
+	run("Matrix", "Transpose", [&](uint32_t n) { for (uint32_t i = 0; i < n; ++i) out.matrices[i] = Matrix::Transpose(in.matrices[i]); });
+	run("Matrix", "Inverse", [&](uint32_t n) { for (uint32_t i = 0; i < n; ++i) out.matrices[i] = Matrix::Inverse(in.matrices[i]); });
+	run("Matrix", "TransformPoint", [&](uint32_t n) { for (uint32_t i = 0; i < n; ++i) out.vectors[i] = in.matrices[i].TransformPoint(in.vectors[i]); });
+	run("Matrix", "TransformPoint4", [&](uint32_t n) { for (uint32_t i = 0; i < n; ++i) out.vectors[i] = in.matrices[i].TransformPoint(in.vectors4[i]); });
+	run("Matrix", "TransformVector", [&](uint32_t n) { for (uint32_t i = 0; i < n; ++i) out.vectors[i] = in.matrices[i].TransformVector(in.vectors[i]); });
+
+	run("ColorRGB", "operator+", [&](uint32_t n) { for (uint32_t i = 0; i < n; ++i) out.colors[i] = in.colors[i] + in.otherColors[i]; });
+	run("ColorRGB", "operator*", [&](uint32_t n) { for (uint32_t i = 0; i < n; ++i) out.colors[i] = in.colors[i] * in.otherColors[i]; });
+	run("ColorRGB", "operator*(float)", [&](uint32_t n) { for (uint32_t i = 0; i < n; ++i) out.colors[i] = in.colors[i] * in.factors[i]; });
+	run("ColorRGB", "MaxToOne", [&](uint32_t n) { for (uint32_t i = 0; i < n; ++i) { out.colors[i] = in.colors[i]; out.colors[i].MaxToOne(); } });
+	run("ColorRGB", "Lerp", [&](uint32_t n) { for (uint32_t i = 0; i < n; ++i) out.colors[i] = ColorRGB::Lerp(in.colors[i], in.otherColors[i], in.factors[i]); });
+
+	float checksum{};
+	for (uint32_t i = 0; i < count; ++i)
+		checksum += out.vectors[i].x + out.scalars[i] + out.matrices[i][3][1] + out.colors[i].g;
+
+	if (!isQuiet)
+		std::cout << std::defaultfloat << "  (checksum " << checksum << ")\n";
+
+	if (isQuiet)
+	{
+		WriteJson(std::cout, results, numRuns, count);
+	}
+	else if (!jsonPath.empty())
+	{
+		std::ofstream file{ jsonPath };
+		if (!file)
+		{
+			std::cout << "Unable to write " << jsonPath << "\n";
+			return 1;
+		}
+		WriteJson(file, results, numRuns, count);
+		std::cout << "Wrote " << jsonPath << "\n";
+	}
+
+	return 0;
+}
@@ -0,0 +1,144 @@
+#include "pch.h"
+#include "BenchmarkUtils.h"
+#include <iomanip>
+#include <random>
+#include <string>
+
+#if defined(_MSC_VER)
+#define DAE_NOINLINE __declspec(noinline)
+#else
+#define DAE_NOINLINE __attribute__((noinline))
+#endif
+
+using namespace dae;
+
+namespace
+{
+	//What every operator cost when Vector3 and Matrix were defined in their .cpp files: a call the optimizer can't see through
+	namespace OutOfLine
+	{
+		DAE_NOINLINE Vector3 Add(const Vector3& a, const Vector3& b) { return a + b; }
+		DAE_NOINLINE Vector3 Subtract(const Vector3& a, const Vector3& b) { return a - b; }
+		DAE_NOINLINE Vector3 Scale(const Vector3& a, float s) { return a * s; }
+		DAE_NOINLINE float Dot(const Vector3& a, const Vector3& b) { return Vector3::Dot(a, b); }
+		DAE_NOINLINE Vector3 Cross(const Vector3& a, const Vector3& b) { return Vector3::Cross(a, b); }
+		DAE_NOINLINE Vector3 Reflect(const Vector3& a, const Vector3& b) { return Vector3::Reflect(a, b); }
+		DAE_NOINLINE Vector3 TransformPoint(const Matrix& m, const Vector3& p) { return m.TransformPoint(p); }
+		DAE_NOINLINE Matrix CreateRotationY(float yaw) { return Matrix::CreateRotationY(yaw); }
+		DAE_NOINLINE Matrix CreateTranslation(const Vector3& t) { return Matrix::CreateTranslation(t); }
+		DAE_NOINLINE Matrix CreateScale(float sx, float sy, float sz) { return Matrix::CreateScale(sx, sy, sz); }
+		DAE_NOINLINE Matrix CreatePerspectiveFovLH(float fov, float aspect, float zn, float zf) { return Matrix::CreatePerspectiveFovLH(fov, aspect, zn, zf); }
+		DAE_NOINLINE Matrix Multiply(const Matrix& a, const Matrix& b) { return a * b; }
+	}
+
+	struct ShadingInput
+	{
+		Vector3 position{};
+		Vector3 normal{};
+		Vector3 tangent{};
+	};
+
+	void PrintResult(const char* label, const Benchmark::Statistics& outOfLine, const Benchmark::Statistics& inlined, uint32_t numOps)
+	{
+		const double outOfLineNs{ outOfLine.median * 1e6 / numOps };
+		const double inlinedNs{ inlined.median * 1e6 / numOps };
+		std::cout << "  " << std::left << std::setw(22) << label << std::right << std::fixed << std::setprecision(2)
+			<< std::setw(9) << outOfLineNs << " ns" << std::setw(9) << inlinedNs << " ns" << std::setw(8) << outOfLineNs / std::max(inlinedNs, 1e-9) << "x\n";
+	}
+}
+
+int main(int argc, char* args[])
+{
+	int numRuns{ 20 };
+	uint32_t numElements{ 200000 };
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string argument{ args[i] };
+		if (argument == "--runs" && i + 1 < argc)
+			numRuns = std::max(1, std::stoi(args[++i]));
+		else if (argument == "--count" && i + 1 < argc)
+			numElements = static_cast<uint32_t>(std::max(1, std::stoi(args[++i])));
+	}
+
+	std::mt19937 random{ 42 };
+	std::uniform_real_distribution<float> value{ -1.f, 1.f };
+	std::vector<ShadingInput> inputs(numElements);
+	std::vector<float> angles(numElements);
+	for (uint32_t i = 0; i < numElements; ++i)
+	{
+		inputs[i] = { { value(random), value(random), value(random) }, Vector3{ value(random), value(random), 1.f }.Normalized(), Vector3{ 1.f, value(random), 0.f }.Normalized() };
+		angles[i] = value(random) * PI;
+	}
+
+	std::vector<Vector3> results(numElements);
+	std::vector<Matrix> matrices(numElements);
+	const Vector3 lightDirection{ Vector3{ 0.577f, -0.577f, 0.577f } };
+	const Vector3 viewPosition{ 0.f, 0.f, -50.f };
+
+	std::cout << "Out-of-line vs constexpr inline math, " << numElements << " elements, median of " << numRuns << " runs\n"
+		<< "  workload                 out-of-line     inline  speedup\n";
+
+	const auto measure = [&](const char* label, auto&& outOfLineKernel, auto&& inlineKernel)
+	{
+		const Benchmark::Statistics outOfLineStats{ Benchmark::Measure(numRuns, [&]() { for (uint32_t i = 0; i < numElements; ++i) outOfLineKernel(i); }) };
+		const Benchmark::Statistics inlineStats{ Benchmark::Measure(numRuns, [&]() { for (uint32_t i = 0; i < numElements; ++i) inlineKernel(i); }) };
+		PrintResult(label, outOfLineStats, inlineStats, numElements);
+	};
+
+	//The vector math of the vehicle pixel shader: binormal, reflection and a Phong style term
+	measure("shading vector math",
+		[&](uint32_t i)
+		{
+			const ShadingInput& input{ inputs[i] };
+			const Vector3 binormal{ OutOfLine::Cross(input.normal, input.tangent) };
+			const Vector3 view{ OutOfLine::Subtract(input.position, viewPosition) };
+			const Vector3 reflected{ OutOfLine::Reflect(lightDirection, input.normal) };
+			const float specular{ std::max(0.f, OutOfLine::Dot(reflected, view)) };
+			results[i] = OutOfLine::Add(OutOfLine::Scale(binormal, specular), OutOfLine::Scale(input.normal, OutOfLine::Dot(input.normal, lightDirection)));
+		},
+		[&](uint32_t i)
+		{
+			const ShadingInput& input{ inputs[i] };
+			const Vector3 binormal{ Vector3::Cross(input.normal, input.tangent) };
+			const Vector3 view{ input.position - viewPosition };
+			const Vector3 reflected{ Vector3::Reflect(lightDirection, input.normal) };
+			const float specular{ std::max(0.f, Vector3::Dot(reflected, view)) };
+			results[i] = binormal * specular + input.normal * Vector3::Dot(input.normal, lightDirection);
+		});
+
+	//Per object world matrix, as Mesh::Update and Mesh::Render build it
+	measure("world matrix + point",
+		[&](uint32_t i)
+		{
+			matrices[i] = OutOfLine::Multiply(OutOfLine::CreateRotationY(angles[i]), OutOfLine::CreateTranslation(inputs[i].position));
+			results[i] = OutOfLine::TransformPoint(matrices[i], inputs[i].normal);
+		},
+		[&](uint32_t i)
+		{
+			matrices[i] = Matrix::CreateRotationY(angles[i]) * Matrix::CreateTranslation(inputs[i].position);
+			results[i] = matrices[i].TransformPoint(inputs[i].normal);
+		});
+
+	//Matrices with constant arguments: built at runtime before, folded into the binary now
+	measure("constant matrices",
+		[&](uint32_t i)
+		{
+			const Matrix projection{ OutOfLine::CreatePerspectiveFovLH(0.41421356f, 640.f / 480.f, 0.1f, 100.f) };
+			const Matrix scale{ OutOfLine::CreateScale(0.5f, 0.5f, 0.5f) };
+			results[i] = OutOfLine::TransformPoint(OutOfLine::Multiply(scale, projection), inputs[i].position);
+		},
+		[&](uint32_t i)
+		{
+			constexpr Matrix ScaledProjection{ Matrix::CreateScale(0.5f, 0.5f, 0.5f) * Matrix::CreatePerspectiveFovLH(0.41421356f, 640.f / 480.f, 0.1f, 100.f) };
+			results[i] = ScaledProjection.TransformPoint(inputs[i].position);
+		});
+
+	//Keeps the results alive
+	float checksum{};
+	for (uint32_t i = 0; i < numElements; ++i)
+		checksum += results[i].x + matrices[i][3][0];
+	std::cout << std::defaultfloat << "  (checksum " << checksum << ")\n";
+
+	return 0;
+}
@@ -0,0 +1,265 @@
+#include "pch.h"
+#include "BenchmarkUtils.h"
+#include "FrameConstants.h"
+#include "Simd.h"
+#include <iomanip>
+#include <random>
+#include <string>
+
+using namespace dae;
+
+namespace
+{
+	//The scalar implementation Matrix.cpp had before the SIMD paths, kept as the baseline
+	namespace Reference
+	{
+		Matrix Transpose(const Matrix& m)
+		{
+			Matrix result{};
+			for (int r{ 0 }; r < 4; ++r)
+			{
+				for (int c{ 0 }; c < 4; ++c)
+				{
+					result[r][c] = m[c][r];
+				}
+			}
+			return result;
+		}
+
+		Matrix Multiply(const Matrix& lhs, const Matrix& rhs)
+		{
+			Matrix result{};
+			const Matrix rhsTransposed{ Transpose(rhs) };
+			for (int r{ 0 }; r < 4; ++r)
+			{
+				for (int c{ 0 }; c < 4; ++c)
+				{
+					result[r][c] = Vector4::Dot(lhs[r], rhsTransposed[c]);
+				}
+			}
+			return result;
+		}
+
+		//Only valid for affine matrices, like the original
+		Matrix Inverse(const Matrix& m)
+		{
+			const Vector3 a{ m[0] };
+			const Vector3 b{ m[1] };
+			const Vector3 c{ m[2] };
+			const Vector3 d{ m[3] };
+
+			const float x{ m[0][3] };
+			const float y{ m[1][3] };
+			const float z{ m[2][3] };
+			const float w{ m[3][3] };
+
+			Vector3 s{ Vector3::Cross(a, b) };
+			Vector3 t{ Vector3::Cross(c, d) };
+			Vector3 u{ a * y - b * x };
+			Vector3 v{ c * w - d * z };
+
+			const float invDet{ 1.f / (Vector3::Dot(s, v) + Vector3::Dot(t, u)) };
+			s *= invDet; t *= invDet; u *= invDet; v *= invDet;
+
+			const Vector3 r0{ Vector3::Cross(b, v) + t * y };
+			const Vector3 r1{ Vector3::Cross(v, a) - t * x };
+			const Vector3 r2{ Vector3::Cross(d, u) + s * w };
+
+			return Matrix{
+				Vector4{ r0.x, r1.x, r2.x, 0.f },
+				Vector4{ r0.y, r1.y, r2.y, 0.f },
+				Vector4{ r0.z, r1.z, r2.z, 0.f },
+				Vector4{ -Vector3::Dot(b, t), Vector3::Dot(a, t), -Vector3::Dot(d, s), Vector3::Dot(c, s) } };
+		}
+
+		Vector3 TransformPoint(const Matrix& m, const Vector3& p)
+		{
+			return Vector3{
+				m[0].x * p.x + m[1].x * p.y + m[2].x * p.z + m[3].x,
+				m[0].y * p.x + m[1].y * p.y + m[2].y * p.z + m[3].y,
+				m[0].z * p.x + m[1].z * p.y + m[2].z * p.z + m[3].z };
+		}
+	}
+
+	float GetMaxDifference(const Matrix& lhs, const Matrix& rhs)
+	{
+		float difference{};
+		for (int r{ 0 }; r < 4; ++r)
+		{
+			for (int c{ 0 }; c < 4; ++c)
+			{
+				difference = std::max(difference, std::abs(lhs[r][c] - rhs[r][c]));
+			}
+		}
+		return difference;
+	}
+
+	//Rotation, non-uniform scale and translation, the kind of matrix the renderer inverts
+	Matrix CreateRandomAffine(std::mt19937& random)
+	{
+		std::uniform_real_distribution<float> angle{ -PI, PI };
+		std::uniform_real_distribution<float> scale{ 0.5f, 2.f };
+		std::uniform_real_distribution<float> translation{ -100.f, 100.f };
+
+		return Matrix::CreateScale(scale(random), scale(random), scale(random))
+			* Matrix::CreateRotation(angle(random), angle(random), angle(random))
+			* Matrix::CreateTranslation(translation(random), translation(random), translation(random));
+	}
+
+	//Random entries on top of a dominant diagonal: not affine, well away from singular
+	Matrix CreateRandomGeneral(std::mt19937& random)
+	{
+		std::uniform_real_distribution<float> entry{ -1.f, 1.f };
+
+		Matrix m{};
+		for (int r{ 0 }; r < 4; ++r)
+		{
+			for (int c{ 0 }; c < 4; ++c)
+			{
+				m[r][c] = entry(random) + (r == c ? 3.f : 0.f);
+			}
+		}
+		return m;
+	}
+
+	void PrintResult(const char* label, const Benchmark::Statistics& reference, const Benchmark::Statistics& simd, uint32_t numOps)
+	{
+		const double referenceNs{ reference.median * 1e6 / numOps };
+		const double simdNs{ simd.median * 1e6 / numOps };
+		std::cout << "  " << std::left << std::setw(16) << label << std::right << std::fixed << std::setprecision(2)
+			<< std::setw(9) << referenceNs << " ns/op" << std::setw(9) << simdNs << " ns/op"
+			<< std::setw(8) << referenceNs / std::max(simdNs, 1e-9) << "x\n";
+	}
+}
+
+int main(int argc, char* args[])
+{
+	int numRuns{ 20 };
+	uint32_t numMatrices{ 100000 };
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string argument{ args[i] };
+		if (argument == "--runs" && i + 1 < argc)
+			numRuns = std::max(1, std::stoi(args[++i]));
+		else if (argument == "--count" && i + 1 < argc)
+			numMatrices = static_cast<uint32_t>(std::max(1, std::stoi(args[++i])));
+	}
+
+	std::mt19937 random{ 1234 };
+	std::vector<Matrix> affine(numMatrices), general(numMatrices);
+	std::vector<Vector3> points(numMatrices);
+	std::uniform_real_distribution<float> coordinate{ -50.f, 50.f };
+	for (uint32_t i = 0; i < numMatrices; ++i)
+	{
+		affine[i] = CreateRandomAffine(random);
+		general[i] = CreateRandomGeneral(random);
+		points[i] = { coordinate(random), coordinate(random), coordinate(random) };
+	}
+
+	//Correctness first: same results as the baseline, and a real inverse for non-affine matrices
+	float multiplyError{}, transposeError{}, inverseError{}, generalError{}, transformError{};
+	for (uint32_t i = 0; i < numMatrices; ++i)
+	{
+		const Matrix& a{ affine[i] };
+		const Matrix& b{ affine[(i + 1) % numMatrices] };
+
+		multiplyError = std::max(multiplyError, GetMaxDifference(a * b, Reference::Multiply(a, b)));
+		transposeError = std::max(transposeError, GetMaxDifference(Matrix::Transpose(a), Reference::Transpose(a)));
+		inverseError = std::max(inverseError, GetMaxDifference(Matrix::Inverse(a), Reference::Inverse(a)));
+		generalError = std::max(generalError, GetMaxDifference(general[i] * Matrix::Inverse(general[i]), Matrix{}));
+		transformError = std::max(transformError, (a.TransformPoint(points[i]) - Reference::TransformPoint(a, points[i])).Magnitude());
+	}
+
+	std::cout << "Matrix kernels (" << Simd::GetInstructionSet() << "), " << numMatrices << " matrices, median of " << numRuns << " runs\n"
+		<< std::scientific << std::setprecision(2)
+		<< "  max difference to baseline: multiply " << multiplyError << ", transpose " << transposeError << ", inverse " << inverseError
+		<< ", transform " << transformError << "\n"
+		<< "  max |M * inverse(M) - I| for non-affine M: " << generalError << "\n\n"
+		<< "  operation         baseline      " << std::setw(9) << Simd::GetInstructionSet() << "     speedup\n";
+
+	std::vector<Matrix> results(numMatrices);
+	std::vector<Vector3> transformed(numMatrices);
+
+	const auto measure = [&](const char* label, auto&& referenceKernel, auto&& simdKernel)
+	{
+		const Benchmark::Statistics referenceStats{ Benchmark::Measure(numRuns, [&]()
+		{
+			for (uint32_t i = 0; i < numMatrices; ++i)
+				referenceKernel(i);
+		}) };
+		const Benchmark::Statistics simdStats{ Benchmark::Measure(numRuns, [&]()
+		{
+			for (uint32_t i = 0; i < numMatrices; ++i)
+				simdKernel(i);
+		}) };
+		PrintResult(label, referenceStats, simdStats, numMatrices);
+	};
+
+	measure("multiply",
+		[&](uint32_t i) { results[i] = Reference::Multiply(affine[i], affine[numMatrices - 1 - i]); },
+		[&](uint32_t i) { results[i] = affine[i] * affine[numMatrices - 1 - i]; });
+	measure("multiply chain",
+		[&](uint32_t i) { results[i] = Reference::Multiply(Reference::Multiply(affine[i], affine[numMatrices - 1 - i]), general[i]); },
+		[&](uint32_t i) { results[i] = affine[i] * affine[numMatrices - 1 - i] * general[i]; });
+	measure("transpose",
+		[&](uint32_t i) { results[i] = Reference::Transpose(affine[i]); },
+		[&](uint32_t i) { results[i] = Matrix::Transpose(affine[i]); });
+	measure("inverse",
+		[&](uint32_t i) { results[i] = Reference::Inverse(affine[i]); },
+		[&](uint32_t i) { results[i] = Matrix::Inverse(affine[i]); });
+	measure("transform point",
+		[&](uint32_t i) { transformed[i] = Reference::TransformPoint(affine[i], points[i]); },
+		[&](uint32_t i) { transformed[i] = affine[i].TransformPoint(points[i]); });
+
+	//Fast paths for matrices known to be affine or rigid, against the general inverse of the same matrices
+	std::vector<Matrix> rigid(numMatrices);
+	std::uniform_real_distribution<float> angle{ -PI, PI };
+	for (uint32_t i = 0; i < numMatrices; ++i)
+		rigid[i] = Matrix::CreateRotation(angle(random), angle(random), angle(random)) * Matrix::CreateTranslation(points[i]);
+
+	float affineError{}, rigidError{};
+	for (uint32_t i = 0; i < numMatrices; ++i)
+	{
+		//Relative to the translation, which dominates the entries of the inverse
+		affineError = std::max(affineError, GetMaxDifference(Matrix::InverseAffine(affine[i]), Matrix::Inverse(affine[i])) / std::max(1.f, affine[i].GetTranslation().Magnitude()));
+		rigidError = std::max(rigidError, GetMaxDifference(Matrix::InverseRigid(rigid[i]), Matrix::Inverse(rigid[i])) / std::max(1.f, rigid[i].GetTranslation().Magnitude()));
+	}
+
+	std::cout << "\n" << std::scientific << std::setprecision(2)
+		<< "  max relative difference to Inverse: affine " << affineError << ", rigid " << rigidError << "\n\n"
+		<< "  inverse of        general         fast     speedup\n";
+
+	measure("affine",
+		[&](uint32_t i) { results[i] = Matrix::Inverse(affine[i]); },
+		[&](uint32_t i) { results[i] = Matrix::InverseAffine(affine[i]); });
+	measure("rigid",
+		[&](uint32_t i) { results[i] = Matrix::Inverse(rigid[i]); },
+		[&](uint32_t i) { results[i] = Matrix::InverseRigid(rigid[i]); });
+
+	//Per-mesh matrix setup in Mesh::Render: world * view * projection for every mesh, against
+	//world * viewProjection from the constants Renderer::Render computes once per frame
+	const Matrix view{ rigid[0] };
+	const Matrix inverseView{ Matrix::InverseRigid(rigid[0]) };
+	const Matrix projection{ Matrix::CreatePerspectiveFovLH(std::tan(PI_DIV_4 / 2.f), 16.f / 9.f, 0.1f, 100.f) };
+	const FrameConstants frame{ FrameConstants::Create(view, inverseView, projection, 1920.f, 1080.f) };
+	float frameError{};
+	for (uint32_t i = 0; i < numMatrices; ++i)
+		frameError = std::max(frameError, GetMaxDifference(rigid[i] * frame.viewProjectionMatrix, rigid[i] * view * projection));
+
+	std::cout << "\n" << std::scientific << std::setprecision(2)
+		<< "  max difference of world * viewProjection: " << frameError << "\n\n"
+		<< "  per-mesh setup    per mesh     per frame     speedup\n";
+
+	measure("world view proj",
+		[&](uint32_t i) { results[i] = rigid[i] * view * projection; },
+		[&](uint32_t i) { results[i] = rigid[i] * frame.viewProjectionMatrix; });
+
+	//Keeps the results alive
+	float checksum{};
+	for (uint32_t i = 0; i < numMatrices; ++i)
+		checksum += results[i][3][0] + transformed[i].x;
+	std::cout << std::defaultfloat << "  (checksum " << checksum << ")\n";
+
+	return affineError <= 1e-5f && rigidError <= 1e-5f && frameError <= 1e-3f ? 0 : 1;
+}
@@ -0,0 +1,143 @@
+#include "pch.h"
+#include "BenchmarkUtils.h"
+#include "MeshOptimizer.h"
+#include "Meshlet.h"
+#include "ObjParser.h"
+#include <cmath>
+#include <iomanip>
+#include <string>
+
+using namespace dae;
+
+namespace
+{
+	struct View
+	{
+		const char* label;
+		float pitch;	//degrees
+		float yaw;		//degrees
+		float distance;
+	};
+
+	//Same construction as Camera::CalculateViewMatrix, looking at the mesh origin
+	Matrix CreateCameraToWorld(const View& view)
+	{
+		const Matrix rotation{ Matrix::CreateRotationX(view.pitch * TO_RADIANS) * Matrix::CreateRotationY(view.yaw * TO_RADIANS) };
+		const Vector3 forward{ rotation.GetAxisZ() };
+		return { rotation.GetAxisX(), rotation.GetAxisY(), forward, forward * -view.distance };
+	}
+}
+
+int main(int argc, char* args[])
+{
+	int numRuns{ 100 };
+	std::vector<std::string> files{};
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string argument{ args[i] };
+		if (argument == "--runs" && i + 1 < argc)
+			numRuns = std::max(1, std::stoi(args[++i]));
+		else
+			files.push_back(argument);
+	}
+
+	if (files.empty())
+	{
+		files.push_back(DAE_RESOURCE_DIR "vehicle.obj");
+		files.push_back(DAE_RESOURCE_DIR "fireFX.obj");
+	}
+
+	//Orbit at the renderer's camera distance plus a close-up that leaves most of the mesh off-screen
+	const View views[]
+	{
+		{ "front", 0.f, 0.f, 50.f },
+		{ "front-right", 0.f, 45.f, 50.f },
+		{ "right", 0.f, 90.f, 50.f },
+		{ "back", 0.f, 180.f, 50.f },
+		{ "left", 0.f, 270.f, 50.f },
+		{ "above", 60.f, 30.f, 50.f },
+		{ "close-up", 10.f, 20.f, 12.f },
+	};
+
+	const Matrix projection{ Matrix::CreatePerspectiveFovLH(std::tan(45.f * TO_RADIANS / 2.f), 640.f / 480.f, 0.1f, 100.f) };
+
+	for (const std::string& file : files)
+	{
+		std::vector<Vertex_Vehicle> vertices{};
+		std::vector<uint32_t> indices{};
+
+		if (!ObjParser::ParseObj(file, vertices, indices) || indices.empty())
+		{
+			std::cout << file << ": unable to parse\n";
+			continue;
+		}
+
+		//Same buffers the mesh cache stores
+		MeshOptimizer::OptimizeVertexCache(indices, static_cast<uint32_t>(vertices.size()));
+		MeshOptimizer::OptimizeVertexFetch(vertices, indices);
+
+		//Build reorders the triangles, every run starts from the optimized order
+		const std::vector<uint32_t> optimizedIndices{ indices };
+		std::vector<Meshlet> meshlets{};
+		const Benchmark::Statistics buildStats{ Benchmark::Measure(std::min(numRuns, 10), [&]()
+		{
+			indices = optimizedIndices;
+			meshlets = Meshlets::Build(vertices, indices);
+		}) };
+
+		uint32_t numWithCone{}, numVertexSlots{};
+		for (const Meshlet& meshlet : meshlets)
+		{
+			numWithCone += meshlet.coneCutoff < 1.f ? 1 : 0;
+			numVertexSlots += meshlet.numVertices;
+		}
+
+		std::cout << file << " (" << vertices.size() << " vertices, " << indices.size() / 3 << " triangles)\n"
+			<< std::fixed << std::setprecision(1)
+			<< "  " << meshlets.size() << " meshlets, " << float(indices.size() / 3) / meshlets.size() << " triangles and "
+			<< float(numVertexSlots) / meshlets.size() << " vertices on average, " << 100.f * numWithCone / meshlets.size() << "% with a normal cone"
+			<< std::setprecision(3) << ", build " << buildStats.median << " ms\n";
+
+		const uint32_t indexStride{ vertices.size() <= 0x10000 ? 2u : 4u };
+		std::vector<char> indexData(indices.size() * indexStride);
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			if (indexStride == 2)
+				reinterpret_cast<uint16_t*>(indexData.data())[i] = static_cast<uint16_t>(indices[i]);
+			else
+				reinterpret_cast<uint32_t*>(indexData.data())[i] = indices[i];
+		}
+		std::vector<char> compacted(indexData.size());
+
+		for (const View& view : views)
+		{
+			const Matrix cameraToWorld{ CreateCameraToWorld(view) };
+			const Matrix worldViewProjection{ Matrix::Inverse(cameraToWorld) * projection };
+			const Vector3 cameraPosition{ cameraToWorld.GetTranslation() };
+
+			std::vector<MeshletRange> visibleRanges{};
+			MeshletCullStatistics statistics{};
+			uint32_t numIndices{};
+
+			const Benchmark::Statistics cullStats{ Benchmark::Measure(numRuns, [&]()
+			{
+				Meshlets::Cull(meshlets, worldViewProjection, cameraPosition, true, visibleRanges, statistics);
+			}) };
+			const Benchmark::Statistics compactStats{ Benchmark::Measure(numRuns, [&]()
+			{
+				numIndices = Meshlets::CompactIndices(visibleRanges, indexData.data(), indexStride, compacted.data());
+			}) };
+
+			std::cout << "  " << std::left << std::setw(12) << view.label << std::right
+				<< std::setw(5) << statistics.numTested << " tested" << std::setw(5) << statistics.numFrustumCulled << " frustum"
+				<< std::setw(5) << statistics.numBackFacingCulled << " back-facing  "
+				<< std::setw(6) << numIndices / 3 << "/" << statistics.numTrianglesTotal << " triangles ("
+				<< std::setprecision(1) << std::setw(5) << 100.f * statistics.numTrianglesSubmitted / statistics.numTrianglesTotal << "%) in "
+				<< std::setw(4) << visibleRanges.size() << " ranges"
+				<< std::setprecision(4) << "  cull " << cullStats.median << " ms  compact " << compactStats.median << " ms\n";
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,155 @@
+#include "pch.h"
+#include "BenchmarkUtils.h"
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include "ObjParser.h"
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <string>
+#include <thread>
+
+using namespace dae;
+
+namespace
+{
+	//Largest per-component difference between two parses, -1 when the topology differs
+	float CompareMeshes(const std::vector<Vertex_Vehicle>& verticesA, const std::vector<uint32_t>& indicesA,
+		const std::vector<Vertex_Vehicle>& verticesB, const std::vector<uint32_t>& indicesB)
+	{
+		if (verticesA.size() != verticesB.size() || indicesA != indicesB)
+			return -1.f;
+
+		float maxDifference{};
+		for (size_t i = 0; i < verticesA.size(); ++i)
+		{
+			const float* pA{ reinterpret_cast<const float*>(&verticesA[i]) };
+			const float* pB{ reinterpret_cast<const float*>(&verticesB[i]) };
+			for (size_t c = 0; c < sizeof(Vertex_Vehicle) / sizeof(float); ++c)
+			{
+				maxDifference = std::max(maxDifference, std::abs(pA[c] - pB[c]));
+			}
+		}
+
+		return maxDifference;
+	}
+
+	bool AreByteIdentical(const std::vector<Vertex_Vehicle>& verticesA, const std::vector<uint32_t>& indicesA,
+		const std::vector<Vertex_Vehicle>& verticesB, const std::vector<uint32_t>& indicesB)
+	{
+		return verticesA.size() == verticesB.size() && indicesA == indicesB
+			&& std::memcmp(verticesA.data(), verticesB.data(), verticesA.size() * sizeof(Vertex_Vehicle)) == 0;
+	}
+
+	void PrintStatistics(const char* label, const Benchmark::Statistics& stats)
+	{
+		std::cout << "  " << std::left << std::setw(10) << label << std::right << std::fixed << std::setprecision(3)
+			<< "median " << std::setw(9) << stats.median << " ms"
+			<< "  min " << std::setw(9) << stats.min << " ms"
+			<< "  stddev " << std::setw(7) << stats.stdDev << " ms\n";
+	}
+}
+
+int main(int argc, char* args[])
+{
+	int numRuns{ 10 };
+	uint32_t maxThreads{ std::max(1u, std::thread::hardware_concurrency()) };
+	std::vector<std::string> files{};
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string argument{ args[i] };
+		if (argument == "--runs" && i + 1 < argc)
+			numRuns = std::max(1, std::stoi(args[++i]));
+		else if (argument == "--threads" && i + 1 < argc)
+			maxThreads = static_cast<uint32_t>(std::max(1, std::stoi(args[++i])));
+		else
+			files.push_back(argument);
+	}
+
+	if (files.empty())
+	{
+		files.push_back(DAE_RESOURCE_DIR "vehicle.obj");
+		files.push_back(DAE_RESOURCE_DIR "fireFX.obj");
+	}
+
+	for (const std::string& file : files)
+	{
+		std::vector<Vertex_Vehicle> streamVertices{}, mappedVertices{};
+		std::vector<uint32_t> streamIndices{}, mappedIndices{};
+
+		if (!ObjParser::ParseObjStream(file, streamVertices, streamIndices) || !ObjParser::ParseObj(file, mappedVertices, mappedIndices))
+		{
+			std::cout << file << ": unable to parse\n";
+			continue;
+		}
+
+		const Benchmark::Statistics streamStats{ Benchmark::Measure(numRuns, [&]() { ObjParser::ParseObjStream(file, streamVertices, streamIndices); }) };
+		const Benchmark::Statistics mappedStats{ Benchmark::Measure(numRuns, [&]() { ObjParser::ParseObj(file, mappedVertices, mappedIndices); }) };
+
+		std::cout << file << " (" << mappedVertices.size() << " vertices, " << mappedIndices.size() / 3 << " triangles, " << numRuns << " runs)\n";
+		PrintStatistics("stream", streamStats);
+		PrintStatistics("mapped", mappedStats);
+		std::cout << "  speedup   " << std::setprecision(2) << streamStats.median / mappedStats.median << "x\n";
+
+		const float difference{ CompareMeshes(streamVertices, streamIndices, mappedVertices, mappedIndices) };
+		if (difference < 0.f)
+			std::cout << "  MISMATCH: vertex/index layout differs from the stream parser\n";
+		else
+			std::cout << "  max difference vs stream " << std::scientific << difference << std::defaultfloat << "\n";
+
+		//Thread scaling of the chunked parser, every result must match the single-threaded parse byte for byte
+		std::cout << "  threads   median ms   speedup   identical\n";
+		for (uint32_t numThreads = 1; numThreads <= maxThreads; numThreads = numThreads < maxThreads ? std::min(numThreads * 2, maxThreads) : numThreads + 1)
+		{
+			std::vector<Vertex_Vehicle> parallelVertices{};
+			std::vector<uint32_t> parallelIndices{};
+
+			const Benchmark::Statistics parallelStats{ Benchmark::Measure(numRuns, [&]() { ObjParser::ParseObj(file, parallelVertices, parallelIndices, true, numThreads); }) };
+			const bool isIdentical{ AreByteIdentical(mappedVertices, mappedIndices, parallelVertices, parallelIndices) };
+
+			std::cout << "  " << std::setw(7) << numThreads << std::fixed << std::setprecision(3) << std::setw(12) << parallelStats.median
+				<< std::setprecision(2) << std::setw(9) << mappedStats.median / parallelStats.median << "x"
+				<< std::setw(12) << (isIdentical ? "yes" : "NO") << "\n";
+		}
+
+		//Binary cache: a cold load parses and writes it, every load after that only maps it
+		const std::string cachePath{ MeshCache::GetCachePath(file) };
+		const VertexLayout layout{ VertexLayout::CreateVehicleLayout() };
+
+		const Benchmark::Statistics coldStats{ Benchmark::Measure(numRuns, [&]()
+		{
+			std::remove(cachePath.c_str());
+			const MeshCache cache{ file, layout };
+		}) };
+		const Benchmark::Statistics warmStats{ Benchmark::Measure(numRuns, [&]()
+		{
+			const MeshCache cache{ file, layout };
+		}) };
+
+		//The cache stores the reordered mesh as its first level of detail
+		std::vector<Vertex_Vehicle> optimizedVertices{ mappedVertices };
+		std::vector<uint32_t> optimizedIndices{ mappedIndices };
+		MeshOptimizer::OptimizeVertexCache(optimizedIndices, static_cast<uint32_t>(optimizedVertices.size()));
+		MeshOptimizer::OptimizeVertexFetch(optimizedVertices, optimizedIndices);
+
+		const MeshCache cache{ file, layout };
+		bool isCacheIdentical{ cache.IsValid() && !cache.WasRebuilt()
+			&& cache.GetHeader().lods[0].numIndices == optimizedIndices.size()
+			&& cache.GetVertexDataSize() == optimizedVertices.size() * sizeof(Vertex_Vehicle)
+			&& std::memcmp(cache.GetVertexData(), optimizedVertices.data(), cache.GetVertexDataSize()) == 0 };
+
+		//Indices may be stored as 16-bit
+		for (uint32_t i = 0; isCacheIdentical && i < optimizedIndices.size(); ++i)
+		{
+			isCacheIdentical = cache.GetIndex(i) == optimizedIndices[i];
+		}
+
+		PrintStatistics("rebuild", coldStats);
+		PrintStatistics("cached", warmStats);
+		std::cout << "  speedup   " << std::setprecision(2) << mappedStats.median / warmStats.median << "x vs mapped parse, cache "
+			<< (isCacheIdentical ? "identical" : "MISMATCH") << "\n";
+	}
+
+	return 0;
+}
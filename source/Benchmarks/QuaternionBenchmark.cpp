@@ -0,0 +1,210 @@
+#include "pch.h"
+#include "BenchmarkUtils.h"
+#include <iomanip>
+#include <random>
+#include <string>
+
+using namespace dae;
+
+//Quaternion orientation against the matrix path it replaces in Camera and Mesh: accuracy first, then the per-frame cost.
+//Exits with 1 when an accuracy check fails
+namespace
+{
+	constexpr float MaxError{ 1e-4f };
+
+	//What Camera::CalculateViewMatrix and Mesh::Render did with matrices only
+	namespace MatrixPath
+	{
+		void CalculateCamera(float pitch, float yaw, const Vector3& origin, Matrix& cameraToWorld, Matrix& worldToCamera)
+		{
+			const Matrix rotation{ Matrix::CreateRotationX(pitch) * Matrix::CreateRotationY(yaw) };
+			cameraToWorld = Matrix{ rotation.GetAxisX(), rotation.GetAxisY(), rotation.GetAxisZ(), origin };
+			worldToCamera = Matrix::Inverse(cameraToWorld);
+		}
+
+		Vector3 ToObjectSpace(float yaw, const Vector3& position, const Vector3& point, Matrix& world)
+		{
+			world = Matrix::CreateTranslation(position) * Matrix::CreateRotationY(yaw);
+			return Matrix::Inverse(world).TransformPoint(point);
+		}
+	}
+
+	namespace QuaternionPath
+	{
+		void CalculateCamera(float pitch, float yaw, const Vector3& origin, Matrix& cameraToWorld, Matrix& worldToCamera)
+		{
+			const RigidTransform transform{ Quaternion::CreateRotationX(pitch) * Quaternion::CreateRotationY(yaw), origin };
+			cameraToWorld = transform.ToMatrix();
+			worldToCamera = transform.Inverse().ToMatrix();
+		}
+
+		Vector3 ToObjectSpace(float yaw, const Vector3& position, const Vector3& point, Matrix& world)
+		{
+			const Quaternion rotation{ Quaternion::CreateRotationY(yaw) };
+			const RigidTransform transform{ rotation, rotation.Rotate(position) };
+			world = transform.ToMatrix();
+			return transform.Inverse().TransformPoint(point);
+		}
+	}
+
+	float GetMaxDifference(const Matrix& lhs, const Matrix& rhs)
+	{
+		float difference{};
+		for (int r{ 0 }; r < 4; ++r)
+		{
+			for (int c{ 0 }; c < 4; ++c)
+			{
+				difference = std::max(difference, std::abs(lhs[r][c] - rhs[r][c]));
+			}
+		}
+		return difference;
+	}
+
+	float GetAngle(const Quaternion& q1, const Quaternion& q2)
+	{
+		return 2.f * std::acos(std::min(1.f, std::abs(Quaternion::Dot(q1, q2))));
+	}
+
+	bool Check(const char* label, float error, float maxError = MaxError)
+	{
+		const bool isPassed{ error <= maxError };
+		std::cout << "  " << std::left << std::setw(34) << label << std::right << std::scientific << std::setprecision(2) << error
+			<< (isPassed ? "" : "  FAILED") << "\n";
+		return isPassed;
+	}
+
+	void PrintResult(const char* label, const Benchmark::Statistics& matrix, const Benchmark::Statistics& quaternion, uint32_t numOps)
+	{
+		const double matrixNs{ matrix.median * 1e6 / numOps };
+		const double quaternionNs{ quaternion.median * 1e6 / numOps };
+		std::cout << "  " << std::left << std::setw(22) << label << std::right << std::fixed << std::setprecision(2)
+			<< std::setw(9) << matrixNs << " ns" << std::setw(9) << quaternionNs << " ns" << std::setw(8) << matrixNs / std::max(quaternionNs, 1e-9) << "x\n";
+	}
+}
+
+int main(int argc, char* args[])
+{
+	int numRuns{ 20 };
+	uint32_t count{ 100000 };
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string argument{ args[i] };
+		if (argument == "--runs" && i + 1 < argc)
+			numRuns = std::max(1, std::stoi(args[++i]));
+		else if (argument == "--count" && i + 1 < argc)
+			count = static_cast<uint32_t>(std::max(1, std::stoi(args[++i])));
+	}
+
+	std::mt19937 random{ 2024 };
+	std::uniform_real_distribution<float> angle{ -PI, PI };
+	std::uniform_real_distribution<float> coordinate{ -50.f, 50.f };
+	std::uniform_real_distribution<float> unit{ 0.f, 1.f };
+
+	std::vector<Vector3> angles(count), positions(count), points(count);
+	std::vector<float> factors(count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		angles[i] = { angle(random), angle(random), angle(random) };
+		positions[i] = { coordinate(random), coordinate(random), coordinate(random) };
+		points[i] = { coordinate(random), coordinate(random), coordinate(random) };
+		factors[i] = unit(random);
+	}
+
+	//Accuracy: every quaternion operation against the matrix it stands in for
+	float rotationError{}, productError{}, rotateError{}, cameraError{}, objectSpaceError{}, rigidInverseError{}, unitError{}, slerpError{}, nlerpError{};
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const Vector3& r{ angles[i] };
+		const Vector3& s{ angles[(i + 1) % count] };
+		const Quaternion q1{ Quaternion::CreateRotation(r) };
+		const Quaternion q2{ Quaternion::CreateRotation(s) };
+
+		rotationError = std::max({ rotationError,
+			GetMaxDifference(Quaternion::CreateRotationX(r.x).ToMatrix(), Matrix::CreateRotationX(r.x)),
+			GetMaxDifference(Quaternion::CreateRotationY(r.y).ToMatrix(), Matrix::CreateRotationY(r.y)),
+			GetMaxDifference(Quaternion::CreateRotationZ(r.z).ToMatrix(), Matrix::CreateRotationZ(r.z)),
+			GetMaxDifference(q1.ToMatrix(), Matrix::CreateRotation(r)) });
+		productError = std::max(productError, GetMaxDifference((q1 * q2).ToMatrix(), Matrix::CreateRotation(r) * Matrix::CreateRotation(s)));
+		rotateError = std::max(rotateError, (q1.Rotate(points[i]) - Matrix::CreateRotation(r).TransformVector(points[i])).Magnitude() / points[i].Magnitude());
+
+		Matrix matrixCameraToWorld{}, matrixWorldToCamera{}, cameraToWorld{}, worldToCamera{};
+		MatrixPath::CalculateCamera(r.x, r.y, positions[i], matrixCameraToWorld, matrixWorldToCamera);
+		QuaternionPath::CalculateCamera(r.x, r.y, positions[i], cameraToWorld, worldToCamera);
+		cameraError = std::max({ cameraError, GetMaxDifference(cameraToWorld, matrixCameraToWorld), GetMaxDifference(worldToCamera, matrixWorldToCamera) / 100.f });
+
+		Matrix matrixWorld{}, world{};
+		const Vector3 matrixObjectPoint{ MatrixPath::ToObjectSpace(r.y, positions[i], points[i], matrixWorld) };
+		const Vector3 objectPoint{ QuaternionPath::ToObjectSpace(r.y, positions[i], points[i], world) };
+		objectSpaceError = std::max({ objectSpaceError, GetMaxDifference(world, matrixWorld) / 100.f, (objectPoint - matrixObjectPoint).Magnitude() / 100.f });
+
+		const RigidTransform rigid{ q1, positions[i] };
+		rigidInverseError = std::max(rigidInverseError, GetMaxDifference(rigid.Inverse().ToMatrix(), Matrix::Inverse(rigid.ToMatrix())) / 100.f);
+
+		//Interpolation: unit length, and slerp covers the expected fraction of the arc
+		const Quaternion slerped{ Quaternion::Slerp(q1, q2, factors[i]) };
+		const Quaternion nlerped{ Quaternion::Nlerp(q1, q2, factors[i]) };
+		unitError = std::max({ unitError, std::abs(slerped.Magnitude() - 1.f), std::abs(nlerped.Magnitude() - 1.f), std::abs((q1 * q2).Magnitude() - 1.f) });
+		slerpError = std::max(slerpError, std::abs(GetAngle(q1, slerped) - factors[i] * GetAngle(q1, q2)));
+		nlerpError = std::max(nlerpError, std::abs(GetAngle(q1, nlerped) - factors[i] * GetAngle(q1, q2)));
+	}
+
+	std::cout << "Quaternion orientation, " << count << " random rotations, median of " << numRuns << " runs\n"
+		<< "  max error (translations relative to 100 units)\n";
+
+	bool isPassed{ true };
+	isPassed &= Check("rotation matrices", rotationError);
+	isPassed &= Check("products", productError);
+	isPassed &= Check("rotated vectors (relative)", rotateError);
+	isPassed &= Check("camera view and inverse view", cameraError);
+	isPassed &= Check("mesh world, object space camera", objectSpaceError);
+	isPassed &= Check("rigid inverse", rigidInverseError);
+	isPassed &= Check("unit length", unitError);
+	//Arc angles come out of acos, which loses precision near parallel rotations
+	isPassed &= Check("slerp arc fraction (radians)", slerpError, 2e-3f);
+	std::cout << "  " << std::left << std::setw(34) << "nlerp arc fraction (radians)" << std::right << std::scientific << std::setprecision(2) << nlerpError << "  (approximation)\n\n";
+
+	std::vector<Matrix> cameraToWorld(count), worldToCamera(count);
+	std::vector<Vector3> results(count);
+	std::vector<Quaternion> orientations(count);
+
+	std::cout << "  per-frame update              matrix  quaternion  speedup\n";
+
+	const auto measure = [&](const char* label, auto&& matrixKernel, auto&& quaternionKernel)
+	{
+		const Benchmark::Statistics matrixStats{ Benchmark::Measure(numRuns, [&]() { for (uint32_t i = 0; i < count; ++i) matrixKernel(i); }) };
+		const Benchmark::Statistics quaternionStats{ Benchmark::Measure(numRuns, [&]() { for (uint32_t i = 0; i < count; ++i) quaternionKernel(i); }) };
+		PrintResult(label, matrixStats, quaternionStats, count);
+	};
+
+	measure("camera view matrices",
+		[&](uint32_t i) { MatrixPath::CalculateCamera(angles[i].x, angles[i].y, positions[i], cameraToWorld[i], worldToCamera[i]); },
+		[&](uint32_t i) { QuaternionPath::CalculateCamera(angles[i].x, angles[i].y, positions[i], cameraToWorld[i], worldToCamera[i]); });
+
+	measure("mesh world + inverse",
+		[&](uint32_t i) { results[i] = MatrixPath::ToObjectSpace(angles[i].y, positions[i], points[i], cameraToWorld[i]); },
+		[&](uint32_t i) { results[i] = QuaternionPath::ToObjectSpace(angles[i].y, positions[i], points[i], cameraToWorld[i]); });
+
+	measure("rotate vector",
+		[&](uint32_t i) { results[i] = Matrix::CreateRotation(angles[i]).TransformVector(points[i]); },
+		[&](uint32_t i) { results[i] = Quaternion::CreateRotation(angles[i]).Rotate(points[i]); });
+
+	measure("compose rotations",
+		[&](uint32_t i) { cameraToWorld[i] = Matrix::CreateRotation(angles[i]) * Matrix::CreateRotation(angles[count - 1 - i]); },
+		[&](uint32_t i) { orientations[i] = Quaternion::CreateRotation(angles[i]) * Quaternion::CreateRotation(angles[count - 1 - i]); });
+
+	for (uint32_t i = 0; i < count; ++i)
+		orientations[i] = Quaternion::CreateRotation(angles[i]);
+
+	const Benchmark::Statistics slerpStats{ Benchmark::Measure(numRuns, [&]() { for (uint32_t i = 0; i < count; ++i) results[i] = Quaternion::Slerp(orientations[i], orientations[count - 1 - i], factors[i]).GetVector(); }) };
+	const Benchmark::Statistics nlerpStats{ Benchmark::Measure(numRuns, [&]() { for (uint32_t i = 0; i < count; ++i) results[i] = Quaternion::Nlerp(orientations[i], orientations[count - 1 - i], factors[i]).GetVector(); }) };
+	std::cout << std::fixed << std::setprecision(2) << "  slerp " << slerpStats.median * 1e6 / count << " ns, nlerp " << nlerpStats.median * 1e6 / count << " ns\n";
+
+	//Keeps the results alive
+	float checksum{};
+	for (uint32_t i = 0; i < count; ++i)
+		checksum += results[i].x + cameraToWorld[i][3][0] + worldToCamera[i][3][1] + orientations[i].w;
+	std::cout << std::defaultfloat << "  (checksum " << checksum << ")\n";
+
+	return isPassed ? 0 : 1;
+}
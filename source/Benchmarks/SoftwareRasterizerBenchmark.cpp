@@ -0,0 +1,407 @@
+#include "pch.h"
+#include "BenchmarkUtils.h"
+#include "FastMath.h"
+#include "MeshCache.h"
+#include "Simd.h"
+#include "SoftwareRasterizer.h"
+#include <cstring>
+#include <iomanip>
+#include <random>
+#include <string>
+
+using namespace dae;
+
+//The software rasterizer drawing the application's scene, time per pipeline stage, then the scaling over threads at
+//640x480 and 4K. The textures are generated: headless builds have no image decoder. Exits with 1 when the fill rules
+//leave a gap or an overlap between triangles, culling loses triangles, or the hierarchical depth buffer or more threads
+//change the image, or the depth pre-pass changes the depth.
+//--image writes the last frame as a PPM
+namespace
+{
+	//Colored checkers, the uv layout shows through
+	SoftwareTexture CreateDiffuseMap(uint32_t size)
+	{
+		std::vector<ColorRGBA8> texels(size * size);
+		for (uint32_t y = 0; y < size; ++y)
+		{
+			for (uint32_t x = 0; x < size; ++x)
+			{
+				const bool isDark{ ((x / 32) + (y / 32)) % 2 == 0 };
+				texels[y * size + x] = isDark ? ColorRGBA8{ 40, 60, 110, 255 } : ColorRGBA8{ 150, 140, 120, 255 };
+			}
+		}
+		return SoftwareTexture{ size, size, std::move(texels) };
+	}
+
+	//Round bumps, stored like a tangent space normal map: (n + 1) / 2
+	SoftwareTexture CreateNormalMap(uint32_t size)
+	{
+		std::vector<ColorRGBA8> texels(size * size);
+		for (uint32_t y = 0; y < size; ++y)
+		{
+			for (uint32_t x = 0; x < size; ++x)
+			{
+				const float angle{ 2.f * PI * 8.f / static_cast<float>(size) };
+				const Vector3 normal{ Vector3{ 0.4f * std::cos(x * angle), 0.4f * std::cos(y * angle), 1.f }.Normalized() };
+				texels[y * size + x] = ColorRGBA8::FromColor(ColorRGB{ normal.x * 0.5f + 0.5f, normal.y * 0.5f + 0.5f, normal.z * 0.5f + 0.5f });
+			}
+		}
+		return SoftwareTexture{ size, size, std::move(texels) };
+	}
+
+	SoftwareTexture CreateGradientMap(uint32_t size, float from, float to)
+	{
+		std::vector<ColorRGBA8> texels(size * size);
+		for (uint32_t y = 0; y < size; ++y)
+		{
+			for (uint32_t x = 0; x < size; ++x)
+			{
+				const float value{ Lerpf(from, to, static_cast<float>(x + y) / static_cast<float>(2 * size)) };
+				texels[y * size + x] = ColorRGBA8::FromColor(ColorRGB{ value, value, value });
+			}
+		}
+		return SoftwareTexture{ size, size, std::move(texels) };
+	}
+
+	//Orange flames fading out towards the edges
+	SoftwareTexture CreateFireMap(uint32_t size)
+	{
+		std::vector<ColorRGBA8> texels(size * size);
+		for (uint32_t y = 0; y < size; ++y)
+		{
+			for (uint32_t x = 0; x < size; ++x)
+			{
+				const float dx{ static_cast<float>(x) / size * 2.f - 1.f };
+				const float dy{ static_cast<float>(y) / size * 2.f - 1.f };
+				const float alpha{ Saturate(1.f - std::sqrt(dx * dx + dy * dy)) };
+				ColorRGBA8 texel{ ColorRGBA8::FromColor(ColorRGB{ 1.f, 0.3f + 0.5f * alpha, 0.05f }) };
+				texel.a = ColorRGBA8::ToChannel(alpha);
+				texels[y * size + x] = texel;
+			}
+		}
+		return SoftwareTexture{ size, size, std::move(texels) };
+	}
+
+	//A screen filling grid of two triangles per cell with jittered inner vertices, drawn with identity matrices:
+	//every pixel center must be covered exactly once
+	SoftwareGeometry CreateScreenGrid(uint32_t numColumns, uint32_t numRows)
+	{
+		std::mt19937 random{ 7 };
+		std::uniform_real_distribution<float> jitter{ -0.3f, 0.3f };
+
+		SoftwareGeometry geometry{};
+		geometry.positions.Resize((numColumns + 1) * (numRows + 1));
+		geometry.normals.Resize(geometry.positions.GetCount());
+		geometry.tangents.Resize(geometry.positions.GetCount());
+		geometry.uvs.resize(geometry.positions.GetCount());
+		for (uint32_t row = 0; row <= numRows; ++row)
+		{
+			for (uint32_t column = 0; column <= numColumns; ++column)
+			{
+				const bool isBorder{ row == 0 || column == 0 || row == numRows || column == numColumns };
+				const float x{ (column + (isBorder ? 0.f : jitter(random))) / numColumns * 2.f - 1.f };
+				const float y{ (row + (isBorder ? 0.f : jitter(random))) / numRows * 2.f - 1.f };
+				geometry.positions.Set(row * (numColumns + 1) + column, Vector3{ x, y, 0.5f });
+			}
+		}
+
+		for (uint32_t row = 0; row < numRows; ++row)
+		{
+			for (uint32_t column = 0; column < numColumns; ++column)
+			{
+				const uint32_t topLeft{ row * (numColumns + 1) + column };
+				const uint32_t bottomLeft{ topLeft + numColumns + 1 };
+				//Alternate the diagonal so edges of every direction are shared
+				if ((row + column) % 2 == 0)
+					geometry.indices.insert(geometry.indices.end(), { topLeft, topLeft + 1, bottomLeft, topLeft + 1, bottomLeft + 1, bottomLeft });
+				else
+					geometry.indices.insert(geometry.indices.end(), { topLeft, topLeft + 1, bottomLeft + 1, topLeft, bottomLeft + 1, bottomLeft });
+			}
+		}
+		return geometry;
+	}
+
+	//The application's camera: 50 units in front of the meshes, 45 degree FOV, 0.1 to 100
+	FrameConstants CreateFrame(uint32_t width, uint32_t height)
+	{
+		const Matrix inverseView{ Matrix::CreateTranslation(0.f, 0.f, -50.f) };
+		const Matrix projection{ Matrix::CreatePerspectiveFovLH(std::tan(PI_DIV_4 / 2.f), static_cast<float>(width) / height, 0.1f, 100.f) };
+		return FrameConstants::Create(Matrix::InverseRigid(inverseView), inverseView, projection, static_cast<float>(width), static_cast<float>(height));
+	}
+
+	bool IsSameImage(const FrameBuffer& lhs, const FrameBuffer& rhs)
+	{
+		return lhs.color.size() == rhs.color.size()
+			&& std::memcmp(lhs.color.data(), rhs.color.data(), lhs.color.size() * sizeof(ColorRGBA8)) == 0
+			&& std::memcmp(lhs.depth.data(), rhs.depth.data(), lhs.depth.size() * sizeof(float)) == 0;
+	}
+
+	void PrintStage(const char* label, const std::vector<double>& samples)
+	{
+		const Benchmark::Statistics stats{ Benchmark::Summarize(samples) };
+		std::cout << "  " << std::left << std::setw(10) << label << std::right << std::fixed << std::setprecision(3)
+			<< std::setw(10) << stats.median << " ms" << std::setw(10) << stats.min << " ms\n";
+	}
+}
+
+int main(int argc, char* args[])
+{
+	int numRuns{ 20 };
+	//Always a few, so the tile threading is checked on small machines too
+	uint32_t maxThreads{ std::max(4u, std::thread::hardware_concurrency()) };
+	uint32_t width{ 640 };
+	uint32_t height{ 480 };
+	std::string imagePath{};
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string argument{ args[i] };
+		if (argument == "--runs" && i + 1 < argc)
+			numRuns = std::max(1, std::stoi(args[++i]));
+		else if (argument == "--width" && i + 1 < argc)
+			width = static_cast<uint32_t>(std::max(1, std::stoi(args[++i])));
+		else if (argument == "--height" && i + 1 < argc)
+			height = static_cast<uint32_t>(std::max(1, std::stoi(args[++i])));
+		else if (argument == "--threads" && i + 1 < argc)
+			maxThreads = static_cast<uint32_t>(std::max(1, std::stoi(args[++i])));
+		else if (argument == "--image" && i + 1 < argc)
+			imagePath = args[++i];
+	}
+
+	const MeshCache vehicleCache{ DAE_RESOURCE_DIR "vehicle.obj", VertexLayout::CreateVehicleLayout() };
+	const MeshCache fireCache{ DAE_RESOURCE_DIR "fireFX.obj", VertexLayout::CreateFireLayout() };
+	if (!vehicleCache.IsValid() || !fireCache.IsValid())
+	{
+		std::cout << "Unable to load the meshes\n";
+		return 1;
+	}
+	const SoftwareGeometry vehicle{ SoftwareGeometry::FromMeshCache(vehicleCache) };
+	const SoftwareGeometry fire{ SoftwareGeometry::FromMeshCache(fireCache) };
+
+	const SoftwareTexture diffuseMap{ CreateDiffuseMap(512) };
+	const SoftwareTexture normalMap{ CreateNormalMap(512) };
+	const SoftwareTexture specularMap{ CreateGradientMap(512, 0.2f, 0.8f) };
+	const SoftwareTexture glossinessMap{ CreateGradientMap(512, 0.3f, 1.f) };
+	const SoftwareTexture fireMap{ CreateFireMap(512) };
+
+	VehicleMaterial vehicleMaterial{ &diffuseMap, &normalMap, &specularMap, &glossinessMap };
+	FireMaterial fireMaterial{ &fireMap };
+
+	const FrameConstants frame{ CreateFrame(width, height) };
+	const ColorRGB clearColor{ 0.39f, 0.59f, 0.93f };
+	const auto drawScene = [&](SoftwareRasterizer& target, const FrameConstants& constants, const Matrix& world)
+	{
+		target.BeginFrame(constants, clearColor);
+		target.DrawVehicle(vehicle, world, vehicleMaterial);
+		target.DrawFire(fire, world, fireMaterial);
+	};
+
+	SoftwareRasterizer rasterizer{ width, height };
+
+	//Fill rules: a jittered grid over the whole screen covers every pixel center once
+	const SoftwareGeometry grid{ CreateScreenGrid(13, 9) };
+	rasterizer.BeginFrame(FrameConstants::Create({}, {}, {}, static_cast<float>(width), static_cast<float>(height)), clearColor);
+	rasterizer.DrawFire(grid, {}, fireMaterial);
+	const uint64_t numGridFragments{ rasterizer.GetStatistics().numFragmentsTested };
+	const bool isCoverageExact{ numGridFragments == static_cast<uint64_t>(width) * height };
+
+	//Culling: every triangle that covers a pixel faces one way or the other
+	uint32_t numRasterized[3]{};
+	const cullMode cullModes[3]{ cullMode::backCulling, cullMode::frontCulling, cullMode::noCulling };
+	for (int mode{ 0 }; mode < 3; ++mode)
+	{
+		VehicleMaterial material{ vehicleMaterial };
+		material.culling = cullModes[mode];
+		rasterizer.ResetStatistics();
+		rasterizer.BeginFrame(frame, clearColor);
+		rasterizer.DrawVehicle(vehicle, Matrix::CreateRotationY(0.6f), material);
+		numRasterized[mode] = rasterizer.GetStatistics().numTrianglesRasterized;
+	}
+	const bool isCullingExact{ numRasterized[0] + numRasterized[1] == numRasterized[2] };
+
+	std::cout << "Software rasterizer (" << Simd::GetInstructionSet() << (FastMath::IsEnabled ? ", fast math" : "") << "), "
+		<< width << "x" << height << ", " << vehicle.GetNumTriangles() << " + " << fire.GetNumTriangles() << " triangles, median of " << numRuns << " runs\n"
+		<< "  screen grid: " << numGridFragments << " fragments for " << width * height << " pixels" << (isCoverageExact ? "" : "  FAILED") << "\n"
+		<< "  rasterized back / front / no culling: " << numRasterized[0] << " + " << numRasterized[1] << " = " << numRasterized[2]
+		<< (isCullingExact ? "" : "  FAILED") << "\n";
+
+	//Anisotropic filtering samples like linear
+	const sampleState sampleStates[2]{ sampleState::point, sampleState::linear };
+	const char* sampleStateNames[2]{ "point", "linear" };
+	for (int state{ 0 }; state < 2; ++state)
+	{
+		vehicleMaterial.sampler = sampleStates[state];
+		fireMaterial.sampler = sampleStates[state];
+
+		std::vector<double> vertexMs{}, setupMs{}, binMs{}, rasterMs{}, shadeMs{}, frameMs{};
+		SoftwareRasterizerStatistics statistics{};
+		//The first frame warms up, every run turns the meshes a little further like the application does
+		for (int run{ -1 }; run < numRuns; ++run)
+		{
+			const Matrix world{ Matrix::CreateRotationY(0.6f + 0.05f * run) };
+			rasterizer.ResetStatistics();
+
+			const auto start{ std::chrono::steady_clock::now() };
+			drawScene(rasterizer, frame, world);
+			const auto end{ std::chrono::steady_clock::now() };
+
+			statistics = rasterizer.GetStatistics();
+			if (run < 0)
+				continue;
+			vertexMs.push_back(statistics.vertexMs);
+			setupMs.push_back(statistics.setupMs);
+			binMs.push_back(statistics.binMs);
+			rasterMs.push_back(statistics.rasterMs);
+			shadeMs.push_back(statistics.shadeMs);
+			frameMs.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+		}
+
+		std::cout << "\n  " << sampleStateNames[state] << " sampling         median       min\n";
+		PrintStage("vertex", vertexMs);
+		PrintStage("setup", setupMs);
+		PrintStage("bin", binMs);
+		PrintStage("raster", rasterMs);
+		PrintStage("shade", shadeMs);
+		PrintStage("frame", frameMs);
+		std::cout << "  triangles " << statistics.numTriangles << ", culled " << statistics.numTrianglesCulled << ", rasterized " << statistics.numTrianglesRasterized
+			<< "; fragments tested " << statistics.numFragmentsTested << ", shaded " << statistics.numFragmentsShaded << "\n"
+			<< "  8x8 blocks outside " << statistics.numBlocksOutside << ", partial " << statistics.numBlocksPartial << ", inside " << statistics.numBlocksInside
+			<< "; occluded tiles " << statistics.numTilesOccluded << ", blocks " << statistics.numBlocksOccluded << ", unoccluded blocks " << statistics.numBlocksUnoccluded << "\n";
+	}
+
+	//Hierarchical depth on the vehicle alone: bit for bit the same frames, with fewer fragments interpolated and depth tested
+	bool isHierarchicalDepthExact{ true };
+	{
+		SoftwareRasterizer targets[2]{ { width, height }, { width, height } };
+		targets[0].SetHierarchicalDepth(false);
+		std::vector<double> rasterMs[2]{}, shadeMs[2]{};
+		SoftwareRasterizerStatistics statistics[2]{};
+		for (int run{ -1 }; run < numRuns; ++run)
+		{
+			const Matrix world{ Matrix::CreateRotationY(0.6f + 0.05f * run) };
+			for (int index{ 0 }; index < 2; ++index)
+			{
+				targets[index].ResetStatistics();
+				targets[index].BeginFrame(frame, clearColor);
+				targets[index].DrawVehicle(vehicle, world, vehicleMaterial);
+
+				statistics[index] = targets[index].GetStatistics();
+				if (run < 0)
+					continue;
+				rasterMs[index].push_back(statistics[index].rasterMs);
+				shadeMs[index].push_back(statistics[index].shadeMs);
+			}
+			isHierarchicalDepthExact &= IsSameImage(targets[0].GetFrameBuffer(), targets[1].GetFrameBuffer());
+		}
+
+		std::cout << "\n  hierarchical depth, vehicle   raster ms   shade ms   fragments tested   shaded" << (isHierarchicalDepthExact ? "" : "  FAILED, image differs") << "\n";
+		const char* labels[2]{ "off", "on" };
+		for (int index{ 0 }; index < 2; ++index)
+		{
+			std::cout << "  " << std::left << std::setw(28) << labels[index] << std::right << std::fixed << std::setprecision(3)
+				<< std::setw(11) << Benchmark::Summarize(rasterMs[index]).median << std::setw(11) << Benchmark::Summarize(shadeMs[index]).median
+				<< std::setw(19) << statistics[index].numFragmentsTested << std::setw(9) << statistics[index].numFragmentsShaded << "\n";
+		}
+		std::cout << "  rejected: " << statistics[1].numTilesOccluded << " triangles over a tile, " << statistics[1].numBlocksOccluded << " 8x8 blocks; "
+			<< statistics[1].numBlocksUnoccluded << " blocks skip the depth test\n";
+	}
+
+	//Depth pre-pass on the whole scene: the vehicle's depth first, then only its visible fragments shaded. The depth must
+	//match bit for bit, colors only where two triangles give a pixel the exact same depth
+	bool isDepthPrePassExact{ true };
+	{
+		SoftwareRasterizer targets[2]{ { width, height }, { width, height } };
+		targets[1].SetDepthPrePass(true);
+		std::vector<double> rasterMs[2]{}, shadeMs[2]{}, frameMs[2]{};
+		SoftwareRasterizerStatistics statistics[2]{};
+		uint32_t numTiedPixels{};
+		for (int run{ -1 }; run < numRuns; ++run)
+		{
+			const Matrix world{ Matrix::CreateRotationY(0.6f + 0.05f * run) };
+			for (int index{ 0 }; index < 2; ++index)
+			{
+				targets[index].ResetStatistics();
+				const auto start{ std::chrono::steady_clock::now() };
+				drawScene(targets[index], frame, world);
+				const auto end{ std::chrono::steady_clock::now() };
+
+				statistics[index] = targets[index].GetStatistics();
+				if (run < 0)
+					continue;
+				rasterMs[index].push_back(statistics[index].rasterMs);
+				shadeMs[index].push_back(statistics[index].shadeMs);
+				frameMs[index].push_back(std::chrono::duration<double, std::milli>(end - start).count());
+			}
+
+			const FrameBuffer& lhs{ targets[0].GetFrameBuffer() };
+			const FrameBuffer& rhs{ targets[1].GetFrameBuffer() };
+			isDepthPrePassExact &= lhs.depth == rhs.depth;
+			for (uint32_t pixel{ 0 }; pixel < lhs.GetNumPixels(); ++pixel)
+				numTiedPixels += std::memcmp(&lhs.color[pixel], &rhs.color[pixel], sizeof(ColorRGBA8)) != 0;
+		}
+
+		std::cout << "\n  depth pre-pass, scene         raster ms   shade ms   frame ms   fragments tested   shaded" << (isDepthPrePassExact ? "" : "  FAILED, depth differs") << "\n";
+		const char* labels[2]{ "off", "on" };
+		for (int index{ 0 }; index < 2; ++index)
+		{
+			std::cout << "  " << std::left << std::setw(28) << labels[index] << std::right << std::fixed << std::setprecision(3)
+				<< std::setw(11) << Benchmark::Summarize(rasterMs[index]).median << std::setw(11) << Benchmark::Summarize(shadeMs[index]).median
+				<< std::setw(11) << Benchmark::Summarize(frameMs[index]).median << std::setw(19) << statistics[index].numFragmentsTested
+				<< std::setw(9) << statistics[index].numFragmentsShaded << "\n";
+		}
+		std::cout << "  pre-pass tested " << statistics[1].numFragmentsPrePassed << " fragments; " << numTiedPixels << " pixels over all runs show another triangle at the same depth\n";
+	}
+
+	//Tiles over threads: every thread count has to give the single threaded image, bit for bit
+	bool isThreadingExact{ true };
+	std::vector<uint32_t> threadCounts{};
+	for (uint32_t numThreads = 1; numThreads < maxThreads; numThreads *= 2)
+		threadCounts.push_back(numThreads);
+	threadCounts.push_back(maxThreads);
+
+	const uint32_t resolutions[2][2]{ { 640, 480 }, { 3840, 2160 } };
+	std::cout << "\n  threads (" << std::thread::hardware_concurrency() << " hardware)   frame ms  speedup\n";
+	for (const auto& resolution : resolutions)
+	{
+		const FrameConstants scalingFrame{ CreateFrame(resolution[0], resolution[1]) };
+		const Matrix world{ Matrix::CreateRotationY(0.6f) };
+		FrameBuffer reference{};
+		double singleThreadMs{};
+
+		for (const uint32_t numThreads : threadCounts)
+		{
+			SoftwareRasterizer threaded{ resolution[0], resolution[1], numThreads };
+			const Benchmark::Statistics stats{ Benchmark::Measure(numRuns, [&]() { drawScene(threaded, scalingFrame, world); }) };
+
+			bool isSame{ true };
+			if (numThreads == 1)
+			{
+				reference = threaded.GetFrameBuffer();
+				singleThreadMs = stats.median;
+			}
+			else
+			{
+				isSame = IsSameImage(reference, threaded.GetFrameBuffer());
+				isThreadingExact &= isSame;
+			}
+
+			std::cout << "  " << std::setw(4) << resolution[0] << "x" << std::left << std::setw(5) << resolution[1] << std::right << std::setw(3) << numThreads
+				<< std::fixed << std::setprecision(3) << std::setw(17) << stats.median << std::setprecision(2) << std::setw(8) << singleThreadMs / std::max(stats.median, 1e-9) << "x"
+				<< (isSame ? "" : "  FAILED, image differs") << "\n";
+		}
+	}
+
+	if (!imagePath.empty())
+	{
+		const bool isWritten{ rasterizer.GetFrameBuffer().WriteImage(imagePath) };
+		std::cout << "  " << (isWritten ? "wrote " : "unable to write ") << imagePath << "\n";
+	}
+
+	//Keeps the results alive
+	uint32_t checksum{};
+	for (const ColorRGBA8& pixel : rasterizer.GetFrameBuffer().color)
+		checksum += pixel.r + pixel.g + pixel.b;
+	std::cout << "  (checksum " << checksum << ")\n";
+
+	return isCoverageExact && isCullingExact && isHierarchicalDepthExact && isDepthPrePassExact && isThreadingExact ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+#include "pch.h"
+#include "BenchmarkUtils.h"
+#include "Simd.h"
+#include "TriangleRaster.h"
+#include <bit>
+#include <iomanip>
+#include <random>
+#include <string>
+
+using namespace dae;
+
+//TriangleRaster's 8x8 block coverage against the edge functions evaluated pixel by pixel over the bounding box, for small,
+//medium and screen filling triangles. Both count the coverage of every pixel, the counts must match exactly.
+//Reports triangles per second. Exits with 1 on a mismatch
+namespace
+{
+	//Snapped like the SoftwareRasterizer's setup: clockwise, positive area, inside the guard band
+	std::vector<RasterTriangle> CreateTriangles(uint32_t count, float minSize, float maxSize, uint32_t width, uint32_t height, uint32_t seed)
+	{
+		std::mt19937 random{ seed };
+		std::uniform_real_distribution<float> centerX{ 0.f, static_cast<float>(width) };
+		std::uniform_real_distribution<float> centerY{ 0.f, static_cast<float>(height) };
+		std::uniform_real_distribution<float> size{ minSize, maxSize };
+		std::uniform_real_distribution<float> angle{ 0.f, 2.f * PI };
+
+		std::vector<RasterTriangle> triangles{};
+		triangles.reserve(count);
+		while (triangles.size() < count)
+		{
+			const float x{ centerX(random) };
+			const float y{ centerY(random) };
+			int32_t fixedX[3]{}, fixedY[3]{};
+			for (int vertex{ 0 }; vertex < 3; ++vertex)
+			{
+				const float radius{ size(random) };
+				const float direction{ angle(random) };
+				RasterTriangle::Snap(x + radius * std::cos(direction), y + radius * std::sin(direction), fixedX[vertex], fixedY[vertex]);
+			}
+
+			const int64_t doubleArea{ RasterTriangle::GetSignedDoubleArea(fixedX, fixedY) };
+			if (doubleArea == 0)
+				continue;
+			if (doubleArea < 0)
+			{
+				std::swap(fixedX[1], fixedX[2]);
+				std::swap(fixedY[1], fixedY[2]);
+			}
+			triangles.push_back(RasterTriangle::Create(fixedX, fixedY));
+		}
+		return triangles;
+	}
+
+	struct Viewport
+	{
+		int minX{};
+		int minY{};
+		int maxX{};
+		int maxY{};
+
+		static Viewport Clip(const RasterTriangle& triangle, uint32_t width, uint32_t height)
+		{
+			return Viewport{ std::max(triangle.minX, 0), std::max(triangle.minY, 0),
+				std::min(triangle.maxX, static_cast<int>(width) - 1), std::min(triangle.maxY, static_cast<int>(height) - 1) };
+		}
+	};
+
+	//Every pixel center of the bounding box, all three edge functions in 64 bits
+	void RasterizePerPixel(const std::vector<RasterTriangle>& triangles, uint32_t width, uint32_t height, std::vector<uint32_t>& coverage)
+	{
+		for (const RasterTriangle& triangle : triangles)
+		{
+			const Viewport bounds{ Viewport::Clip(triangle, width, height) };
+			for (int y{ bounds.minY }; y <= bounds.maxY; ++y)
+			{
+				for (int x{ bounds.minX }; x <= bounds.maxX; ++x)
+				{
+					const bool isCovered{ triangle.GetEdgeValue(0, x, y) >= 0 && triangle.GetEdgeValue(1, x, y) >= 0 && triangle.GetEdgeValue(2, x, y) >= 0 };
+					coverage[y * width + x] += isCovered;
+				}
+			}
+		}
+	}
+
+	void RasterizeBlocks(const std::vector<RasterTriangle>& triangles, uint32_t width, uint32_t height, std::vector<uint32_t>& coverage, uint64_t numBlocks[3])
+	{
+		constexpr int BlockSize{ TriangleRaster::BlockSize };
+
+		for (const RasterTriangle& triangle : triangles)
+		{
+			const Viewport bounds{ Viewport::Clip(triangle, width, height) };
+			for (int blockY{ bounds.minY & ~(BlockSize - 1) }; blockY <= bounds.maxY; blockY += BlockSize)
+			{
+				const int firstRow{ std::max(bounds.minY, blockY) };
+				const int lastRow{ std::min(bounds.maxY, blockY + BlockSize - 1) };
+
+				for (int blockX{ bounds.minX & ~(BlockSize - 1) }; blockX <= bounds.maxX; blockX += BlockSize)
+				{
+					uint8_t rowMasks[BlockSize]{};
+					const TriangleRaster::BlockType blockType{ TriangleRaster::GetBlockCoverage(triangle, blockX, blockY, rowMasks) };
+					++numBlocks[static_cast<int>(blockType)];
+					if (blockType == TriangleRaster::BlockType::Outside)
+						continue;
+
+					const int firstColumn{ std::max(bounds.minX, blockX) - blockX };
+					const int lastColumn{ std::min(bounds.maxX, blockX + BlockSize - 1) - blockX };
+					const uint32_t columnMask{ (0xffu << firstColumn) & (0xffu >> (BlockSize - 1 - lastColumn)) };
+
+					for (int row{ firstRow }; row <= lastRow; ++row)
+					{
+						const uint32_t rowCoverage{ (blockType == TriangleRaster::BlockType::Inside ? 0xffu : rowMasks[row - blockY]) & columnMask };
+						uint32_t* pRow{ coverage.data() + row * width + blockX };
+						for (uint32_t remaining{ rowCoverage }; remaining != 0; remaining &= remaining - 1)
+							++pRow[std::countr_zero(remaining)];
+					}
+				}
+			}
+		}
+	}
+}
+
+int main(int argc, char* args[])
+{
+	int numRuns{ 20 };
+	uint32_t width{ 640 };
+	uint32_t height{ 480 };
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string argument{ args[i] };
+		if (argument == "--runs" && i + 1 < argc)
+			numRuns = std::max(1, std::stoi(args[++i]));
+		else if (argument == "--width" && i + 1 < argc)
+			width = static_cast<uint32_t>(std::max(1, std::stoi(args[++i])));
+		else if (argument == "--height" && i + 1 < argc)
+			height = static_cast<uint32_t>(std::max(1, std::stoi(args[++i])));
+	}
+
+	//Vertex distance from the triangle's center in pixels. The screen filling ones reach past the edges
+	struct TriangleClass
+	{
+		const char* label{};
+		uint32_t count{};
+		float minSize{};
+		float maxSize{};
+	};
+	const float screenSize{ static_cast<float>(std::max(width, height)) };
+	const TriangleClass classes[3]{
+		{ "small (1-4 px)", 100000, 1.f, 4.f },
+		{ "medium (10-40 px)", 10000, 10.f, 40.f },
+		{ "screen filling", 100, screenSize * 0.6f, screenSize * 1.2f }
+	};
+
+	std::cout << "Triangle coverage (" << Simd::GetInstructionSet() << "), " << width << "x" << height << ", median of " << numRuns << " runs\n"
+		<< "  triangles           per pixel tri/s  8x8 blocks tri/s  speedup   blocks outside / partial / inside\n";
+
+	bool isExact{ true };
+	std::vector<uint32_t> perPixelCoverage(width * height), blockCoverage(width * height);
+	for (uint32_t index{ 0 }; index < 3; ++index)
+	{
+		const TriangleClass& triangleClass{ classes[index] };
+		const std::vector<RasterTriangle> triangles{ CreateTriangles(triangleClass.count, triangleClass.minSize, triangleClass.maxSize, width, height, 11 + index) };
+
+		//Exactness first: one pass of each into cleared targets
+		uint64_t numBlocks[3]{};
+		std::fill(perPixelCoverage.begin(), perPixelCoverage.end(), 0u);
+		std::fill(blockCoverage.begin(), blockCoverage.end(), 0u);
+		RasterizePerPixel(triangles, width, height, perPixelCoverage);
+		RasterizeBlocks(triangles, width, height, blockCoverage, numBlocks);
+		const bool isSame{ perPixelCoverage == blockCoverage };
+		isExact &= isSame;
+
+		//The targets keep accumulating, the counts only feed the checksum from here
+		uint64_t unused[3]{};
+		const Benchmark::Statistics perPixel{ Benchmark::Measure(numRuns, [&]() { RasterizePerPixel(triangles, width, height, perPixelCoverage); }) };
+		const Benchmark::Statistics blocks{ Benchmark::Measure(numRuns, [&]() { RasterizeBlocks(triangles, width, height, blockCoverage, unused); }) };
+
+		const double perPixelRate{ triangleClass.count / std::max(perPixel.median, 1e-9) * 1e3 };
+		const double blockRate{ triangleClass.count / std::max(blocks.median, 1e-9) * 1e3 };
+		std::cout << "  " << std::left << std::setw(18) << triangleClass.label << std::right << std::fixed << std::setprecision(0)
+			<< std::setw(17) << perPixelRate << std::setw(18) << blockRate << std::setprecision(2) << std::setw(8) << blockRate / std::max(perPixelRate, 1e-9) << "x"
+			<< "   " << numBlocks[0] << " / " << numBlocks[1] << " / " << numBlocks[2] << (isSame ? "" : "  FAILED, coverage differs") << "\n";
+	}
+
+	//Keeps the results alive
+	uint32_t checksum{};
+	for (uint32_t pixel{ 0 }; pixel < width * height; ++pixel)
+		checksum += perPixelCoverage[pixel] + blockCoverage[pixel];
+	std::cout << "  (checksum " << checksum << ")\n";
+
+	return isExact ? 0 : 1;
+}
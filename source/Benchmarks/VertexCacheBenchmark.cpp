@@ -0,0 +1,137 @@
+#include "pch.h"
+#include "BenchmarkUtils.h"
+#include "MeshOptimizer.h"
+#include "ObjParser.h"
+#include <array>
+#include <iomanip>
+#include <string>
+
+using namespace dae;
+
+namespace
+{
+	bool IsLess(const Vector3& a, const Vector3& b)
+	{
+		return a.x != b.x ? a.x < b.x : a.y != b.y ? a.y < b.y : a.z < b.z;
+	}
+
+	bool IsEqual(const Vector3& a, const Vector3& b)
+	{
+		return a.x == b.x && a.y == b.y && a.z == b.z;
+	}
+
+	//Triangles as rotation-independent keys so the reordered mesh can be checked against the original
+	std::vector<std::array<Vector3, 3>> GetSortedTriangles(const std::vector<Vertex_Vehicle>& vertices, const std::vector<uint32_t>& indices)
+	{
+		std::vector<std::array<Vector3, 3>> triangles{};
+		triangles.reserve(indices.size() / 3);
+
+		for (size_t i = 0; i + 2 < indices.size(); i += 3)
+		{
+			std::array<Vector3, 3> triangle{ vertices[indices[i]].position, vertices[indices[i + 1]].position, vertices[indices[i + 2]].position };
+
+			//Rotate the smallest corner first, keeping the winding
+			while (IsLess(triangle[1], triangle[0]) || IsLess(triangle[2], triangle[0]))
+				std::rotate(triangle.begin(), triangle.begin() + 1, triangle.end());
+
+			triangles.push_back(triangle);
+		}
+
+		std::sort(triangles.begin(), triangles.end(), [](const std::array<Vector3, 3>& a, const std::array<Vector3, 3>& b)
+		{
+			for (int c = 0; c < 3; ++c)
+			{
+				if (IsLess(a[c], b[c]))
+					return true;
+				if (IsLess(b[c], a[c]))
+					return false;
+			}
+			return false;
+		});
+
+		return triangles;
+	}
+
+	bool AreSameTriangles(const std::vector<std::array<Vector3, 3>>& a, const std::vector<std::array<Vector3, 3>>& b)
+	{
+		return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](const std::array<Vector3, 3>& x, const std::array<Vector3, 3>& y)
+		{
+			return IsEqual(x[0], y[0]) && IsEqual(x[1], y[1]) && IsEqual(x[2], y[2]);
+		});
+	}
+
+	void PrintCacheStatistics(const char* label, const std::vector<uint32_t>& indices, uint32_t numVertices)
+	{
+		std::cout << "  " << std::left << std::setw(10) << label << std::right << std::fixed << std::setprecision(3);
+		for (const uint32_t cacheSize : { 16u, 32u })
+		{
+			const MeshOptimizer::VertexCacheStatistics stats{ MeshOptimizer::AnalyzeVertexCache(indices, numVertices, cacheSize) };
+			std::cout << "  FIFO" << std::setw(2) << cacheSize << " ACMR " << stats.acmr << " ATVR " << stats.atvr;
+		}
+		std::cout << "\n";
+	}
+}
+
+int main(int argc, char* args[])
+{
+	int numRuns{ 10 };
+	std::vector<std::string> files{};
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string argument{ args[i] };
+		if (argument == "--runs" && i + 1 < argc)
+			numRuns = std::max(1, std::stoi(args[++i]));
+		else
+			files.push_back(argument);
+	}
+
+	if (files.empty())
+	{
+		files.push_back(DAE_RESOURCE_DIR "vehicle.obj");
+		files.push_back(DAE_RESOURCE_DIR "fireFX.obj");
+	}
+
+	for (const std::string& file : files)
+	{
+		std::vector<Vertex_Vehicle> vertices{};
+		std::vector<uint32_t> indices{};
+
+		if (!ObjParser::ParseObj(file, vertices, indices))
+		{
+			std::cout << file << ": unable to parse\n";
+			continue;
+		}
+
+		const uint32_t numVertices{ static_cast<uint32_t>(vertices.size()) };
+		std::cout << file << " (" << numVertices << " vertices, " << indices.size() / 3 << " triangles)\n";
+		PrintCacheStatistics("file order", indices, numVertices);
+
+		std::vector<uint32_t> optimizedIndices{};
+
+		const Benchmark::Statistics cacheStats{ Benchmark::Measure(numRuns, [&]()
+		{
+			optimizedIndices = indices;
+			MeshOptimizer::OptimizeVertexCache(optimizedIndices, numVertices);
+		}) };
+		PrintCacheStatistics("forsyth", optimizedIndices, numVertices);
+
+		std::vector<Vertex_Vehicle> fetchVertices{};
+		std::vector<uint32_t> fetchIndices{};
+
+		const Benchmark::Statistics fetchStats{ Benchmark::Measure(numRuns, [&]()
+		{
+			fetchVertices = vertices;
+			fetchIndices = optimizedIndices;
+			MeshOptimizer::OptimizeVertexFetch(fetchVertices, fetchIndices);
+		}) };
+		PrintCacheStatistics("+ fetch", fetchIndices, static_cast<uint32_t>(fetchVertices.size()));
+
+		const bool isSameMesh{ AreSameTriangles(GetSortedTriangles(vertices, indices), GetSortedTriangles(fetchVertices, fetchIndices)) };
+
+		std::cout << std::setprecision(3) << "  vertex cache pass " << cacheStats.median << " ms, vertex fetch pass " << fetchStats.median
+			<< " ms, triangles " << (isSameMesh ? "preserved" : "CHANGED") << "\n";
+	}
+
+	return 0;
+}
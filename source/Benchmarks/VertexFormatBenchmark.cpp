@@ -0,0 +1,157 @@
+#include "pch.h"
+#include "BenchmarkUtils.h"
+#include "MeshOptimizer.h"
+#include "ObjParser.h"
+#include "VertexLayout.h"
+#include <cmath>
+#include <iomanip>
+#include <string>
+
+using namespace dae;
+
+namespace
+{
+	struct ErrorStatistics
+	{
+		double max{};
+		double sum{};
+		uint32_t count{};
+
+		void Add(double error)
+		{
+			max = std::max(max, error);
+			sum += error;
+			++count;
+		}
+
+		double GetMean() const
+		{
+			return count > 0 ? sum / count : 0.0;
+		}
+	};
+
+	//In double: acos of a float cosine alone is off by a few hundredths of a degree near 1
+	double GetAngleDegrees(const Vector3& reference, const Vector3& decoded)
+	{
+		const double dot{ double(reference.x) * decoded.x + double(reference.y) * decoded.y + double(reference.z) * decoded.z };
+		const double lengths{ std::sqrt((double(reference.x) * reference.x + double(reference.y) * reference.y + double(reference.z) * reference.z)
+			* (double(decoded.x) * decoded.x + double(decoded.y) * decoded.y + double(decoded.z) * decoded.z)) };
+		return std::acos(std::clamp(dot / lengths, -1.0, 1.0)) * 180.0 / 3.14159265358979;
+	}
+
+	void MeasureLayout(const char* label, const VertexLayout& layout, const std::vector<Vertex_Vehicle>& vertices, const PositionQuantization& quantization,
+		float boundsDiagonal, uint32_t numTransforms, int numRuns)
+	{
+		std::vector<char> buffer(vertices.size() * layout.stride);
+		std::vector<Vertex_Vehicle> decoded(vertices.size());
+
+		const Benchmark::Statistics encodeStats{ Benchmark::Measure(numRuns, [&]()
+		{
+			for (size_t i = 0; i < vertices.size(); ++i)
+				layout.WriteVertex(vertices[i], buffer.data() + i * layout.stride, quantization);
+		}) };
+
+		const Benchmark::Statistics decodeStats{ Benchmark::Measure(numRuns, [&]()
+		{
+			for (size_t i = 0; i < vertices.size(); ++i)
+				decoded[i] = layout.ReadVertex(buffer.data() + i * layout.stride, quantization);
+		}) };
+
+		ErrorStatistics positionError{}, normalError{}, tangentError{}, uvError{};
+		for (size_t i = 0; i < vertices.size(); ++i)
+		{
+			const Vertex_Vehicle& reference{ vertices[i] };
+			const Vertex_Vehicle& result{ decoded[i] };
+
+			positionError.Add((reference.position - result.position).Magnitude());
+			uvError.Add(std::max(std::abs(reference.uv.x - result.uv.x), std::abs(reference.uv.y - result.uv.y)));
+
+			//Vertices that only touch degenerate uv triangles keep a zero tangent, there is no direction to compare
+			if (layout.FindAttribute(VertexSemantic::Normal) && reference.normal.SqrMagnitude() > 0.f)
+				normalError.Add(GetAngleDegrees(reference.normal, result.normal));
+			if (layout.FindAttribute(VertexSemantic::Tangent) && reference.tangent.SqrMagnitude() > 0.f)
+				tangentError.Add(GetAngleDegrees(reference.tangent, result.tangent));
+		}
+
+		const double vertexKiB{ buffer.size() / 1024.0 };
+		const double fetchKiB{ static_cast<double>(numTransforms) * layout.stride / 1024.0 };
+
+		std::cout << "  " << std::left << std::setw(16) << label << std::right << std::fixed
+			<< std::setw(3) << layout.stride << " B/vertex" << std::setprecision(1) << std::setw(9) << vertexKiB << " KiB"
+			<< std::setw(9) << fetchKiB << " KiB/draw"
+			<< std::setprecision(3) << "  encode " << encodeStats.median << " ms  decode " << decodeStats.median << " ms\n";
+
+		std::cout << std::scientific << std::setprecision(2)
+			<< "                  position max " << positionError.max << " (" << positionError.max / boundsDiagonal << " of bounds) mean " << positionError.GetMean() << "\n"
+			<< "                  uv max " << uvError.max << " mean " << uvError.GetMean() << std::fixed << std::setprecision(4);
+
+		if (normalError.count > 0)
+			std::cout << "  normal max " << normalError.max << " deg mean " << normalError.GetMean() << " deg";
+		if (tangentError.count > 0)
+			std::cout << "  tangent max " << tangentError.max << " deg mean " << tangentError.GetMean() << " deg";
+
+		std::cout << std::defaultfloat << "\n";
+	}
+}
+
+int main(int argc, char* args[])
+{
+	int numRuns{ 10 };
+	std::vector<std::string> files{};
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string argument{ args[i] };
+		if (argument == "--runs" && i + 1 < argc)
+			numRuns = std::max(1, std::stoi(args[++i]));
+		else
+			files.push_back(argument);
+	}
+
+	if (files.empty())
+	{
+		files.push_back(DAE_RESOURCE_DIR "vehicle.obj");
+		files.push_back(DAE_RESOURCE_DIR "fireFX.obj");
+	}
+
+	for (const std::string& file : files)
+	{
+		std::vector<Vertex_Vehicle> vertices{};
+		std::vector<uint32_t> indices{};
+
+		if (!ObjParser::ParseObj(file, vertices, indices) || vertices.empty())
+		{
+			std::cout << file << ": unable to parse\n";
+			continue;
+		}
+
+		//Same buffers the mesh cache stores
+		MeshOptimizer::OptimizeVertexCache(indices, static_cast<uint32_t>(vertices.size()));
+		MeshOptimizer::OptimizeVertexFetch(vertices, indices);
+
+		Vector3 boundsMin{ vertices.front().position }, boundsMax{ vertices.front().position };
+		for (const Vertex_Vehicle& vertex : vertices)
+		{
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				boundsMin[axis] = std::min(boundsMin[axis], vertex.position[axis]);
+				boundsMax[axis] = std::max(boundsMax[axis], vertex.position[axis]);
+			}
+		}
+
+		const PositionQuantization quantization{ PositionQuantization::FromBounds(boundsMin, boundsMax) };
+		const float boundsDiagonal{ (boundsMax - boundsMin).Magnitude() };
+
+		//Vertex shader invocations per draw, each of them fetches one vertex
+		const uint32_t numTransforms{ MeshOptimizer::AnalyzeVertexCache(indices, static_cast<uint32_t>(vertices.size())).numTransforms };
+
+		std::cout << file << " (" << vertices.size() << " vertices, " << numTransforms << " vertex fetches per draw)\n";
+		MeasureLayout("float", VertexLayout::CreateVehicleLayout(), vertices, quantization, boundsDiagonal, numTransforms, numRuns);
+		MeasureLayout("packed half uv", VertexLayout::CreatePackedVehicleLayout(VertexFormat::Half2), vertices, quantization, boundsDiagonal, numTransforms, numRuns);
+		MeasureLayout("packed unorm uv", VertexLayout::CreatePackedVehicleLayout(VertexFormat::Unorm16x2), vertices, quantization, boundsDiagonal, numTransforms, numRuns);
+		MeasureLayout("fire float", VertexLayout::CreateFireLayout(), vertices, quantization, boundsDiagonal, numTransforms, numRuns);
+		MeasureLayout("fire packed", VertexLayout::CreatePackedFireLayout(), vertices, quantization, boundsDiagonal, numTransforms, numRuns);
+	}
+
+	return 0;
+}
@@ -10,7 +10,7 @@ Camera::Camera(float _fovAngle, const Vector3& _origin, float _aspectRatio)
 	m_FovAngle{ _fovAngle },
 	m_AspectRatio{_aspectRatio}
 {
-	m_FOV = tanf((m_FovAngle * TO_RADIANS) / 2.f);
+	CalculateViewMatrix();
 	CalculateProjectionMatrix();
 }
 
@@ -21,6 +21,9 @@ Camera::~Camera()
 void Camera::Update(const Timer* pTimer)
 {
 	const float deltaTime = pTimer->GetElapsed();
+	const Vector3 previousOrigin{ m_Origin };
+	const float previousPitch{ m_TotalPitch };
+	const float previousYaw{ m_TotalYaw };
 
 	//Camera Update Logic
 	//Keyboard Input
@@ -102,44 +105,70 @@ void Camera::Update(const Timer* pTimer)
 		}
 	}
 	//Update Matrix
-	CalculateViewMatrix();
-	CalculateProjectionMatrix();
+	m_IsViewDirty |= m_TotalPitch != previousPitch || m_TotalYaw != previousYaw || (m_Origin - previousOrigin).SqrMagnitude() > 0.f;
+	if (m_IsViewDirty)
+	{
+		CalculateViewMatrix();
+	}
+	if (m_IsProjectionDirty)
+	{
+		CalculateProjectionMatrix();
+	}
 }
 
 
 void Camera::CalculateViewMatrix()
 {
-	Matrix rotationMatrix = Matrix::CreateRotationX(m_TotalPitch * TO_RADIANS) * Matrix::CreateRotationY(m_TotalYaw * TO_RADIANS);
-
-	m_Forward = rotationMatrix.GetAxisZ();
-	m_Up = rotationMatrix.GetAxisY();
-	m_Right = rotationMatrix.GetAxisX();
+	m_Orientation = Quaternion::CreateRotationX(m_TotalPitch * TO_RADIANS) * Quaternion::CreateRotationY(m_TotalYaw * TO_RADIANS);
 
-	Matrix ONB
-	{
-		Vector4{ m_Right, 0.f},
-		Vector4{ m_Up, 0.f},
-		Vector4{ m_Forward, 0.f},
-		Vector4{ m_Origin ,1.f}
-	};
+	m_Forward = m_Orientation.GetAxisZ();
+	m_Up = m_Orientation.GetAxisY();
+	m_Right = m_Orientation.GetAxisX();
 
-	m_ViewMatrix = ONB;
-	m_InvViewMatrix = Matrix::Inverse(m_ViewMatrix);
+	//ONB, its inverse is rigid: no general 4x4 inverse needed
+	const RigidTransform ONB{ m_Orientation, m_Origin };
 
+	m_ViewMatrix = ONB.ToMatrix();
+	m_InvViewMatrix = ONB.Inverse().ToMatrix();
+	m_IsViewDirty = false;
 }
 
 void Camera::CalculateProjectionMatrix()
 {
+	m_FOV = tanf((m_FovAngle * TO_RADIANS) / 2.f);
 	m_ProjectionMatrix = Matrix::CreatePerspectiveFovLH(m_FOV, m_AspectRatio, m_NearPlane, m_FarPlane);
+	m_IsProjectionDirty = false;
 }
 
-Matrix Camera::GetViewMatrix()
+void Camera::SetFovAngle(float fovAngle)
+{
+	m_FovAngle = fovAngle;
+	m_IsProjectionDirty = true;
+}
+
+void Camera::SetAspectRatio(float aspectRatio)
+{
+	m_AspectRatio = aspectRatio;
+	m_IsProjectionDirty = true;
+}
+
+const Matrix& Camera::GetViewMatrix() const
 {
 	return m_ViewMatrix;
 }
 
-Matrix Camera::GetProjectionMatrix()
+const Matrix& Camera::GetInverseViewMatrix() const
+{
+	return m_InvViewMatrix;
+}
+
+const Matrix& Camera::GetProjectionMatrix() const
 {
 	return m_ProjectionMatrix;
 }
 
+const Vector3& Camera::GetOrigin() const
+{
+	return m_Origin;
+}
+
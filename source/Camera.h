@@ -24,8 +24,12 @@ public:
 	void Update(const Timer* pTimer);
 	void CalculateViewMatrix();
 	void CalculateProjectionMatrix();
-	Matrix GetViewMatrix();
-	Matrix GetProjectionMatrix();
+	void SetFovAngle(float fovAngle);
+	void SetAspectRatio(float aspectRatio);
+	const Matrix& GetViewMatrix() const;
+	const Matrix& GetInverseViewMatrix() const;
+	const Matrix& GetProjectionMatrix() const;
+	const Vector3& GetOrigin() const;
 
 private:
 
@@ -37,8 +41,8 @@ private:
 	float m_TotalYaw{};
 	float m_FOV{};
 
-	const float m_FovAngle{ };
-	const float m_AspectRatio{};
+	float m_FovAngle{ };
+	float m_AspectRatio{};
 	const float m_MovementSpeed{ 20.f };
 	const float m_RotationSpeed{ 1000.f };
 	const float m_NearPlane{ 0.1f };
@@ -48,11 +52,16 @@ private:
 	Vector3 m_Forward{ Vector3::UnitZ };
 	Vector3 m_Up{ Vector3::UnitY };
 	Vector3 m_Right{ Vector3::UnitX };
+	Quaternion m_Orientation{};
 
 	Matrix m_ViewMatrix{};
 	Matrix m_InvViewMatrix{};
 	Matrix m_ProjectionMatrix{};
 
+	//Matrices are only recalculated in Update after something they depend on changed
+	bool m_IsViewDirty{ true };
+	bool m_IsProjectionDirty{ true };
+
 	//------------------------------------------------
 	// Private member functions						
 	//------------------------------------------------
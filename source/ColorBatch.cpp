@@ -0,0 +1,246 @@
+#include "pch.h"
+#include "ColorBatch.h"
+#include "Simd.h"
+
+namespace dae
+{
+	void ColorRGBStream::Resize(uint32_t count)
+	{
+		r.resize(count);
+		g.resize(count);
+		b.resize(count);
+	}
+
+	void ColorRGBStream::Set(uint32_t index, const ColorRGB& value)
+	{
+		r[index] = value.r;
+		g[index] = value.g;
+		b[index] = value.b;
+	}
+
+	ColorRGB ColorRGBStream::Get(uint32_t index) const
+	{
+		return ColorRGB{ r[index], g[index], b[index] };
+	}
+
+	uint32_t ColorRGBStream::GetCount() const
+	{
+		return static_cast<uint32_t>(r.size());
+	}
+
+	namespace ColorBatch
+	{
+		namespace
+		{
+			constexpr float ChannelScale{ 1.f / 255.f };
+
+#if defined(DAE_SIMD_SSE)
+			//Byte channel of four packed texels as 32-bit integers
+			inline __m128i GetChannel(__m128i texels, int shift)
+			{
+				return _mm_and_si128(_mm_srli_epi32(texels, shift), _mm_set1_epi32(0xff));
+			}
+
+			//Four channel steps (0 - 255, 32 bits each) into four opaque packed texels
+			inline __m128i PackChannels(__m128i r, __m128i g, __m128i b)
+			{
+				const __m128i rg{ _mm_or_si128(r, _mm_slli_epi32(g, 8)) };
+				const __m128i ba{ _mm_or_si128(_mm_slli_epi32(b, 16), _mm_set1_epi32(static_cast<int>(0xff000000u))) };
+				return _mm_or_si128(rg, ba);
+			}
+
+			//ColorRGBA8::ToChannel before the conversion: max first so NaN becomes 0
+			inline __m128 ToSteps(__m128 value)
+			{
+				const __m128 saturated{ _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.f)) };
+				return _mm_add_ps(_mm_mul_ps(saturated, _mm_set1_ps(255.f)), _mm_set1_ps(0.5f));
+			}
+#endif
+
+#if defined(DAE_SIMD_AVX)
+			inline __m256 ToSteps(__m256 value)
+			{
+				const __m256 saturated{ _mm256_min_ps(_mm256_max_ps(value, _mm256_setzero_ps()), _mm256_set1_ps(1.f)) };
+				return _mm256_add_ps(_mm256_mul_ps(saturated, _mm256_set1_ps(255.f)), _mm256_set1_ps(0.5f));
+			}
+
+			//AVX has no 256-bit integer operations: the byte shuffling stays 128 bits wide, the float math goes 8 wide
+			inline __m256 ToFloat(__m128i low, __m128i high)
+			{
+				return _mm256_cvtepi32_ps(_mm256_insertf128_si256(_mm256_castsi128_si256(low), high, 1));
+			}
+#endif
+		}
+
+		void Unpack(const ColorRGBA8* pTexels, uint32_t count, float* pR, float* pG, float* pB)
+		{
+			uint32_t i{ 0 };
+
+#if defined(DAE_SIMD_AVX)
+			const __m256 scale8{ _mm256_set1_ps(ChannelScale) };
+			for (; i + 8 <= count; i += 8)
+			{
+				const __m128i low{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(pTexels + i)) };
+				const __m128i high{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(pTexels + i + 4)) };
+
+				_mm256_storeu_ps(pR + i, _mm256_mul_ps(ToFloat(GetChannel(low, 0), GetChannel(high, 0)), scale8));
+				_mm256_storeu_ps(pG + i, _mm256_mul_ps(ToFloat(GetChannel(low, 8), GetChannel(high, 8)), scale8));
+				_mm256_storeu_ps(pB + i, _mm256_mul_ps(ToFloat(GetChannel(low, 16), GetChannel(high, 16)), scale8));
+			}
+#endif
+
+#if defined(DAE_SIMD_SSE)
+			const __m128 scale{ _mm_set1_ps(ChannelScale) };
+			for (; i + 4 <= count; i += 4)
+			{
+				const __m128i texels{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(pTexels + i)) };
+
+				_mm_storeu_ps(pR + i, _mm_mul_ps(_mm_cvtepi32_ps(GetChannel(texels, 0)), scale));
+				_mm_storeu_ps(pG + i, _mm_mul_ps(_mm_cvtepi32_ps(GetChannel(texels, 8)), scale));
+				_mm_storeu_ps(pB + i, _mm_mul_ps(_mm_cvtepi32_ps(GetChannel(texels, 16)), scale));
+			}
+#endif
+
+			for (; i < count; ++i)
+			{
+				const ColorRGB color{ pTexels[i].ToColor() };
+				pR[i] = color.r;
+				pG[i] = color.g;
+				pB[i] = color.b;
+			}
+		}
+
+		void Unpack(const ColorRGBA8* pTexels, uint32_t count, ColorRGBStream& result)
+		{
+			result.Resize(count);
+			Unpack(pTexels, count, result.r.data(), result.g.data(), result.b.data());
+		}
+
+		void Pack(const float* pR, const float* pG, const float* pB, uint32_t count, ColorRGBA8* pTexels)
+		{
+			uint32_t i{ 0 };
+
+#if defined(DAE_SIMD_AVX)
+			for (; i + 8 <= count; i += 8)
+			{
+				//Truncating the positive steps + 0.5 rounds them, the same as the scalar cast
+				const __m256i r{ _mm256_cvttps_epi32(ToSteps(_mm256_loadu_ps(pR + i))) };
+				const __m256i g{ _mm256_cvttps_epi32(ToSteps(_mm256_loadu_ps(pG + i))) };
+				const __m256i b{ _mm256_cvttps_epi32(ToSteps(_mm256_loadu_ps(pB + i))) };
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pTexels + i),
+					PackChannels(_mm256_castsi256_si128(r), _mm256_castsi256_si128(g), _mm256_castsi256_si128(b)));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pTexels + i + 4),
+					PackChannels(_mm256_extractf128_si256(r, 1), _mm256_extractf128_si256(g, 1), _mm256_extractf128_si256(b, 1)));
+			}
+#endif
+
+#if defined(DAE_SIMD_SSE)
+			for (; i + 4 <= count; i += 4)
+			{
+				const __m128i r{ _mm_cvttps_epi32(ToSteps(_mm_loadu_ps(pR + i))) };
+				const __m128i g{ _mm_cvttps_epi32(ToSteps(_mm_loadu_ps(pG + i))) };
+				const __m128i b{ _mm_cvttps_epi32(ToSteps(_mm_loadu_ps(pB + i))) };
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pTexels + i), PackChannels(r, g, b));
+			}
+#endif
+
+			for (; i < count; ++i)
+			{
+				pTexels[i] = ColorRGBA8::FromColor(ColorRGB{ pR[i], pG[i], pB[i] });
+			}
+		}
+
+		void Pack(const ColorRGBStream& colors, ColorRGBA8* pTexels)
+		{
+			Pack(colors.r.data(), colors.g.data(), colors.b.data(), colors.GetCount(), pTexels);
+		}
+
+		void MaxToOne(float* pR, float* pG, float* pB, uint32_t count)
+		{
+			uint32_t i{ 0 };
+
+			//Dividing by max(maxValue, 1) instead of branching: a division by 1 is exact
+#if defined(DAE_SIMD_AVX)
+			for (; i + 8 <= count; i += 8)
+			{
+				const __m256 r{ _mm256_loadu_ps(pR + i) };
+				const __m256 g{ _mm256_loadu_ps(pG + i) };
+				const __m256 b{ _mm256_loadu_ps(pB + i) };
+				const __m256 divisor{ _mm256_max_ps(_mm256_max_ps(r, _mm256_max_ps(g, b)), _mm256_set1_ps(1.f)) };
+
+				_mm256_storeu_ps(pR + i, _mm256_div_ps(r, divisor));
+				_mm256_storeu_ps(pG + i, _mm256_div_ps(g, divisor));
+				_mm256_storeu_ps(pB + i, _mm256_div_ps(b, divisor));
+			}
+#endif
+
+#if defined(DAE_SIMD_SSE)
+			for (; i + 4 <= count; i += 4)
+			{
+				const __m128 r{ _mm_loadu_ps(pR + i) };
+				const __m128 g{ _mm_loadu_ps(pG + i) };
+				const __m128 b{ _mm_loadu_ps(pB + i) };
+				const __m128 divisor{ _mm_max_ps(_mm_max_ps(r, _mm_max_ps(g, b)), _mm_set1_ps(1.f)) };
+
+				_mm_storeu_ps(pR + i, _mm_div_ps(r, divisor));
+				_mm_storeu_ps(pG + i, _mm_div_ps(g, divisor));
+				_mm_storeu_ps(pB + i, _mm_div_ps(b, divisor));
+			}
+#endif
+
+			for (; i < count; ++i)
+			{
+				ColorRGB color{ pR[i], pG[i], pB[i] };
+				color.MaxToOne();
+				pR[i] = color.r;
+				pG[i] = color.g;
+				pB[i] = color.b;
+			}
+		}
+
+		void MaxToOne(ColorRGBStream& colors)
+		{
+			MaxToOne(colors.r.data(), colors.g.data(), colors.b.data(), colors.GetCount());
+		}
+
+		void Lerp(const float* pValues1, const float* pValues2, const float* pFactors, uint32_t count, float* pResult)
+		{
+			uint32_t i{ 0 };
+
+			//Same operation order as Lerpf
+#if defined(DAE_SIMD_AVX)
+			for (; i + 8 <= count; i += 8)
+			{
+				const __m256 factor{ _mm256_loadu_ps(pFactors + i) };
+				const __m256 weighted1{ _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(1.f), factor), _mm256_loadu_ps(pValues1 + i)) };
+				_mm256_storeu_ps(pResult + i, _mm256_add_ps(weighted1, _mm256_mul_ps(factor, _mm256_loadu_ps(pValues2 + i))));
+			}
+#endif
+
+#if defined(DAE_SIMD_SSE)
+			for (; i + 4 <= count; i += 4)
+			{
+				const __m128 factor{ _mm_loadu_ps(pFactors + i) };
+				const __m128 weighted1{ _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(1.f), factor), _mm_loadu_ps(pValues1 + i)) };
+				_mm_storeu_ps(pResult + i, _mm_add_ps(weighted1, _mm_mul_ps(factor, _mm_loadu_ps(pValues2 + i))));
+			}
+#endif
+
+			for (; i < count; ++i)
+			{
+				pResult[i] = Lerpf(pValues1[i], pValues2[i], pFactors[i]);
+			}
+		}
+
+		void Lerp(const ColorRGBStream& colors1, const ColorRGBStream& colors2, const float* pFactors, ColorRGBStream& result)
+		{
+			const uint32_t count{ colors1.GetCount() };
+			result.Resize(count);
+			Lerp(colors1.r.data(), colors2.r.data(), pFactors, count, result.r.data());
+			Lerp(colors1.g.data(), colors2.g.data(), pFactors, count, result.g.data());
+			Lerp(colors1.b.data(), colors2.b.data(), pFactors, count, result.b.data());
+		}
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "ColorRGB.h"
+#include <cstdint>
+#include <vector>
+
+namespace dae
+{
+	//Structure of arrays copy of rgb data, the layout ColorBatch works on
+	struct ColorRGBStream
+	{
+		std::vector<float> r{};
+		std::vector<float> g{};
+		std::vector<float> b{};
+
+		void Resize(uint32_t count);
+		void Set(uint32_t index, const ColorRGB& value);
+		ColorRGB Get(uint32_t index) const;
+		uint32_t GetCount() const;
+	};
+
+	//The per-pixel ColorRGB operations for count colors at once, 8 wide with AVX, 4 wide with SSE (see Simd.h).
+	//Every lane gives the same result as the matching ColorRGB / ColorRGBA8 function.
+	//Inputs and outputs need no particular alignment, in-place calls are fine where an output is also an input
+	namespace ColorBatch
+	{
+		//RGBA8 texels to floats in [0, 1], alpha dropped. ColorRGBA8::ToColor per texel
+		void Unpack(const ColorRGBA8* pTexels, uint32_t count, float* pR, float* pG, float* pB);
+		void Unpack(const ColorRGBA8* pTexels, uint32_t count, ColorRGBStream& result);
+
+		//Floats to opaque RGBA8, saturated and rounded to the nearest step. ColorRGBA8::FromColor per color
+		void Pack(const float* pR, const float* pG, const float* pB, uint32_t count, ColorRGBA8* pTexels);
+		void Pack(const ColorRGBStream& colors, ColorRGBA8* pTexels);
+
+		//ColorRGB::MaxToOne per color
+		void MaxToOne(float* pR, float* pG, float* pB, uint32_t count);
+		void MaxToOne(ColorRGBStream& colors);
+
+		//ColorRGB::Lerp per color, with one factor per color. The pointer version does a single channel
+		void Lerp(const float* pValues1, const float* pValues2, const float* pFactors, uint32_t count, float* pResult);
+		void Lerp(const ColorRGBStream& colors1, const ColorRGBStream& colors2, const float* pFactors, ColorRGBStream& result);
+	}
+}
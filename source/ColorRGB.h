@@ -1,5 +1,6 @@
 #pragma once
 #include "MathHelpers.h"
+#include <cstdint>
 
 namespace dae
 {
@@ -109,6 +110,37 @@ namespace dae
 		return c * s;
 	}
 
+	//8 bits per channel in r, g, b, a byte order: DXGI_FORMAT_R8G8B8A8_UNORM and SDL_PIXELFORMAT_RGBA32.
+	//Batches of these convert to and from floats with ColorBatch
+	struct ColorRGBA8
+	{
+		uint8_t r{};
+		uint8_t g{};
+		uint8_t b{};
+		uint8_t a{ 255 };
+
+		//Saturated and rounded to the nearest step, opaque
+		static ColorRGBA8 FromColor(const ColorRGB& c)
+		{
+			return { ToChannel(c.r), ToChannel(c.g), ToChannel(c.b), 255 };
+		}
+
+		ColorRGB ToColor() const
+		{
+			constexpr float scale{ 1.f / 255.f };
+			return { r * scale, g * scale, b * scale };
+		}
+
+		static uint8_t ToChannel(float value)
+		{
+			//Written so NaN becomes 0, like the SIMD min/max in ColorBatch
+			value = value > 0.f ? value : 0.f;
+			value = value < 1.f ? value : 1.f;
+			return static_cast<uint8_t>(value * 255.f + 0.5f);
+		}
+	};
+	static_assert(sizeof(ColorRGBA8) == 4);
+
 	namespace colors
 	{
 		static ColorRGB Red{ 1,0,0 };
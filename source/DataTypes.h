@@ -18,6 +18,14 @@ namespace dae
 		Vector3 tangent{};
 	};
 
+	struct Vertex_Vehicle
+	{
+		Vector3 position{};
+		Vector3 normal{};
+		Vector3 tangent{};
+		Vector2 uv{};
+	};
+
 	struct Vertex_Out
 	{
 		Vertex_Out(	Vector4 posInput = Vector4{ 0,0,0,0 }, 
@@ -44,4 +52,20 @@ namespace dae
 		TriangleStrip
 	};
 
+	//Render states of the effects' techniques, shared with the software rasterizer
+	enum class sampleState
+	{
+		point,
+		linear,
+		anisotropic
+	};
+
+	//Named after the techniques: backCulling keeps the triangles that are clockwise on screen
+	enum class cullMode
+	{
+		backCulling,
+		frontCulling,
+		noCulling
+	};
+
 }
\ No newline at end of file
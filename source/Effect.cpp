@@ -2,9 +2,20 @@
 #include "Effect.h"
 #include <assert.h>
 
-Effect::Effect(ID3D11Device* pDeviceInput, const std::wstring& pathInput)
+Effect::Effect(ID3D11Device* pDeviceInput, const std::wstring& pathInput, const D3D_SHADER_MACRO* pDefines)
 {
-	m_pEffect = LoadEffect(pDeviceInput, pathInput);
+	m_pEffect = LoadEffect(pDeviceInput, pathInput, pDefines);
+
+	BindShaderTechniques();
+
+	BindShaderMatrices();
+
+	BindShaderMaps();
+}
+
+Effect::Effect(ID3D11Device* pDeviceInput, ID3DBlob* pCompiledEffect)
+{
+	m_pEffect = CreateEffect(pDeviceInput, pCompiledEffect);
 
 	BindShaderTechniques();
 
@@ -19,11 +30,22 @@ Effect::~Effect()
 	m_pEffect->Release();
 }
 
-ID3DX11Effect* Effect::LoadEffect(ID3D11Device* pDevice, const std::wstring& assetFile)
+ID3DX11Effect* Effect::LoadEffect(ID3D11Device* pDevice, const std::wstring& assetFile, const D3D_SHADER_MACRO* pDefines)
+{
+	ID3DBlob* pCompiledEffect{ CompileEffect(assetFile, pDefines) };
+	ID3DX11Effect* pEffect{ CreateEffect(pDevice, pCompiledEffect) };
+
+	if (pCompiledEffect)
+		pCompiledEffect->Release();
+
+	return pEffect;
+}
+
+ID3DBlob* Effect::CompileEffect(const std::wstring& assetFile, const D3D_SHADER_MACRO* pDefines)
 {
 	HRESULT result;
 	ID3D10Blob* pErrorBlob{ nullptr };
-	ID3DX11Effect* pEffect;
+	ID3DBlob* pCompiledEffect{ nullptr };
 
 	DWORD shaderFlags = 0;
 
@@ -32,15 +54,17 @@ ID3DX11Effect* Effect::LoadEffect(ID3D11Device* pDevice, const std::wstring& ass
 	shaderFlags |= D3DCOMPILE_SKIP_OPTIMIZATION;
 #endif
 
-	result = D3DX11CompileEffectFromFile(assetFile.c_str(),
+	//The compile step of D3DX11CompileEffectFromFile, it doesn't touch the device so any thread can run it
+	result = D3DCompileFromFile(assetFile.c_str(),
+		pDefines,
 		nullptr,
 		nullptr,
+		"fx_5_0",
 		shaderFlags,
 		0,
-		pDevice,
-		&pEffect,
+		&pCompiledEffect,
 		&pErrorBlob);
-	
+
 	if (FAILED(result))
 	{
 		if (pErrorBlob != nullptr)
@@ -58,15 +82,37 @@ ID3DX11Effect* Effect::LoadEffect(ID3D11Device* pDevice, const std::wstring& ass
 			pErrorBlob = nullptr;
 
 			std::wcout << ss.str() << std::endl;
-
 		}
 		else
 		{
 			std::wstringstream ss;
 			ss << "Effectloader: Failed to CreateEffectFromFile!\nPath: " << assetFile;
 			std::wcout << ss.str() << std::endl;
-			return nullptr;
 		}
+
+		if (pCompiledEffect)
+			pCompiledEffect->Release();
+		return nullptr;
+	}
+
+	//Warnings only
+	if (pErrorBlob)
+		pErrorBlob->Release();
+
+	return pCompiledEffect;
+}
+
+ID3DX11Effect* Effect::CreateEffect(ID3D11Device* pDevice, ID3DBlob* pCompiledEffect)
+{
+	if (!pCompiledEffect)
+		return nullptr;
+
+	ID3DX11Effect* pEffect{ nullptr };
+	const HRESULT result = D3DX11CreateEffectFromMemory(pCompiledEffect->GetBufferPointer(), pCompiledEffect->GetBufferSize(), 0, pDevice, &pEffect);
+	if (FAILED(result))
+	{
+		std::wcout << L"Effectloader: Failed to create the effect from the compiled blob" << std::endl;
+		return nullptr;
 	}
 
 	return pEffect;
@@ -89,6 +135,15 @@ void Effect::SetDiffuseMap(dae::Texture* pDiffuseTexture)
 		m_pDiffuseMapVariable->SetResource(pDiffuseTexture->GetResourceViewTexturePtr());
 }
 
+void Effect::SetPositionQuantization(const PositionQuantization& quantization)
+{
+	//float3 variables: SetFloatVector would read a fourth float past the Vector3
+	if (m_pPositionOffsetVariable->IsValid())
+		m_pPositionOffsetVariable->SetRawValue(&quantization.offset, 0, sizeof(Vector3));
+	if (m_pPositionScaleVariable->IsValid())
+		m_pPositionScaleVariable->SetRawValue(&quantization.scale, 0, sizeof(Vector3));
+}
+
 void Effect::ToggleSampleState()
 {
 	m_SampleState = static_cast<sampleState>((static_cast<int>(m_SampleState) + 1) % NROFSAMPLESTATES);
@@ -286,6 +341,18 @@ void Effect::BindShaderMatrices()
 		std::wcout << L"variable gWorldViewProj invalid\n";
 	}
 
+	m_pPositionOffsetVariable = m_pEffect->GetVariableByName("gPositionOffset");
+	if (!m_pPositionOffsetVariable->IsValid())
+	{
+		std::wcout << L"variable gPositionOffset invalid\n";
+	}
+
+	m_pPositionScaleVariable = m_pEffect->GetVariableByName("gPositionScale");
+	if (!m_pPositionScaleVariable->IsValid())
+	{
+		std::wcout << L"variable gPositionScale invalid\n";
+	}
+
 }
 
 void Effect::BindShaderMaps()
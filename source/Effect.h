@@ -1,26 +1,15 @@
 #pragma once
 #include "Texture.h"
+#include "VertexLayout.h"
 using namespace dae;
 
-enum class sampleState
-{
-	point,
-	linear,
-	anisotropic
-};
-
-enum class cullMode
-{
-	backCulling,
-	frontCulling,
-	noCulling
-};
-
 class Effect
 {
 public:
 
-	Effect(ID3D11Device* pDeviceInput, const std::wstring& pathInput);
+	Effect(ID3D11Device* pDeviceInput, const std::wstring& pathInput, const D3D_SHADER_MACRO* pDefines = nullptr);
+	//From CompileEffect's output, the caller keeps ownership of the blob
+	Effect(ID3D11Device* pDeviceInput, ID3DBlob* pCompiledEffect);
 	virtual ~Effect();
 
 	// -----------------------------------------------
@@ -34,11 +23,15 @@ public:
 	//------------------------------------------------
 	// Public member functions						
 	//------------------------------------------------
-	static ID3DX11Effect* LoadEffect(ID3D11Device* pDevice, const std::wstring& assetFile);
+	static ID3DX11Effect* LoadEffect(ID3D11Device* pDevice, const std::wstring& assetFile, const D3D_SHADER_MACRO* pDefines = nullptr);
+	//Compiling needs no device and is safe on worker threads, creating the effect happens on the device's thread
+	static ID3DBlob* CompileEffect(const std::wstring& assetFile, const D3D_SHADER_MACRO* pDefines = nullptr);
+	static ID3DX11Effect* CreateEffect(ID3D11Device* pDevice, ID3DBlob* pCompiledEffect);
 	ID3DX11EffectTechnique* GetTechniquePtr();
 
 	void SetWorldViewProjectionMatrix(const Matrix& worldViewProjectionMatrix);
 	void SetDiffuseMap(dae::Texture* pDiffuseTexture);
+	void SetPositionQuantization(const PositionQuantization& quantization);
 	
 
 	void ToggleSampleState();
@@ -77,6 +70,9 @@ protected:
 
 	ID3DX11EffectMatrixVariable* m_pMatWorldViewProjVariable{ nullptr };
 
+	ID3DX11EffectVariable* m_pPositionOffsetVariable{ nullptr };
+	ID3DX11EffectVariable* m_pPositionScaleVariable{ nullptr };
+
 	ID3DX11EffectShaderResourceVariable* m_pDiffuseMapVariable{ nullptr };
 	ID3DX11EffectShaderResourceVariable* m_pNormalMapVariable{ nullptr };
 	ID3DX11EffectShaderResourceVariable* m_pSpecularMapVariable{ nullptr };
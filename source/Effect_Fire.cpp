@@ -1,8 +1,13 @@
 #include "pch.h"
 #include "Effect_Fire.h"
 
-Effect_Fire::Effect_Fire(ID3D11Device* pDeviceInput, const std::wstring& pathInput)
-	: Effect(pDeviceInput,pathInput)
+Effect_Fire::Effect_Fire(ID3D11Device* pDeviceInput, const std::wstring& pathInput, const D3D_SHADER_MACRO* pDefines)
+	: Effect(pDeviceInput,pathInput,pDefines)
+{
+}
+
+Effect_Fire::Effect_Fire(ID3D11Device* pDeviceInput, ID3DBlob* pCompiledEffect)
+	: Effect(pDeviceInput, pCompiledEffect)
 {
 }
 
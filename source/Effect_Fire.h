@@ -4,7 +4,8 @@ class Effect_Fire :
     public Effect
 {
 public: 
-    Effect_Fire(ID3D11Device* pDeviceInput, const std::wstring& pathInput);
+    Effect_Fire(ID3D11Device* pDeviceInput, const std::wstring& pathInput, const D3D_SHADER_MACRO* pDefines = nullptr);
+    Effect_Fire(ID3D11Device* pDeviceInput, ID3DBlob* pCompiledEffect);
     ~Effect_Fire();
 }; 
 
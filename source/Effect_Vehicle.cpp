@@ -1,8 +1,19 @@
 #include "pch.h"
 #include "Effect_Vehicle.h"
 
-Effect_Vehicle::Effect_Vehicle(ID3D11Device* pDeviceInput, const std::wstring& pathInput)
-	: Effect(pDeviceInput,pathInput)
+Effect_Vehicle::Effect_Vehicle(ID3D11Device* pDeviceInput, const std::wstring& pathInput, const D3D_SHADER_MACRO* pDefines)
+	: Effect(pDeviceInput,pathInput,pDefines)
+{
+	BindVehicleVariables();
+}
+
+Effect_Vehicle::Effect_Vehicle(ID3D11Device* pDeviceInput, ID3DBlob* pCompiledEffect)
+	: Effect(pDeviceInput, pCompiledEffect)
+{
+	BindVehicleVariables();
+}
+
+void Effect_Vehicle::BindVehicleVariables()
 {
 	m_pNormalMapVariable = m_pEffect->GetVariableByName("gNormalMap")->AsShaderResource();
 	if (!m_pNormalMapVariable->IsValid())
@@ -34,10 +45,37 @@ Effect_Vehicle::Effect_Vehicle(ID3D11Device* pDeviceInput, const std::wstring& p
 		std::wcout << L"variable gViewInverseMatrix invalid\n";
 	}
 
+	m_pDepthBackCullTechnique = m_pEffect->GetTechniqueByName("DepthBackCullTechnique");
+	if (!m_pDepthBackCullTechnique->IsValid())
+	{
+		std::wcout << L"DepthBackCullTechnique invalid\n";
+	}
+
+	m_pDepthFrontCullTechnique = m_pEffect->GetTechniqueByName("DepthFrontCullTechnique");
+	if (!m_pDepthFrontCullTechnique->IsValid())
+	{
+		std::wcout << L"DepthFrontCullTechnique invalid\n";
+	}
+
+	m_pDepthNoCullTechnique = m_pEffect->GetTechniqueByName("DepthNoCullTechnique");
+	if (!m_pDepthNoCullTechnique->IsValid())
+	{
+		std::wcout << L"DepthNoCullTechnique invalid\n";
+	}
+
+	//The effect creates the state, GetDepthStencilState adds a reference for us
+	ID3DX11EffectDepthStencilVariable* pEqualDepthStencilVariable{ m_pEffect->GetVariableByName("gEqualDepthStencilState")->AsDepthStencil() };
+	if (!pEqualDepthStencilVariable->IsValid() || FAILED(pEqualDepthStencilVariable->GetDepthStencilState(0, &m_pEqualDepthStencilState)))
+	{
+		std::wcout << L"variable gEqualDepthStencilState invalid\n";
+	}
+
 }
 
 Effect_Vehicle::~Effect_Vehicle()
 {
+	if (m_pEqualDepthStencilState)
+		m_pEqualDepthStencilState->Release();
 }
 
 void Effect_Vehicle::SetNormalMap(ID3D11ShaderResourceView* pResourceView)
@@ -68,3 +106,20 @@ void Effect_Vehicle::SetViewInverseMatrix(const Matrix& viewInverseMatrix)
 	m_pMatViewInverseVariable->SetMatrix(reinterpret_cast<const float*>(&viewInverseMatrix));
 }
 
+ID3DX11EffectTechnique* Effect_Vehicle::GetDepthTechniquePtr() const
+{
+	switch (m_CullMode)
+	{
+	case cullMode::backCulling:
+		return m_pDepthBackCullTechnique;
+	case cullMode::frontCulling:
+		return m_pDepthFrontCullTechnique;
+	default:
+		return m_pDepthNoCullTechnique;
+	}
+}
+
+ID3D11DepthStencilState* Effect_Vehicle::GetEqualDepthStencilStatePtr() const
+{
+	return m_pEqualDepthStencilState;
+}
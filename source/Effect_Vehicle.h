@@ -4,7 +4,8 @@
 class Effect_Vehicle : public Effect
 {
 public:
-	Effect_Vehicle(ID3D11Device* pDeviceInput, const std::wstring& pathInput);
+	Effect_Vehicle(ID3D11Device* pDeviceInput, const std::wstring& pathInput, const D3D_SHADER_MACRO* pDefines = nullptr);
+	Effect_Vehicle(ID3D11Device* pDeviceInput, ID3DBlob* pCompiledEffect);
 	~Effect_Vehicle();
 
 	void SetNormalMap(ID3D11ShaderResourceView* pResourceView);
@@ -12,6 +13,11 @@ public:
 	void SetGlossinessMap(ID3D11ShaderResourceView* pResourceView);
 	void SetWorldMatrix(const Matrix& worldMatrix);
 	void SetViewInverseMatrix(const Matrix& viewInverseMatrix);
+
+	//Depth pre-pass: positions only and no pixel shader, culled like the active technique
+	ID3DX11EffectTechnique* GetDepthTechniquePtr() const;
+	//Set after the active technique's pass to shade only what the pre-pass left in front
+	ID3D11DepthStencilState* GetEqualDepthStencilStatePtr() const;
 private:
 	ID3DX11EffectMatrixVariable* m_pMatWorldVariable{ nullptr };
 	ID3DX11EffectMatrixVariable* m_pMatViewInverseVariable{ nullptr };
@@ -19,5 +25,12 @@ private:
 	ID3DX11EffectShaderResourceVariable* m_pNormalMapVariable{nullptr};
 	ID3DX11EffectShaderResourceVariable* m_pSpecularMapVariable{ nullptr };
 	ID3DX11EffectShaderResourceVariable* m_pGlossinessMapVariable{ nullptr };
+
+	ID3DX11EffectTechnique* m_pDepthBackCullTechnique{ nullptr };
+	ID3DX11EffectTechnique* m_pDepthFrontCullTechnique{ nullptr };
+	ID3DX11EffectTechnique* m_pDepthNoCullTechnique{ nullptr };
+	ID3D11DepthStencilState* m_pEqualDepthStencilState{ nullptr };
+
+	void BindVehicleVariables();
 };
 
@@ -0,0 +1,109 @@
+#include "pch.h"
+#include "FastMath.h"
+
+namespace dae
+{
+	namespace FastMath
+	{
+#if defined(DAE_SIMD_SSE)
+		namespace
+		{
+			inline __m128 ReciprocalSqrt4(__m128 value)
+			{
+				const __m128 estimate{ _mm_rsqrt_ps(value) };
+				const __m128 halfValueSquared{ _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), value), _mm_mul_ps(estimate, estimate)) };
+				return _mm_mul_ps(estimate, _mm_sub_ps(_mm_set1_ps(1.5f), halfValueSquared));
+			}
+
+			inline __m128 Reciprocal4(__m128 value)
+			{
+				const __m128 estimate{ _mm_rcp_ps(value) };
+				return _mm_mul_ps(estimate, _mm_sub_ps(_mm_set1_ps(2.f), _mm_mul_ps(value, estimate)));
+			}
+
+			//Lane for lane the scalar Log2 and Exp2. AVX has no 256-bit integer operations, so SSE is as wide as these go
+			inline __m128 Log24(__m128 x)
+			{
+				const __m128i bits{ _mm_castps_si128(x) };
+				const __m128 exponent{ _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127))) };
+				const __m128 mantissa{ _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f800000))) };
+				const __m128 t{ _mm_sub_ps(mantissa, _mm_set1_ps(1.f)) };
+
+				__m128 polynomial{ _mm_set1_ps(-0.0338220447f) };
+				polynomial = _mm_add_ps(_mm_mul_ps(polynomial, t), _mm_set1_ps(0.144471094f));
+				polynomial = _mm_add_ps(_mm_mul_ps(polynomial, t), _mm_set1_ps(-0.301638007f));
+				polynomial = _mm_add_ps(_mm_mul_ps(polynomial, t), _mm_set1_ps(0.468658864f));
+				polynomial = _mm_add_ps(_mm_mul_ps(polynomial, t), _mm_set1_ps(-0.720358789f));
+				polynomial = _mm_add_ps(_mm_mul_ps(polynomial, t), _mm_set1_ps(1.44268143f));
+				return _mm_add_ps(exponent, _mm_mul_ps(polynomial, t));
+			}
+
+			inline __m128 Exp24(__m128 x)
+			{
+				x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-127.f)), _mm_set1_ps(127.f));
+
+				const __m128i whole{ _mm_sub_epi32(_mm_cvttps_epi32(_mm_add_ps(x, _mm_set1_ps(128.f))), _mm_set1_epi32(128)) };
+				const __m128 t{ _mm_sub_ps(x, _mm_cvtepi32_ps(whole)) };
+
+				__m128 polynomial{ _mm_set1_ps(0.0136703094f) };
+				polynomial = _mm_add_ps(_mm_mul_ps(polynomial, t), _mm_set1_ps(0.0517449975f));
+				polynomial = _mm_add_ps(_mm_mul_ps(polynomial, t), _mm_set1_ps(0.241604358f));
+				polynomial = _mm_add_ps(_mm_mul_ps(polynomial, t), _mm_set1_ps(0.692972898f));
+				polynomial = _mm_add_ps(_mm_mul_ps(polynomial, t), _mm_set1_ps(1.00000346f));
+				return _mm_mul_ps(polynomial, _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(whole, _mm_set1_epi32(127)), 23)));
+			}
+		}
+#endif
+
+		void ReciprocalSqrt(const float* pValues, uint32_t count, float* pResults)
+		{
+			uint32_t i{ 0 };
+#if defined(DAE_SIMD_SSE)
+			for (; i + 4 <= count; i += 4)
+			{
+				_mm_storeu_ps(pResults + i, ReciprocalSqrt4(_mm_loadu_ps(pValues + i)));
+			}
+#endif
+			for (; i < count; ++i)
+			{
+				pResults[i] = ReciprocalSqrt(pValues[i]);
+			}
+		}
+
+		void Reciprocal(const float* pValues, uint32_t count, float* pResults)
+		{
+			uint32_t i{ 0 };
+#if defined(DAE_SIMD_SSE)
+			for (; i + 4 <= count; i += 4)
+			{
+				_mm_storeu_ps(pResults + i, Reciprocal4(_mm_loadu_ps(pValues + i)));
+			}
+#endif
+			for (; i < count; ++i)
+			{
+				pResults[i] = Reciprocal(pValues[i]);
+			}
+		}
+
+		void SpecularPow(const float* pCosines, const float* pExponents, uint32_t count, float* pResults)
+		{
+			uint32_t i{ 0 };
+#if defined(DAE_SIMD_SSE)
+			for (; i + 4 <= count; i += 4)
+			{
+				const __m128 cosine{ _mm_loadu_ps(pCosines + i) };
+				const __m128 exponent{ _mm_loadu_ps(pExponents + i) };
+				const __m128 power{ Exp24(_mm_mul_ps(exponent, Log24(_mm_max_ps(cosine, _mm_set1_ps(FLT_MIN))))) };
+
+				//0 for a cosine of 0, unless the exponent is 0 too
+				const __m128 isKept{ _mm_or_ps(_mm_cmpgt_ps(cosine, _mm_setzero_ps()), _mm_cmple_ps(exponent, _mm_setzero_ps())) };
+				_mm_storeu_ps(pResults + i, _mm_and_ps(power, isKept));
+			}
+#endif
+			for (; i < count; ++i)
+			{
+				pResults[i] = SpecularPow(pCosines[i], pExponents[i]);
+			}
+		}
+	}
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include "Simd.h"
+#include <algorithm>
+#include <bit>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+
+//Approximate kernels for the shading math, max errors as measured over the full input range by FastMathBenchmark.
+//Defining DAE_FAST_MATH sets FastMath::IsEnabled, which CPU shading code checks to opt in to the batch kernels.
+//Vector3 stays exact, so normalized data such as the tangents baked into mesh caches is the same in every build
+namespace dae
+{
+	namespace FastMath
+	{
+#if defined(DAE_FAST_MATH)
+		constexpr bool IsEnabled{ true };
+#else
+		constexpr bool IsEnabled{ false };
+#endif
+
+		//1 / sqrt(x) for x > 0. SSE: rsqrtss and one Newton step, relative error < 3e-7.
+		//Scalar: bit pattern estimate and two Newton steps, relative error < 5e-6
+		inline float ReciprocalSqrt(float x)
+		{
+#if defined(DAE_SIMD_SSE)
+			const __m128 value{ _mm_set_ss(x) };
+			const __m128 estimate{ _mm_rsqrt_ss(value) };
+			//y * (1.5 - 0.5 * x * y * y)
+			const __m128 halfValueSquared{ _mm_mul_ss(_mm_mul_ss(_mm_set_ss(0.5f), value), _mm_mul_ss(estimate, estimate)) };
+			return _mm_cvtss_f32(_mm_mul_ss(estimate, _mm_sub_ss(_mm_set_ss(1.5f), halfValueSquared)));
+#else
+			float estimate{ std::bit_cast<float>(0x5f375a86u - (std::bit_cast<uint32_t>(x) >> 1)) };
+			estimate *= 1.5f - 0.5f * x * estimate * estimate;
+			estimate *= 1.5f - 0.5f * x * estimate * estimate;
+			return estimate;
+#endif
+		}
+
+		//1 / x for x != 0. SSE: rcpss and one Newton step, relative error < 2e-7. Scalar: the exact division
+		inline float Reciprocal(float x)
+		{
+#if defined(DAE_SIMD_SSE)
+			const __m128 value{ _mm_set_ss(x) };
+			const __m128 estimate{ _mm_rcp_ss(value) };
+			//y * (2 - x * y)
+			return _mm_cvtss_f32(_mm_mul_ss(estimate, _mm_sub_ss(_mm_set_ss(2.f), _mm_mul_ss(value, estimate))));
+#else
+			return 1.f / x;
+#endif
+		}
+
+		//log2(x) for normal x > 0: exponent bits plus a degree 5 polynomial on the mantissa, absolute error < 1e-5
+		inline float Log2(float x)
+		{
+			const uint32_t bits{ std::bit_cast<uint32_t>(x) };
+			const float exponent{ static_cast<float>(static_cast<int>(bits >> 23) - 127) };
+			//Mantissa in [1, 2)
+			const float t{ std::bit_cast<float>((bits & 0x007fffffu) | 0x3f800000u) - 1.f };
+
+			//log2(1 + t) / t, Chebyshev fit on [0, 1]
+			float polynomial{ -0.0338220447f };
+			polynomial = polynomial * t + 0.144471094f;
+			polynomial = polynomial * t - 0.301638007f;
+			polynomial = polynomial * t + 0.468658864f;
+			polynomial = polynomial * t - 0.720358789f;
+			polynomial = polynomial * t + 1.44268143f;
+			return exponent + polynomial * t;
+		}
+
+		//2^x for x up to 127. Degree 4 polynomial on the fraction, relative error < 4e-6.
+		//Results below 2^-126 are exactly 0: denormals would slow down everything they flow into
+		inline float Exp2(float x)
+		{
+			x = std::min(std::max(x, -127.f), 127.f);
+
+			//floor without a library call: truncating a positive value rounds down. A whole part of -127 makes the scale 0
+			const int whole{ static_cast<int>(x + 128.f) - 128 };
+			const float t{ x - static_cast<float>(whole) };
+
+			//2^t, Chebyshev fit on [0, 1]
+			float polynomial{ 0.0136703094f };
+			polynomial = polynomial * t + 0.0517449975f;
+			polynomial = polynomial * t + 0.241604358f;
+			polynomial = polynomial * t + 0.692972898f;
+			polynomial = polynomial * t + 1.00000346f;
+			return polynomial * std::bit_cast<float>(static_cast<uint32_t>(whole + 127) << 23);
+		}
+
+		//pow(cosine, exponent) for a saturated cosine in [0, 1] and a specular exponent >= 0, as the Phong term uses it.
+		//Absolute error < 2e-4 for exponents up to 25 (gShininess), far below one 8-bit color step. Exact 0 and 1 at a
+		//cosine of 0, like pow. One at a time this is not faster than a good powf, the batch version below is
+		inline float SpecularPow(float cosine, float exponent)
+		{
+			const float power{ Exp2(exponent * Log2(std::max(cosine, FLT_MIN))) };
+			return cosine > 0.f || exponent <= 0.f ? power : 0.f;
+		}
+
+		//count values at once, 4 wide with SSE (see Simd.h), within the error bounds of the scalar versions.
+		//Inputs and outputs need no particular alignment, pResults may be one of the inputs
+		void ReciprocalSqrt(const float* pValues, uint32_t count, float* pResults);
+		void Reciprocal(const float* pValues, uint32_t count, float* pResults);
+		void SpecularPow(const float* pCosines, const float* pExponents, uint32_t count, float* pResults);
+	}
+}
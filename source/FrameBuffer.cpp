@@ -0,0 +1,47 @@
+#include "pch.h"
+#include "FrameBuffer.h"
+#include <fstream>
+
+namespace dae
+{
+	void FrameBuffer::Resize(uint32_t newWidth, uint32_t newHeight)
+	{
+		width = newWidth;
+		height = newHeight;
+		color.resize(GetNumPixels());
+		depth.resize(GetNumPixels());
+	}
+
+	void FrameBuffer::Clear(const ColorRGB& clearColor, float clearDepth)
+	{
+		std::fill(color.begin(), color.end(), ColorRGBA8::FromColor(clearColor));
+		std::fill(depth.begin(), depth.end(), clearDepth);
+	}
+
+	uint32_t FrameBuffer::GetNumPixels() const
+	{
+		return width * height;
+	}
+
+	bool FrameBuffer::WriteImage(const std::string& path) const
+	{
+		std::ofstream file{ path, std::ios::binary };
+		if (!file)
+			return false;
+
+		file << "P6\n" << width << " " << height << "\n255\n";
+		std::vector<uint8_t> row(width * 3);
+		for (uint32_t y = 0; y < height; ++y)
+		{
+			for (uint32_t x = 0; x < width; ++x)
+			{
+				const ColorRGBA8& pixel{ color[y * width + x] };
+				row[x * 3] = pixel.r;
+				row[x * 3 + 1] = pixel.g;
+				row[x * 3 + 2] = pixel.b;
+			}
+			file.write(reinterpret_cast<const char*>(row.data()), row.size());
+		}
+		return static_cast<bool>(file);
+	}
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "ColorRGB.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace dae
+{
+	//Color and depth target of the software rasterizer, row after row from the top left like the swap chain.
+	//Depth is z / w in [0, 1], cleared to the far plane
+	struct FrameBuffer
+	{
+		uint32_t width{};
+		uint32_t height{};
+		std::vector<ColorRGBA8> color{};
+		std::vector<float> depth{};
+
+		void Resize(uint32_t newWidth, uint32_t newHeight);
+		void Clear(const ColorRGB& clearColor, float clearDepth = 1.f);
+		uint32_t GetNumPixels() const;
+
+		//Binary PPM of the color target, for comparing against screenshots of the hardware renderer
+		bool WriteImage(const std::string& path) const;
+	};
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include "Frustum.h"
+
+namespace dae
+{
+	//Everything camera dependent a mesh needs to draw, computed once per frame by Renderer::Render and passed to every mesh
+	struct FrameConstants
+	{
+		//World to camera, and its inverse: the camera to world ONB
+		Matrix viewMatrix{};
+		Matrix inverseViewMatrix{};
+		Matrix projectionMatrix{};
+		Matrix viewProjectionMatrix{};
+		//World space planes, for whole-object culling
+		Frustum frustum{};
+		Vector3 cameraPosition{};
+		float viewportWidth{};
+		float viewportHeight{};
+
+		static FrameConstants Create(const Matrix& viewMatrix, const Matrix& inverseViewMatrix, const Matrix& projectionMatrix, float viewportWidth, float viewportHeight)
+		{
+			FrameConstants constants{ viewMatrix, inverseViewMatrix, projectionMatrix, viewMatrix * projectionMatrix };
+			constants.frustum = Frustum::FromMatrix(constants.viewProjectionMatrix);
+			constants.cameraPosition = inverseViewMatrix.GetTranslation();
+			constants.viewportWidth = viewportWidth;
+			constants.viewportHeight = viewportHeight;
+			return constants;
+		}
+	};
+}
@@ -0,0 +1,204 @@
+#include "pch.h"
+#include "Frustum.h"
+#include "Simd.h"
+
+namespace dae
+{
+	namespace
+	{
+		Vector4 GetColumn(const Matrix& m, int column)
+		{
+			return { m[0][column], m[1][column], m[2][column], m[3][column] };
+		}
+
+		//Scaled to a unit normal so GetSignedDistance returns real distances
+		Plane CreatePlane(const Vector4& coefficients)
+		{
+			const Vector3 normal{ coefficients.GetXYZ() };
+			const float length{ normal.Magnitude() };
+			if (length <= 0.f)
+				return {};
+
+			return { normal / length, coefficients.w / length };
+		}
+	}
+
+	float Plane::GetSignedDistance(const Vector3& point) const
+	{
+		return Vector3::Dot(normal, point) + distance;
+	}
+
+	Bounds Bounds::FromMinMax(const Vector3& min, const Vector3& max, float radius)
+	{
+		return { (min + max) * 0.5f, (max - min) * 0.5f, radius };
+	}
+
+	Bounds Bounds::Transform(const Matrix& matrix) const
+	{
+		Bounds result{ matrix.TransformPoint(center) };
+
+		//Row vectors: output axis c gets |m[r][c]| of every input extent r
+		float maxSqrScale{};
+		for (int r{ 0 }; r < 3; ++r)
+		{
+			const Vector3 axis{ matrix[r] };
+			result.extents += Vector3{ std::abs(axis.x), std::abs(axis.y), std::abs(axis.z) } * extents[r];
+			maxSqrScale = std::max(maxSqrScale, axis.SqrMagnitude());
+		}
+		result.radius = radius * std::sqrt(maxSqrScale);
+		return result;
+	}
+
+	void BoundsStream::Resize(uint32_t count)
+	{
+		centerX.resize(count);
+		centerY.resize(count);
+		centerZ.resize(count);
+		extentX.resize(count);
+		extentY.resize(count);
+		extentZ.resize(count);
+		radius.resize(count);
+	}
+
+	void BoundsStream::Set(uint32_t index, const Bounds& value)
+	{
+		centerX[index] = value.center.x;
+		centerY[index] = value.center.y;
+		centerZ[index] = value.center.z;
+		extentX[index] = value.extents.x;
+		extentY[index] = value.extents.y;
+		extentZ[index] = value.extents.z;
+		radius[index] = value.radius;
+	}
+
+	Bounds BoundsStream::Get(uint32_t index) const
+	{
+		return { Vector3{ centerX[index], centerY[index], centerZ[index] }, Vector3{ extentX[index], extentY[index], extentZ[index] }, radius[index] };
+	}
+
+	uint32_t BoundsStream::GetCount() const
+	{
+		return static_cast<uint32_t>(centerX.size());
+	}
+
+	Frustum Frustum::FromMatrix(const Matrix& viewProjection)
+	{
+		const Vector4 x{ GetColumn(viewProjection, 0) };
+		const Vector4 y{ GetColumn(viewProjection, 1) };
+		const Vector4 z{ GetColumn(viewProjection, 2) };
+		const Vector4 w{ GetColumn(viewProjection, 3) };
+
+		Frustum frustum{};
+		frustum.planes[Left] = CreatePlane(w + x);
+		frustum.planes[Right] = CreatePlane(w - x);
+		frustum.planes[Bottom] = CreatePlane(w + y);
+		frustum.planes[Top] = CreatePlane(w - y);
+		frustum.planes[Near] = CreatePlane(z);
+		frustum.planes[Far] = CreatePlane(w - z);
+		return frustum;
+	}
+
+	bool Frustum::IsSphereVisible(const Vector3& center, float radius) const
+	{
+		for (const Plane& plane : planes)
+		{
+			if (plane.GetSignedDistance(center) < -radius)
+				return false;
+		}
+		return true;
+	}
+
+	bool Frustum::IsBoxVisible(const Vector3& center, const Vector3& extents) const
+	{
+		return IsVisible(Bounds{ center, extents, FLT_MAX });
+	}
+
+	bool Frustum::IsVisible(const Bounds& bounds) const
+	{
+		for (const Plane& plane : planes)
+		{
+			//Distance of the box corner farthest along the normal, same operation order as the SIMD lanes in Cull
+			const Vector3& n{ plane.normal };
+			const float boxRadius{ (std::abs(n.x) * bounds.extents.x + std::abs(n.y) * bounds.extents.y) + std::abs(n.z) * bounds.extents.z };
+			if (plane.GetSignedDistance(bounds.center) < -std::min(boxRadius, bounds.radius))
+				return false;
+		}
+		return true;
+	}
+
+	void Frustum::Cull(const BoundsStream& bounds, std::vector<uint8_t>& isVisible, FrustumCullStatistics& statistics) const
+	{
+		const uint32_t count{ bounds.GetCount() };
+		isVisible.resize(count);
+		uint32_t i{ 0 };
+
+#if defined(DAE_SIMD_AVX)
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256 centerX{ _mm256_loadu_ps(bounds.centerX.data() + i) };
+			const __m256 centerY{ _mm256_loadu_ps(bounds.centerY.data() + i) };
+			const __m256 centerZ{ _mm256_loadu_ps(bounds.centerZ.data() + i) };
+			const __m256 extentX{ _mm256_loadu_ps(bounds.extentX.data() + i) };
+			const __m256 extentY{ _mm256_loadu_ps(bounds.extentY.data() + i) };
+			const __m256 extentZ{ _mm256_loadu_ps(bounds.extentZ.data() + i) };
+			const __m256 radius{ _mm256_loadu_ps(bounds.radius.data() + i) };
+
+			__m256 isCulled{ _mm256_setzero_ps() };
+			for (const Plane& plane : planes)
+			{
+				const Vector3& n{ plane.normal };
+				const __m256 distance{ _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(n.x), centerX), _mm256_mul_ps(_mm256_set1_ps(n.y), centerY)),
+					_mm256_mul_ps(_mm256_set1_ps(n.z), centerZ)), _mm256_set1_ps(plane.distance)) };
+				const __m256 boxRadius{ _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(std::abs(n.x)), extentX), _mm256_mul_ps(_mm256_set1_ps(std::abs(n.y)), extentY)),
+					_mm256_mul_ps(_mm256_set1_ps(std::abs(n.z)), extentZ)) };
+				const __m256 negativeRadius{ _mm256_sub_ps(_mm256_setzero_ps(), _mm256_min_ps(boxRadius, radius)) };
+				isCulled = _mm256_or_ps(isCulled, _mm256_cmp_ps(distance, negativeRadius, _CMP_LT_OQ));
+			}
+
+			const int culledMask{ _mm256_movemask_ps(isCulled) };
+			for (uint32_t lane = 0; lane < 8; ++lane)
+				isVisible[i + lane] = ((culledMask >> lane) & 1) == 0;
+		}
+#endif
+
+#if defined(DAE_SIMD_SSE)
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128 centerX{ _mm_loadu_ps(bounds.centerX.data() + i) };
+			const __m128 centerY{ _mm_loadu_ps(bounds.centerY.data() + i) };
+			const __m128 centerZ{ _mm_loadu_ps(bounds.centerZ.data() + i) };
+			const __m128 extentX{ _mm_loadu_ps(bounds.extentX.data() + i) };
+			const __m128 extentY{ _mm_loadu_ps(bounds.extentY.data() + i) };
+			const __m128 extentZ{ _mm_loadu_ps(bounds.extentZ.data() + i) };
+			const __m128 radius{ _mm_loadu_ps(bounds.radius.data() + i) };
+
+			__m128 isCulled{ _mm_setzero_ps() };
+			for (const Plane& plane : planes)
+			{
+				const Vector3& n{ plane.normal };
+				const __m128 distance{ _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(n.x), centerX), _mm_mul_ps(_mm_set1_ps(n.y), centerY)),
+					_mm_mul_ps(_mm_set1_ps(n.z), centerZ)), _mm_set1_ps(plane.distance)) };
+				const __m128 boxRadius{ _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(std::abs(n.x)), extentX), _mm_mul_ps(_mm_set1_ps(std::abs(n.y)), extentY)),
+					_mm_mul_ps(_mm_set1_ps(std::abs(n.z)), extentZ)) };
+				const __m128 negativeRadius{ _mm_sub_ps(_mm_setzero_ps(), _mm_min_ps(boxRadius, radius)) };
+				isCulled = _mm_or_ps(isCulled, _mm_cmplt_ps(distance, negativeRadius));
+			}
+
+			const int culledMask{ _mm_movemask_ps(isCulled) };
+			for (uint32_t lane = 0; lane < 4; ++lane)
+				isVisible[i + lane] = ((culledMask >> lane) & 1) == 0;
+		}
+#endif
+
+		for (; i < count; ++i)
+		{
+			isVisible[i] = IsVisible(bounds.Get(i));
+		}
+
+		statistics = {};
+		statistics.numTested = count;
+		for (const uint8_t visible : isVisible)
+			statistics.numVisible += visible;
+		statistics.numCulled = count - statistics.numVisible;
+	}
+}
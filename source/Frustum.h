@@ -0,0 +1,79 @@
+#pragma once
+#include "Matrix.h"
+#include <cstdint>
+#include <vector>
+
+namespace dae
+{
+	//Plane through the points p with Dot(normal, p) + distance == 0, normal pointing to the inside
+	struct Plane
+	{
+		Vector3 normal{};
+		float distance{};
+
+		float GetSignedDistance(const Vector3& point) const;
+	};
+
+	//Axis aligned box and a sphere around the same center, culled against both: the box is tighter along the axes,
+	//the sphere (from the farthest vertex, see MeshCacheHeader::boundsRadius) near the corners
+	struct Bounds
+	{
+		Vector3 center{};
+		Vector3 extents{};
+		float radius{};
+
+		static Bounds FromMinMax(const Vector3& min, const Vector3& max, float radius);
+
+		//Box around the transformed box, sphere scaled by the largest axis scale of the affine matrix
+		Bounds Transform(const Matrix& matrix) const;
+	};
+
+	//Structure of arrays copy of many Bounds, the input of Frustum::Cull
+	struct BoundsStream
+	{
+		std::vector<float> centerX{};
+		std::vector<float> centerY{};
+		std::vector<float> centerZ{};
+		std::vector<float> extentX{};
+		std::vector<float> extentY{};
+		std::vector<float> extentZ{};
+		std::vector<float> radius{};
+
+		void Resize(uint32_t count);
+		void Set(uint32_t index, const Bounds& value);
+		Bounds Get(uint32_t index) const;
+		uint32_t GetCount() const;
+	};
+
+	struct FrustumCullStatistics
+	{
+		uint32_t numTested{};
+		uint32_t numVisible{};
+		uint32_t numCulled{};
+	};
+
+	//View volume of a (world)ViewProjection matrix, in the space the matrix transforms from.
+	//Passing world * view * projection gives the planes in object space so bounds never need transforming
+	struct Frustum
+	{
+		enum PlaneIndex
+		{
+			Left, Right, Bottom, Top, Near, Far, NumPlanes
+		};
+
+		Plane planes[NumPlanes]{};
+
+		//Gribb-Hartmann extraction for row vectors and a D3D clip volume (0 <= z <= w)
+		static Frustum FromMatrix(const Matrix& viewProjection);
+
+		bool IsSphereVisible(const Vector3& center, float radius) const;
+		bool IsBoxVisible(const Vector3& center, const Vector3& extents) const;
+		//False only when the box or the sphere is fully outside one of the planes. Conservative: bounds outside the frustum
+		//but not outside any single plane stay visible
+		bool IsVisible(const Bounds& bounds) const;
+
+		//IsVisible for every element of bounds, 8 at once with AVX, 4 with SSE (see Simd.h), identical results.
+		//Resizes isVisible to the number of bounds and overwrites statistics
+		void Cull(const BoundsStream& bounds, std::vector<uint8_t>& isVisible, FrustumCullStatistics& statistics) const;
+	};
+}
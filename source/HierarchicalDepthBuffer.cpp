@@ -0,0 +1,111 @@
+#include "pch.h"
+#include "HierarchicalDepthBuffer.h"
+#include "Simd.h"
+#include <algorithm>
+#include <bit>
+
+namespace dae
+{
+	void HierarchicalDepthBuffer::Resize(uint32_t width, uint32_t height, uint32_t newTileSize)
+	{
+		tileSize = newTileSize;
+		tileShift = static_cast<uint32_t>(std::countr_zero(tileSize));
+		numBlocksX = (width + BlockSize - 1) / BlockSize;
+		numBlocksY = (height + BlockSize - 1) / BlockSize;
+		numTilesX = (width + tileSize - 1) / tileSize;
+		numTilesY = (height + tileSize - 1) / tileSize;
+		blockNearest.resize(numBlocksX * numBlocksY);
+		blockFarthest.resize(numBlocksX * numBlocksY);
+		tileNearest.resize(numTilesX * numTilesY);
+		tileFarthest.resize(numTilesX * numTilesY);
+	}
+
+	void HierarchicalDepthBuffer::Clear(float clearDepth)
+	{
+		std::fill(blockNearest.begin(), blockNearest.end(), clearDepth);
+		std::fill(blockFarthest.begin(), blockFarthest.end(), clearDepth);
+		std::fill(tileNearest.begin(), tileNearest.end(), clearDepth);
+		std::fill(tileFarthest.begin(), tileFarthest.end(), clearDepth);
+	}
+
+	uint32_t HierarchicalDepthBuffer::GetBlock(uint32_t pixelX, uint32_t pixelY) const
+	{
+		return (pixelY / BlockSize) * numBlocksX + pixelX / BlockSize;
+	}
+
+	uint32_t HierarchicalDepthBuffer::GetTile(uint32_t pixelX, uint32_t pixelY) const
+	{
+		return (pixelY >> tileShift) * numTilesX + (pixelX >> tileShift);
+	}
+
+	void HierarchicalDepthBuffer::UpdateBlock(const FrameBuffer& frameBuffer, uint32_t pixelX, uint32_t pixelY, float writtenNearest, float replacedFarthest)
+	{
+		const uint32_t firstX{ pixelX - pixelX % BlockSize };
+		const uint32_t firstY{ pixelY - pixelY % BlockSize };
+		const uint32_t block{ GetBlock(firstX, firstY) };
+		const uint32_t tile{ GetTile(firstX, firstY) };
+		blockNearest[block] = std::min(blockNearest[block], writtenNearest);
+		tileNearest[tile] = std::min(tileNearest[tile], writtenNearest);
+
+		//The pixels at the farthest depth were not written
+		const float previousFarthest{ blockFarthest[block] };
+		if (replacedFarthest < previousFarthest)
+			return;
+
+		const uint32_t numColumns{ std::min(BlockSize, frameBuffer.width - firstX) };
+		const uint32_t numRows{ std::min(BlockSize, frameBuffer.height - firstY) };
+		const float* pRow{ frameBuffer.depth.data() + firstY * frameBuffer.width + firstX };
+
+		//Maximum is exact, every path gives the same levels
+		float farthest{ pRow[0] };
+		uint32_t row{ 0 };
+#if defined(DAE_SIMD_SSE)
+		if (numColumns == BlockSize)
+		{
+#if defined(DAE_SIMD_AVX)
+			__m256 farthest8{ _mm256_loadu_ps(pRow) };
+			for (; row < numRows; ++row)
+				farthest8 = _mm256_max_ps(farthest8, _mm256_loadu_ps(pRow + row * frameBuffer.width));
+			__m128 farthest4{ _mm_max_ps(_mm256_castps256_ps128(farthest8), _mm256_extractf128_ps(farthest8, 1)) };
+#else
+			__m128 farthest4{ _mm_loadu_ps(pRow) };
+			for (; row < numRows; ++row)
+				farthest4 = _mm_max_ps(farthest4, _mm_max_ps(_mm_loadu_ps(pRow + row * frameBuffer.width), _mm_loadu_ps(pRow + row * frameBuffer.width + 4)));
+#endif
+			farthest4 = _mm_max_ps(farthest4, _mm_movehl_ps(farthest4, farthest4));
+			farthest4 = _mm_max_ss(farthest4, _mm_shuffle_ps(farthest4, farthest4, _MM_SHUFFLE(1, 1, 1, 1)));
+			farthest = _mm_cvtss_f32(farthest4);
+		}
+#endif
+		//Blocks cut off by the right edge, and every block in scalar builds
+		for (; row < numRows; ++row)
+		{
+			for (uint32_t column{ 0 }; column < numColumns; ++column)
+				farthest = std::max(farthest, pRow[row * frameBuffer.width + column]);
+		}
+		blockFarthest[block] = farthest;
+
+		//The tile's farthest depth only moves when it was this block's. Another block still that far keeps it
+		if (!(farthest < previousFarthest && previousFarthest == tileFarthest[tile]))
+			return;
+
+		const uint32_t blocksPerTile{ tileSize / BlockSize };
+		const uint32_t firstBlockX{ (firstX >> tileShift) * blocksPerTile };
+		const uint32_t firstBlockY{ (firstY >> tileShift) * blocksPerTile };
+		const uint32_t lastBlockX{ std::min(firstBlockX + blocksPerTile, numBlocksX) };
+		const uint32_t lastBlockY{ std::min(firstBlockY + blocksPerTile, numBlocksY) };
+
+		float tileFarthestDepth{ farthest };
+		for (uint32_t blockY{ firstBlockY }; blockY < lastBlockY; ++blockY)
+		{
+			for (uint32_t blockX{ firstBlockX }; blockX < lastBlockX; ++blockX)
+			{
+				const float blockFarthestDepth{ blockFarthest[blockY * numBlocksX + blockX] };
+				if (blockFarthestDepth == previousFarthest)
+					return;
+				tileFarthestDepth = std::max(tileFarthestDepth, blockFarthestDepth);
+			}
+		}
+		tileFarthest[tile] = tileFarthestDepth;
+	}
+}
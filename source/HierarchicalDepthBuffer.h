@@ -0,0 +1,39 @@
+#pragma once
+#include "FrameBuffer.h"
+#include <cstdint>
+#include <vector>
+
+namespace dae
+{
+	//Coarse levels over a FrameBuffer's depth: the nearest and farthest depth of every 8x8 block, and of every tile of blocks.
+	//With the less depth test, a triangle that is nowhere nearer than a block's farthest depth fails on every pixel of it,
+	//one that is everywhere nearer than the block's nearest depth passes on every pixel.
+	//Whoever writes the depth updates the levels a block at a time. Depth only gets nearer between clears
+	struct HierarchicalDepthBuffer
+	{
+		static constexpr uint32_t BlockSize{ 8 };
+
+		//In pixels, a power of two multiple of BlockSize
+		uint32_t tileSize{};
+		uint32_t tileShift{};
+		uint32_t numBlocksX{};
+		uint32_t numBlocksY{};
+		uint32_t numTilesX{};
+		uint32_t numTilesY{};
+		//Row after row of blocks, then of tiles. Blocks and tiles on the right and bottom edges may be partly off screen
+		std::vector<float> blockNearest{};
+		std::vector<float> blockFarthest{};
+		std::vector<float> tileNearest{};
+		std::vector<float> tileFarthest{};
+
+		void Resize(uint32_t width, uint32_t height, uint32_t newTileSize);
+		//Matches FrameBuffer::Clear
+		void Clear(float clearDepth = 1.f);
+
+		uint32_t GetBlock(uint32_t pixelX, uint32_t pixelY) const;
+		uint32_t GetTile(uint32_t pixelX, uint32_t pixelY) const;
+		//After depth writes to the block: the nearest depth written and the farthest depth replaced. Reads the block's pixels
+		//back from the depth target only when its farthest depth may have moved, then updates its tile
+		void UpdateBlock(const FrameBuffer& frameBuffer, uint32_t pixelX, uint32_t pixelY, float writtenNearest, float replacedFarthest);
+	};
+}
@@ -0,0 +1,299 @@
+#include "pch.h"
+#include "IndexCodec.h"
+
+namespace dae
+{
+	namespace IndexCodec
+	{
+		namespace
+		{
+			//Code byte: high nibble is the edge FIFO index, or NoEdge followed by three vertex code bytes.
+			//Vertex codes: NextVertex, 1 + vertex FIFO index, or ExplicitVertex followed by a zigzag varint delta
+			constexpr uint32_t FifoSize{ 16 };
+			constexpr uint32_t MaxEdgeCodes{ 15 };
+			constexpr uint32_t MaxVertexCodes{ 14 };
+			constexpr uint8_t NoEdge{ 0xF };
+			constexpr uint8_t NextVertex{ 0 };
+			constexpr uint8_t ExplicitVertex{ 0xF };
+
+			//Ring buffers, index 0 is the most recent entry
+			struct EdgeFifo
+			{
+				uint32_t first[FifoSize]{};
+				uint32_t second[FifoSize]{};
+				uint32_t cursor{};
+
+				void Push(uint32_t a, uint32_t b)
+				{
+					first[cursor % FifoSize] = a;
+					second[cursor % FifoSize] = b;
+					++cursor;
+				}
+
+				uint32_t GetCount() const
+				{
+					return std::min(cursor, MaxEdgeCodes);
+				}
+
+				int Find(uint32_t a, uint32_t b) const
+				{
+					for (uint32_t i = 0; i < GetCount(); ++i)
+					{
+						const uint32_t slot{ (cursor - 1 - i) % FifoSize };
+						if (first[slot] == a && second[slot] == b)
+							return static_cast<int>(i);
+					}
+					return -1;
+				}
+			};
+
+			struct VertexFifo
+			{
+				uint32_t vertices[FifoSize]{};
+				uint32_t cursor{};
+
+				void Push(uint32_t vertex)
+				{
+					vertices[cursor % FifoSize] = vertex;
+					++cursor;
+				}
+
+				uint32_t GetCount() const
+				{
+					return std::min(cursor, MaxVertexCodes);
+				}
+
+				uint32_t Get(uint32_t index) const
+				{
+					return vertices[(cursor - 1 - index) % FifoSize];
+				}
+
+				int Find(uint32_t vertex) const
+				{
+					for (uint32_t i = 0; i < GetCount(); ++i)
+					{
+						if (Get(i) == vertex)
+							return static_cast<int>(i);
+					}
+					return -1;
+				}
+			};
+
+			//State both sides update identically after every vertex
+			struct CodecState
+			{
+				EdgeFifo edges{};
+				VertexFifo vertices{};
+				uint32_t next{};
+				uint32_t last{};
+
+				void ApplyVertex(uint32_t vertex, uint8_t code)
+				{
+					if (code == NextVertex)
+						++next;
+
+					if (code == NextVertex || code == ExplicitVertex)
+						vertices.Push(vertex);
+
+					last = vertex;
+				}
+			};
+
+			void WriteVarint(std::vector<uint8_t>& output, uint64_t value)
+			{
+				while (value >= 0x80)
+				{
+					output.push_back(static_cast<uint8_t>(value | 0x80));
+					value >>= 7;
+				}
+				output.push_back(static_cast<uint8_t>(value));
+			}
+
+			bool ReadVarint(const uint8_t* pData, size_t size, size_t& position, uint64_t& value)
+			{
+				value = 0;
+				for (uint32_t shift = 0; shift < 64; shift += 7)
+				{
+					if (position >= size)
+						return false;
+
+					const uint8_t byte{ pData[position++] };
+					value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+					if ((byte & 0x80) == 0)
+						return true;
+				}
+				return false;
+			}
+
+			uint8_t GetVertexCode(const CodecState& state, uint32_t vertex)
+			{
+				if (vertex == state.next)
+					return NextVertex;
+
+				const int fifoIndex{ state.vertices.Find(vertex) };
+				return fifoIndex >= 0 ? static_cast<uint8_t>(1 + fifoIndex) : ExplicitVertex;
+			}
+
+			void WriteExplicitVertex(std::vector<uint8_t>& output, const CodecState& state, uint32_t vertex)
+			{
+				const int64_t delta{ static_cast<int64_t>(vertex) - static_cast<int64_t>(state.last) };
+				WriteVarint(output, static_cast<uint64_t>((delta << 1) ^ (delta >> 63)));
+			}
+
+			bool ReadVertex(const uint8_t* pData, size_t size, size_t& position, CodecState& state, uint8_t code, uint32_t numVertices, uint32_t& vertex)
+			{
+				if (code == NextVertex)
+				{
+					vertex = state.next;
+				}
+				else if (code == ExplicitVertex)
+				{
+					uint64_t zigzag{};
+					if (!ReadVarint(pData, size, position, zigzag))
+						return false;
+
+					const int64_t delta{ static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1) };
+					const int64_t value{ static_cast<int64_t>(state.last) + delta };
+					if (value < 0 || value >= numVertices)
+						return false;
+
+					vertex = static_cast<uint32_t>(value);
+				}
+				else
+				{
+					if (code - 1u >= state.vertices.GetCount())
+						return false;
+
+					vertex = state.vertices.Get(code - 1u);
+				}
+
+				state.ApplyVertex(vertex, code);
+				return vertex < numVertices;
+			}
+
+			template <typename Index>
+			bool DecodeTriangles(const uint8_t* pData, size_t size, Index* pIndices, uint32_t numIndices, uint32_t numVertices)
+			{
+				CodecState state{};
+				size_t position{};
+
+				const auto readCodedVertex = [&](uint32_t& vertex)
+				{
+					return position < size && ReadVertex(pData, size, position, state, pData[position++], numVertices, vertex);
+				};
+
+				for (uint32_t i = 0; i + 2 < numIndices; i += 3)
+				{
+					if (position >= size)
+						return false;
+
+					const uint8_t code{ pData[position++] };
+					uint32_t a{}, b{}, c{};
+
+					if ((code >> 4) == NoEdge)
+					{
+						if ((code & 0xF) != 0 || !readCodedVertex(a) || !readCodedVertex(b) || !readCodedVertex(c))
+							return false;
+
+						state.edges.Push(b, a);
+					}
+					else
+					{
+						const uint32_t edgeIndex{ static_cast<uint32_t>(code >> 4) };
+						if (edgeIndex >= state.edges.GetCount())
+							return false;
+
+						const uint32_t slot{ (state.edges.cursor - 1 - edgeIndex) % FifoSize };
+						a = state.edges.first[slot];
+						b = state.edges.second[slot];
+
+						if (!ReadVertex(pData, size, position, state, code & 0xF, numVertices, c))
+							return false;
+					}
+
+					state.edges.Push(c, b);
+					state.edges.Push(a, c);
+
+					pIndices[i] = static_cast<Index>(a);
+					pIndices[i + 1] = static_cast<Index>(b);
+					pIndices[i + 2] = static_cast<Index>(c);
+				}
+
+				return position == size;
+			}
+		}
+
+		std::vector<uint8_t> Encode(const std::vector<uint32_t>& indices)
+		{
+			std::vector<uint8_t> output{};
+			output.reserve(indices.size() / 2);
+
+			CodecState state{};
+
+			for (size_t i = 0; i + 2 < indices.size(); i += 3)
+			{
+				const uint32_t triangle[3]{ indices[i], indices[i + 1], indices[i + 2] };
+
+				//A neighbour wound the same way stored the shared edge reversed, in any of the three rotations
+				int edgeIndex{ -1 };
+				int rotation{};
+				for (; rotation < 3; ++rotation)
+				{
+					edgeIndex = state.edges.Find(triangle[rotation], triangle[(rotation + 1) % 3]);
+					if (edgeIndex >= 0)
+						break;
+				}
+
+				if (edgeIndex >= 0)
+				{
+					const uint32_t a{ triangle[rotation] };
+					const uint32_t b{ triangle[(rotation + 1) % 3] };
+					const uint32_t c{ triangle[(rotation + 2) % 3] };
+
+					const uint8_t vertexCode{ GetVertexCode(state, c) };
+					output.push_back(static_cast<uint8_t>((edgeIndex << 4) | vertexCode));
+					if (vertexCode == ExplicitVertex)
+						WriteExplicitVertex(output, state, c);
+
+					state.ApplyVertex(c, vertexCode);
+
+					state.edges.Push(c, b);
+					state.edges.Push(a, c);
+				}
+				else
+				{
+					output.push_back(NoEdge << 4);
+
+					for (const uint32_t vertex : triangle)
+					{
+						const uint8_t vertexCode{ GetVertexCode(state, vertex) };
+						output.push_back(vertexCode);
+						if (vertexCode == ExplicitVertex)
+							WriteExplicitVertex(output, state, vertex);
+
+						state.ApplyVertex(vertex, vertexCode);
+					}
+
+					state.edges.Push(triangle[1], triangle[0]);
+					state.edges.Push(triangle[2], triangle[1]);
+					state.edges.Push(triangle[0], triangle[2]);
+				}
+			}
+
+			return output;
+		}
+
+		bool Decode(const uint8_t* pData, size_t size, void* pDestination, uint32_t numIndices, uint32_t indexStride, uint32_t numVertices)
+		{
+			if (numIndices % 3 != 0)
+				return false;
+
+			if (indexStride == sizeof(uint16_t))
+				return numVertices <= 0x10000 && DecodeTriangles(pData, size, static_cast<uint16_t*>(pDestination), numIndices, numVertices);
+			if (indexStride == sizeof(uint32_t))
+				return DecodeTriangles(pData, size, static_cast<uint32_t*>(pDestination), numIndices, numVertices);
+
+			return false;
+		}
+	}
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace dae
+{
+	//Compact triangle list encoding for the binary mesh cache.
+	//Every triangle costs one code byte when it shares an edge with one of the last 15 triangle edges and its third vertex is
+	//either the next unseen vertex or one of the last 14 vertices; anything else falls back to zigzag varint deltas.
+	//Works best on buffers that went through MeshOptimizer (cache-ordered triangles, first-use ordered vertices).
+	//The codec keeps every triangle and its winding, but may rotate the corners of a triangle
+	namespace IndexCodec
+	{
+		std::vector<uint8_t> Encode(const std::vector<uint32_t>& indices);
+
+		//Writes numIndices indices of indexStride (2 or 4) bytes to pDestination.
+		//Returns false on truncated or corrupt data or when an index is not below numVertices
+		bool Decode(const uint8_t* pData, size_t size, void* pDestination, uint32_t numIndices, uint32_t indexStride, uint32_t numVertices);
+	}
+}
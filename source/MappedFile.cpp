@@ -0,0 +1,116 @@
+#include "pch.h"
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace dae
+{
+#if defined(_WIN32)
+	MappedFile::MappedFile(const std::string& filename)
+	{
+		HANDLE fileHandle{ CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr) };
+		if (fileHandle == INVALID_HANDLE_VALUE)
+			return;
+
+		m_pFileHandle = fileHandle;
+
+		LARGE_INTEGER fileSize{};
+		if (!GetFileSizeEx(fileHandle, &fileSize))
+			return;
+
+		m_Size = static_cast<size_t>(fileSize.QuadPart);
+
+		//Windows refuses to map empty files, an empty view is still a valid result
+		if (m_Size == 0)
+		{
+			m_IsValid = true;
+			return;
+		}
+
+		m_pMappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!m_pMappingHandle)
+			return;
+
+		m_pData = static_cast<const char*>(MapViewOfFile(m_pMappingHandle, FILE_MAP_READ, 0, 0, 0));
+		m_IsValid = m_pData != nullptr;
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (m_pData)
+			UnmapViewOfFile(m_pData);
+		if (m_pMappingHandle)
+			CloseHandle(m_pMappingHandle);
+		if (m_pFileHandle)
+			CloseHandle(m_pFileHandle);
+	}
+#else
+	MappedFile::MappedFile(const std::string& filename)
+	{
+		m_FileDescriptor = open(filename.c_str(), O_RDONLY);
+		if (m_FileDescriptor < 0)
+			return;
+
+		struct stat fileStat{};
+		if (fstat(m_FileDescriptor, &fileStat) != 0)
+			return;
+
+		m_Size = static_cast<size_t>(fileStat.st_size);
+
+		//mmap refuses zero-length mappings, an empty view is still a valid result
+		if (m_Size == 0)
+		{
+			m_IsValid = true;
+			return;
+		}
+
+		void* pMapping{ mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, m_FileDescriptor, 0) };
+		if (pMapping == MAP_FAILED)
+			return;
+
+		//The parsers walk the file front to back exactly once
+		madvise(pMapping, m_Size, MADV_SEQUENTIAL);
+
+		m_pData = static_cast<const char*>(pMapping);
+		m_IsValid = true;
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (m_pData)
+			munmap(const_cast<char*>(m_pData), m_Size);
+		if (m_FileDescriptor >= 0)
+			close(m_FileDescriptor);
+	}
+#endif
+
+	bool MappedFile::IsValid() const
+	{
+		return m_IsValid;
+	}
+
+	const char* MappedFile::GetData() const
+	{
+		return m_pData;
+	}
+
+	size_t MappedFile::GetSize() const
+	{
+		return m_Size;
+	}
+
+	std::string_view MappedFile::GetView() const
+	{
+		if (!m_pData)
+			return {};
+
+		return { m_pData, m_Size };
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+namespace dae
+{
+	//Read-only memory mapping of a whole file, released when the object goes out of scope
+	class MappedFile final
+	{
+	public:
+		explicit MappedFile(const std::string& filename);
+		~MappedFile();
+
+		// -----------------------------------------------
+		// Copy/move constructors and assignment operators
+		// -----------------------------------------------
+		MappedFile(const MappedFile& other)					= delete;
+		MappedFile(MappedFile&& other) noexcept				= delete;
+		MappedFile& operator=(const MappedFile& other)		= delete;
+		MappedFile& operator=(MappedFile&& other) noexcept	= delete;
+
+		//------------------------------------------------
+		// Public member functions
+		//------------------------------------------------
+		bool IsValid() const;
+		const char* GetData() const;
+		size_t GetSize() const;
+		std::string_view GetView() const;
+
+	private:
+		//------------------------------------------------
+		// Member Variables
+		//------------------------------------------------
+		const char* m_pData{ nullptr };
+		size_t m_Size{};
+		bool m_IsValid{ false };
+
+#if defined(_WIN32)
+		void* m_pFileHandle{ nullptr };
+		void* m_pMappingHandle{ nullptr };
+#else
+		int m_FileDescriptor{ -1 };
+#endif
+	};
+}
@@ -0,0 +1,103 @@
+#include "pch.h"
+#include "Math.h"
+
+//Compile-time checks of the constexpr math core, this file has nothing to run: it only has to compile
+namespace dae
+{
+	namespace
+	{
+		constexpr bool IsNear(float a, float b, float epsilon = 1e-5f)
+		{
+			return (a > b ? a - b : b - a) <= epsilon;
+		}
+
+		constexpr bool IsNear(const Vector3& a, const Vector3& b, float epsilon = 1e-5f)
+		{
+			return IsNear(a.x, b.x, epsilon) && IsNear(a.y, b.y, epsilon) && IsNear(a.z, b.z, epsilon);
+		}
+
+		constexpr bool IsNear(const Vector4& a, const Vector4& b, float epsilon = 1e-5f)
+		{
+			return IsNear(a.x, b.x, epsilon) && IsNear(a.y, b.y, epsilon) && IsNear(a.z, b.z, epsilon) && IsNear(a.w, b.w, epsilon);
+		}
+
+		constexpr bool IsNear(const Matrix& a, const Matrix& b, float epsilon = 1e-5f)
+		{
+			return IsNear(a[0], b[0], epsilon) && IsNear(a[1], b[1], epsilon) && IsNear(a[2], b[2], epsilon) && IsNear(a[3], b[3], epsilon);
+		}
+
+		//Vector2
+		static_assert((Vector2{ 1, 2 } + Vector2{ 3, 4 }).x == 4.f && (Vector2{ 1, 2 } - Vector2{ 3, 4 }).y == -2.f);
+		static_assert(Vector2::Dot({ 1, 2 }, { 3, 4 }) == 11.f);
+		static_assert(Vector2::Cross(Vector2::UnitX, Vector2::UnitY) == 1.f);
+		static_assert((2.f * Vector2{ 1, -2 }).y == -4.f);
+		static_assert(Vector2{ Vector2{ 1, 1 }, Vector2{ 3, 4 } }.SqrMagnitude() == 13.f);
+
+		//Vector3
+		static_assert(IsNear(Vector3::Cross(Vector3::UnitX, Vector3::UnitY), Vector3::UnitZ));
+		static_assert(IsNear(Vector3::Cross(Vector3::UnitY, Vector3::UnitX), -Vector3::UnitZ));
+		static_assert(Vector3::Dot({ 1, 2, 3 }, { 4, 5, 6 }) == 32.f);
+		static_assert(IsNear(Vector3{ 1, 2, 3 } * 2.f - Vector3{ 1, 1, 1 }, { 1, 3, 5 }));
+		static_assert(IsNear(Vector3{ 4, 2, 8 } / 2.f, { 2, 1, 4 }));
+		static_assert(IsNear(Vector3::Project({ 3, 4, 0 }, Vector3::UnitX), { 3, 0, 0 }));
+		static_assert(IsNear(Vector3::Reject({ 3, 4, 0 }, Vector3::UnitX), { 0, 4, 0 }));
+		static_assert(IsNear(Vector3::Reflect({ 1, -1, 0 }, Vector3::UnitY), { 1, 1, 0 }));
+		static_assert(Vector3{ 1, 2, 3 }[2] == 3.f);
+		static_assert(IsNear(Vector3{ Vector4{ 1, 2, 3, 4 } }, { 1, 2, 3 }));
+		static_assert(IsNear(Vector3{ 1, 2, 3 }.ToPoint4(), { 1, 2, 3, 1 }));
+		static_assert(IsNear(Vector3{ 1, 2, 3 }.ToVector4(), { 1, 2, 3, 0 }));
+
+		//Vector4
+		static_assert(Vector4::Dot({ 1, 2, 3, 4 }, { 1, 1, 1, 1 }) == 10.f);
+		static_assert(IsNear(Vector4{ 1, 2, 3, 4 } + Vector4{ 1, 1, 1, 1 } * 2.f, { 3, 4, 5, 6 }));
+		static_assert(Vector4{ Vector3::UnitY, 5.f }.GetXYZ().y == 1.f);
+
+		//Compile-time sine and cosine
+		static_assert(IsNear(Sin(0.f), 0.f) && IsNear(Sin(PI_DIV_2), 1.f) && IsNear(Sin(-PI_DIV_2), -1.f));
+		static_assert(IsNear(Cos(0.f), 1.f) && IsNear(Cos(PI), -1.f) && IsNear(Cos(PI_2 * 3.f), 1.f, 1e-4f));
+		static_assert(IsNear(Sin(PI_DIV_4), 0.70710678f) && IsNear(Cos(PI_DIV_4), 0.70710678f));
+
+		//Matrix construction and products fold
+		constexpr Matrix Identity{};
+		constexpr Matrix Translation{ Matrix::CreateTranslation(1, 2, 3) };
+		constexpr Matrix Scale{ Matrix::CreateScale(2, 2, 2) };
+
+		static_assert(IsNear(Identity * Translation, Translation));
+		static_assert(IsNear(Translation.GetTranslation(), { 1, 2, 3 }));
+		static_assert(IsNear((Scale * Translation).TransformPoint({ 1, 1, 1 }), { 3, 4, 5 }));
+		static_assert(IsNear((Translation * Scale).TransformPoint({ 1, 1, 1 }), { 4, 6, 8 }));
+		static_assert(IsNear((Scale * Translation).TransformVector({ 1, 1, 1 }), { 2, 2, 2 }));
+		static_assert(IsNear(Translation.TransformPoint(Vector4{ 1, 1, 1, 0 }), { 1, 1, 1, 0 }));
+		static_assert(IsNear(Matrix::Transpose(Matrix::Transpose(Translation)), Translation));
+		static_assert(IsNear(Matrix::Transpose(Translation)[0], { 1, 0, 0, 1 }));
+
+		constexpr Matrix Multiplied{ [] { Matrix m{ Scale }; m *= Translation; return m; }() };
+		static_assert(IsNear(Multiplied, Scale * Translation));
+
+		//Rotations follow the row vector convention of the renderer
+		static_assert(IsNear(Matrix::CreateRotationX(PI_DIV_2).TransformVector(Vector3::UnitY), -Vector3::UnitZ));
+		static_assert(IsNear(Matrix::CreateRotationY(PI_DIV_2).TransformVector(Vector3::UnitX), -Vector3::UnitZ));
+		static_assert(IsNear(Matrix::CreateRotationZ(PI_DIV_2).TransformVector(Vector3::UnitX), Vector3::UnitY));
+		static_assert(IsNear(Matrix::CreateRotation(0.3f, -1.2f, 2.f) * Matrix::Transpose(Matrix::CreateRotation(0.3f, -1.2f, 2.f)), Identity));
+		static_assert(IsNear(Matrix::CreateRotation(Vector3{ 0.3f, 0.f, 0.f }), Matrix::CreateRotationX(0.3f)));
+
+		//Quaternions turn like the matrices and compose in the same order
+		static_assert(IsNear(Quaternion::CreateRotationX(0.7f).ToMatrix(), Matrix::CreateRotationX(0.7f)));
+		static_assert(IsNear(Quaternion::CreateRotationY(-1.3f).ToMatrix(), Matrix::CreateRotationY(-1.3f)));
+		static_assert(IsNear(Quaternion::CreateRotationZ(2.1f).ToMatrix(), Matrix::CreateRotationZ(2.1f)));
+		static_assert(IsNear(Quaternion::CreateRotation({ 0.3f, -1.2f, 2.f }).ToMatrix(), Matrix::CreateRotation(0.3f, -1.2f, 2.f)));
+		static_assert(IsNear(Quaternion::CreateRotation({ 0.3f, -1.2f, 2.f }).Rotate({ 1, 2, 3 }), Matrix::CreateRotation(0.3f, -1.2f, 2.f).TransformVector({ 1, 2, 3 })));
+		static_assert(IsNear((Quaternion::CreateRotationY(0.5f) * Quaternion::CreateRotationY(-0.5f)).ToMatrix(), Identity));
+
+		//Rigid transforms invert without a general inverse
+		constexpr RigidTransform Rigid{ Quaternion::CreateRotation({ 0.3f, -1.2f, 2.f }), { 1, 2, 3 } };
+		static_assert(IsNear(Rigid.ToMatrix(), Matrix::CreateRotation(0.3f, -1.2f, 2.f) * Translation));
+		static_assert(IsNear(Rigid.Inverse().TransformPoint(Rigid.TransformPoint({ 4, 5, 6 })), { 4, 5, 6 }));
+		static_assert(IsNear((Rigid * Rigid.Inverse()).ToMatrix(), Identity));
+
+		//Projection as Camera builds it: tan(fov / 2), aspect, near, far
+		constexpr Matrix Projection{ Matrix::CreatePerspectiveFovLH(1.f, 2.f, 0.1f, 100.f) };
+		static_assert(IsNear(Projection[0].x, 0.5f) && IsNear(Projection[1].y, 1.f) && Projection[2].w == 1.f && Projection[3].w == 0.f);
+		static_assert(IsNear(Projection.TransformPoint(Vector4{ 0, 0, 10, 1 }).w, 10.f));
+	}
+}
@@ -1,5 +1,7 @@
 #pragma once
 #include <cmath>
+#include <cfloat>
+#include <type_traits>
 
 namespace dae
 {
@@ -21,6 +23,44 @@ namespace dae
 	constexpr auto TO_RADIANS(PI / 180.0f);
 
 	/* --- HELPER FUNCTIONS --- */
+	namespace Detail
+	{
+		//Taylor series in double after wrapping to [-pi, pi], for compile-time evaluation only
+		constexpr double SinSeries(double radians)
+		{
+			constexpr double pi{ 3.14159265358979323846 };
+			const double turns{ (radians + pi) / (2.0 * pi) };
+			long long wholeTurns{ static_cast<long long>(turns) };
+			if (turns < static_cast<double>(wholeTurns))
+				--wholeTurns;
+			const double x{ radians - static_cast<double>(wholeTurns) * 2.0 * pi };
+
+			double term{ x };
+			double sum{ x };
+			for (int n = 1; n < 14; ++n)
+			{
+				term *= -x * x / ((2.0 * n) * (2.0 * n + 1.0));
+				sum += term;
+			}
+			return sum;
+		}
+	}
+
+	//std::sin and std::cos are not constexpr yet: these call them at runtime and fold to a series at compile time
+	constexpr float Sin(float radians)
+	{
+		if (std::is_constant_evaluated())
+			return static_cast<float>(Detail::SinSeries(radians));
+		return std::sin(radians);
+	}
+
+	constexpr float Cos(float radians)
+	{
+		if (std::is_constant_evaluated())
+			return static_cast<float>(Detail::SinSeries(radians + 1.57079632679489661923));
+		return std::cos(radians);
+	}
+
 	inline float Square(float a)
 	{
 		return a * a;
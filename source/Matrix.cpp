@@ -4,96 +4,151 @@
 
 #include <cassert>
 
-#include "MathHelpers.h"
+#include "Simd.h"
 #include <cmath>
 
 namespace dae {
-	Matrix::Matrix(const Vector3& xAxis, const Vector3& yAxis, const Vector3& zAxis, const Vector3& t) :
-		Matrix({ xAxis, 0 }, { yAxis, 0 }, { zAxis, 0 }, { t, 1 })
+#if defined(DAE_SIMD_SSE)
+	namespace
 	{
-	}
+		inline __m128 LoadRow(const Vector4& row)
+		{
+			return _mm_load_ps(&row.x);
+		}
 
-	Matrix::Matrix(const Vector4& xAxis, const Vector4& yAxis, const Vector4& zAxis, const Vector4& t)
-	{
-		data[0] = xAxis;
-		data[1] = yAxis;
-		data[2] = zAxis;
-		data[3] = t;
-	}
+		inline void StoreRow(Vector4& row, __m128 value)
+		{
+			_mm_store_ps(&row.x, value);
+		}
 
-	Matrix::Matrix(const Matrix& m)
-	{
-		data[0] = m[0];
-		data[1] = m[1];
-		data[2] = m[2];
-		data[3] = m[3];
-	}
+		template <int Lane>
+		inline __m128 Splat(__m128 value)
+		{
+			return _mm_shuffle_ps(value, value, _MM_SHUFFLE(Lane, Lane, Lane, Lane));
+		}
 
-	Vector3 Matrix::TransformVector(const Vector3& v) const
-	{
-		return TransformVector(v.x, v.y, v.z);
-	}
+		//xyz cross product, w of the result is 0
+		inline __m128 Cross(__m128 a, __m128 b)
+		{
+			const __m128 aYzx{ _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1)) };
+			const __m128 bYzx{ _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1)) };
+			const __m128 zxy{ _mm_sub_ps(_mm_mul_ps(a, bYzx), _mm_mul_ps(aYzx, b)) };
+			return _mm_shuffle_ps(zxy, zxy, _MM_SHUFFLE(3, 0, 2, 1));
+		}
 
-	Vector3 Matrix::TransformVector(float x, float y, float z) const
-	{
-		return Vector3{
-			data[0].x * x + data[1].x * y + data[2].x * z,
-			data[0].y * x + data[1].y * y + data[2].y * z,
-			data[0].z * x + data[1].z * y + data[2].z * z
-		};
-	}
+		//4 component dot product in every lane
+		inline __m128 Dot(__m128 a, __m128 b)
+		{
+			const __m128 product{ _mm_mul_ps(a, b) };
+			const __m128 pairs{ _mm_add_ps(product, _mm_shuffle_ps(product, product, _MM_SHUFFLE(1, 0, 3, 2))) };
+			return _mm_add_ps(pairs, _mm_shuffle_ps(pairs, pairs, _MM_SHUFFLE(2, 3, 0, 1)));
+		}
 
-	Vector3 Matrix::TransformPoint(const Vector3& p) const
-	{
-		return TransformPoint(p.x, p.y, p.z);
+		//row * [r0 r1 r2 r3]
+		inline __m128 TransformRow(__m128 row, __m128 r0, __m128 r1, __m128 r2, __m128 r3)
+		{
+			__m128 result{ _mm_mul_ps(Splat<0>(row), r0) };
+			result = _mm_add_ps(result, _mm_mul_ps(Splat<1>(row), r1));
+			result = _mm_add_ps(result, _mm_mul_ps(Splat<2>(row), r2));
+			return _mm_add_ps(result, _mm_mul_ps(Splat<3>(row), r3));
+		}
 	}
+#endif
 
-	Vector3 Matrix::TransformPoint(float x, float y, float z) const
+	void Matrix::MultiplyRows(const Vector4* pLhs, const Vector4* pRhs, Vector4* pResult)
 	{
-		return Vector3{
-			data[0].x * x + data[1].x * y + data[2].x * z + data[3].x,
-			data[0].y * x + data[1].y * y + data[2].y * z + data[3].y,
-			data[0].z * x + data[1].z * y + data[2].z * z + data[3].z,
-		};
-	}
+#if defined(DAE_SIMD_AVX)
+		//Two result rows per 256-bit register, every row of rhs broadcast to both halves
+		const __m256 rhs0{ _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&pRhs[0].x)) };
+		const __m256 rhs1{ _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&pRhs[1].x)) };
+		const __m256 rhs2{ _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&pRhs[2].x)) };
+		const __m256 rhs3{ _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&pRhs[3].x)) };
 
-	Vector4 Matrix::TransformPoint(const Vector4& p) const
-	{
-		return TransformPoint(p.x, p.y, p.z, p.w);
-	}
+		const __m256 lhs01{ _mm256_loadu_ps(&pLhs[0].x) };
+		const __m256 lhs23{ _mm256_loadu_ps(&pLhs[2].x) };
 
-	Vector4 Matrix::TransformPoint(float x, float y, float z, float w) const
-	{
-		return Vector4{
-			data[0].x * x + data[1].x * y + data[2].x * z + data[3].x,
-			data[0].y * x + data[1].y * y + data[2].y * z + data[3].y,
-			data[0].z * x + data[1].z * y + data[2].z * z + data[3].z,
-			data[0].w * x + data[1].w * y + data[2].w * z + data[3].w
+		const auto transformRows = [&](__m256 rows)
+		{
+			__m256 result{ _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, _MM_SHUFFLE(0, 0, 0, 0)), rhs0) };
+			result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, _MM_SHUFFLE(1, 1, 1, 1)), rhs1));
+			result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, _MM_SHUFFLE(2, 2, 2, 2)), rhs2));
+			return _mm256_add_ps(result, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, _MM_SHUFFLE(3, 3, 3, 3)), rhs3));
 		};
-	}
 
-	const Matrix& Matrix::Transpose()
-	{
-		Matrix result{};
+		_mm256_storeu_ps(&pResult[0].x, transformRows(lhs01));
+		_mm256_storeu_ps(&pResult[2].x, transformRows(lhs23));
+#elif defined(DAE_SIMD_SSE)
+		const __m128 rhs0{ LoadRow(pRhs[0]) };
+		const __m128 rhs1{ LoadRow(pRhs[1]) };
+		const __m128 rhs2{ LoadRow(pRhs[2]) };
+		const __m128 rhs3{ LoadRow(pRhs[3]) };
+
+		for (int r{ 0 }; r < 4; ++r)
+		{
+			StoreRow(pResult[r], TransformRow(LoadRow(pLhs[r]), rhs0, rhs1, rhs2, rhs3));
+		}
+#else
+		Vector4 lhs[4]{ pLhs[0], pLhs[1], pLhs[2], pLhs[3] };
+		Vector4 rhsColumns[4]{};
 		for (int r{ 0 }; r < 4; ++r)
 		{
 			for (int c{ 0 }; c < 4; ++c)
 			{
-				result[r][c] = data[c][r];
+				rhsColumns[c][r] = pRhs[r][c];
 			}
 		}
 
-		data[0] = result[0];
-		data[1] = result[1];
-		data[2] = result[2];
-		data[3] = result[3];
-
-		return *this;
+		for (int r{ 0 }; r < 4; ++r)
+		{
+			for (int c{ 0 }; c < 4; ++c)
+			{
+				pResult[r][c] = Vector4::Dot(lhs[r], rhsColumns[c]);
+			}
+		}
+#endif
 	}
 
 	const Matrix& Matrix::Inverse()
 	{
 		//Optimized Inverse as explained in FGED1 - used widely in other libraries too.
+#if defined(DAE_SIMD_SSE)
+		const __m128 a{ LoadRow(data[0]) };
+		const __m128 b{ LoadRow(data[1]) };
+		const __m128 c{ LoadRow(data[2]) };
+		const __m128 d{ LoadRow(data[3]) };
+
+		const __m128 x{ Splat<3>(a) };
+		const __m128 y{ Splat<3>(b) };
+		const __m128 z{ Splat<3>(c) };
+		const __m128 w{ Splat<3>(d) };
+
+		//The w lanes of s, t, u and v cancel out to 0, so 4 component dot products act as 3 component ones
+		__m128 s{ Cross(a, b) };
+		__m128 t{ Cross(c, d) };
+		__m128 u{ _mm_sub_ps(_mm_mul_ps(a, y), _mm_mul_ps(b, x)) };
+		__m128 v{ _mm_sub_ps(_mm_mul_ps(c, w), _mm_mul_ps(d, z)) };
+
+		const __m128 det{ _mm_add_ps(Dot(s, v), Dot(t, u)) };
+		assert((!AreEqual(_mm_cvtss_f32(det), 0.f)) && "ERROR: determinant is 0, there is no INVERSE!");
+		const __m128 invDet{ _mm_div_ps(_mm_set1_ps(1.f), det) };
+
+		s = _mm_mul_ps(s, invDet); t = _mm_mul_ps(t, invDet); u = _mm_mul_ps(u, invDet); v = _mm_mul_ps(v, invDet);
+
+		__m128 r0{ _mm_add_ps(Cross(b, v), _mm_mul_ps(t, y)) };
+		__m128 r1{ _mm_sub_ps(Cross(v, a), _mm_mul_ps(t, x)) };
+		__m128 r2{ _mm_add_ps(Cross(d, u), _mm_mul_ps(s, w)) };
+		__m128 r3{ _mm_sub_ps(Cross(u, c), _mm_mul_ps(s, z)) };
+
+		//r0..r3 are the columns of the inverse, the last row holds their w components
+		const __m128 bt{ Dot(b, t) }, at{ Dot(a, t) }, ds{ Dot(d, s) }, cs{ Dot(c, s) };
+		const __m128 lastRow{ _mm_xor_ps(_mm_unpacklo_ps(_mm_unpacklo_ps(bt, ds), _mm_unpacklo_ps(at, cs)), _mm_setr_ps(-0.f, 0.f, -0.f, 0.f)) };
+
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		StoreRow(data[0], r0);
+		StoreRow(data[1], r1);
+		StoreRow(data[2], r2);
+		StoreRow(data[3], lastRow);
+#else
 		const Vector3& a = data[0];
 		const Vector3& b = data[1];
 		const Vector3& c = data[2];
@@ -118,24 +173,18 @@ namespace dae {
 		const Vector3 r0 = Vector3::Cross(b, v) + t * y;
 		const Vector3 r1 = Vector3::Cross(v, a) - t * x;
 		const Vector3 r2 = Vector3::Cross(d, u) + s * w;
-		//Vector3 r3 = Vector3::Cross(u, c) - s * z;
+		const Vector3 r3 = Vector3::Cross(u, c) - s * z;
 
-		data[0] = Vector4{ r0.x, r1.x, r2.x, 0.f };
-		data[1] = Vector4{ r0.y, r1.y, r2.y, 0.f };
-		data[2] = Vector4{ r0.z, r1.z, r2.z, 0.f };
-		data[3] = {-Vector3::Dot(b, t),Vector3::Dot(a, t),-Vector3::Dot(d, s),Vector3::Dot(c, s) };
+		const Vector4 lastRow{ -Vector3::Dot(b, t),Vector3::Dot(a, t),-Vector3::Dot(d, s),Vector3::Dot(c, s) };
+		data[0] = Vector4{ r0.x, r1.x, r2.x, r3.x };
+		data[1] = Vector4{ r0.y, r1.y, r2.y, r3.y };
+		data[2] = Vector4{ r0.z, r1.z, r2.z, r3.z };
+		data[3] = lastRow;
+#endif
 
 		return *this;
 	}
 
-	Matrix Matrix::Transpose(const Matrix& m)
-	{
-		Matrix out{ m };
-		out.Transpose();
-
-		return out;
-	}
-
 	Matrix Matrix::Inverse(const Matrix& m)
 	{
 		Matrix out{ m };
@@ -144,146 +193,90 @@ namespace dae {
 		return out;
 	}
 
-	Matrix Matrix::CreateLookAtLH(const Vector3& origin, const Vector3& forward, const Vector3& up)
-	{
-		assert(false && "Not Implemented");
-		return {};
-	}
-
-	Matrix Matrix::CreatePerspectiveFovLH(float fov, float aspect, float zn, float zf)
-	{
-		return {
-				{ 1 / (aspect * fov)					, 0					, 0																	,0 },
-				{ 0										, 1 / fov			, 0																	,0 },
-				{ 0										, 0					, zf / (zf - zn)													,1 },
-				{ 0										, 0					,-(zf * zn) / (zf * zn)												,0 }
-
-		};
-	}
-
-	Vector3 Matrix::GetAxisX() const
-	{
-		return data[0];
-	}
-
-	Vector3 Matrix::GetAxisY() const
-	{
-		return data[1];
-	}
-
-	Vector3 Matrix::GetAxisZ() const
-	{
-		return data[2];
-	}
-
-	Vector3 Matrix::GetTranslation() const
-	{
-		return data[3];
-	}
-
-	Matrix Matrix::CreateTranslation(float x, float y, float z)
-	{
-		return CreateTranslation({ x, y, z });
-	}
-
-	Matrix Matrix::CreateTranslation(const Vector3& t)
-	{
-		return { Vector3::UnitX, Vector3::UnitY, Vector3::UnitZ, t };
-	}
-
-	Matrix Matrix::CreateRotationX(float pitch)
-	{
-		return {
-			{1, 0, 0, 0},
-			{0, cos(pitch), -sin(pitch), 0},
-			{0, sin(pitch), cos(pitch), 0},
-			{0, 0, 0, 1}
-		};
-	}
-
-	Matrix Matrix::CreateRotationY(float yaw)
-	{
-		return {
-			{cos(yaw), 0, -sin(yaw), 0},
-			{0, 1, 0, 0},
-			{sin(yaw), 0, cos(yaw), 0},
-			{0, 0, 0, 1}
-		};
-	}
-
-	Matrix Matrix::CreateRotationZ(float roll)
-	{
-		return {
-			{cos(roll), sin(roll), 0, 0},
-			{-sin(roll), cos(roll), 0, 0},
-			{0, 0, 1, 0},
-			{0, 0, 0, 1}
-		};
-	}
-
-	Matrix Matrix::CreateRotation(float pitch, float yaw, float roll)
-	{
-		return CreateRotation({ pitch, yaw, roll });
-	}
-
-	Matrix Matrix::CreateRotation(const Vector3& r)
-	{
-		return CreateRotationX(r[0]) * CreateRotationY(r[1]) * CreateRotationZ(r[2]);
-	}
-
-	Matrix Matrix::CreateScale(float sx, float sy, float sz)
-	{
-		return { {sx, 0, 0}, {0, sy, 0}, {0, 0, sz}, Vector3::Zero };
-	}
+	Matrix Matrix::InverseAffine(const Matrix& m)
+	{
+		assert(m.IsAffine() && "ERROR: InverseAffine needs 0, 0, 0, 1 as last column");
+
+		//Rows of the inverse 3x3 are the columns of [b x c, c x a, a x b] / det, the translation is moved back through them
+		Matrix out{};
+#if defined(DAE_SIMD_SSE)
+		const __m128 wMask{ _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0)) };
+		const __m128 a{ _mm_and_ps(LoadRow(m.data[0]), wMask) };
+		const __m128 b{ _mm_and_ps(LoadRow(m.data[1]), wMask) };
+		const __m128 c{ _mm_and_ps(LoadRow(m.data[2]), wMask) };
+		const __m128 t{ LoadRow(m.data[3]) };
+
+		const __m128 bc{ Cross(b, c) };
+		const __m128 det{ Dot(a, bc) };
+		assert((!AreEqual(_mm_cvtss_f32(det), 0.f)) && "ERROR: determinant is 0, there is no INVERSE!");
+		const __m128 invDet{ _mm_div_ps(_mm_set1_ps(1.f), det) };
+
+		__m128 r0{ _mm_mul_ps(bc, invDet) };
+		__m128 r1{ _mm_mul_ps(Cross(c, a), invDet) };
+		__m128 r2{ _mm_mul_ps(Cross(a, b), invDet) };
+		__m128 r3{ _mm_setzero_ps() };
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+		const __m128 translation{ TransformRow(t, r0, r1, r2, r3) };
+		StoreRow(out.data[0], r0);
+		StoreRow(out.data[1], r1);
+		StoreRow(out.data[2], r2);
+		StoreRow(out.data[3], _mm_sub_ps(_mm_setr_ps(0.f, 0.f, 0.f, 1.f), translation));
+#else
+		const Vector3 a{ m.data[0] };
+		const Vector3 b{ m.data[1] };
+		const Vector3 c{ m.data[2] };
+
+		const Vector3 bc{ Vector3::Cross(b, c) };
+		const float det{ Vector3::Dot(a, bc) };
+		assert((!AreEqual(det, 0.f)) && "ERROR: determinant is 0, there is no INVERSE!");
+		const float invDet{ 1.f / det };
 
-	Matrix Matrix::CreateScale(const Vector3& s)
-	{
-		return CreateScale(s[0], s[1], s[2]);
-	}
+		const Vector3 r0{ bc * invDet };
+		const Vector3 r1{ Vector3::Cross(c, a) * invDet };
+		const Vector3 r2{ Vector3::Cross(a, b) * invDet };
 
-#pragma region Operator Overloads
-	Vector4& Matrix::operator[](int index)
-	{
-		assert(index <= 3 && index >= 0);
-		return data[index];
-	}
+		out.data[0] = { r0.x, r1.x, r2.x, 0.f };
+		out.data[1] = { r0.y, r1.y, r2.y, 0.f };
+		out.data[2] = { r0.z, r1.z, r2.z, 0.f };
+		out.data[3] = { -out.TransformVector(m.GetTranslation()), 1.f };
+#endif
 
-	Vector4 Matrix::operator[](int index) const
-	{
-		assert(index <= 3 && index >= 0);
-		return data[index];
+		return out;
 	}
 
-	Matrix Matrix::operator*(const Matrix& m) const
-	{
-		Matrix result{};
-		Matrix m_transposed = Transpose(m);
+	Matrix Matrix::InverseRigid(const Matrix& m)
+	{
+		assert(m.IsAffine() && "ERROR: InverseRigid needs 0, 0, 0, 1 as last column");
+
+		//The inverse of an orthonormal 3x3 is its transpose
+		Matrix out{};
+#if defined(DAE_SIMD_SSE)
+		const __m128 wMask{ _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0)) };
+		__m128 r0{ _mm_and_ps(LoadRow(m.data[0]), wMask) };
+		__m128 r1{ _mm_and_ps(LoadRow(m.data[1]), wMask) };
+		__m128 r2{ _mm_and_ps(LoadRow(m.data[2]), wMask) };
+		__m128 r3{ _mm_setzero_ps() };
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+		const __m128 translation{ TransformRow(LoadRow(m.data[3]), r0, r1, r2, r3) };
+		StoreRow(out.data[0], r0);
+		StoreRow(out.data[1], r1);
+		StoreRow(out.data[2], r2);
+		StoreRow(out.data[3], _mm_sub_ps(_mm_setr_ps(0.f, 0.f, 0.f, 1.f), translation));
+#else
+		out.data[0] = { m.data[0].x, m.data[1].x, m.data[2].x, 0.f };
+		out.data[1] = { m.data[0].y, m.data[1].y, m.data[2].y, 0.f };
+		out.data[2] = { m.data[0].z, m.data[1].z, m.data[2].z, 0.f };
+		out.data[3] = { -out.TransformVector(m.GetTranslation()), 1.f };
+#endif
 
-		for (int r{ 0 }; r < 4; ++r)
-		{
-			for (int c{ 0 }; c < 4; ++c)
-			{
-				result[r][c] = Vector4::Dot(data[r], m_transposed[c]);
-			}
-		}
-
-		return result;
+		return out;
 	}
 
-	const Matrix& Matrix::operator*=(const Matrix& m)
+	Matrix Matrix::CreateLookAtLH(const Vector3& origin, const Vector3& forward, const Vector3& up)
 	{
-		Matrix copy{ *this };
-		Matrix m_transposed = Transpose(m);
-
-		for (int r{ 0 }; r < 4; ++r)
-		{
-			for (int c{ 0 }; c < 4; ++c)
-			{
-				data[r][c] = Vector4::Dot(copy[r], m_transposed[c]);
-			}
-		}
-
-		return *this;
+		assert(false && "Not Implemented");
+		return {};
 	}
-#pragma endregion
 }
\ No newline at end of file
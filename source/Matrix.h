@@ -1,65 +1,256 @@
 #pragma once
+#include "MathHelpers.h"
+#include "Simd.h"
 #include "Vector3.h"
 #include "Vector4.h"
 
 namespace dae {
+	//Everything but the inverse is constexpr and inline: constant matrices fold at compile time.
+	//At runtime the 4x4 products go through the SIMD kernels in Matrix.cpp, transposes through the inline one below
 	struct Matrix
 	{
-		Matrix() = default;
-		Matrix(
+		constexpr Matrix() = default;
+		constexpr Matrix(
 			const Vector3& xAxis,
 			const Vector3& yAxis,
 			const Vector3& zAxis,
-			const Vector3& t);
+			const Vector3& t) :
+			Matrix({ xAxis, 0 }, { yAxis, 0 }, { zAxis, 0 }, { t, 1 })
+		{
+		}
 
-		Matrix(
+		constexpr Matrix(
 			const Vector4& xAxis,
 			const Vector4& yAxis,
 			const Vector4& zAxis,
-			const Vector4& t);
+			const Vector4& t) :
+			data{ xAxis, yAxis, zAxis, t }
+		{
+		}
 
-		Matrix(const Matrix& m);
+		constexpr Matrix(const Matrix& m) = default;
+		constexpr Matrix& operator=(const Matrix& m) = default;
 
-		Vector3 TransformVector(const Vector3& v) const;
-		Vector3 TransformVector(float x, float y, float z) const;
-		Vector3 TransformPoint(const Vector3& p) const;
-		Vector3 TransformPoint(float x, float y, float z) const;
+		constexpr Vector3 TransformVector(const Vector3& v) const
+		{
+			return TransformVector(v.x, v.y, v.z);
+		}
 
-		Vector4 TransformPoint(const Vector4& p) const;
-		Vector4 TransformPoint(float x, float y, float z, float w) const;
+		constexpr Vector3 TransformVector(float x, float y, float z) const
+		{
+			return Vector3{
+				data[0].x * x + data[1].x * y + data[2].x * z,
+				data[0].y * x + data[1].y * y + data[2].y * z,
+				data[0].z * x + data[1].z * y + data[2].z * z
+			};
+		}
+
+		constexpr Vector3 TransformPoint(const Vector3& p) const
+		{
+			return TransformPoint(p.x, p.y, p.z);
+		}
+
+		constexpr Vector3 TransformPoint(float x, float y, float z) const
+		{
+			return Vector3{
+				data[0].x * x + data[1].x * y + data[2].x * z + data[3].x,
+				data[0].y * x + data[1].y * y + data[2].y * z + data[3].y,
+				data[0].z * x + data[1].z * y + data[2].z * z + data[3].z,
+			};
+		}
+
+		constexpr Vector4 TransformPoint(const Vector4& p) const
+		{
+			return TransformPoint(p.x, p.y, p.z, p.w);
+		}
+
+		constexpr Vector4 TransformPoint(float x, float y, float z, float w) const
+		{
+			return Vector4{
+				data[0].x * x + data[1].x * y + data[2].x * z + data[3].x * w,
+				data[0].y * x + data[1].y * y + data[2].y * z + data[3].y * w,
+				data[0].z * x + data[1].z * y + data[2].z * z + data[3].z * w,
+				data[0].w * x + data[1].w * y + data[2].w * z + data[3].w * w
+			};
+		}
+
+		constexpr const Matrix& Transpose()
+		{
+			if (std::is_constant_evaluated())
+			{
+				const Matrix copy{ *this };
+				for (int r{ 0 }; r < 4; ++r)
+				{
+					for (int c{ 0 }; c < 4; ++c)
+					{
+						data[r][c] = copy.data[c][r];
+					}
+				}
+			}
+			else
+			{
+				TransposeRows(data, data);
+			}
+
+			return *this;
+		}
 
-		const Matrix& Transpose();
 		const Matrix& Inverse();
 
-		Vector3 GetAxisX() const;
-		Vector3 GetAxisY() const;
-		Vector3 GetAxisZ() const;
-		Vector3 GetTranslation() const;
-
-		static Matrix CreateTranslation(float x, float y, float z);
-		static Matrix CreateTranslation(const Vector3& t);
-		static Matrix CreateRotationX(float pitch);
-		static Matrix CreateRotationY(float yaw);
-		static Matrix CreateRotationZ(float roll);
-		static Matrix CreateRotation(float pitch, float yaw, float roll);
-		static Matrix CreateRotation(const Vector3& r);
-		static Matrix CreateScale(float sx, float sy, float sz);
-		static Matrix CreateScale(const Vector3& s);
-		static Matrix Transpose(const Matrix& m);
+		constexpr Vector3 GetAxisX() const
+		{
+			return data[0];
+		}
+
+		constexpr Vector3 GetAxisY() const
+		{
+			return data[1];
+		}
+
+		constexpr Vector3 GetAxisZ() const
+		{
+			return data[2];
+		}
+
+		constexpr Vector3 GetTranslation() const
+		{
+			return data[3];
+		}
+
+		constexpr bool IsAffine() const
+		{
+			return data[0].w == 0.f && data[1].w == 0.f && data[2].w == 0.f && data[3].w == 1.f;
+		}
+
+		static constexpr Matrix CreateTranslation(float x, float y, float z)
+		{
+			return CreateTranslation({ x, y, z });
+		}
+
+		static constexpr Matrix CreateTranslation(const Vector3& t)
+		{
+			return { Vector3::UnitX, Vector3::UnitY, Vector3::UnitZ, t };
+		}
+
+		static constexpr Matrix CreateRotationX(float pitch)
+		{
+			return {
+				{1, 0, 0, 0},
+				{0, Cos(pitch), -Sin(pitch), 0},
+				{0, Sin(pitch), Cos(pitch), 0},
+				{0, 0, 0, 1}
+			};
+		}
+
+		static constexpr Matrix CreateRotationY(float yaw)
+		{
+			return {
+				{Cos(yaw), 0, -Sin(yaw), 0},
+				{0, 1, 0, 0},
+				{Sin(yaw), 0, Cos(yaw), 0},
+				{0, 0, 0, 1}
+			};
+		}
+
+		static constexpr Matrix CreateRotationZ(float roll)
+		{
+			return {
+				{Cos(roll), Sin(roll), 0, 0},
+				{-Sin(roll), Cos(roll), 0, 0},
+				{0, 0, 1, 0},
+				{0, 0, 0, 1}
+			};
+		}
+
+		static constexpr Matrix CreateRotation(float pitch, float yaw, float roll)
+		{
+			return CreateRotation({ pitch, yaw, roll });
+		}
+
+		static constexpr Matrix CreateRotation(const Vector3& r)
+		{
+			return CreateRotationX(r[0]) * CreateRotationY(r[1]) * CreateRotationZ(r[2]);
+		}
+
+		static constexpr Matrix CreateScale(float sx, float sy, float sz)
+		{
+			return { {sx, 0, 0}, {0, sy, 0}, {0, 0, sz}, Vector3::Zero };
+		}
+
+		static constexpr Matrix CreateScale(const Vector3& s)
+		{
+			return CreateScale(s[0], s[1], s[2]);
+		}
+
+		static constexpr Matrix Transpose(const Matrix& m)
+		{
+			if (std::is_constant_evaluated())
+			{
+				Matrix out{ m };
+				out.Transpose();
+
+				return out;
+			}
+
+			//Straight from m into out, no copy to transpose in place
+			Matrix out;
+			TransposeRows(m.data, out.data);
+
+			return out;
+		}
+
 		static Matrix Inverse(const Matrix& m);
+		//For matrices known to be affine (last column 0, 0, 0, 1): a 3x3 inverse and the translation moved back through it
+		static Matrix InverseAffine(const Matrix& m);
+		//For rotations and translations only: the transposed rotation, no determinant
+		static Matrix InverseRigid(const Matrix& m);
 
 		static Matrix CreateLookAtLH(const Vector3& origin, const Vector3& forward, const Vector3& up);
-		static Matrix CreatePerspectiveFovLH(float fovy, float aspect, float zn, float zf);
 
-		Vector4& operator[](int index);
-		Vector4 operator[](int index) const;
-		Matrix operator*(const Matrix& m) const;
-		const Matrix& operator*=(const Matrix& m);
+		static constexpr Matrix CreatePerspectiveFovLH(float fov, float aspect, float zn, float zf)
+		{
+			return {
+				{ 1 / (aspect * fov)					, 0					, 0																	,0 },
+				{ 0										, 1 / fov			, 0																	,0 },
+				{ 0										, 0					, zf / (zf - zn)													,1 },
+				{ 0										, 0					,-(zf * zn) / (zf * zn)												,0 }
+
+			};
+		}
+
+#pragma region Operator Overloads
+		constexpr Vector4& operator[](int index)
+		{
+			assert(index <= 3 && index >= 0);
+			return data[index];
+		}
+
+		constexpr Vector4 operator[](int index) const
+		{
+			assert(index <= 3 && index >= 0);
+			return data[index];
+		}
+
+		constexpr Matrix operator*(const Matrix& m) const
+		{
+			Matrix result;
+			Multiply(data, m.data, result.data);
+
+			return result;
+		}
+
+		constexpr const Matrix& operator*=(const Matrix& m)
+		{
+			Multiply(data, m.data, data);
+
+			return *this;
+		}
+#pragma endregion
 
 	private:
 
-		//Row-Major Matrix
-		Vector4 data[4]
+		//Row-Major Matrix, rows 16-byte aligned for the SIMD paths in Matrix.cpp
+		alignas(16) Vector4 data[4]
 		{
 			{1,0,0,0}, //xAxis
 			{0,1,0,0}, //yAxis
@@ -71,5 +262,51 @@ namespace dae {
 		// v1x v1y v1z v1w
 		// v2x v2y v2z v2w
 		// v3x v3y v3z v3w
+
+		//pResult may alias either operand
+		static constexpr void Multiply(const Vector4* pLhs, const Vector4* pRhs, Vector4* pResult)
+		{
+			if (!std::is_constant_evaluated())
+			{
+				MultiplyRows(pLhs, pRhs, pResult);
+				return;
+			}
+
+			const Vector4 lhs[4]{ pLhs[0], pLhs[1], pLhs[2], pLhs[3] };
+			const Vector4 rhs[4]{ pRhs[0], pRhs[1], pRhs[2], pRhs[3] };
+			for (int r{ 0 }; r < 4; ++r)
+			{
+				for (int c{ 0 }; c < 4; ++c)
+				{
+					pResult[r][c] = lhs[r].x * rhs[0][c] + lhs[r].y * rhs[1][c] + lhs[r].z * rhs[2][c] + lhs[r].w * rhs[3][c];
+				}
+			}
+		}
+
+		//Runtime kernels, see Simd.h for the instruction set
+		static void MultiplyRows(const Vector4* pLhs, const Vector4* pRhs, Vector4* pResult);
+
+		//Inline: a call costs about as much as the 4 loads, 8 shuffles and 4 stores themselves.
+		//pResult may alias pRows
+		static void TransposeRows(const Vector4* pRows, Vector4* pResult)
+		{
+#if defined(DAE_SIMD_SSE)
+			__m128 r0{ _mm_load_ps(&pRows[0].x) };
+			__m128 r1{ _mm_load_ps(&pRows[1].x) };
+			__m128 r2{ _mm_load_ps(&pRows[2].x) };
+			__m128 r3{ _mm_load_ps(&pRows[3].x) };
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+			_mm_store_ps(&pResult[0].x, r0);
+			_mm_store_ps(&pResult[1].x, r1);
+			_mm_store_ps(&pResult[2].x, r2);
+			_mm_store_ps(&pResult[3].x, r3);
+#else
+			const Vector4 rows[4]{ pRows[0], pRows[1], pRows[2], pRows[3] };
+			for (int r{ 0 }; r < 4; ++r)
+			{
+				pResult[r] = { rows[0][r], rows[1][r], rows[2][r], rows[3][r] };
+			}
+#endif
+		}
 	};
-}
\ No newline at end of file
+}
@@ -2,176 +2,151 @@
 #include "Mesh.h"
 #include "Effect_Vehicle.h"
 #include "Effect_Fire.h"
+#include "MeshSimplifier.h"
+#include <cstring>
+#include <initializer_list>
 #include <assert.h>
 
-Mesh::Mesh(ID3D11Device* pDeviceInput, const std::string& objPath, const std::string& diffuseMapPath, const Vector3& position)
+namespace
 {
-	m_pEffect = new Effect_Fire(pDeviceInput,L"Resources/Fire_Shader.fx");
+	//Switch to a coarser level once its simplification error projects to at most a pixel
+	constexpr float MaxLodPixelError{ 1.f };
 
-	ParseFireObj(objPath);
+	//Geometry loads already run side by side on the AssetLoader's pool, a cache rebuild parsing on every hardware thread
+	//on top of that would oversubscribe the CPU
+	constexpr uint32_t NumParseThreadsOnPool{ 1 };
 
-	//Create Vertex Layout
-	static constexpr uint32_t numElements{ 2 };
-	D3D11_INPUT_ELEMENT_DESC vertexDesc[numElements]{};
-
-	vertexDesc[0].SemanticName = "POSITION";
-	vertexDesc[0].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-	vertexDesc[0].AlignedByteOffset = 0;
-	vertexDesc[0].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-
-	vertexDesc[1].SemanticName = "TEXCOORD";
-	vertexDesc[1].Format = DXGI_FORMAT_R32G32_FLOAT;
-	vertexDesc[1].AlignedByteOffset = 12;
-	vertexDesc[1].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-
-	//Create Input Layout
-	D3DX11_PASS_DESC passDesc{};
-	m_pEffect->GetTechniquePtr()->GetPassByIndex(0)->GetDesc(&passDesc);
-
-	HRESULT result = pDeviceInput->CreateInputLayout(
-		vertexDesc,
-		numElements,
-		passDesc.pIAInputSignature,
-		passDesc.IAInputSignatureSize,
-		&m_pInputLayout);
-
-	if (FAILED(result))
+	const char* GetSemanticName(VertexSemantic semantic)
 	{
-		assert(false && "Unable to create input layout in constructor of Mesh class");
+		switch (semantic)
+		{
+		case VertexSemantic::Position:
+			return "POSITION";
+		case VertexSemantic::Normal:
+			return "NORMAL";
+		case VertexSemantic::Tangent:
+			return "TANGENT";
+		case VertexSemantic::TexCoord:
+			return "TEXCOORD";
+		default:
+			return "";
+		}
 	}
 
-
-	//Create vertex buffer
-	D3D11_BUFFER_DESC bd = {};
-	bd.Usage = D3D11_USAGE_IMMUTABLE;
-	bd.ByteWidth = sizeof(Vertex_Fire) * static_cast<uint32_t>(m_FireVertices.size());
-	bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	bd.CPUAccessFlags = 0;
-	bd.MiscFlags = 0;
-
-	D3D11_SUBRESOURCE_DATA initData = {};
-	initData.pSysMem = m_FireVertices.data();
-	
-	result = pDeviceInput->CreateBuffer(&bd, &initData, &m_pVertexBuffer);
-	if (FAILED(result))
+	DXGI_FORMAT GetDxgiFormat(VertexFormat format)
 	{
-		assert(false && "Unable to create vertex buffer in constructor of Mesh class");
+		switch (format)
+		{
+		case VertexFormat::Float2:
+			return DXGI_FORMAT_R32G32_FLOAT;
+		case VertexFormat::Float3:
+			return DXGI_FORMAT_R32G32B32_FLOAT;
+		case VertexFormat::Half2:
+			return DXGI_FORMAT_R16G16_FLOAT;
+		case VertexFormat::Unorm16x2:
+			return DXGI_FORMAT_R16G16_UNORM;
+		case VertexFormat::Unorm16x4:
+			return DXGI_FORMAT_R16G16B16A16_UNORM;
+		case VertexFormat::OctahedralSnorm16x2:
+			return DXGI_FORMAT_R16G16_SNORM;
+		default:
+			return DXGI_FORMAT_UNKNOWN;
+		}
 	}
 
-	//Create index buffer
-	m_NumIndices = static_cast<uint32_t>(m_Indices.size());
-	bd.Usage = D3D11_USAGE_IMMUTABLE;
-	bd.ByteWidth = sizeof(uint32_t) * m_NumIndices;
-	bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
-	bd.CPUAccessFlags = 0;
-	bd.MiscFlags = 0;
-	
-	initData.pSysMem = m_Indices.data();
-
-	result = pDeviceInput->CreateBuffer(&bd, &initData, &m_pIndexBuffer);
-	if (FAILED(result))
+	//Packed formats need decoding in the vertex shader, see the #if blocks in the .fx files
+	std::vector<D3D_SHADER_MACRO> GetShaderDefines(const VertexLayout& layout)
 	{
-		assert(false && "Unable to create index buffer in constructor of Mesh class");
+		std::vector<D3D_SHADER_MACRO> defines{};
+		if (layout.HasQuantizedPosition())
+			defines.push_back({ "QUANTIZED_POSITION", "1" });
+		if (layout.HasOctahedralNormals())
+			defines.push_back({ "OCTAHEDRAL_NORMALS", "1" });
+
+		defines.push_back({ nullptr, nullptr });
+		return defines;
 	}
-
-	m_pDiffuseMap = new dae::Texture(pDeviceInput, diffuseMapPath.c_str());
-	m_pEffect->SetDiffuseMap(m_pDiffuseMap);
 }
 
-Mesh::Mesh(ID3D11Device* pDeviceInput, const std::string& objPath, const std::string& diffuseMapPath, const std::string& normalMapPath, const std::string& specularMapPath, const std::string& glossinessMapPath, const Vector3& position)
+void MeshAssets::Wait() const
 {
-	m_pEffect = new Effect_Vehicle(pDeviceInput,L"Resources/Vehicle_Shader.fx");
-
-	//Parse OBJ
-	ParseObj(objPath,m_VehicleVertices,m_Indices);
-
-	//Create Vertex Layout
-	static constexpr uint32_t numElements{ 4 };
-	D3D11_INPUT_ELEMENT_DESC vertexDesc[numElements]{};
-
-	vertexDesc[0].SemanticName = "POSITION";
-	vertexDesc[0].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-	vertexDesc[0].AlignedByteOffset = 0;
-	vertexDesc[0].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-
-	vertexDesc[1].SemanticName = "NORMAL";
-	vertexDesc[1].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-	vertexDesc[1].AlignedByteOffset = 12;
-	vertexDesc[1].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-
-	vertexDesc[2].SemanticName = "TANGENT";
-	vertexDesc[2].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-	vertexDesc[2].AlignedByteOffset = 24;
-	vertexDesc[2].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-
-	vertexDesc[3].SemanticName = "TEXCOORD";
-	vertexDesc[3].Format = DXGI_FORMAT_R32G32_FLOAT;
-	vertexDesc[3].AlignedByteOffset = 36;
-	vertexDesc[3].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-
-	//Create Input Layout
-	D3DX11_PASS_DESC passDesc{};
-	m_pEffect->GetTechniquePtr()->GetPassByIndex(0)->GetDesc(&passDesc);
-
-	HRESULT result = pDeviceInput->CreateInputLayout(
-		vertexDesc,
-		numElements,
-		passDesc.pIAInputSignature,
-		passDesc.IAInputSignatureSize,
-		&m_pInputLayout);
-
-	if (FAILED(result))
+	for (const std::future<SDL_Surface*>* pImage : { &diffuseMap, &normalMap, &specularMap, &glossinessMap })
 	{
-		assert(false && "Unable to create input layout in constructor of Mesh class");
+		if (pImage->valid())
+			pImage->wait();
 	}
 
-	//Create vertex buffer
-	D3D11_BUFFER_DESC bd = {};
-	bd.Usage = D3D11_USAGE_IMMUTABLE;
-	bd.ByteWidth = sizeof(Vertex_Vehicle) * static_cast<uint32_t>(m_VehicleVertices.size());
-	bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	bd.CPUAccessFlags = 0;
-	bd.MiscFlags = 0;
+	geometry.wait();
+	effect.wait();
+}
 
-	D3D11_SUBRESOURCE_DATA initData = {};
-	initData.pSysMem = m_VehicleVertices.data();
-	
-	result = pDeviceInput->CreateBuffer(&bd, &initData, &m_pVertexBuffer);
-	if (FAILED(result))
-	{
-		assert(false && "Unable to create vertex buffer in constructor of Mesh class");
-	}
+MeshAssets Mesh::RequestFireAssets(AssetLoader& loader, const std::string& objPath, const std::string& diffuseMapPath, bool usePackedVertices)
+{
+	//Load OBJ (parsed once, memory-mapped from the binary cache afterwards)
+	const VertexLayout layout{ usePackedVertices ? VertexLayout::CreatePackedFireLayout() : VertexLayout::CreateFireLayout() };
+
+	MeshAssets assets{};
+	assets.geometry = loader.Submit("mesh " + objPath, [objPath, layout]() { return LoadGeometry(objPath, layout, NumParseThreadsOnPool); });
+	assets.effect = loader.CompileEffect(L"Resources/Fire_Shader.fx", GetShaderDefines(layout).data());
+	assets.diffuseMap = loader.DecodeImage(diffuseMapPath);
+	return assets;
+}
 
-	//Create index buffer
-	m_NumIndices = static_cast<uint32_t>(m_Indices.size());
-	bd.Usage = D3D11_USAGE_IMMUTABLE;
-	bd.ByteWidth = sizeof(uint32_t) * m_NumIndices;
-	bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
-	bd.CPUAccessFlags = 0;
-	bd.MiscFlags = 0;
-	
-	initData.pSysMem = m_Indices.data();
+MeshAssets Mesh::RequestVehicleAssets(AssetLoader& loader, const std::string& objPath, const std::string& diffuseMapPath, const std::string& normalMapPath,
+	const std::string& specularMapPath, const std::string& glossinessMapPath, bool usePackedVertices)
+{
+	//Load OBJ (parsed once, memory-mapped from the binary cache afterwards)
+	const VertexLayout layout{ usePackedVertices ? VertexLayout::CreatePackedVehicleLayout() : VertexLayout::CreateVehicleLayout() };
+
+	MeshAssets assets{};
+	assets.isVehicle = true;
+	assets.geometry = loader.Submit("mesh " + objPath, [objPath, layout]() { return LoadGeometry(objPath, layout, NumParseThreadsOnPool); });
+	assets.effect = loader.CompileEffect(L"Resources/Vehicle_Shader.fx", GetShaderDefines(layout).data());
+	assets.diffuseMap = loader.DecodeImage(diffuseMapPath);
+	assets.normalMap = loader.DecodeImage(normalMapPath);
+	assets.specularMap = loader.DecodeImage(specularMapPath);
+	assets.glossinessMap = loader.DecodeImage(glossinessMapPath);
+	return assets;
+}
 
-	result = pDeviceInput->CreateBuffer(&bd, &initData, &m_pIndexBuffer);
-	if (FAILED(result))
-	{
-		assert(false && "Unable to create index buffer in constructor of Mesh class");
-	}
+Mesh::Mesh(ID3D11Device* pDeviceInput, MeshAssets& assets, const Vector3& position)
+{
+	MeshGeometry geometry{ assets.geometry.get() };
+	m_pMeshCache = std::move(geometry.pMeshCache);
+	m_Meshlets = std::move(geometry.meshlets);
+	m_MeshletIndexData = std::move(geometry.meshletIndexData);
+	m_VisibleMeshletRanges.reserve(m_Meshlets.size());
+
+	ID3DBlob* pCompiledEffect{ assets.effect.get() };
+	if (assets.isVehicle)
+		m_pEffect = new Effect_Vehicle(pDeviceInput, pCompiledEffect);
+	else
+		m_pEffect = new Effect_Fire(pDeviceInput, pCompiledEffect);
 
-	m_pDiffuseMap		= new dae::Texture(pDeviceInput, diffuseMapPath.c_str());
-	m_pNormalMap		= new dae::Texture(pDeviceInput, normalMapPath.c_str());
-	m_pSpecularMap		= new dae::Texture(pDeviceInput, specularMapPath.c_str());
-	m_pGlossinessMap	= new dae::Texture(pDeviceInput, glossinessMapPath.c_str());
+	if (pCompiledEffect)
+		pCompiledEffect->Release();
 
+	m_pEffect->SetPositionQuantization(m_pMeshCache->GetPositionQuantization());
+
+	CreateInputLayout(pDeviceInput);
+	CreateBuffers(pDeviceInput);
+	CreateCulledIndexBuffer(pDeviceInput);
+	CreateDepthPassResources(pDeviceInput);
+
+	m_pDiffuseMap = new dae::Texture(pDeviceInput, assets.diffuseMap.get());
 	m_pEffect->SetDiffuseMap(m_pDiffuseMap);
+
 	Effect_Vehicle* vehicleEffect{ dynamic_cast<Effect_Vehicle*>(m_pEffect) };
 	if (vehicleEffect)
 	{
+		m_pNormalMap		= new dae::Texture(pDeviceInput, assets.normalMap.get());
+		m_pSpecularMap		= new dae::Texture(pDeviceInput, assets.specularMap.get());
+		m_pGlossinessMap	= new dae::Texture(pDeviceInput, assets.glossinessMap.get());
+
 		vehicleEffect->SetNormalMap(m_pNormalMap->GetResourceViewTexturePtr());
 		vehicleEffect->SetSpecularMap(m_pSpecularMap->GetResourceViewTexturePtr());
 		vehicleEffect->SetGlossinessMap(m_pGlossinessMap->GetResourceViewTexturePtr());
 	}
-
 }
 
 Mesh::~Mesh()
@@ -183,6 +158,12 @@ Mesh::~Mesh()
 	delete m_pGlossinessMap;
 	m_pVertexBuffer->Release();
 	m_pIndexBuffer->Release();
+	if (m_pCulledIndexBuffer)
+		m_pCulledIndexBuffer->Release();
+	if (m_pPositionBuffer)
+		m_pPositionBuffer->Release();
+	if (m_pDepthInputLayout)
+		m_pDepthInputLayout->Release();
 	m_pInputLayout->Release();
 }
 
@@ -197,14 +178,21 @@ void Mesh::Update(const Timer* pTimer)
 	m_VehicleYaw = PI_DIV_4 * m_AccuSec;
 }
 
-void Mesh::Render(ID3D11DeviceContext* pDeviceContext, Camera* pCamera) const
+void Mesh::Render(ID3D11DeviceContext* pDeviceContext, const FrameConstants& frameConstants, MeshPass pass)
 {
+	if (!HasDepthPass())
+	{
+		if (pass == MeshPass::Depth)
+			return;
+		pass = MeshPass::Color;
+	}
+	const bool isDepthPass{ pass == MeshPass::Depth };
+
 	//1. Set Matrices
-	dae::Matrix worldMatrix = Matrix::CreateTranslation(m_Position) * Matrix::CreateRotationY(m_VehicleYaw);
-	dae::Matrix viewMatrix{ pCamera->GetViewMatrix().Inverse() };
-	dae::Matrix inverseViewMatrix{ pCamera->GetViewMatrix() };
-	dae::Matrix projectionMatrix{ pCamera->GetProjectionMatrix() };
-	dae::Matrix worldViewProjectionMatrix{ worldMatrix * viewMatrix * projectionMatrix};
+	const RigidTransform worldTransform{ GetWorldTransform() };
+	const dae::Matrix worldMatrix{ worldTransform.ToMatrix() };
+	//View and projection are shared by every mesh: one multiply per mesh
+	const dae::Matrix worldViewProjectionMatrix{ worldMatrix * frameConstants.viewProjectionMatrix };
 
 	m_pEffect->SetWorldViewProjectionMatrix(worldViewProjectionMatrix);
 
@@ -213,45 +201,62 @@ void Mesh::Render(ID3D11DeviceContext* pDeviceContext, Camera* pCamera) const
 	if (vehicleEffect)
 	{
 		vehicleEffect->SetWorldMatrix(worldMatrix);
-		vehicleEffect->SetViewInverseMatrix(inverseViewMatrix);
+		vehicleEffect->SetViewInverseMatrix(frameConstants.inverseViewMatrix);
 	}
 
 	//1. Set Primitive Topology
 	pDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
 	//2. Set Input Layout
-	pDeviceContext->IASetInputLayout(m_pInputLayout);
+	pDeviceContext->IASetInputLayout(isDepthPass ? m_pDepthInputLayout : m_pInputLayout);
 
 	//3. Set VertexBuffer
-	UINT stride{};
+	const UINT stride{ isDepthPass ? m_PositionStride : m_VertexStride };
+	constexpr UINT offset = 0;
+	pDeviceContext->IASetVertexBuffers(0, 1, isDepthPass ? &m_pPositionBuffer : &m_pVertexBuffer, &stride, &offset);
 
-	if (vehicleEffect)
+	//4. Set IndexBuffer: the range of the selected level of detail, or only the visible meshlets of the full mesh when culling.
+	//After the depth pass the same triangles again, or the equal depth test would drop pixels
+	if (pass != MeshPass::ColorAfterDepth)
 	{
-		stride = sizeof(Vertex_Vehicle);
-	}
-	else
-	{
-		stride = sizeof(Vertex_Fire);
+		m_CurrentLod = m_IsLodSelection ? SelectLod(worldMatrix, frameConstants) : 0;
+		const MeshLod& lod{ GetLod(m_CurrentLod) };
+
+		m_StartIndex = lod.firstIndex;
+		m_NumIndices = lod.numIndices;
+		m_IsCulledDraw = m_IsMeshletCulling && m_pCulledIndexBuffer && m_CurrentLod == 0;
+		if (m_IsCulledDraw)
+		{
+			m_StartIndex = 0;
+			m_NumIndices = CullMeshlets(pDeviceContext, worldTransform, worldViewProjectionMatrix, frameConstants.cameraPosition);
+		}
 	}
-	
-	constexpr UINT offset = 0;
-	pDeviceContext->IASetVertexBuffers(0, 1, &m_pVertexBuffer, &stride, &offset);
+	pDeviceContext->IASetIndexBuffer(m_IsCulledDraw ? m_pCulledIndexBuffer : m_pIndexBuffer, m_IndexFormat, 0);
 
-	//4. Set IndexBuffer
-	pDeviceContext->IASetIndexBuffer(m_pIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
+	if (m_NumIndices == 0)
+		return;
 
 	//5. Draw
+	ID3DX11EffectTechnique* pTechnique{ isDepthPass ? vehicleEffect->GetDepthTechniquePtr() : m_pEffect->GetTechniquePtr() };
 	D3DX11_TECHNIQUE_DESC techDesc{};
-	m_pEffect->GetTechniquePtr()->GetDesc(&techDesc);
+	pTechnique->GetDesc(&techDesc);
 	for (UINT p = 0; p < techDesc.Passes; p++)
 	{
-		m_pEffect->GetTechniquePtr()->GetPassByIndex(p)->Apply(0, pDeviceContext);
-		pDeviceContext->DrawIndexed(m_NumIndices, 0, 0);
+		pTechnique->GetPassByIndex(p)->Apply(0, pDeviceContext);
+		//Overrides the pass's less test and depth write
+		if (pass == MeshPass::ColorAfterDepth)
+			pDeviceContext->OMSetDepthStencilState(vehicleEffect->GetEqualDepthStencilStatePtr(), 0);
+		pDeviceContext->DrawIndexed(m_NumIndices, m_StartIndex, 0);
 	}
 
 
 }
 
+bool Mesh::HasDepthPass() const
+{
+	return m_pPositionBuffer && m_pDepthInputLayout;
+}
+
 ID3D11InputLayout* Mesh::GetInputLayoutPtr()
 {
 	return m_pInputLayout;
@@ -272,172 +277,279 @@ bool Mesh::GetIsRotating() const
 	return m_IsRotating;
 }
 
+void Mesh::ToggleMeshletCulling()
+{
+	m_IsMeshletCulling = !m_IsMeshletCulling;
+}
+
+bool Mesh::GetIsMeshletCulling() const
+{
+	return m_IsMeshletCulling;
+}
+
+const MeshletCullStatistics& Mesh::GetMeshletStatistics() const
+{
+	return m_MeshletStatistics;
+}
+
+Bounds Mesh::GetWorldBounds() const
+{
+	return m_Bounds.Transform(GetWorldTransform().ToMatrix());
+}
+
+RigidTransform Mesh::GetWorldTransform() const
+{
+	//Translation first, then the spin around the origin: CreateTranslation(m_Position) * CreateRotationY(m_VehicleYaw)
+	const Quaternion rotation{ Quaternion::CreateRotationY(m_VehicleYaw) };
+	return RigidTransform{ rotation, rotation.Rotate(m_Position) };
+}
+
+void Mesh::ToggleLodSelection()
+{
+	m_IsLodSelection = !m_IsLodSelection;
+}
+
+bool Mesh::GetIsLodSelection() const
+{
+	return m_IsLodSelection;
+}
 
-void Mesh::ParseFireObj(const std::string& filename)
+uint32_t Mesh::GetCurrentLod() const
 {
-	std::vector<Vertex_Vehicle> parserVertices{};
+	return m_CurrentLod;
+}
+
+uint32_t Mesh::GetNumLods() const
+{
+	return std::max(m_pMeshCache->GetHeader().numLods, 1u);
+}
+
+const MeshLod& Mesh::GetLod(uint32_t lod) const
+{
+	return m_pMeshCache->GetHeader().lods[std::min(lod, GetNumLods() - 1)];
+}
 
-	ParseObj(filename, parserVertices, m_Indices);
 
-	for (const Vertex_Vehicle& vert : parserVertices)
+void Mesh::CreateInputLayout(ID3D11Device* pDeviceInput)
+{
+	//Create Vertex Layout from the layout stored in the mesh cache
+	const VertexLayout& layout{ m_pMeshCache->GetHeader().vertexLayout };
+
+	D3D11_INPUT_ELEMENT_DESC vertexDesc[VertexLayout::MaxAttributes]{};
+	for (uint32_t i = 0; i < layout.numAttributes; ++i)
 	{
-		Vertex_Fire v{};
-		v.position = vert.position;
-		v.uv = vert.uv;
+		vertexDesc[i].SemanticName = GetSemanticName(layout.attributes[i].semantic);
+		vertexDesc[i].Format = GetDxgiFormat(layout.attributes[i].format);
+		vertexDesc[i].AlignedByteOffset = layout.attributes[i].offset;
+		vertexDesc[i].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+	}
+
+	//Create Input Layout
+	D3DX11_PASS_DESC passDesc{};
+	m_pEffect->GetTechniquePtr()->GetPassByIndex(0)->GetDesc(&passDesc);
 
-		m_FireVertices.push_back(v);
+	HRESULT result = pDeviceInput->CreateInputLayout(
+		vertexDesc,
+		layout.numAttributes,
+		passDesc.pIAInputSignature,
+		passDesc.IAInputSignatureSize,
+		&m_pInputLayout);
+
+	if (FAILED(result))
+	{
+		assert(false && "Unable to create input layout in constructor of Mesh class");
 	}
 }
 
-bool Mesh::ParseObj(const std::string& filename, std::vector<Vertex_Vehicle>& vertices, std::vector<uint32_t>& indices, bool flipAxisAndWinding)
+void Mesh::CreateBuffers(ID3D11Device* pDeviceInput)
 {
-	std::ifstream file(filename);
-	if (!file)
-		return false;
+	if (!m_pMeshCache->IsValid())
+	{
+		assert(false && "Unable to load obj in constructor of Mesh class");
+		return;
+	}
 
-	std::vector<Vector3> positions{};
-	std::vector<Vector3> normals{};
-	std::vector<Vector2> UVs{};
+	const MeshCacheHeader& header{ m_pMeshCache->GetHeader() };
+	m_VertexStride = header.vertexLayout.stride;
 
-	vertices.clear();
-	indices.clear();
+	//Create vertex buffer, uploaded straight from the mapped cache
+	D3D11_BUFFER_DESC bd = {};
+	bd.Usage = D3D11_USAGE_IMMUTABLE;
+	bd.ByteWidth = m_pMeshCache->GetVertexDataSize();
+	bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	bd.CPUAccessFlags = 0;
+	bd.MiscFlags = 0;
+
+	D3D11_SUBRESOURCE_DATA initData = {};
+	initData.pSysMem = m_pMeshCache->GetVertexData();
 
-	std::string sCommand;
-	// start a while iteration ending when the end of file is reached (ios::eof)
-	while (!file.eof())
+	HRESULT result = pDeviceInput->CreateBuffer(&bd, &initData, &m_pVertexBuffer);
+	if (FAILED(result))
 	{
-		//read the first word of the string, use the >> operator (istream::operator>>) 
-		file >> sCommand;
-		//use conditional statements to process the different commands	
-		if (sCommand == "#")
-		{
-			// Ignore Comment
-		}
-		else if (sCommand == "v")
-		{
-			//Vertex
-			float x, y, z;
-			file >> x >> y >> z;
+		assert(false && "Unable to create vertex buffer in constructor of Mesh class");
+	}
 
-			positions.emplace_back(x, y, z);
-		}
-		else if (sCommand == "vt")
-		{
-			// Vertex TexCoord
-			float u, v;
-			file >> u >> v;
-			UVs.emplace_back(u, 1 - v);
-		}
-		else if (sCommand == "vn")
-		{
-			// Vertex Normal
-			float x, y, z;
-			file >> x >> y >> z;
+	//Create index buffer, 16-bit whenever the mesh has few enough vertices
+	m_Bounds = Bounds::FromMinMax(header.boundsMin, header.boundsMax, header.boundsRadius);
+	m_IndexFormat = header.indexStride == sizeof(uint16_t) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+	bd.Usage = D3D11_USAGE_IMMUTABLE;
+	bd.ByteWidth = m_pMeshCache->GetIndexDataSize();
+	bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
+	bd.CPUAccessFlags = 0;
+	bd.MiscFlags = 0;
 
-			normals.emplace_back(x, y, z);
-		}
-		else if (sCommand == "f")
-		{
-			//if a face is read:
-			//construct the 3 vertices, add them to the vertex array
-			//add three indices to the index array
-			//add the material index as attibute to the attribute array
-			//
-			// Faces or triangles
-			Vertex_Vehicle vertex{};
-			size_t iPosition, iTexCoord, iNormal;
-
-			uint32_t tempIndices[3];
-			for (size_t iFace = 0; iFace < 3; iFace++)
-			{
-				// OBJ format uses 1-based arrays
-				file >> iPosition;
-				vertex.position = positions[iPosition - 1];
-
-				if ('/' == file.peek())//is next in buffer ==  '/' ?
-				{
-					file.ignore();//read and ignore one element ('/')
-
-					if ('/' != file.peek())
-					{
-						// Optional texture coordinate
-						file >> iTexCoord;
-						vertex.uv = UVs[iTexCoord - 1];
-					}
-
-					if ('/' == file.peek())
-					{
-						file.ignore();
-
-						// Optional vertex normal
-						file >> iNormal;
-						vertex.normal = normals[iNormal - 1];
-					}
-				}
-
-				vertices.push_back(vertex);
-				tempIndices[iFace] = uint32_t(vertices.size()) - 1;
-				//indices.push_back(uint32_t(vertices.size()) - 1);
-			}
-
-			indices.push_back(tempIndices[0]);
-			if (flipAxisAndWinding)
-			{
-				indices.push_back(tempIndices[2]);
-				indices.push_back(tempIndices[1]);
-			}
-			else
-			{
-				indices.push_back(tempIndices[1]);
-				indices.push_back(tempIndices[2]);
-			}
-		}
-		//read till end of line and ignore all remaining chars
-		file.ignore(1000, '\n');
+	initData.pSysMem = m_pMeshCache->GetIndexData();
+
+	result = pDeviceInput->CreateBuffer(&bd, &initData, &m_pIndexBuffer);
+	if (FAILED(result))
+	{
+		assert(false && "Unable to create index buffer in constructor of Mesh class");
 	}
+}
 
-	//Cheap Tangent Calculations
-	for (uint32_t i = 0; i < indices.size(); i += 3)
+void Mesh::CreateDepthPassResources(ID3D11Device* pDeviceInput)
+{
+	Effect_Vehicle* vehicleEffect{ dynamic_cast<Effect_Vehicle*>(m_pEffect) };
+	if (!vehicleEffect || !m_pMeshCache->IsValid())
+		return;
+
+	const MeshCacheHeader& header{ m_pMeshCache->GetHeader() };
+	const VertexAttribute* pPosition{ header.vertexLayout.FindAttribute(VertexSemantic::Position) };
+	if (!pPosition)
+		return;
+
+	//Positions in the format the cache stores them, quantized ones stay quantized
+	m_PositionStride = VertexLayout::GetFormatSize(pPosition->format);
+	std::vector<char> positions(size_t(header.numVertices) * m_PositionStride);
+	const char* pVertexData{ static_cast<const char*>(m_pMeshCache->GetVertexData()) };
+	for (uint32_t i = 0; i < header.numVertices; ++i)
 	{
-		uint32_t index0 = indices[i];
-		uint32_t index1 = indices[size_t(i) + 1];
-		uint32_t index2 = indices[size_t(i) + 2];
-
-		const Vector3& p0 = vertices[index0].position;
-		const Vector3& p1 = vertices[index1].position;
-		const Vector3& p2 = vertices[index2].position;
-		const Vector2& uv0 = vertices[index0].uv;
-		const Vector2& uv1 = vertices[index1].uv;
-		const Vector2& uv2 = vertices[index2].uv;
-
-		const Vector3 edge0 = p1 - p0;
-		const Vector3 edge1 = p2 - p0;
-		const Vector2 diffX = Vector2(uv1.x - uv0.x, uv2.x - uv0.x);
-		const Vector2 diffY = Vector2(uv1.y - uv0.y, uv2.y - uv0.y);
-		float r = 1.f / Vector2::Cross(diffX, diffY);
-
-		Vector3 tangent = (edge0 * diffY.y - edge1 * diffY.x) * r;
-		vertices[index0].tangent += tangent;
-		vertices[index1].tangent += tangent;
-		vertices[index2].tangent += tangent;
+		std::memcpy(positions.data() + size_t(i) * m_PositionStride, pVertexData + size_t(i) * header.vertexLayout.stride + pPosition->offset, m_PositionStride);
 	}
 
-	//Create the Tangents (reject)
-	for (auto& v : vertices)
+	D3D11_BUFFER_DESC bd = {};
+	bd.Usage = D3D11_USAGE_IMMUTABLE;
+	bd.ByteWidth = static_cast<UINT>(positions.size());
+	bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	bd.CPUAccessFlags = 0;
+	bd.MiscFlags = 0;
+
+	D3D11_SUBRESOURCE_DATA initData = {};
+	initData.pSysMem = positions.data();
+
+	HRESULT result = pDeviceInput->CreateBuffer(&bd, &initData, &m_pPositionBuffer);
+	if (FAILED(result))
 	{
-		v.tangent = Vector3::Reject(v.tangent, v.normal).Normalized();
+		assert(false && "Unable to create position buffer in constructor of Mesh class");
+		return;
+	}
 
-		if (flipAxisAndWinding)
-		{
-			v.position.z *= -1.f;
-			v.normal.z *= -1.f;
-			v.tangent.z *= -1.f;
-		}
+	D3D11_INPUT_ELEMENT_DESC positionDesc{};
+	positionDesc.SemanticName = GetSemanticName(VertexSemantic::Position);
+	positionDesc.Format = GetDxgiFormat(pPosition->format);
+	positionDesc.AlignedByteOffset = 0;
+	positionDesc.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+
+	//Every depth technique has the same vertex shader
+	D3DX11_PASS_DESC passDesc{};
+	vehicleEffect->GetDepthTechniquePtr()->GetPassByIndex(0)->GetDesc(&passDesc);
+
+	result = pDeviceInput->CreateInputLayout(&positionDesc, 1, passDesc.pIAInputSignature, passDesc.IAInputSignatureSize, &m_pDepthInputLayout);
+	if (FAILED(result))
+	{
+		assert(false && "Unable to create depth pass input layout in constructor of Mesh class");
+	}
+}
+
+MeshGeometry Mesh::LoadGeometry(const std::string& objPath, const VertexLayout& layout, uint32_t numParseThreads)
+{
+	MeshGeometry geometry{};
+	geometry.pMeshCache = std::make_unique<MeshCache>(objPath, layout, true, false, numParseThreads);
+
+	const MeshCache& meshCache{ *geometry.pMeshCache };
+	if (!meshCache.IsValid())
+		return geometry;
 
+	//Decode the cached buffers once, the meshlets only need positions and normals of the full level of detail
+	const MeshCacheHeader& header{ meshCache.GetHeader() };
+	const MeshLod& lod{ header.lods[0] };
+	const PositionQuantization quantization{ meshCache.GetPositionQuantization() };
+	const char* pVertexData{ static_cast<const char*>(meshCache.GetVertexData()) };
+
+	std::vector<Vertex_Vehicle> vertices(header.numVertices);
+	for (uint32_t i = 0; i < header.numVertices; ++i)
+	{
+		vertices[i] = header.vertexLayout.ReadVertex(pVertexData + size_t(i) * header.vertexLayout.stride, quantization);
+	}
+
+	std::vector<uint32_t> indices(lod.numIndices);
+	for (uint32_t i = 0; i < lod.numIndices; ++i)
+	{
+		indices[i] = meshCache.GetIndex(lod.firstIndex + i);
 	}
 
-	return true;
+	//Clustering reorders the triangles, the culled draw copies its ranges from this order instead of the cache's
+	geometry.meshlets = Meshlets::Build(vertices, indices);
 
+	geometry.meshletIndexData.resize(indices.size() * header.indexStride);
+	for (size_t i = 0; i < indices.size(); ++i)
+	{
+		if (header.indexStride == sizeof(uint16_t))
+			reinterpret_cast<uint16_t*>(geometry.meshletIndexData.data())[i] = static_cast<uint16_t>(indices[i]);
+		else
+			reinterpret_cast<uint32_t*>(geometry.meshletIndexData.data())[i] = indices[i];
+	}
+	return geometry;
 }
 
+void Mesh::CreateCulledIndexBuffer(ID3D11Device* pDeviceInput)
+{
+	if (!m_pMeshCache->IsValid())
+		return;
 
+	//Rewritten every frame with the visible triangles
+	D3D11_BUFFER_DESC bd = {};
+	bd.Usage = D3D11_USAGE_DYNAMIC;
+	bd.ByteWidth = GetLod(0).numIndices * m_pMeshCache->GetHeader().indexStride;
+	bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
+	bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	bd.MiscFlags = 0;
+
+	const HRESULT result = pDeviceInput->CreateBuffer(&bd, nullptr, &m_pCulledIndexBuffer);
+	if (FAILED(result))
+	{
+		assert(false && "Unable to create culled index buffer in constructor of Mesh class");
+	}
+}
+
+uint32_t Mesh::SelectLod(const Matrix& worldMatrix, const FrameConstants& frameConstants) const
+{
+	//Closest point of the bounding sphere, the error can't be seen larger anywhere on the mesh
+	const Vector3 worldCenter{ worldMatrix.TransformPoint(m_Bounds.center) };
+	const float distance{ (worldCenter - frameConstants.cameraPosition).Magnitude() - m_Bounds.radius };
+
+	for (uint32_t lod = GetNumLods() - 1; lod > 0; --lod)
+	{
+		if (MeshSimplifier::GetScreenSpaceError(GetLod(lod).error, distance, frameConstants.projectionMatrix[1][1], frameConstants.viewportHeight) <= MaxLodPixelError)
+			return lod;
+	}
+	return 0;
+}
+
+uint32_t Mesh::CullMeshlets(ID3D11DeviceContext* pDeviceContext, const RigidTransform& worldTransform, const Matrix& worldViewProjectionMatrix, const Vector3& cameraPosition)
+{
+	//Cull in object space, the meshlet bounds stay untransformed
+	const Vector3 objectCameraPosition{ worldTransform.Inverse().TransformPoint(cameraPosition) };
+	const bool cullBackFacing{ m_pEffect->GetCullMode() == cullMode::backCulling };
+
+	Meshlets::Cull(m_Meshlets, worldViewProjectionMatrix, objectCameraPosition, cullBackFacing, m_VisibleMeshletRanges, m_MeshletStatistics);
+
+	D3D11_MAPPED_SUBRESOURCE mappedIndices{};
+	if (FAILED(pDeviceContext->Map(m_pCulledIndexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedIndices)))
+		return 0;
+
+	const uint32_t numIndices{ Meshlets::CompactIndices(m_VisibleMeshletRanges, m_MeshletIndexData.data(), m_pMeshCache->GetHeader().indexStride, mappedIndices.pData) };
+	pDeviceContext->Unmap(m_pCulledIndexBuffer, 0);
+
+	return numIndices;
+}
@@ -1,47 +1,86 @@
 #pragma once
 #include "DataTypes.h"
 #include "Effect.h"
-#include "Camera.h"
-#include <fstream>
+#include "FrameConstants.h"
+#include "MeshCache.h"
+#include "Meshlet.h"
+#include "AssetLoader.h"
 
-struct Vertex_Fire
+//Geometry side of a mesh, loaded and clustered on a worker thread
+struct MeshGeometry
 {
-	Vector3 position{};
-	Vector2 uv{};
+	std::unique_ptr<MeshCache> pMeshCache{};
+	std::vector<Meshlet> meshlets{};
+	//Full level of detail with the triangles in meshlet order, GetHeader().indexStride bytes per index
+	std::vector<char> meshletIndexData{};
 };
 
-struct Vertex_Vehicle
+//Everything a Mesh reads from disk. Requested for every mesh before the first one is constructed so all loads overlap
+struct MeshAssets
 {
-	Vector3 position{};
-	Vector3 normal{};
-	Vector3 tangent{};
-	Vector2 uv{};
+	bool isVehicle{ false };
+	std::future<MeshGeometry> geometry{};
+	std::future<ID3DBlob*> effect{};
+	std::future<SDL_Surface*> diffuseMap{};
+	std::future<SDL_Surface*> normalMap{};
+	std::future<SDL_Surface*> specularMap{};
+	std::future<SDL_Surface*> glossinessMap{};
+
+	void Wait() const;
+};
+
+//What a Render call draws, see Renderer::Render
+enum class MeshPass
+{
+	//Depth tested, written and shaded in one go, without a depth pre-pass
+	Color,
+	//Depth pre-pass: positions only, no pixel shader
+	Depth,
+	//Shaded where the depth equals the pre-pass's, the same triangles as the Depth pass of the frame
+	ColorAfterDepth
 };
 
 class Mesh final
 {
 public:
-	Mesh(ID3D11Device* pDeviceInput, const std::string& objPath, const std::string& diffuseMapPath, const Vector3& position);
-	Mesh(ID3D11Device* pDeviceInput, const std::string& objPath, const std::string& diffuseMapPath, const std::string& normalMapPath, const std::string& specularMapPath, const std::string& glossinessMapPath, const Vector3& position);
+	//Waits for the assets and creates the device objects, call on the thread that owns the device
+	Mesh(ID3D11Device* pDeviceInput, MeshAssets& assets, const Vector3& position);
 	~Mesh();
 
+	static MeshAssets RequestFireAssets(AssetLoader& loader, const std::string& objPath, const std::string& diffuseMapPath, bool usePackedVertices = false);
+	static MeshAssets RequestVehicleAssets(AssetLoader& loader, const std::string& objPath, const std::string& diffuseMapPath, const std::string& normalMapPath,
+		const std::string& specularMapPath, const std::string& glossinessMapPath, bool usePackedVertices = false);
+
 	// -----------------------------------------------
 	// Copy/move constructors and assignment operators
 	// -----------------------------------------------
-	Mesh(const Mesh& other)					= default;
-	Mesh(Mesh&& other) noexcept				= default;
-	Mesh& operator=(const Mesh& other)		= default;
-	Mesh& operator=(Mesh&& other) noexcept	= default;
+	Mesh(const Mesh& other)					= delete;
+	Mesh(Mesh&& other) noexcept				= delete;
+	Mesh& operator=(const Mesh& other)		= delete;
+	Mesh& operator=(Mesh&& other) noexcept	= delete;
 
 	//------------------------------------------------
 	// Public member functions						
 	//------------------------------------------------
 	void Update(const Timer* pTimer);
-	void Render(ID3D11DeviceContext* pDeviceContext, Camera* pCamera) const;
+	//Meshes without a depth pass draw nothing in the Depth pass, and the same as Color in ColorAfterDepth
+	void Render(ID3D11DeviceContext* pDeviceContext, const FrameConstants& frameConstants, MeshPass pass = MeshPass::Color);
+	//Only opaque meshes have one: the fire writes no depth and hides nothing behind it
+	bool HasDepthPass() const;
 	ID3D11InputLayout* GetInputLayoutPtr();
 	Effect* GetEffectPtr() const;
 	void ToggleRotation();
 	bool GetIsRotating() const;
+	void ToggleMeshletCulling();
+	bool GetIsMeshletCulling() const;
+	const MeshletCullStatistics& GetMeshletStatistics() const;
+	void ToggleLodSelection();
+	bool GetIsLodSelection() const;
+	uint32_t GetCurrentLod() const;
+	uint32_t GetNumLods() const;
+	const MeshLod& GetLod(uint32_t lod) const;
+	//Object bounds moved by the current world transform, for culling the whole mesh before Render
+	Bounds GetWorldBounds() const;
 
 private:
 
@@ -57,22 +96,49 @@ private:
 	Effect* m_pEffect{};
 	ID3D11InputLayout* m_pInputLayout{};
 
+	//Parsed geometry, memory-mapped from the binary cache next to the OBJ
+	std::unique_ptr<MeshCache> m_pMeshCache{};
+
 	ID3D11Buffer* m_pVertexBuffer{};
 	ID3D11Buffer* m_pIndexBuffer{};
+	DXGI_FORMAT m_IndexFormat{ DXGI_FORMAT_R32_UINT };
+	uint32_t m_VertexStride{};
+
+	//Depth pre-pass stream: only the positions, copied out of the interleaved vertices so the pass reads no other attribute
+	ID3D11Buffer* m_pPositionBuffer{};
+	ID3D11InputLayout* m_pDepthInputLayout{};
+	uint32_t m_PositionStride{};
+
+	//CPU culled clusters, the visible triangles are copied to a dynamic index buffer every frame
+	std::vector<Meshlet> m_Meshlets{};
+	std::vector<char> m_MeshletIndexData{};
+	std::vector<MeshletRange> m_VisibleMeshletRanges{};
+	MeshletCullStatistics m_MeshletStatistics{};
+	ID3D11Buffer* m_pCulledIndexBuffer{};
+	bool m_IsMeshletCulling{ false };
+
+	//Index range of the last Color or Depth pass, ColorAfterDepth draws it again
+	uint32_t m_StartIndex{};
 	uint32_t m_NumIndices{};
+	bool m_IsCulledDraw{ false };
+
+	//Level of detail picked every frame from the projected simplification error, all levels share m_pIndexBuffer
+	uint32_t m_CurrentLod{};
+	bool m_IsLodSelection{ true };
+	Bounds m_Bounds{};
 
 	Texture* m_pNormalMap		{ nullptr };
 	Texture* m_pDiffuseMap		{ nullptr };
 	Texture* m_pSpecularMap		{ nullptr };
 	Texture* m_pGlossinessMap	{ nullptr };
 
-
-	std::vector<Vertex_Vehicle> m_VehicleVertices{};
-	std::vector<Vertex_Fire> m_FireVertices{};
-	std::vector<uint32_t> m_Indices{};
-
-	void ParseFireObj(const std::string& filename);
-
-	bool ParseObj(const std::string& filename, std::vector<Vertex_Vehicle>& vertices, std::vector<uint32_t>& indices, bool flipAxisAndWinding = true);
+	RigidTransform GetWorldTransform() const;
+	void CreateInputLayout(ID3D11Device* pDeviceInput);
+	void CreateBuffers(ID3D11Device* pDeviceInput);
+	void CreateDepthPassResources(ID3D11Device* pDeviceInput);
+	void CreateCulledIndexBuffer(ID3D11Device* pDeviceInput);
+	static MeshGeometry LoadGeometry(const std::string& objPath, const VertexLayout& layout, uint32_t numParseThreads);
+	uint32_t SelectLod(const Matrix& worldMatrix, const FrameConstants& frameConstants) const;
+	uint32_t CullMeshlets(ID3D11DeviceContext* pDeviceContext, const RigidTransform& worldTransform, const Matrix& worldViewProjectionMatrix, const Vector3& cameraPosition);
 };
 
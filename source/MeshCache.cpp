@@ -0,0 +1,341 @@
+#include "pch.h"
+#include "MeshCache.h"
+#include "IndexCodec.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "ObjParser.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <thread>
+#include <type_traits>
+
+namespace dae
+{
+	static_assert(std::is_trivially_copyable_v<MeshCacheHeader>, "MeshCacheHeader is written to disk as raw bytes");
+
+	namespace
+	{
+		//Coarsest level of detail may move the surface by 5% of the mesh extent
+		constexpr float MaxLodError{ 0.05f };
+
+		constexpr uint64_t AlignTo16(uint64_t value)
+		{
+			return (value + 15) & ~uint64_t(15);
+		}
+
+		constexpr uint64_t RotateLeft(uint64_t value, int bits)
+		{
+			return (value << bits) | (value >> (64 - bits));
+		}
+
+		bool WriteCacheFile(const std::string& cachePath, const std::vector<char>& blob)
+		{
+			//Write next to the target and swap it in, so a crash never leaves a half-written cache behind.
+			//The name is unique per writer: two loads of the same OBJ must not truncate or rename each other's file
+			std::ostringstream tempName{};
+			tempName << cachePath << "." << std::this_thread::get_id() << "." << std::random_device{}() << ".tmp";
+			const std::string tempPath{ tempName.str() };
+			{
+				std::ofstream file{ tempPath, std::ios::binary | std::ios::trunc };
+				if (!file)
+					return false;
+
+				file.write(blob.data(), static_cast<std::streamsize>(blob.size()));
+				if (!file)
+					return false;
+			}
+
+			std::error_code error{};
+			std::filesystem::rename(tempPath, cachePath, error);
+			if (error)
+			{
+				std::filesystem::remove(tempPath, error);
+				return false;
+			}
+
+			return true;
+		}
+	}
+
+	MeshCache::MeshCache(const std::string& objPath, const VertexLayout& vertexLayout, bool flipAxisAndWinding, bool compressIndices, uint32_t numParseThreads)
+	{
+		MeshCacheHeader expected{};
+		{
+			const MappedFile sourceFile{ objPath };
+			if (!sourceFile.IsValid())
+			{
+				std::cout << "MeshCache: unable to open " << objPath << "\n";
+				return;
+			}
+
+			//Build flags are not part of the key, so the baked data may not depend on them: ObjParser normalizes the
+			//tangents with Vector3, which stays exact with DAE_FAST_MATH
+			expected.magic = MeshCacheHeader::Magic;
+			expected.version = MeshCacheHeader::Version;
+			expected.sourceSize = sourceFile.GetSize();
+			expected.sourceHash = HashBytes(sourceFile.GetData(), sourceFile.GetSize());
+			expected.flags = (flipAxisAndWinding ? static_cast<uint32_t>(MeshCacheHeader::FlipAxisAndWinding) : 0u)
+				| (compressIndices ? static_cast<uint32_t>(MeshCacheHeader::CompressedIndices) : 0u);
+			expected.vertexLayout = vertexLayout;
+		}
+
+		const std::string cachePath{ GetCachePath(objPath) };
+
+		m_pMappedFile = std::make_unique<MappedFile>(cachePath);
+		if (m_pMappedFile->IsValid() && ReadHeader(m_pMappedFile->GetData(), m_pMappedFile->GetSize(), expected))
+		{
+			m_pData = m_pMappedFile->GetData();
+			if (DecodeIndices())
+			{
+				m_IsValid = true;
+				return;
+			}
+		}
+
+		//Missing or stale: unmap before the file gets replaced
+		m_pMappedFile.reset();
+
+		if (!Rebuild(objPath, expected, numParseThreads) || !DecodeIndices())
+		{
+			std::cout << "MeshCache: unable to parse " << objPath << "\n";
+			return;
+		}
+
+		m_IsValid = true;
+		m_WasRebuilt = true;
+
+		if (!WriteCacheFile(cachePath, m_Blob))
+		{
+			std::cout << "MeshCache: unable to write " << cachePath << ", using the in-memory mesh\n";
+		}
+	}
+
+	bool MeshCache::IsValid() const
+	{
+		return m_IsValid;
+	}
+
+	bool MeshCache::WasRebuilt() const
+	{
+		return m_WasRebuilt;
+	}
+
+	const MeshCacheHeader& MeshCache::GetHeader() const
+	{
+		return m_Header;
+	}
+
+	PositionQuantization MeshCache::GetPositionQuantization() const
+	{
+		return PositionQuantization::FromBounds(m_Header.boundsMin, m_Header.boundsMax);
+	}
+
+	const void* MeshCache::GetVertexData() const
+	{
+		return m_pData + m_Header.vertexDataOffset;
+	}
+
+	const void* MeshCache::GetIndexData() const
+	{
+		return m_DecodedIndices.empty() ? m_pData + m_Header.indexDataOffset : m_DecodedIndices.data();
+	}
+
+	uint32_t MeshCache::GetVertexDataSize() const
+	{
+		return m_Header.numVertices * m_Header.vertexLayout.stride;
+	}
+
+	uint32_t MeshCache::GetIndexDataSize() const
+	{
+		return m_Header.numIndices * m_Header.indexStride;
+	}
+
+	uint32_t MeshCache::GetIndex(uint32_t index) const
+	{
+		if (m_Header.indexStride == sizeof(uint16_t))
+			return static_cast<const uint16_t*>(GetIndexData())[index];
+
+		return static_cast<const uint32_t*>(GetIndexData())[index];
+	}
+
+	std::string MeshCache::GetCachePath(const std::string& objPath)
+	{
+		return objPath + ".meshcache";
+	}
+
+	uint64_t MeshCache::HashBytes(const char* pData, size_t size)
+	{
+		//Multiply-rotate hash over 8-byte words with a Murmur3 finalizer, cheap enough to run on every load
+		constexpr uint64_t prime1{ 0x9E3779B185EBCA87ull };
+		constexpr uint64_t prime2{ 0xC2B2AE3D27D4EB4Full };
+
+		uint64_t hash{ static_cast<uint64_t>(size) * prime1 };
+
+		size_t i{};
+		for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+		{
+			uint64_t word{};
+			std::memcpy(&word, pData + i, sizeof(uint64_t));
+
+			hash ^= RotateLeft(word * prime2, 31) * prime1;
+			hash = RotateLeft(hash, 27) * prime1 + prime2;
+		}
+
+		//Also skips empty files, whose data may be null
+		if (i < size)
+		{
+			uint64_t tail{};
+			std::memcpy(&tail, pData + i, size - i);
+			hash ^= RotateLeft(tail * prime2, 31) * prime1;
+		}
+
+		hash ^= hash >> 33;
+		hash *= 0xff51afd7ed558ccdull;
+		hash ^= hash >> 33;
+		hash *= 0xc4ceb9fe1a85ec53ull;
+		hash ^= hash >> 33;
+		return hash;
+	}
+
+	bool MeshCache::ReadHeader(const char* pData, size_t size, const MeshCacheHeader& expected)
+	{
+		if (size < sizeof(MeshCacheHeader))
+			return false;
+
+		std::memcpy(&m_Header, pData, sizeof(MeshCacheHeader));
+
+		if (m_Header.magic != expected.magic || m_Header.version != expected.version
+			|| m_Header.sourceSize != expected.sourceSize || m_Header.sourceHash != expected.sourceHash
+			|| m_Header.flags != expected.flags || !(m_Header.vertexLayout == expected.vertexLayout))
+		{
+			return false;
+		}
+
+		//Never trust the offsets of a file we did not just write
+		const uint64_t vertexDataEnd{ m_Header.vertexDataOffset + uint64_t(m_Header.numVertices) * m_Header.vertexLayout.stride };
+		const uint64_t indexDataEnd{ m_Header.indexDataOffset + m_Header.indexDataSize };
+		const bool isCompressed{ (m_Header.flags & MeshCacheHeader::CompressedIndices) != 0 };
+
+		if (m_Header.numLods == 0 || m_Header.numLods > MeshCacheHeader::MaxLods)
+			return false;
+
+		for (uint32_t i = 0; i < m_Header.numLods; ++i)
+		{
+			const MeshLod& lod{ m_Header.lods[i] };
+			if (lod.numIndices % 3 != 0 || uint64_t(lod.firstIndex) + lod.numIndices > m_Header.numIndices)
+				return false;
+		}
+
+		return (m_Header.indexStride == sizeof(uint16_t) || m_Header.indexStride == sizeof(uint32_t))
+			&& (isCompressed || m_Header.indexDataSize == uint64_t(m_Header.numIndices) * m_Header.indexStride)
+			&& m_Header.vertexDataOffset >= sizeof(MeshCacheHeader) && vertexDataEnd <= size
+			&& m_Header.indexDataOffset >= vertexDataEnd && indexDataEnd <= size;
+	}
+
+	bool MeshCache::Rebuild(const std::string& objPath, const MeshCacheHeader& expected, uint32_t numParseThreads)
+	{
+		std::vector<Vertex_Vehicle> vertices{};
+		std::vector<uint32_t> indices{};
+
+		if (!ObjParser::ParseObj(objPath, vertices, indices, (expected.flags & MeshCacheHeader::FlipAxisAndWinding) != 0, numParseThreads))
+			return false;
+
+		//Reordering is too slow to redo on every load, so the cache stores the optimized buffers
+		MeshOptimizer::OptimizeVertexCache(indices, static_cast<uint32_t>(vertices.size()));
+		MeshOptimizer::OptimizeVertexFetch(vertices, indices);
+
+		//Simplified levels index the same vertices and follow the full mesh in the index section
+		const std::vector<MeshSimplifier::Lod> lods{ MeshSimplifier::BuildLodChain(vertices, indices, MeshCacheHeader::MaxLods, MaxLodError) };
+
+		MeshCacheHeader header{ expected };
+		header.numLods = static_cast<uint32_t>(lods.size());
+		for (uint32_t i = 0; i < header.numLods; ++i)
+		{
+			header.lods[i] = { static_cast<uint32_t>(i == 0 ? 0 : indices.size()), static_cast<uint32_t>(lods[i].indices.size()), lods[i].error };
+			if (i > 0)
+				indices.insert(indices.end(), lods[i].indices.begin(), lods[i].indices.end());
+		}
+
+		header.numVertices = static_cast<uint32_t>(vertices.size());
+		header.numIndices = static_cast<uint32_t>(indices.size());
+		header.indexStride = header.numVertices <= 0x10000 ? sizeof(uint16_t) : sizeof(uint32_t);
+		header.vertexDataOffset = AlignTo16(sizeof(MeshCacheHeader));
+		header.indexDataOffset = AlignTo16(header.vertexDataOffset + uint64_t(header.numVertices) * header.vertexLayout.stride);
+
+		if (!vertices.empty())
+		{
+			header.boundsMin = vertices.front().position;
+			header.boundsMax = vertices.front().position;
+		}
+
+		for (const Vertex_Vehicle& vertex : vertices)
+		{
+			header.boundsMin = Vector3{ std::min(header.boundsMin.x, vertex.position.x), std::min(header.boundsMin.y, vertex.position.y), std::min(header.boundsMin.z, vertex.position.z) };
+			header.boundsMax = Vector3{ std::max(header.boundsMax.x, vertex.position.x), std::max(header.boundsMax.y, vertex.position.y), std::max(header.boundsMax.z, vertex.position.z) };
+		}
+
+		//Usually well inside the box's half diagonal, so the sphere culls where the box's corners are empty
+		const Vector3 boundsCenter{ (header.boundsMin + header.boundsMax) * 0.5f };
+		float sqrBoundsRadius{};
+		for (const Vertex_Vehicle& vertex : vertices)
+		{
+			sqrBoundsRadius = std::max(sqrBoundsRadius, (vertex.position - boundsCenter).SqrMagnitude());
+		}
+		header.boundsRadius = std::sqrt(sqrBoundsRadius);
+
+		std::vector<uint8_t> indexData{};
+		if ((header.flags & MeshCacheHeader::CompressedIndices) != 0)
+		{
+			indexData = IndexCodec::Encode(indices);
+		}
+		else
+		{
+			indexData.resize(indices.size() * header.indexStride);
+			for (size_t i = 0; i < indices.size(); ++i)
+			{
+				if (header.indexStride == sizeof(uint16_t))
+					reinterpret_cast<uint16_t*>(indexData.data())[i] = static_cast<uint16_t>(indices[i]);
+				else
+					reinterpret_cast<uint32_t*>(indexData.data())[i] = indices[i];
+			}
+		}
+		header.indexDataSize = indexData.size();
+
+		m_Blob.assign(static_cast<size_t>(header.indexDataOffset + header.indexDataSize), 0);
+		std::memcpy(m_Blob.data(), &header, sizeof(MeshCacheHeader));
+
+		const PositionQuantization quantization{ PositionQuantization::FromBounds(header.boundsMin, header.boundsMax) };
+
+		char* pVertexData{ m_Blob.data() + header.vertexDataOffset };
+		for (const Vertex_Vehicle& vertex : vertices)
+		{
+			header.vertexLayout.WriteVertex(vertex, pVertexData, quantization);
+			pVertexData += header.vertexLayout.stride;
+		}
+
+		std::memcpy(m_Blob.data() + header.indexDataOffset, indexData.data(), indexData.size());
+
+		m_Header = header;
+		m_pData = m_Blob.data();
+		return true;
+	}
+
+	bool MeshCache::DecodeIndices()
+	{
+		if ((m_Header.flags & MeshCacheHeader::CompressedIndices) == 0)
+			return true;
+
+		m_DecodedIndices.resize(size_t(m_Header.numIndices) * m_Header.indexStride);
+		const uint8_t* pEncoded{ reinterpret_cast<const uint8_t*>(m_pData + m_Header.indexDataOffset) };
+
+		if (!IndexCodec::Decode(pEncoded, static_cast<size_t>(m_Header.indexDataSize), m_DecodedIndices.data(), m_Header.numIndices, m_Header.indexStride, m_Header.numVertices))
+		{
+			m_DecodedIndices.clear();
+			return false;
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include "MappedFile.h"
+#include "VertexLayout.h"
+#include <memory>
+#include <string>
+
+namespace dae
+{
+	//Index range of one level of detail in the cache's index buffer, all levels share the vertex buffer
+	struct MeshLod
+	{
+		uint32_t firstIndex{};
+		uint32_t numIndices{};
+		float error{};		//object space simplification error, see MeshSimplifier
+	};
+
+	//On-disk header of a binary mesh file, followed by the vertex and index blobs at the given (16-byte aligned) offsets
+	struct MeshCacheHeader
+	{
+		static constexpr uint32_t Magic{ 0x4853454D }; //"MESH"
+		static constexpr uint32_t Version{ 7 };
+		static constexpr uint32_t MaxLods{ 4 };
+
+		enum Flags : uint32_t
+		{
+			FlipAxisAndWinding = 1 << 0,
+			CompressedIndices = 1 << 1		//index section holds IndexCodec data, decoded at load
+		};
+
+		uint32_t magic{};
+		uint32_t version{};
+		uint64_t sourceSize{};
+		uint64_t sourceHash{};
+		uint32_t flags{};
+		uint32_t numVertices{};
+		uint32_t numIndices{};				//every level of detail, lods[0] is the full mesh
+		uint32_t indexStride{};				//2 when every vertex fits a 16-bit index, 4 otherwise
+		uint64_t vertexDataOffset{};
+		uint64_t indexDataOffset{};
+		uint64_t indexDataSize{};			//bytes on disk, smaller than numIndices * indexStride when compressed
+		Vector3 boundsMin{};
+		Vector3 boundsMax{};
+		float boundsRadius{};				//farthest vertex from the center of boundsMin and boundsMax
+		VertexLayout vertexLayout{};
+		uint32_t numLods{};
+		MeshLod lods[MaxLods]{};
+	};
+
+	//Binary cache of a parsed OBJ, written next to the source the first time it is loaded and memory-mapped afterwards.
+	//Triangles and vertices are stored reordered for the post-transform cache and vertex fetch (see MeshOptimizer),
+	//followed by the simplified levels of detail (see MeshSimplifier).
+	//The cache rebuilds itself whenever the source size or hash, the requested vertex layout or the flags change
+	class MeshCache final
+	{
+	public:
+		//numParseThreads: threads ObjParser::ParseObj splits a rebuild over, 0 = one per hardware thread.
+		//Pass 1 when the cache is loaded on a pool worker, the pool already runs the loads side by side
+		MeshCache(const std::string& objPath, const VertexLayout& vertexLayout, bool flipAxisAndWinding = true, bool compressIndices = false, uint32_t numParseThreads = 0);
+		~MeshCache() = default;
+
+		// -----------------------------------------------
+		// Copy/move constructors and assignment operators
+		// -----------------------------------------------
+		MeshCache(const MeshCache& other)					= delete;
+		MeshCache(MeshCache&& other) noexcept				= delete;
+		MeshCache& operator=(const MeshCache& other)		= delete;
+		MeshCache& operator=(MeshCache&& other) noexcept	= delete;
+
+		//------------------------------------------------
+		// Public member functions
+		//------------------------------------------------
+		bool IsValid() const;
+		bool WasRebuilt() const;
+		const MeshCacheHeader& GetHeader() const;
+		//Decode parameters for layouts with VertexFormat::Unorm16x4 positions
+		PositionQuantization GetPositionQuantization() const;
+
+		const void* GetVertexData() const;
+		//Always uncompressed, GetHeader().indexStride bytes per index
+		const void* GetIndexData() const;
+		uint32_t GetVertexDataSize() const;
+		uint32_t GetIndexDataSize() const;
+		uint32_t GetIndex(uint32_t index) const;
+
+		static std::string GetCachePath(const std::string& objPath);
+		static uint64_t HashBytes(const char* pData, size_t size);
+
+	private:
+		//------------------------------------------------
+		// Member Variables
+		//------------------------------------------------
+		MeshCacheHeader m_Header{};
+
+		std::unique_ptr<MappedFile> m_pMappedFile{};
+
+		//Serialized mesh of this run when it had to be rebuilt, also the fallback when the cache cannot be written
+		std::vector<char> m_Blob{};
+		//Decoded index buffer when the cache stores compressed indices
+		std::vector<char> m_DecodedIndices{};
+
+		const char* m_pData{ nullptr };
+		bool m_IsValid{ false };
+		bool m_WasRebuilt{ false };
+
+		//------------------------------------------------
+		// Private member functions
+		//------------------------------------------------
+		bool ReadHeader(const char* pData, size_t size, const MeshCacheHeader& expected);
+		bool Rebuild(const std::string& objPath, const MeshCacheHeader& expected, uint32_t numParseThreads);
+		bool DecodeIndices();
+	};
+}
@@ -0,0 +1,234 @@
+#include "pch.h"
+#include "MeshOptimizer.h"
+#include <cmath>
+
+namespace dae
+{
+	namespace MeshOptimizer
+	{
+		namespace
+		{
+			constexpr uint32_t InvalidIndex{ UINT32_MAX };
+
+			//Tuning constants from Forsyth's "Linear-Speed Vertex Cache Optimisation"
+			constexpr uint32_t CacheSize{ 32 };
+			constexpr uint32_t MaxValence{ 32 };
+			constexpr float CacheDecayPower{ 1.5f };
+			constexpr float LastTriangleScore{ 0.75f };
+			constexpr float ValenceBoostScale{ 2.f };
+			constexpr float ValenceBoostPower{ 0.5f };
+
+			//Scores only depend on the cache position and the number of triangles left, so they are tabulated once
+			struct VertexScoreTable
+			{
+				float cachePosition[CacheSize]{};
+				float valence[MaxValence + 1]{};
+
+				VertexScoreTable()
+				{
+					for (uint32_t i = 0; i < CacheSize; ++i)
+					{
+						//The three vertices of the last triangle get a fixed score so the next triangle does not simply reuse its edge
+						cachePosition[i] = i < 3 ? LastTriangleScore
+							: std::pow(1.f - static_cast<float>(i - 3) / (CacheSize - 3), CacheDecayPower);
+					}
+
+					for (uint32_t i = 1; i <= MaxValence; ++i)
+					{
+						valence[i] = ValenceBoostScale * std::pow(static_cast<float>(i), -ValenceBoostPower);
+					}
+				}
+
+				float GetScore(uint32_t cacheIndex, uint32_t numRemainingTriangles) const
+				{
+					if (numRemainingTriangles == 0)
+						return -1.f;
+
+					//Boost vertices with few triangles left so lone triangles get finished instead of stranded
+					const float score{ valence[std::min(numRemainingTriangles, MaxValence)] };
+					return cacheIndex < CacheSize ? score + cachePosition[cacheIndex] : score;
+				}
+			};
+		}
+
+		void OptimizeVertexCache(std::vector<uint32_t>& indices, uint32_t numVertices)
+		{
+			static const VertexScoreTable scoreTable{};
+
+			const uint32_t numTriangles{ static_cast<uint32_t>(indices.size() / 3) };
+			if (numTriangles == 0)
+				return;
+
+			//Triangles per vertex, stored as one flat array; emitted triangles are swapped out of the live range
+			std::vector<uint32_t> adjacencyOffsets(numVertices + 1, 0);
+			std::vector<uint32_t> numRemaining(numVertices, 0);
+			for (uint32_t i = 0; i < numTriangles * 3; ++i)
+			{
+				++numRemaining[indices[i]];
+			}
+
+			for (uint32_t v = 0; v < numVertices; ++v)
+			{
+				adjacencyOffsets[v + 1] = adjacencyOffsets[v] + numRemaining[v];
+			}
+
+			std::vector<uint32_t> adjacency(numTriangles * 3);
+			{
+				std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+				for (uint32_t i = 0; i < numTriangles * 3; ++i)
+				{
+					adjacency[cursor[indices[i]]++] = i / 3;
+				}
+			}
+
+			std::vector<uint32_t> cacheIndex(numVertices, CacheSize);
+			std::vector<float> vertexScore(numVertices);
+			for (uint32_t v = 0; v < numVertices; ++v)
+			{
+				vertexScore[v] = scoreTable.GetScore(CacheSize, numRemaining[v]);
+			}
+
+			const auto getTriangleScore = [&](uint32_t triangle)
+			{
+				return vertexScore[indices[triangle * 3]] + vertexScore[indices[triangle * 3 + 1]] + vertexScore[indices[triangle * 3 + 2]];
+			};
+
+			//Seed with the best triangle overall, afterwards only triangles touching the cache are candidates
+			uint32_t bestTriangle{};
+			{
+				float bestScore{ -1.f };
+				for (uint32_t t = 0; t < numTriangles; ++t)
+				{
+					const float score{ getTriangleScore(t) };
+					if (score > bestScore)
+					{
+						bestScore = score;
+						bestTriangle = t;
+					}
+				}
+			}
+
+			std::vector<uint8_t> isEmitted(numTriangles, 0);
+			std::vector<uint32_t> output{};
+			output.reserve(numTriangles * 3);
+
+			uint32_t cache[CacheSize + 3]{};
+			uint32_t cacheCount{};
+			uint32_t deadEndCursor{};
+
+			for (uint32_t emitted = 0; emitted < numTriangles; ++emitted)
+			{
+				//Nothing in the cache has triangles left: continue with the next triangle in input order
+				if (bestTriangle == InvalidIndex)
+				{
+					while (isEmitted[deadEndCursor])
+						++deadEndCursor;
+
+					bestTriangle = deadEndCursor;
+				}
+
+				const uint32_t* pTriangle{ &indices[bestTriangle * 3] };
+				output.insert(output.end(), pTriangle, pTriangle + 3);
+				isEmitted[bestTriangle] = 1;
+
+				uint32_t newCache[CacheSize + 3]{};
+				uint32_t newCacheCount{};
+
+				for (uint32_t corner = 0; corner < 3; ++corner)
+				{
+					const uint32_t vertex{ pTriangle[corner] };
+
+					uint32_t* pBegin{ &adjacency[adjacencyOffsets[vertex]] };
+					uint32_t* pEnd{ pBegin + numRemaining[vertex] };
+					*std::find(pBegin, pEnd, bestTriangle) = *(pEnd - 1);
+					--numRemaining[vertex];
+
+					if (std::find(newCache, newCache + newCacheCount, vertex) == newCache + newCacheCount)
+						newCache[newCacheCount++] = vertex;
+				}
+
+				const uint32_t numTriangleVertices{ newCacheCount };
+				for (uint32_t i = 0; i < cacheCount; ++i)
+				{
+					if (std::find(newCache, newCache + numTriangleVertices, cache[i]) == newCache + numTriangleVertices)
+						newCache[newCacheCount++] = cache[i];
+				}
+
+				//Rescore everything that moved, including the vertices that just fell out of the cache
+				for (uint32_t i = 0; i < newCacheCount; ++i)
+				{
+					const uint32_t vertex{ newCache[i] };
+					cacheIndex[vertex] = std::min(i, CacheSize);
+					vertexScore[vertex] = scoreTable.GetScore(cacheIndex[vertex], numRemaining[vertex]);
+				}
+
+				cacheCount = std::min(newCacheCount, CacheSize);
+				std::copy(newCache, newCache + cacheCount, cache);
+
+				bestTriangle = InvalidIndex;
+				float bestScore{ -1.f };
+				for (uint32_t i = 0; i < cacheCount; ++i)
+				{
+					const uint32_t vertex{ cache[i] };
+					const uint32_t* pAdjacent{ &adjacency[adjacencyOffsets[vertex]] };
+
+					for (uint32_t a = 0; a < numRemaining[vertex]; ++a)
+					{
+						const float score{ getTriangleScore(pAdjacent[a]) };
+						if (score > bestScore)
+						{
+							bestScore = score;
+							bestTriangle = pAdjacent[a];
+						}
+					}
+				}
+			}
+
+			indices.swap(output);
+		}
+
+		void OptimizeVertexFetch(std::vector<Vertex_Vehicle>& vertices, std::vector<uint32_t>& indices)
+		{
+			std::vector<uint32_t> remap(vertices.size(), InvalidIndex);
+			std::vector<Vertex_Vehicle> reordered{};
+			reordered.reserve(vertices.size());
+
+			for (uint32_t& index : indices)
+			{
+				if (remap[index] == InvalidIndex)
+				{
+					remap[index] = static_cast<uint32_t>(reordered.size());
+					reordered.push_back(vertices[index]);
+				}
+
+				index = remap[index];
+			}
+
+			vertices.swap(reordered);
+		}
+
+		VertexCacheStatistics AnalyzeVertexCache(const std::vector<uint32_t>& indices, uint32_t numVertices, uint32_t cacheSize)
+		{
+			VertexCacheStatistics statistics{};
+			if (indices.empty() || numVertices == 0)
+				return statistics;
+
+			//FIFO: a vertex is still cached while fewer than cacheSize misses happened since it was inserted
+			std::vector<uint32_t> insertedAt(numVertices, 0);
+			uint32_t time{ cacheSize + 1 };
+
+			for (const uint32_t index : indices)
+			{
+				if (time - insertedAt[index] > cacheSize)
+				{
+					insertedAt[index] = time++;
+					++statistics.numTransforms;
+				}
+			}
+
+			statistics.acmr = static_cast<float>(statistics.numTransforms) / static_cast<float>(indices.size() / 3);
+			statistics.atvr = static_cast<float>(statistics.numTransforms) / static_cast<float>(numVertices);
+			return statistics;
+		}
+	}
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "DataTypes.h"
+
+namespace dae
+{
+	namespace MeshOptimizer
+	{
+		//Result of replaying an index buffer through a simulated FIFO post-transform cache
+		struct VertexCacheStatistics
+		{
+			uint32_t numTransforms{};	//cache misses, i.e. vertex shader invocations
+			float acmr{};				//average cache miss ratio: transforms per triangle (0.5 is the ideal for a regular grid, 3 the worst)
+			float atvr{};				//average transform to vertex ratio: transforms per unique vertex (1 is the ideal)
+		};
+
+		//Reorders the triangles for post-transform cache reuse using Forsyth's linear-speed algorithm.
+		//Only the triangle order changes, winding within a triangle is kept
+		void OptimizeVertexCache(std::vector<uint32_t>& indices, uint32_t numVertices);
+
+		//Renumbers the vertices in the order the index buffer first references them so the vertex fetch walks memory linearly.
+		//Vertices no triangle references are dropped
+		void OptimizeVertexFetch(std::vector<Vertex_Vehicle>& vertices, std::vector<uint32_t>& indices);
+
+		VertexCacheStatistics AnalyzeVertexCache(const std::vector<uint32_t>& indices, uint32_t numVertices, uint32_t cacheSize = 16);
+	}
+}
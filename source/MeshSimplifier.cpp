@@ -0,0 +1,521 @@
+#include "pch.h"
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace dae
+{
+	namespace MeshSimplifier
+	{
+		namespace
+		{
+			enum class VertexKind : uint8_t
+			{
+				Manifold,	//free to collapse onto any neighbour
+				Border,		//single copy on an open edge, slides along the border
+				Seam,		//two copies with different attributes, slides along the seam
+				Locked
+			};
+
+			//Seam and border edges get a plane perpendicular to the surface so they keep their shape
+			constexpr double EdgeWeight{ 10.0 };
+
+			//Sum of weighted squared distances to a set of planes
+			struct Quadric
+			{
+				double a00{}, a11{}, a22{}, a01{}, a02{}, a12{};
+				double b0{}, b1{}, b2{};
+				double c{};
+				double weight{};
+
+				//Plane Dot(normal, p) + distance == 0 with a unit normal
+				void AddPlane(const Vector3& normal, float distance, double planeWeight)
+				{
+					const double x{ normal.x }, y{ normal.y }, z{ normal.z }, d{ distance };
+					a00 += planeWeight * x * x;
+					a11 += planeWeight * y * y;
+					a22 += planeWeight * z * z;
+					a01 += planeWeight * x * y;
+					a02 += planeWeight * x * z;
+					a12 += planeWeight * y * z;
+					b0 += planeWeight * x * d;
+					b1 += planeWeight * y * d;
+					b2 += planeWeight * z * d;
+					c += planeWeight * d * d;
+					weight += planeWeight;
+				}
+
+				void Add(const Quadric& other)
+				{
+					a00 += other.a00; a11 += other.a11; a22 += other.a22;
+					a01 += other.a01; a02 += other.a02; a12 += other.a12;
+					b0 += other.b0; b1 += other.b1; b2 += other.b2;
+					c += other.c;
+					weight += other.weight;
+				}
+
+				//Weighted mean of the squared distances, so it compares to a squared length
+				double GetError(const Vector3& p) const
+				{
+					if (weight <= 0.0)
+						return 0.0;
+
+					const double x{ p.x }, y{ p.y }, z{ p.z };
+					const double error{ a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+						+ 2.0 * (b0 * x + b1 * y + b2 * z) + c };
+					return std::abs(error) / weight;
+				}
+			};
+
+			//Directed edges a->b of a triangle list grouped by a, through an optional vertex remap
+			struct EdgeAdjacency
+			{
+				std::vector<uint32_t> offsets{};
+				std::vector<uint32_t> targets{};
+
+				void Build(const std::vector<uint32_t>& indices, const uint32_t* pRemap, size_t numVertices)
+				{
+					const auto map = [pRemap](uint32_t vertex) { return pRemap ? pRemap[vertex] : vertex; };
+
+					offsets.assign(numVertices + 1, 0);
+					for (const uint32_t index : indices)
+						++offsets[map(index) + 1];
+
+					for (size_t i = 1; i < offsets.size(); ++i)
+						offsets[i] += offsets[i - 1];
+
+					targets.resize(indices.size());
+					std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+					for (size_t i = 0; i + 2 < indices.size(); i += 3)
+					{
+						for (size_t corner = 0; corner < 3; ++corner)
+						{
+							const uint32_t from{ map(indices[i + corner]) };
+							targets[cursor[from]++] = map(indices[i + (corner + 1) % 3]);
+						}
+					}
+				}
+
+				bool HasEdge(uint32_t from, uint32_t to) const
+				{
+					for (uint32_t i = offsets[from]; i < offsets[from + 1]; ++i)
+					{
+						if (targets[i] == to)
+							return true;
+					}
+					return false;
+				}
+			};
+
+			struct Collapse
+			{
+				uint32_t from{};
+				uint32_t to{};
+				double error{};
+			};
+
+			struct PositionHash
+			{
+				size_t operator()(const Vector3& position) const
+				{
+					uint32_t bits[3]{};
+					std::memcpy(bits, &position, sizeof(bits));
+					return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+				}
+			};
+
+			struct PositionEqual
+			{
+				bool operator()(const Vector3& a, const Vector3& b) const
+				{
+					return std::memcmp(&a, &b, sizeof(Vector3)) == 0;
+				}
+			};
+
+			//Every vertex maps to the first used vertex at its position; wedges link the copies at one position in a cycle
+			void BuildPositionRemap(const std::vector<Vertex_Vehicle>& vertices, const std::vector<uint8_t>& isUsed,
+				std::vector<uint32_t>& remap, std::vector<uint32_t>& wedges)
+			{
+				std::unordered_map<Vector3, uint32_t, PositionHash, PositionEqual> firstVertex{};
+				firstVertex.reserve(vertices.size());
+
+				remap.resize(vertices.size());
+				wedges.resize(vertices.size());
+				for (uint32_t i = 0; i < vertices.size(); ++i)
+				{
+					remap[i] = i;
+					wedges[i] = i;
+					if (!isUsed[i])
+						continue;
+
+					const auto [it, isInserted] { firstVertex.emplace(vertices[i].position, i) };
+					if (isInserted)
+						continue;
+
+					remap[i] = it->second;
+					wedges[i] = wedges[it->second];
+					wedges[it->second] = i;
+				}
+			}
+
+			Vector3 GetNormal(const Vector3& p0, const Vector3& p1, const Vector3& p2)
+			{
+				return Vector3::Cross(p1 - p0, p2 - p0);
+			}
+
+			void RemoveDegenerateTriangles(std::vector<uint32_t>& indices, const std::vector<uint32_t>& remap)
+			{
+				size_t writeIndex{};
+				for (size_t i = 0; i + 2 < indices.size(); i += 3)
+				{
+					const uint32_t a{ remap[indices[i]] }, b{ remap[indices[i + 1]] }, c{ remap[indices[i + 2]] };
+					if (a == b || b == c || c == a)
+						continue;
+
+					indices[writeIndex++] = indices[i];
+					indices[writeIndex++] = indices[i + 1];
+					indices[writeIndex++] = indices[i + 2];
+				}
+				indices.resize(writeIndex);
+			}
+		}
+
+		std::vector<uint32_t> Simplify(const std::vector<Vertex_Vehicle>& vertices, const std::vector<uint32_t>& indices,
+			uint32_t targetIndexCount, float maxError, float* pResultError)
+		{
+			const size_t numVertices{ vertices.size() };
+			std::vector<uint32_t> result{ indices };
+			if (pResultError)
+				*pResultError = 0.f;
+
+			std::vector<uint8_t> isUsed(numVertices, 0);
+			for (const uint32_t index : indices)
+				isUsed[index] = 1;
+
+			std::vector<uint32_t> remap{}, wedges{};
+			BuildPositionRemap(vertices, isUsed, remap, wedges);
+			RemoveDegenerateTriangles(result, remap);
+
+			if (result.size() <= targetIndexCount)
+				return result;
+
+			//Unit-sized copy so errors are relative to the mesh extent
+			Vector3 boundsMin{ vertices.empty() ? Vector3{} : vertices.front().position };
+			for (const Vertex_Vehicle& vertex : vertices)
+			{
+				for (int axis = 0; axis < 3; ++axis)
+					boundsMin[axis] = std::min(boundsMin[axis], vertex.position[axis]);
+			}
+
+			const float extent{ GetMeshExtent(vertices) };
+			const float scale{ extent > 0.f ? 1.f / extent : 1.f };
+
+			std::vector<Vector3> positions(numVertices);
+			for (size_t i = 0; i < numVertices; ++i)
+				positions[i] = (vertices[i].position - boundsMin) * scale;
+
+			EdgeAdjacency attributeEdges{}, positionEdges{};
+			attributeEdges.Build(result, nullptr, numVertices);
+			positionEdges.Build(result, remap.data(), numVertices);
+
+			//Classify: an edge is open in position space on a border, open only in attribute space on a seam
+			std::vector<uint32_t> numOpenOut(numVertices, 0), numOpenIn(numVertices, 0);
+			std::vector<uint32_t> numSeamOut(numVertices, 0), numSeamIn(numVertices, 0);
+			for (size_t i = 0; i < result.size(); i += 3)
+			{
+				for (size_t corner = 0; corner < 3; ++corner)
+				{
+					const uint32_t a{ result[i + corner] }, b{ result[i + (corner + 1) % 3] };
+					if (!positionEdges.HasEdge(remap[b], remap[a]))
+					{
+						++numOpenOut[remap[a]];
+						++numOpenIn[remap[b]];
+					}
+					else if (!attributeEdges.HasEdge(b, a))
+					{
+						++numSeamOut[a];
+						++numSeamIn[b];
+					}
+				}
+			}
+
+			std::vector<VertexKind> kinds(numVertices, VertexKind::Locked);
+			for (uint32_t vertex = 0; vertex < numVertices; ++vertex)
+			{
+				if (!isUsed[vertex] || remap[vertex] != vertex)
+					continue;
+
+				uint32_t numWedges{};
+				bool isSeamLine{ true };
+				bool hasSeamEdges{ false };
+				uint32_t wedge{ vertex };
+				do
+				{
+					++numWedges;
+					isSeamLine = isSeamLine && numSeamOut[wedge] == 1 && numSeamIn[wedge] == 1;
+					hasSeamEdges = hasSeamEdges || numSeamOut[wedge] > 0 || numSeamIn[wedge] > 0;
+					wedge = wedges[wedge];
+				} while (wedge != vertex);
+
+				const bool isBorder{ numOpenOut[vertex] > 0 || numOpenIn[vertex] > 0 };
+
+				if (numWedges == 1 && !isBorder && !hasSeamEdges)
+					kinds[vertex] = VertexKind::Manifold;
+				else if (numWedges == 1 && numOpenOut[vertex] == 1 && numOpenIn[vertex] == 1 && !hasSeamEdges)
+					kinds[vertex] = VertexKind::Border;
+				else if (numWedges == 2 && !isBorder && isSeamLine)
+					kinds[vertex] = VertexKind::Seam;
+			}
+
+			//Quadrics live on the first vertex of each position
+			std::vector<Quadric> quadrics(numVertices);
+			for (size_t i = 0; i < result.size(); i += 3)
+			{
+				const uint32_t roots[3]{ remap[result[i]], remap[result[i + 1]], remap[result[i + 2]] };
+				Vector3 normal{ GetNormal(positions[roots[0]], positions[roots[1]], positions[roots[2]]) };
+				const float area{ normal.Normalize() * 0.5f };
+				if (area <= 0.f)
+					continue;
+
+				const float distance{ -Vector3::Dot(normal, positions[roots[0]]) };
+				for (const uint32_t root : roots)
+					quadrics[root].AddPlane(normal, distance, area);
+
+				for (size_t corner = 0; corner < 3; ++corner)
+				{
+					const uint32_t a{ result[i + corner] }, b{ result[i + (corner + 1) % 3] };
+					if (positionEdges.HasEdge(remap[b], remap[a]) && attributeEdges.HasEdge(b, a))
+						continue;
+
+					const Vector3 edge{ positions[remap[b]] - positions[remap[a]] };
+					Vector3 edgeNormal{ Vector3::Cross(edge, normal) };
+					if (edgeNormal.Normalize() <= 0.f)
+						continue;
+
+					const float edgeDistance{ -Vector3::Dot(edgeNormal, positions[remap[a]]) };
+					quadrics[remap[a]].AddPlane(edgeNormal, edgeDistance, edge.SqrMagnitude() * EdgeWeight);
+					quadrics[remap[b]].AddPlane(edgeNormal, edgeDistance, edge.SqrMagnitude() * EdgeWeight);
+				}
+			}
+
+			const double maxErrorSquared{ double(maxError) * maxError };
+			double resultErrorSquared{};
+
+			std::vector<uint32_t> collapseTargets(numVertices);
+			std::vector<uint8_t> isLocked(numVertices);
+			std::vector<uint32_t> triangleOffsets{}, triangleList{};
+			std::vector<Collapse> collapses{};
+
+			while (result.size() > targetIndexCount)
+			{
+				attributeEdges.Build(result, nullptr, numVertices);
+				positionEdges.Build(result, remap.data(), numVertices);
+
+				//Triangles around every position, for the flip test
+				triangleOffsets.assign(numVertices + 1, 0);
+				for (const uint32_t index : result)
+					++triangleOffsets[remap[index] + 1];
+				for (size_t i = 1; i < triangleOffsets.size(); ++i)
+					triangleOffsets[i] += triangleOffsets[i - 1];
+
+				triangleList.resize(result.size());
+				std::vector<uint32_t> cursor(triangleOffsets.begin(), triangleOffsets.end() - 1);
+				for (uint32_t i = 0; i < result.size(); ++i)
+					triangleList[cursor[remap[result[i]]]++] = i / 3;
+
+				const auto canCollapse = [&](uint32_t from, uint32_t to, bool isBorderEdge, bool isSeamEdge)
+				{
+					switch (kinds[remap[from]])
+					{
+					case VertexKind::Manifold:
+						return true;
+					case VertexKind::Border:
+						return isBorderEdge && (kinds[remap[to]] == VertexKind::Border || kinds[remap[to]] == VertexKind::Locked);
+					case VertexKind::Seam:
+						return isSeamEdge && (kinds[remap[to]] == VertexKind::Seam || kinds[remap[to]] == VertexKind::Locked);
+					default:
+						return false;
+					}
+				};
+
+				collapses.clear();
+				for (size_t i = 0; i < result.size(); i += 3)
+				{
+					for (size_t corner = 0; corner < 3; ++corner)
+					{
+						const uint32_t a{ result[i + corner] }, b{ result[i + (corner + 1) % 3] };
+						const bool isBorderEdge{ !positionEdges.HasEdge(remap[b], remap[a]) };
+						const bool isSeamEdge{ !isBorderEdge && !attributeEdges.HasEdge(b, a) };
+
+						Quadric quadric{ quadrics[remap[a]] };
+						quadric.Add(quadrics[remap[b]]);
+
+						if (canCollapse(a, b, isBorderEdge, isSeamEdge))
+							collapses.push_back({ a, b, quadric.GetError(positions[remap[b]]) });
+						if (canCollapse(b, a, isBorderEdge, isSeamEdge))
+							collapses.push_back({ b, a, quadric.GetError(positions[remap[a]]) });
+					}
+				}
+
+				std::sort(collapses.begin(), collapses.end(), [](const Collapse& lhs, const Collapse& rhs) { return lhs.error < rhs.error; });
+
+				for (uint32_t i = 0; i < numVertices; ++i)
+					collapseTargets[i] = i;
+				std::fill(isLocked.begin(), isLocked.end(), uint8_t(0));
+
+				if (collapses.empty())
+					break;
+
+				//Most collapses remove two triangles, stop early enough not to overshoot the target by much
+				const size_t numTrianglesToRemove{ (result.size() - targetIndexCount) / 3 };
+				size_t numTrianglesRemoved{};
+				uint32_t numCollapses{};
+
+				//Locking skips many cheap collapses, don't let the pass walk far past the error the goal needs (1.5x in distance)
+				const double goalError{ collapses[std::min(numTrianglesToRemove / 2, collapses.size() - 1)].error };
+				const double passErrorSquared{ std::min(maxErrorSquared, goalError * 2.25) };
+
+				for (const Collapse& collapse : collapses)
+				{
+					if (collapse.error > passErrorSquared || numTrianglesRemoved >= numTrianglesToRemove)
+						break;
+
+					const uint32_t fromRoot{ remap[collapse.from] }, toRoot{ remap[collapse.to] };
+					if (isLocked[fromRoot] || isLocked[toRoot])
+						continue;
+
+					//Moving the vertex must not turn any remaining triangle around
+					bool isFlipped{ false };
+					for (uint32_t t = triangleOffsets[fromRoot]; t < triangleOffsets[fromRoot + 1] && !isFlipped; ++t)
+					{
+						const uint32_t* pTriangle{ &result[size_t(triangleList[t]) * 3] };
+						Vector3 before[3]{}, after[3]{};
+						bool isCollapsing{ false };
+						for (int corner = 0; corner < 3; ++corner)
+						{
+							const uint32_t root{ remap[pTriangle[corner]] };
+							isCollapsing = isCollapsing || root == toRoot;
+							before[corner] = positions[root];
+							after[corner] = root == fromRoot ? positions[toRoot] : positions[root];
+						}
+
+						if (!isCollapsing)
+							isFlipped = Vector3::Dot(GetNormal(before[0], before[1], before[2]), GetNormal(after[0], after[1], after[2])) <= 0.f;
+					}
+					if (isFlipped)
+						continue;
+
+					//Every copy of the vertex goes to the copy of the target on its side of the seam
+					uint32_t targets[2]{};
+					uint32_t numWedges{};
+					bool isMatched{ true };
+					uint32_t wedge{ fromRoot };
+					do
+					{
+						uint32_t target{ wedge == collapse.from ? collapse.to : ~0u };
+						uint32_t candidate{ toRoot };
+						do
+						{
+							if (target == ~0u && (attributeEdges.HasEdge(wedge, candidate) || attributeEdges.HasEdge(candidate, wedge)))
+								target = candidate;
+							candidate = wedges[candidate];
+						} while (candidate != toRoot);
+
+						isMatched = isMatched && target != ~0u && numWedges < 2 && (numWedges == 0 || target != targets[0]);
+						if (isMatched)
+							targets[numWedges++] = target;
+						wedge = wedges[wedge];
+					} while (wedge != fromRoot && isMatched);
+
+					if (!isMatched)
+						continue;
+
+					wedge = fromRoot;
+					for (uint32_t i = 0; i < numWedges; ++i)
+					{
+						collapseTargets[wedge] = targets[i];
+						wedge = wedges[wedge];
+					}
+
+					quadrics[toRoot].Add(quadrics[fromRoot]);
+					resultErrorSquared = std::max(resultErrorSquared, collapse.error);
+
+					//Lock the whole neighbourhood so the flip test of later collapses in this pass stays valid
+					for (uint32_t t = triangleOffsets[fromRoot]; t < triangleOffsets[fromRoot + 1]; ++t)
+					{
+						for (int corner = 0; corner < 3; ++corner)
+							isLocked[remap[result[size_t(triangleList[t]) * 3 + corner]]] = 1;
+					}
+					isLocked[toRoot] = 1;
+
+					numTrianglesRemoved += kinds[fromRoot] == VertexKind::Manifold || kinds[fromRoot] == VertexKind::Seam ? 2 : 1;
+					++numCollapses;
+				}
+
+				if (numCollapses == 0)
+					break;
+
+				for (uint32_t& index : result)
+					index = collapseTargets[index];
+
+				RemoveDegenerateTriangles(result, remap);
+			}
+
+			if (pResultError)
+				*pResultError = static_cast<float>(std::sqrt(resultErrorSquared));
+
+			return result;
+		}
+
+		std::vector<Lod> BuildLodChain(const std::vector<Vertex_Vehicle>& vertices, const std::vector<uint32_t>& indices, uint32_t maxLods, float maxError)
+		{
+			std::vector<Lod> lods{};
+			lods.push_back({ indices, 0.f });
+
+			const float extent{ GetMeshExtent(vertices) };
+			for (uint32_t level = 1; level < maxLods; ++level)
+			{
+				const size_t previousSize{ lods.back().indices.size() };
+				const uint32_t targetIndexCount{ static_cast<uint32_t>((indices.size() >> level) / 3 * 3) };
+
+				float relativeError{};
+				std::vector<uint32_t> lodIndices{ Simplify(vertices, indices, targetIndexCount, maxError, &relativeError) };
+
+				//Less than 10% fewer triangles is not worth a level
+				if (lodIndices.empty() || lodIndices.size() * 10 > previousSize * 9)
+					break;
+
+				MeshOptimizer::OptimizeVertexCache(lodIndices, static_cast<uint32_t>(vertices.size()));
+				lods.push_back({ std::move(lodIndices), relativeError * extent });
+			}
+
+			return lods;
+		}
+
+		float GetScreenSpaceError(float error, float distance, float projectionScale, float screenHeight)
+		{
+			return error * projectionScale * 0.5f * screenHeight / std::max(distance, 1e-4f);
+		}
+
+		float GetMeshExtent(const std::vector<Vertex_Vehicle>& vertices)
+		{
+			if (vertices.empty())
+				return 0.f;
+
+			Vector3 boundsMin{ vertices.front().position }, boundsMax{ boundsMin };
+			for (const Vertex_Vehicle& vertex : vertices)
+			{
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					boundsMin[axis] = std::min(boundsMin[axis], vertex.position[axis]);
+					boundsMax[axis] = std::max(boundsMax[axis], vertex.position[axis]);
+				}
+			}
+
+			const Vector3 size{ boundsMax - boundsMin };
+			return std::max(size.x, std::max(size.y, size.z));
+		}
+	}
+}
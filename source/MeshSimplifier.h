@@ -0,0 +1,34 @@
+#pragma once
+#include "DataTypes.h"
+
+namespace dae
+{
+	namespace MeshSimplifier
+	{
+		struct Lod
+		{
+			std::vector<uint32_t> indices{};
+			float error{};		//object space distance the surface moved, 0 for the source mesh
+		};
+
+		//Collapses edges in order of quadric error (Garland-Heckbert) until at most targetIndexCount indices remain or the next
+		//collapse would move the surface further than maxError, both errors relative to GetMeshExtent.
+		//Vertices only ever collapse onto a neighbour, so the result indexes the same vertex buffer.
+		//Vertices on a uv/normal seam or an open border only slide along it, every copy of a seam vertex moving together;
+		//vertices where seams or borders meet stay locked
+		std::vector<uint32_t> Simplify(const std::vector<Vertex_Vehicle>& vertices, const std::vector<uint32_t>& indices,
+			uint32_t targetIndexCount, float maxError, float* pResultError = nullptr);
+
+		//Level 0 is the source mesh, every further level aims for half the triangles of the one before and is cache-optimized.
+		//Levels are simplified from the source so errors don't accumulate; the chain ends early when the simplifier
+		//stops making progress (locked seams) or the next level would exceed maxError
+		std::vector<Lod> BuildLodChain(const std::vector<Vertex_Vehicle>& vertices, const std::vector<uint32_t>& indices, uint32_t maxLods, float maxError);
+
+		//Height in pixels an object space error covers at the given distance.
+		//projectionScale is element [1][1] of the projection matrix (1 / tan(fov / 2))
+		float GetScreenSpaceError(float error, float distance, float projectionScale, float screenHeight);
+
+		//Largest side of the bounding box
+		float GetMeshExtent(const std::vector<Vertex_Vehicle>& vertices);
+	}
+}
@@ -0,0 +1,380 @@
+#include "pch.h"
+#include "Meshlet.h"
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace dae
+{
+	namespace Meshlets
+	{
+		namespace
+		{
+			//Candidate cost: its new vertices plus ConeWeight * (1 - dot with the cone axis), so a triangle turned 60 degrees
+			//away costs as much as one new vertex
+			constexpr float ConeWeight{ 2.f };
+			//Candidates more than 60 degrees off the cone axis end the meshlet. Looser limits give fewer, larger meshlets
+			//that are rarely back-facing as a whole: at 0 (90 degrees) the vehicle still submits over 90% of its triangles from every side
+			constexpr float MinConeDot{ 0.5f };
+
+			struct PositionHash
+			{
+				size_t operator()(const Vector3& position) const
+				{
+					uint32_t bits[3]{};
+					std::memcpy(bits, &position, sizeof(bits));
+					return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+				}
+			};
+
+			struct PositionEqual
+			{
+				bool operator()(const Vector3& a, const Vector3& b) const
+				{
+					return std::memcmp(&a, &b, sizeof(Vector3)) == 0;
+				}
+			};
+
+			//Every vertex maps to the first vertex at its position, so hard edges and texture seams stay connected
+			std::vector<uint32_t> BuildPositionRemap(const std::vector<Vertex_Vehicle>& vertices)
+			{
+				std::unordered_map<Vector3, uint32_t, PositionHash, PositionEqual> firstVertex{};
+				firstVertex.reserve(vertices.size());
+
+				std::vector<uint32_t> remap(vertices.size());
+				for (uint32_t i = 0; i < vertices.size(); ++i)
+				{
+					remap[i] = firstVertex.emplace(vertices[i].position, i).first->second;
+				}
+				return remap;
+			}
+
+			Vector3 GetFaceNormal(const std::vector<Vertex_Vehicle>& vertices, const uint32_t* pTriangle)
+			{
+				const Vector3& p0{ vertices[pTriangle[0]].position };
+				return Vector3::Cross(vertices[pTriangle[1]].position - p0, vertices[pTriangle[2]].position - p0);
+			}
+
+			//+1 or -1 to turn the winding normal outwards, 0 when there are no vertex normals to compare with
+			float GetWindingSign(const std::vector<Vertex_Vehicle>& vertices, const std::vector<uint32_t>& indices)
+			{
+				double agreement{};
+				for (size_t i = 0; i + 2 < indices.size(); i += 3)
+				{
+					const Vector3 vertexNormals{ vertices[indices[i]].normal + vertices[indices[i + 1]].normal + vertices[indices[i + 2]].normal };
+					agreement += Vector3::Dot(GetFaceNormal(vertices, &indices[i]).Normalized(), vertexNormals);
+				}
+
+				if (agreement == 0.0)
+					return 0.f;
+				return agreement > 0.0 ? 1.f : -1.f;
+			}
+
+			void ComputeBounds(Meshlet& meshlet, const std::vector<Vertex_Vehicle>& vertices, const std::vector<uint32_t>& indices, float windingSign)
+			{
+				const uint32_t firstIndex{ meshlet.firstTriangle * 3 };
+				const uint32_t endIndex{ firstIndex + meshlet.numTriangles * 3 };
+
+				Vector3 boundsMin{ vertices[indices[firstIndex]].position }, boundsMax{ boundsMin };
+				for (uint32_t i = firstIndex; i < endIndex; ++i)
+				{
+					const Vector3& position{ vertices[indices[i]].position };
+					for (int axis = 0; axis < 3; ++axis)
+					{
+						boundsMin[axis] = std::min(boundsMin[axis], position[axis]);
+						boundsMax[axis] = std::max(boundsMax[axis], position[axis]);
+					}
+				}
+
+				meshlet.center = (boundsMin + boundsMax) * 0.5f;
+				for (uint32_t i = firstIndex; i < endIndex; ++i)
+				{
+					meshlet.radius = std::max(meshlet.radius, (vertices[indices[i]].position - meshlet.center).Magnitude());
+				}
+
+				if (windingSign == 0.f)
+					return;
+
+				//Cone axis: average facing, the cutoff follows from the normal furthest away from it
+				struct Face
+				{
+					Vector3 normal;
+					Vector3 point;
+				};
+
+				std::vector<Face> faces{};
+				faces.reserve(meshlet.numTriangles);
+				Vector3 axis{};
+				for (uint32_t i = firstIndex; i < endIndex; i += 3)
+				{
+					Vector3 normal{ GetFaceNormal(vertices, &indices[i]) * windingSign };
+					if (normal.Normalize() <= 0.f)
+						continue;
+
+					faces.push_back({ normal, vertices[indices[i]].position });
+					axis += normal;
+				}
+
+				if (faces.empty() || axis.Normalize() <= 0.f)
+					return;
+
+				float minDot{ 1.f };
+				for (const Face& face : faces)
+				{
+					minDot = std::min(minDot, Vector3::Dot(face.normal, axis));
+				}
+
+				//Wider than a hemisphere, some triangle always faces the viewer
+				if (minDot <= 0.f)
+					return;
+
+				//Move the apex back along the axis until it lies behind every triangle plane
+				float maxT{};
+				for (const Face& face : faces)
+				{
+					const float distance{ Vector3::Dot(meshlet.center - face.point, face.normal) };
+					maxT = std::max(maxT, distance / Vector3::Dot(axis, face.normal));
+				}
+
+				meshlet.coneAxis = axis;
+				meshlet.coneApex = meshlet.center - axis * maxT;
+				meshlet.coneCutoff = std::sqrt(1.f - minDot * minDot);
+			}
+		}
+
+		std::vector<Meshlet> Build(const std::vector<Vertex_Vehicle>& vertices, std::vector<uint32_t>& indices, uint32_t maxVertices, uint32_t maxTriangles)
+		{
+			std::vector<Meshlet> meshlets{};
+			if (indices.size() < 3 || maxVertices < 3 || maxTriangles < 1)
+				return meshlets;
+
+			const uint32_t numTriangles{ static_cast<uint32_t>(indices.size() / 3) };
+			const uint32_t numVertices{ static_cast<uint32_t>(vertices.size()) };
+			const float windingSign{ GetWindingSign(vertices, indices) };
+
+			//Outward unit face normals, zero for degenerate triangles or without vertex normals
+			std::vector<Vector3> faceNormals(numTriangles);
+			if (windingSign != 0.f)
+			{
+				for (uint32_t triangle = 0; triangle < numTriangles; ++triangle)
+				{
+					faceNormals[triangle] = GetFaceNormal(vertices, &indices[triangle * 3]) * windingSign;
+					if (faceNormals[triangle].Normalize() <= 0.f)
+						faceNormals[triangle] = Vector3{};
+				}
+			}
+
+			//Triangles around each position, a repeated corner lists the triangle once
+			const std::vector<uint32_t> positionRemap{ BuildPositionRemap(vertices) };
+			const auto isRepeatedCorner = [&](uint32_t i)
+			{
+				const uint32_t first{ i - i % 3 };
+				return (i > first && positionRemap[indices[i]] == positionRemap[indices[first]])
+					|| (i > first + 1 && positionRemap[indices[i]] == positionRemap[indices[first + 1]]);
+			};
+
+			std::vector<uint32_t> adjacencyOffsets(numVertices + 1, 0);
+			for (uint32_t i = 0; i < numTriangles * 3; ++i)
+			{
+				if (!isRepeatedCorner(i))
+					++adjacencyOffsets[positionRemap[indices[i]] + 1];
+			}
+			for (uint32_t vertex = 0; vertex < numVertices; ++vertex)
+				adjacencyOffsets[vertex + 1] += adjacencyOffsets[vertex];
+
+			std::vector<uint32_t> adjacentTriangles(adjacencyOffsets.back());
+			{
+				std::vector<uint32_t> writeOffsets(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+				for (uint32_t i = 0; i < numTriangles * 3; ++i)
+				{
+					if (!isRepeatedCorner(i))
+						adjacentTriangles[writeOffsets[positionRemap[indices[i]]]++] = i / 3;
+				}
+			}
+
+			//Meshlet index + 1 that last used each vertex or position or listed each candidate, saves clearing a set per meshlet
+			std::vector<uint32_t> lastMeshlet(numVertices, 0);
+			std::vector<uint32_t> lastPosition(numVertices, 0);
+			std::vector<uint32_t> lastCandidate(numTriangles, 0);
+			std::vector<bool> isEmitted(numTriangles, false);
+
+			std::vector<uint32_t> order{};
+			order.reserve(numTriangles);
+			std::vector<uint32_t> candidates{};
+			uint32_t nextUnemitted{};
+
+			while (order.size() < numTriangles)
+			{
+				const uint32_t stamp{ static_cast<uint32_t>(meshlets.size() + 1) };
+				Meshlet current{};
+				current.firstTriangle = static_cast<uint32_t>(order.size());
+				Vector3 normalSum{}, coneAxis{};
+
+				const auto countNewVertices = [&](uint32_t triangle)
+				{
+					const uint32_t* pTriangle{ &indices[triangle * 3] };
+					uint32_t count{};
+					for (int corner = 0; corner < 3; ++corner)
+					{
+						const bool isRepeated{ (corner > 0 && pTriangle[corner] == pTriangle[0]) || (corner > 1 && pTriangle[corner] == pTriangle[1]) };
+						if (!isRepeated && lastMeshlet[pTriangle[corner]] != stamp)
+							++count;
+					}
+					return count;
+				};
+
+				const auto addTriangle = [&](uint32_t triangle, uint32_t numNewVertices)
+				{
+					isEmitted[triangle] = true;
+					order.push_back(triangle);
+					current.numVertices += numNewVertices;
+					++current.numTriangles;
+
+					normalSum += faceNormals[triangle];
+					coneAxis = normalSum;
+					if (coneAxis.Normalize() <= 0.f)
+						coneAxis = Vector3{};
+
+					for (int corner = 0; corner < 3; ++corner)
+					{
+						const uint32_t vertex{ indices[triangle * 3 + corner] };
+						lastMeshlet[vertex] = stamp;
+
+						const uint32_t position{ positionRemap[vertex] };
+						if (lastPosition[position] == stamp)
+							continue;
+
+						lastPosition[position] = stamp;
+						for (uint32_t i = adjacencyOffsets[position]; i < adjacencyOffsets[position + 1]; ++i)
+						{
+							const uint32_t neighbor{ adjacentTriangles[i] };
+							if (!isEmitted[neighbor] && lastCandidate[neighbor] != stamp)
+							{
+								lastCandidate[neighbor] = stamp;
+								candidates.push_back(neighbor);
+							}
+						}
+					}
+				};
+
+				//Seed in index order, which the vertex cache optimization already keeps spatially coherent
+				while (isEmitted[nextUnemitted])
+					++nextUnemitted;
+
+				candidates.clear();
+				addTriangle(nextUnemitted, countNewVertices(nextUnemitted));
+
+				//Grow over shared positions, cheapest candidate first. Stop rather than take a triangle past MinConeDot,
+				//a meshlet with a wide cone is never back-face culled
+				while (current.numTriangles < maxTriangles)
+				{
+					const bool hasAxis{ coneAxis.SqrMagnitude() > 0.f };
+					uint32_t bestCandidate{}, bestNewVertices{};
+					float bestCost{ FLT_MAX };
+
+					for (size_t i = 0; i < candidates.size();)
+					{
+						const uint32_t triangle{ candidates[i] };
+						//Too many new vertices now means too many for the rest of this meshlet as well
+						if (isEmitted[triangle] || current.numVertices + countNewVertices(triangle) > maxVertices)
+						{
+							candidates[i] = candidates.back();
+							candidates.pop_back();
+							continue;
+						}
+
+						const uint32_t numNewVertices{ countNewVertices(triangle) };
+
+						//Degenerate triangles and an axis that cancelled out leave the cone as it is
+						const float coneDot{ hasAxis && faceNormals[triangle].SqrMagnitude() > 0.f ? Vector3::Dot(faceNormals[triangle], coneAxis) : 1.f };
+						const float cost{ static_cast<float>(numNewVertices) + ConeWeight * (1.f - coneDot) };
+						if (coneDot >= MinConeDot && cost < bestCost)
+						{
+							bestCost = cost;
+							bestCandidate = triangle;
+							bestNewVertices = numNewVertices;
+						}
+						++i;
+					}
+
+					if (bestCost == FLT_MAX)
+						break;
+
+					addTriangle(bestCandidate, bestNewVertices);
+				}
+
+				meshlets.push_back(current);
+			}
+
+			//Meshlets become contiguous triangle ranges
+			std::vector<uint32_t> reordered(size_t(numTriangles) * 3);
+			for (uint32_t i = 0; i < numTriangles; ++i)
+			{
+				std::memcpy(&reordered[i * 3], &indices[order[i] * 3], 3 * sizeof(uint32_t));
+			}
+			reordered.insert(reordered.end(), indices.begin() + numTriangles * 3, indices.end());
+			indices.swap(reordered);
+
+			for (Meshlet& meshlet : meshlets)
+			{
+				ComputeBounds(meshlet, vertices, indices, windingSign);
+			}
+
+			return meshlets;
+		}
+
+		void Cull(const std::vector<Meshlet>& meshlets, const Matrix& worldViewProjection, const Vector3& cameraPosition, bool cullBackFacing,
+			std::vector<MeshletRange>& visibleRanges, MeshletCullStatistics& statistics)
+		{
+			visibleRanges.clear();
+			statistics = MeshletCullStatistics{};
+
+			const Frustum frustum{ Frustum::FromMatrix(worldViewProjection) };
+
+			for (const Meshlet& meshlet : meshlets)
+			{
+				++statistics.numTested;
+				statistics.numTrianglesTotal += meshlet.numTriangles;
+
+				if (!frustum.IsSphereVisible(meshlet.center, meshlet.radius))
+				{
+					++statistics.numFrustumCulled;
+					continue;
+				}
+
+				if (cullBackFacing && meshlet.coneCutoff < 1.f)
+				{
+					const Vector3 toApex{ (meshlet.coneApex - cameraPosition).Normalized() };
+					if (Vector3::Dot(toApex, meshlet.coneAxis) >= meshlet.coneCutoff)
+					{
+						++statistics.numBackFacingCulled;
+						continue;
+					}
+				}
+
+				statistics.numTrianglesSubmitted += meshlet.numTriangles;
+				if (!visibleRanges.empty() && visibleRanges.back().firstTriangle + visibleRanges.back().numTriangles == meshlet.firstTriangle)
+					visibleRanges.back().numTriangles += meshlet.numTriangles;
+				else
+					visibleRanges.push_back({ meshlet.firstTriangle, meshlet.numTriangles });
+			}
+		}
+
+		uint32_t CompactIndices(const std::vector<MeshletRange>& visibleRanges, const void* pIndices, uint32_t indexStride, void* pDestination)
+		{
+			const char* pSource{ static_cast<const char*>(pIndices) };
+			char* pWrite{ static_cast<char*>(pDestination) };
+
+			uint32_t numIndices{};
+			for (const MeshletRange& range : visibleRanges)
+			{
+				const size_t rangeBytes{ size_t(range.numTriangles) * 3 * indexStride };
+				std::memcpy(pWrite, pSource + size_t(range.firstTriangle) * 3 * indexStride, rangeBytes);
+				pWrite += rangeBytes;
+				numIndices += range.numTriangles * 3;
+			}
+
+			return numIndices;
+		}
+	}
+}
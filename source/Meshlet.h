@@ -0,0 +1,62 @@
+#pragma once
+#include "DataTypes.h"
+#include "Frustum.h"
+
+namespace dae
+{
+	//Cluster of at most MaxVertices unique vertices and MaxTriangles triangles.
+	//D3D11 has no mesh shaders, so a meshlet is a contiguous triangle range of the index buffer
+	//and culling happens on the CPU before the draw
+	struct Meshlet
+	{
+		static constexpr uint32_t MaxVertices{ 64 };
+		static constexpr uint32_t MaxTriangles{ 124 };
+
+		uint32_t firstTriangle{};
+		uint32_t numTriangles{};
+		uint32_t numVertices{};
+
+		//Bounding sphere
+		Vector3 center{};
+		float radius{};
+
+		//Normal cone: every triangle faces away from a viewer inside the cone of directions around -coneAxis through coneApex.
+		//A coneCutoff of 1 means the triangles spread too far to ever be back-facing together
+		Vector3 coneApex{};
+		Vector3 coneAxis{};
+		float coneCutoff{ 1.f };
+	};
+
+	//Triangles that survived culling, adjacent meshlets merged into one range
+	struct MeshletRange
+	{
+		uint32_t firstTriangle{};
+		uint32_t numTriangles{};
+	};
+
+	struct MeshletCullStatistics
+	{
+		uint32_t numTested{};
+		uint32_t numFrustumCulled{};
+		uint32_t numBackFacingCulled{};
+		uint32_t numTrianglesSubmitted{};
+		uint32_t numTrianglesTotal{};
+	};
+
+	namespace Meshlets
+	{
+		//Grows each meshlet from a seed triangle over shared vertices, keeping its face normals close together, and reorders
+		//the triangles of indices so every meshlet is a contiguous range. Face normals are oriented to agree with the vertex normals;
+		//without vertex normals (all zero) the meshlets get no cone and are only frustum culled
+		std::vector<Meshlet> Build(const std::vector<Vertex_Vehicle>& vertices, std::vector<uint32_t>& indices,
+			uint32_t maxVertices = Meshlet::MaxVertices, uint32_t maxTriangles = Meshlet::MaxTriangles);
+
+		//Tests in object space: pass world * view * projection and the camera position transformed by the inverse world matrix.
+		//Clears visibleRanges and overwrites statistics
+		void Cull(const std::vector<Meshlet>& meshlets, const Matrix& worldViewProjection, const Vector3& cameraPosition, bool cullBackFacing,
+			std::vector<MeshletRange>& visibleRanges, MeshletCullStatistics& statistics);
+
+		//Copies the visible triangles' indices (indexStride 2 or 4 bytes) to pDestination, returns the number of indices written
+		uint32_t CompactIndices(const std::vector<MeshletRange>& visibleRanges, const void* pIndices, uint32_t indexStride, void* pDestination);
+	}
+}
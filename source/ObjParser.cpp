@@ -0,0 +1,723 @@
+#include "pch.h"
+#include "ObjParser.h"
+#include "MappedFile.h"
+#include "ObjVertexKey.h"
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+namespace dae
+{
+	namespace
+	{
+		//------------------------------------------------
+		// Tokenizer
+		//------------------------------------------------
+		constexpr double g_PowersOfTen[]
+		{
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+		};
+
+		inline bool IsBlank(char c)
+		{
+			return c == ' ' || c == '\t' || c == '\r';
+		}
+
+		inline bool IsDigit(char c)
+		{
+			return static_cast<unsigned char>(c - '0') < 10;
+		}
+
+		inline const char* SkipBlanks(const char* pCurrent, const char* pEnd)
+		{
+			while (pCurrent < pEnd && IsBlank(*pCurrent))
+				++pCurrent;
+
+			return pCurrent;
+		}
+
+		inline const char* SkipLine(const char* pCurrent, const char* pEnd)
+		{
+			const void* pNewLine{ std::memchr(pCurrent, '\n', static_cast<size_t>(pEnd - pCurrent)) };
+			return pNewLine ? static_cast<const char*>(pNewLine) + 1 : pEnd;
+		}
+
+		//Decimal float with optional sign, fraction and exponent. Up to 19 significant digits are gathered in an
+		//integer and scaled once by an exact power of ten, which is correctly rounded for the values OBJ exporters write
+		const char* ParseFloat(const char* pCurrent, const char* pEnd, float& value)
+		{
+			pCurrent = SkipBlanks(pCurrent, pEnd);
+
+			bool isNegative{ false };
+			if (pCurrent < pEnd && (*pCurrent == '-' || *pCurrent == '+'))
+			{
+				isNegative = *pCurrent == '-';
+				++pCurrent;
+			}
+
+			uint64_t mantissa{};
+			int exponent{};
+			int numDigits{};
+
+			for (; pCurrent < pEnd && IsDigit(*pCurrent); ++pCurrent)
+			{
+				if (numDigits < 19)
+				{
+					mantissa = mantissa * 10 + static_cast<uint64_t>(*pCurrent - '0');
+					numDigits += mantissa != 0;
+				}
+				else
+				{
+					++exponent;
+				}
+			}
+
+			if (pCurrent < pEnd && *pCurrent == '.')
+			{
+				for (++pCurrent; pCurrent < pEnd && IsDigit(*pCurrent); ++pCurrent)
+				{
+					if (numDigits < 19)
+					{
+						mantissa = mantissa * 10 + static_cast<uint64_t>(*pCurrent - '0');
+						numDigits += mantissa != 0;
+						--exponent;
+					}
+				}
+			}
+
+			if (pCurrent < pEnd && (*pCurrent == 'e' || *pCurrent == 'E'))
+			{
+				++pCurrent;
+
+				bool isExponentNegative{ false };
+				if (pCurrent < pEnd && (*pCurrent == '-' || *pCurrent == '+'))
+				{
+					isExponentNegative = *pCurrent == '-';
+					++pCurrent;
+				}
+
+				int explicitExponent{};
+				for (; pCurrent < pEnd && IsDigit(*pCurrent); ++pCurrent)
+				{
+					if (explicitExponent < 10000)
+						explicitExponent = explicitExponent * 10 + (*pCurrent - '0');
+				}
+
+				exponent += isExponentNegative ? -explicitExponent : explicitExponent;
+			}
+
+			double result{ static_cast<double>(mantissa) };
+			if (exponent < 0)
+			{
+				result = exponent >= -22 ? result / g_PowersOfTen[-exponent] : result * std::pow(10.0, exponent);
+			}
+			else if (exponent > 0)
+			{
+				result = exponent <= 22 ? result * g_PowersOfTen[exponent] : result * std::pow(10.0, exponent);
+			}
+
+			value = static_cast<float>(isNegative ? -result : result);
+			return pCurrent;
+		}
+
+		//Signed OBJ index, resolved to a 1-based absolute index (negative values count back from the current end)
+		const char* ParseIndex(const char* pCurrent, const char* pEnd, size_t numElements, uint32_t& index)
+		{
+			bool isNegative{ false };
+			if (pCurrent < pEnd && *pCurrent == '-')
+			{
+				isNegative = true;
+				++pCurrent;
+			}
+
+			//Stops accumulating past UINT32_MAX so a long run of digits can't overflow, but still consumes them
+			int64_t value{};
+			for (; pCurrent < pEnd && IsDigit(*pCurrent); ++pCurrent)
+			{
+				if (value <= UINT32_MAX)
+					value = value * 10 + (*pCurrent - '0');
+			}
+
+			if (value > UINT32_MAX)
+			{
+				index = 0;
+				return pCurrent;
+			}
+
+			if (isNegative)
+				value = static_cast<int64_t>(numElements) - value + 1;
+
+			index = value > 0 && value <= UINT32_MAX ? static_cast<uint32_t>(value) : 0;
+			return pCurrent;
+		}
+
+		inline const char* SkipIndex(const char* pCurrent, const char* pEnd)
+		{
+			if (pCurrent < pEnd && *pCurrent == '-')
+				++pCurrent;
+
+			while (pCurrent < pEnd && IsDigit(*pCurrent))
+				++pCurrent;
+
+			return pCurrent;
+		}
+
+		//Advances over one face corner exactly like ParseCorner reads it, without resolving the indices
+		inline const char* SkipCorner(const char* pCurrent, const char* pEnd)
+		{
+			pCurrent = SkipIndex(pCurrent, pEnd);
+
+			if (pCurrent < pEnd && *pCurrent == '/')
+			{
+				++pCurrent;
+
+				if (pCurrent < pEnd && *pCurrent != '/')
+					pCurrent = SkipIndex(pCurrent, pEnd);
+
+				if (pCurrent < pEnd && *pCurrent == '/')
+					pCurrent = SkipIndex(pCurrent + 1, pEnd);
+			}
+
+			return pCurrent;
+		}
+
+		//------------------------------------------------
+		// Records
+		//------------------------------------------------
+		struct ObjCounts
+		{
+			size_t positions{};
+			size_t normals{};
+			size_t UVs{};
+			size_t triangles{};
+		};
+
+		//Attribute streams shared by every chunk, sized up front so each chunk writes its own range without locking
+		struct ObjAttributes
+		{
+			std::vector<Vector3> positions{};
+			std::vector<Vector3> normals{};
+			std::vector<Vector2> UVs{};
+		};
+
+		//Line-aligned slice of the file
+		struct ObjChunk
+		{
+			std::string_view text{};
+			ObjCounts counts{};
+
+			//Prefix sum of the counts of all previous chunks, where this chunk's attributes start
+			ObjCounts first{};
+
+			//Three corners per triangle, in file winding
+			std::vector<ObjVertexKey> corners{};
+		};
+
+		//Largest chunk count is size / g_MinChunkSize, so small files are never split into thread-sized crumbs
+		constexpr size_t g_MinChunkSize{ 64 * 1024 };
+
+		//Cheap line pre-pass so every array is allocated exactly once
+		ObjCounts CountRecords(std::string_view text)
+		{
+			ObjCounts counts{};
+
+			const char* pCurrent{ text.data() };
+			const char* pEnd{ text.data() + text.size() };
+			while (pCurrent < pEnd)
+			{
+				//Must classify lines exactly like ParseChunk, which writes into the ranges sized from these counts
+				pCurrent = SkipBlanks(pCurrent, pEnd);
+				if (pCurrent + 1 >= pEnd)
+					break;
+
+				if (pCurrent[0] == 'v')
+				{
+					counts.positions += IsBlank(pCurrent[1]);
+					counts.UVs += pCurrent[1] == 't';
+					counts.normals += pCurrent[1] == 'n';
+				}
+				else if (pCurrent[0] == 'f' && IsBlank(pCurrent[1]))
+				{
+					//Polygons are fan-triangulated, n corners make n - 2 triangles
+					size_t numCorners{};
+					pCurrent = SkipBlanks(pCurrent + 1, pEnd);
+					while (pCurrent < pEnd && (IsDigit(*pCurrent) || *pCurrent == '-'))
+					{
+						pCurrent = SkipCorner(pCurrent, pEnd);
+						++numCorners;
+						pCurrent = SkipBlanks(pCurrent, pEnd);
+					}
+
+					counts.triangles += numCorners > 2 ? numCorners - 2 : 0;
+				}
+
+				pCurrent = SkipLine(pCurrent, pEnd);
+			}
+
+			return counts;
+		}
+
+		std::vector<ObjChunk> SplitIntoChunks(std::string_view text, uint32_t numThreads)
+		{
+			const size_t numChunks{ std::clamp<size_t>(text.size() / g_MinChunkSize, 1, numThreads) };
+
+			std::vector<ObjChunk> chunks(numChunks);
+
+			const char* pBegin{ text.data() };
+			const char* pEnd{ text.data() + text.size() };
+			for (size_t i = 0; i < numChunks; ++i)
+			{
+				//Every boundary is moved forward to just past the next newline
+				const char* pChunkEnd{ pEnd };
+				if (i + 1 < numChunks)
+				{
+					const char* pSplit{ std::max(pBegin, text.data() + text.size() * (i + 1) / numChunks) };
+					pChunkEnd = pSplit > pBegin ? SkipLine(pSplit - 1, pEnd) : pBegin;
+				}
+
+				chunks[i].text = std::string_view{ pBegin, static_cast<size_t>(pChunkEnd - pBegin) };
+				pBegin = pChunkEnd;
+			}
+
+			return chunks;
+		}
+
+		//Runs function once per chunk, chunk 0 on the calling thread and every other chunk on its own worker
+		template<typename Function>
+		void ForEachChunk(std::vector<ObjChunk>& chunks, const Function& function)
+		{
+			std::vector<std::thread> workers{};
+			workers.reserve(chunks.size() - 1);
+
+			for (size_t i = 1; i < chunks.size(); ++i)
+			{
+				workers.emplace_back([&function, &chunk = chunks[i]]() { function(chunk); });
+			}
+
+			function(chunks[0]);
+
+			for (std::thread& worker : workers)
+			{
+				worker.join();
+			}
+		}
+
+		const char* ParseCorner(const char* pCurrent, const char* pEnd, const ObjCounts& current, ObjVertexKey& key)
+		{
+			key = {};
+			pCurrent = ParseIndex(pCurrent, pEnd, current.positions, key.position);
+
+			if (pCurrent < pEnd && *pCurrent == '/')
+			{
+				++pCurrent;
+
+				if (pCurrent < pEnd && *pCurrent != '/')
+				{
+					// Optional texture coordinate
+					pCurrent = ParseIndex(pCurrent, pEnd, current.UVs, key.texCoord);
+				}
+
+				if (pCurrent < pEnd && *pCurrent == '/')
+				{
+					// Optional vertex normal
+					pCurrent = ParseIndex(pCurrent + 1, pEnd, current.normals, key.normal);
+				}
+			}
+
+			return pCurrent;
+		}
+
+		void ParseChunk(ObjChunk& chunk, ObjAttributes& attributes)
+		{
+			//Running file-global counts, needed to write attributes in place and to resolve relative indices
+			ObjCounts current{ chunk.first };
+
+			chunk.corners.reserve(chunk.counts.triangles * 3);
+
+			const char* pCurrent{ chunk.text.data() };
+			const char* pEnd{ chunk.text.data() + chunk.text.size() };
+
+			while (pCurrent < pEnd)
+			{
+				pCurrent = SkipBlanks(pCurrent, pEnd);
+				if (pCurrent + 1 >= pEnd)
+					break;
+
+				if (pCurrent[0] == 'v' && IsBlank(pCurrent[1]))
+				{
+					//Vertex
+					float x, y, z;
+					pCurrent = ParseFloat(pCurrent + 1, pEnd, x);
+					pCurrent = ParseFloat(pCurrent, pEnd, y);
+					pCurrent = ParseFloat(pCurrent, pEnd, z);
+
+					attributes.positions[current.positions++] = Vector3{ x, y, z };
+				}
+				else if (pCurrent[0] == 'v' && pCurrent[1] == 't')
+				{
+					// Vertex TexCoord
+					float u, v;
+					pCurrent = ParseFloat(pCurrent + 2, pEnd, u);
+					pCurrent = ParseFloat(pCurrent, pEnd, v);
+
+					attributes.UVs[current.UVs++] = Vector2{ u, 1 - v };
+				}
+				else if (pCurrent[0] == 'v' && pCurrent[1] == 'n')
+				{
+					// Vertex Normal
+					float x, y, z;
+					pCurrent = ParseFloat(pCurrent + 2, pEnd, x);
+					pCurrent = ParseFloat(pCurrent, pEnd, y);
+					pCurrent = ParseFloat(pCurrent, pEnd, z);
+
+					attributes.normals[current.normals++] = Vector3{ x, y, z };
+				}
+				else if (pCurrent[0] == 'f' && IsBlank(pCurrent[1]))
+				{
+					// Faces, polygons are fan-triangulated around their first corner
+					ObjVertexKey first{}, previous{}, corner{};
+					int numCorners{};
+
+					pCurrent = SkipBlanks(pCurrent + 1, pEnd);
+					while (pCurrent < pEnd && (IsDigit(*pCurrent) || *pCurrent == '-'))
+					{
+						pCurrent = ParseCorner(pCurrent, pEnd, current, corner);
+
+						if (numCorners >= 2)
+						{
+							chunk.corners.push_back(first);
+							chunk.corners.push_back(previous);
+							chunk.corners.push_back(corner);
+						}
+						else if (numCorners == 0)
+						{
+							first = corner;
+						}
+
+						previous = corner;
+						++numCorners;
+						pCurrent = SkipBlanks(pCurrent, pEnd);
+					}
+				}
+
+				//read till end of line and ignore all remaining chars
+				pCurrent = SkipLine(pCurrent, pEnd);
+			}
+
+			assert(chunk.corners.size() == chunk.counts.triangles * 3 && "ERROR: CountRecords and ParseChunk disagree on the triangle count");
+		}
+
+		//------------------------------------------------
+		// Welding
+		//------------------------------------------------
+
+		//Open-addressing table sized once up front, so welding does not allocate per corner like std::unordered_map
+		class VertexWeldTable final
+		{
+		public:
+			explicit VertexWeldTable(size_t maxEntries)
+			{
+				size_t capacity{ 16 };
+				while (capacity < maxEntries * 2)
+					capacity <<= 1;
+
+				m_Keys.resize(capacity);
+				m_Values.resize(capacity);
+				m_Mask = capacity - 1;
+			}
+
+			//Returns the value stored for key, inserting newValue if the key was not present yet
+			uint32_t FindOrInsert(const ObjVertexKey& key, uint32_t newValue, bool& isNew)
+			{
+				size_t slot{ ObjVertexKeyHash{}(key) & m_Mask };
+				while (m_Keys[slot].position != 0)
+				{
+					if (m_Keys[slot] == key)
+					{
+						isNew = false;
+						return m_Values[slot];
+					}
+
+					slot = (slot + 1) & m_Mask;
+				}
+
+				//position is never 0 for a valid key, which marks the slot as empty
+				m_Keys[slot] = key;
+				m_Values[slot] = newValue;
+				isNew = true;
+				return newValue;
+			}
+
+		private:
+			std::vector<ObjVertexKey> m_Keys{};
+			std::vector<uint32_t> m_Values{};
+			size_t m_Mask{};
+		};
+
+		//Welding stays serial: vertices are numbered in order of first use, exactly like the single-threaded parse
+		bool WeldChunks(const std::vector<ObjChunk>& chunks, const ObjAttributes& attributes, std::vector<Vertex_Vehicle>& vertices, std::vector<uint32_t>& indices, bool flipAxisAndWinding)
+		{
+			size_t numCorners{};
+			for (const ObjChunk& chunk : chunks)
+				numCorners += chunk.corners.size();
+
+			VertexWeldTable weldTable{ numCorners };
+			indices.resize(numCorners);
+
+			size_t i{};
+			for (const ObjChunk& chunk : chunks)
+			{
+				for (const ObjVertexKey& key : chunk.corners)
+				{
+					bool isNew{};
+					const uint32_t index{ weldTable.FindOrInsert(key, uint32_t(vertices.size()), isNew) };
+					if (isNew)
+					{
+						if (key.position == 0 || key.position > attributes.positions.size()
+							|| key.texCoord > attributes.UVs.size() || key.normal > attributes.normals.size())
+						{
+							return false;
+						}
+
+						Vertex_Vehicle vertex{};
+						vertex.position = attributes.positions[key.position - 1];
+						if (key.texCoord)
+							vertex.uv = attributes.UVs[key.texCoord - 1];
+						if (key.normal)
+							vertex.normal = attributes.normals[key.normal - 1];
+
+						vertices.push_back(vertex);
+					}
+
+					//Swap the last two corners of every triangle when flipping the winding
+					const size_t corner{ i % 3 };
+					const size_t target{ flipAxisAndWinding && corner != 0 ? i - corner + 3 - corner : i };
+					indices[target] = index;
+					++i;
+				}
+			}
+
+			return true;
+		}
+	}
+
+	namespace ObjParser
+	{
+		bool ParseObj(const std::string& filename, std::vector<Vertex_Vehicle>& vertices, std::vector<uint32_t>& indices, bool flipAxisAndWinding, uint32_t numThreads)
+		{
+			const MappedFile file{ filename };
+			if (!file.IsValid())
+				return false;
+
+			vertices.clear();
+			indices.clear();
+
+			if (numThreads == 0)
+				numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+			std::vector<ObjChunk> chunks{ SplitIntoChunks(file.GetView(), numThreads) };
+
+			//1. Count the records of every chunk in parallel
+			ForEachChunk(chunks, [](ObjChunk& chunk) { chunk.counts = CountRecords(chunk.text); });
+
+			//2. Prefix sums give every chunk the file-global offset of its first position/uv/normal
+			ObjCounts total{};
+			for (ObjChunk& chunk : chunks)
+			{
+				chunk.first = total;
+				total.positions += chunk.counts.positions;
+				total.normals += chunk.counts.normals;
+				total.UVs += chunk.counts.UVs;
+				total.triangles += chunk.counts.triangles;
+			}
+
+			ObjAttributes attributes{};
+			attributes.positions.resize(total.positions);
+			attributes.normals.resize(total.normals);
+			attributes.UVs.resize(total.UVs);
+
+			//3. Parse every chunk in parallel straight into its range of the shared attribute arrays
+			ForEachChunk(chunks, [&attributes](ObjChunk& chunk) { ParseChunk(chunk, attributes); });
+
+			//4. Weld the corners of all chunks in file order
+			if (!WeldChunks(chunks, attributes, vertices, indices, flipAxisAndWinding))
+			{
+				vertices.clear();
+				indices.clear();
+				return false;
+			}
+
+			CalculateTangents(vertices, indices, flipAxisAndWinding);
+			return true;
+		}
+
+		bool ParseObjStream(const std::string& filename, std::vector<Vertex_Vehicle>& vertices, std::vector<uint32_t>& indices, bool flipAxisAndWinding)
+		{
+			std::ifstream file(filename);
+			if (!file)
+				return false;
+
+			std::vector<Vector3> positions{};
+			std::vector<Vector3> normals{};
+			std::vector<Vector2> UVs{};
+
+			vertices.clear();
+			indices.clear();
+
+			ObjVertexMap weldedVertices{};
+
+			std::string sCommand;
+			// start a while iteration ending when the end of file is reached (ios::eof)
+			while (!file.eof())
+			{
+				//read the first word of the string, use the >> operator (istream::operator>>)
+				file >> sCommand;
+				//use conditional statements to process the different commands
+				if (sCommand == "#")
+				{
+					// Ignore Comment
+				}
+				else if (sCommand == "v")
+				{
+					//Vertex
+					float x, y, z;
+					file >> x >> y >> z;
+
+					positions.emplace_back(x, y, z);
+				}
+				else if (sCommand == "vt")
+				{
+					// Vertex TexCoord
+					float u, v;
+					file >> u >> v;
+					UVs.emplace_back(u, 1 - v);
+				}
+				else if (sCommand == "vn")
+				{
+					// Vertex Normal
+					float x, y, z;
+					file >> x >> y >> z;
+
+					normals.emplace_back(x, y, z);
+				}
+				else if (sCommand == "f")
+				{
+					// Faces or triangles
+					// Corners that reference the same position/uv/normal triple are welded into one shared vertex
+					uint32_t tempIndices[3];
+					for (size_t iFace = 0; iFace < 3; iFace++)
+					{
+						ObjVertexKey key{};
+
+						// OBJ format uses 1-based arrays
+						file >> key.position;
+
+						if ('/' == file.peek())//is next in buffer ==  '/' ?
+						{
+							file.ignore();//read and ignore one element ('/')
+
+							if ('/' != file.peek())
+							{
+								// Optional texture coordinate
+								file >> key.texCoord;
+							}
+
+							if ('/' == file.peek())
+							{
+								file.ignore();
+
+								// Optional vertex normal
+								file >> key.normal;
+							}
+						}
+
+						const auto [it, isNew] { weldedVertices.try_emplace(key, uint32_t(vertices.size())) };
+						if (isNew)
+						{
+							Vertex_Vehicle vertex{};
+							vertex.position = positions[key.position - 1];
+							if (key.texCoord)
+								vertex.uv = UVs[key.texCoord - 1];
+							if (key.normal)
+								vertex.normal = normals[key.normal - 1];
+
+							vertices.push_back(vertex);
+						}
+
+						tempIndices[iFace] = it->second;
+					}
+
+					indices.push_back(tempIndices[0]);
+					if (flipAxisAndWinding)
+					{
+						indices.push_back(tempIndices[2]);
+						indices.push_back(tempIndices[1]);
+					}
+					else
+					{
+						indices.push_back(tempIndices[1]);
+						indices.push_back(tempIndices[2]);
+					}
+				}
+				//read till end of line and ignore all remaining chars
+				file.ignore(1000, '\n');
+			}
+
+			CalculateTangents(vertices, indices, flipAxisAndWinding);
+			return true;
+		}
+
+		void CalculateTangents(std::vector<Vertex_Vehicle>& vertices, const std::vector<uint32_t>& indices, bool flipAxisAndWinding)
+		{
+			//Cheap Tangent Calculations
+			for (size_t i = 0; i + 2 < indices.size(); i += 3)
+			{
+				uint32_t index0 = indices[i];
+				uint32_t index1 = indices[i + 1];
+				uint32_t index2 = indices[i + 2];
+
+				const Vector3& p0 = vertices[index0].position;
+				const Vector3& p1 = vertices[index1].position;
+				const Vector3& p2 = vertices[index2].position;
+				const Vector2& uv0 = vertices[index0].uv;
+				const Vector2& uv1 = vertices[index1].uv;
+				const Vector2& uv2 = vertices[index2].uv;
+
+				const Vector3 edge0 = p1 - p0;
+				const Vector3 edge1 = p2 - p0;
+				const Vector2 diffX = Vector2(uv1.x - uv0.x, uv2.x - uv0.x);
+				const Vector2 diffY = Vector2(uv1.y - uv0.y, uv2.y - uv0.y);
+				const float uvArea = Vector2::Cross(diffX, diffY);
+
+				//Degenerate uv triangles would spread inf/NaN into every face sharing the welded vertex
+				if (uvArea == 0.f)
+					continue;
+
+				float r = 1.f / uvArea;
+
+				Vector3 tangent = (edge0 * diffY.y - edge1 * diffY.x) * r;
+				vertices[index0].tangent += tangent;
+				vertices[index1].tangent += tangent;
+				vertices[index2].tangent += tangent;
+			}
+
+			//Create the Tangents (reject)
+			for (auto& v : vertices)
+			{
+				//Vertices that only touch degenerate uv triangles keep a zero tangent instead of NaN
+				const Vector3 tangent{ Vector3::Reject(v.tangent, v.normal) };
+				if (tangent.SqrMagnitude() > 0.f)
+					v.tangent = tangent.Normalized();
+
+				if (flipAxisAndWinding)
+				{
+					v.position.z *= -1.f;
+					v.normal.z *= -1.f;
+					v.tangent.z *= -1.f;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include "DataTypes.h"
+#include <string>
+
+namespace dae
+{
+	namespace ObjParser
+	{
+		//Maps the file and scans it in place: no per-token allocations, corners are welded into shared vertices and tangents generated.
+		//numThreads > 1 splits the file at line boundaries and parses the chunks in parallel (0 = one per hardware thread);
+		//the result is byte-identical to the single-threaded parse
+		bool ParseObj(const std::string& filename, std::vector<Vertex_Vehicle>& vertices, std::vector<uint32_t>& indices, bool flipAxisAndWinding = true, uint32_t numThreads = 1);
+
+		//Reference parser going through std::ifstream extraction, kept to validate and benchmark ParseObj against
+		bool ParseObjStream(const std::string& filename, std::vector<Vertex_Vehicle>& vertices, std::vector<uint32_t>& indices, bool flipAxisAndWinding = true);
+
+		//Accumulates per-triangle tangents on the (welded) vertices, orthogonalizes them and applies the optional handedness flip
+		void CalculateTangents(std::vector<Vertex_Vehicle>& vertices, const std::vector<uint32_t>& indices, bool flipAxisAndWinding);
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+namespace dae
+{
+	//Identifies a unique face corner by the 1-based OBJ indices it references (0 = not present)
+	struct ObjVertexKey
+	{
+		uint32_t position{};
+		uint32_t texCoord{};
+		uint32_t normal{};
+
+		bool operator==(const ObjVertexKey& other) const
+		{
+			return position == other.position && texCoord == other.texCoord && normal == other.normal;
+		}
+	};
+
+	struct ObjVertexKeyHash
+	{
+		size_t operator()(const ObjVertexKey& key) const
+		{
+			//Pack the three indices (21 bits each covers 2M attributes) and run a 64-bit finalizer over them
+			uint64_t hash{ (uint64_t(key.position) << 42) ^ (uint64_t(key.texCoord) << 21) ^ uint64_t(key.normal) };
+			hash ^= hash >> 33;
+			hash *= 0xff51afd7ed558ccdull;
+			hash ^= hash >> 33;
+			hash *= 0xc4ceb9fe1a85ec53ull;
+			hash ^= hash >> 33;
+			return static_cast<size_t>(hash);
+		}
+	};
+
+	using ObjVertexMap = std::unordered_map<ObjVertexKey, uint32_t, ObjVertexKeyHash>;
+}
@@ -0,0 +1,170 @@
+#pragma once
+#include "Matrix.h"
+
+namespace dae
+{
+	//Unit quaternion rotation. Rotations and products follow the row vector matrices of the renderer:
+	//CreateRotationX/Y/Z turn the same way as Matrix::CreateRotationX/Y/Z and (a * b) applies a first, so
+	//(a * b).ToMatrix() == a.ToMatrix() * b.ToMatrix()
+	struct Quaternion
+	{
+		float x{};
+		float y{};
+		float z{};
+		float w{ 1.f };
+
+		constexpr Quaternion() = default;
+		constexpr Quaternion(float _x, float _y, float _z, float _w) : x(_x), y(_y), z(_z), w(_w) {}
+
+		//Turns angle radians around a unit axis, counterclockwise looking down the axis like Matrix::CreateRotationY/Z
+		static constexpr Quaternion CreateFromAxisAngle(const Vector3& axis, float angle)
+		{
+			const float halfSin{ Sin(angle * 0.5f) };
+			return { axis.x * halfSin, axis.y * halfSin, axis.z * halfSin, Cos(angle * 0.5f) };
+		}
+
+		//Matrix::CreateRotationX turns the other way around its axis than Y and Z
+		static constexpr Quaternion CreateRotationX(float pitch)
+		{
+			return CreateFromAxisAngle(Vector3::UnitX, -pitch);
+		}
+
+		static constexpr Quaternion CreateRotationY(float yaw)
+		{
+			return CreateFromAxisAngle(Vector3::UnitY, yaw);
+		}
+
+		static constexpr Quaternion CreateRotationZ(float roll)
+		{
+			return CreateFromAxisAngle(Vector3::UnitZ, roll);
+		}
+
+		//Same order as Matrix::CreateRotation: pitch, then yaw, then roll
+		static constexpr Quaternion CreateRotation(const Vector3& r)
+		{
+			return CreateRotationX(r.x) * CreateRotationY(r.y) * CreateRotationZ(r.z);
+		}
+
+		constexpr Vector3 GetVector() const
+		{
+			return { x, y, z };
+		}
+
+		constexpr float SqrMagnitude() const
+		{
+			return x * x + y * y + z * z + w * w;
+		}
+
+		float Magnitude() const
+		{
+			return std::sqrt(SqrMagnitude());
+		}
+
+		float Normalize()
+		{
+			const float m = Magnitude();
+			x /= m;
+			y /= m;
+			z /= m;
+			w /= m;
+
+			return m;
+		}
+
+		Quaternion Normalized() const
+		{
+			const float m = Magnitude();
+			return { x / m, y / m, z / m, w / m };
+		}
+
+		//Inverse of a unit quaternion
+		constexpr Quaternion Conjugate() const
+		{
+			return { -x, -y, -z, w };
+		}
+
+		static constexpr float Dot(const Quaternion& q1, const Quaternion& q2)
+		{
+			return q1.x * q2.x + q1.y * q2.y + q1.z * q2.z + q1.w * q2.w;
+		}
+
+		//q v q*, expanded to two cross products
+		constexpr Vector3 Rotate(const Vector3& v) const
+		{
+			const Vector3 axis{ x, y, z };
+			const Vector3 t{ Vector3::Cross(axis, v) * 2.f };
+			return v + t * w + Vector3::Cross(axis, t);
+		}
+
+		//Rotated unit axes, the rows of ToMatrix
+		constexpr Vector3 GetAxisX() const
+		{
+			return { 1.f - 2.f * (y * y + z * z), 2.f * (x * y + w * z), 2.f * (x * z - w * y) };
+		}
+
+		constexpr Vector3 GetAxisY() const
+		{
+			return { 2.f * (x * y - w * z), 1.f - 2.f * (x * x + z * z), 2.f * (y * z + w * x) };
+		}
+
+		constexpr Vector3 GetAxisZ() const
+		{
+			return { 2.f * (x * z + w * y), 2.f * (y * z - w * x), 1.f - 2.f * (x * x + y * y) };
+		}
+
+		constexpr Matrix ToMatrix() const
+		{
+			return { GetAxisX(), GetAxisY(), GetAxisZ(), Vector3::Zero };
+		}
+
+		//Normalized linear interpolation along the shortest arc. Not constant speed, but close for small angles and cheap
+		static Quaternion Nlerp(const Quaternion& q1, const Quaternion& q2, float factor)
+		{
+			const float sign{ Dot(q1, q2) < 0.f ? -1.f : 1.f };
+			const float factor1{ 1.f - factor };
+			const float factor2{ factor * sign };
+			return Quaternion{ q1.x * factor1 + q2.x * factor2, q1.y * factor1 + q2.y * factor2, q1.z * factor1 + q2.z * factor2, q1.w * factor1 + q2.w * factor2 }.Normalized();
+		}
+
+		//Constant angular speed along the shortest arc
+		static Quaternion Slerp(const Quaternion& q1, const Quaternion& q2, float factor)
+		{
+			float cosine{ Dot(q1, q2) };
+			const float sign{ cosine < 0.f ? -1.f : 1.f };
+			cosine *= sign;
+
+			//Nearly parallel: sin(angle) vanishes, the linear path is exact enough
+			if (cosine > 0.9995f)
+				return Nlerp(q1, q2, factor);
+
+			const float angle{ std::acos(cosine) };
+			const float invSin{ 1.f / std::sin(angle) };
+			const float factor1{ std::sin((1.f - factor) * angle) * invSin };
+			const float factor2{ std::sin(factor * angle) * invSin * sign };
+			return { q1.x * factor1 + q2.x * factor2, q1.y * factor1 + q2.y * factor2, q1.z * factor1 + q2.z * factor2, q1.w * factor1 + q2.w * factor2 };
+		}
+
+#pragma region Operator Overloads
+		//This rotation followed by q
+		constexpr Quaternion operator*(const Quaternion& q) const
+		{
+			return {
+				q.w * x + w * q.x + q.y * z - q.z * y,
+				q.w * y + w * q.y + q.z * x - q.x * z,
+				q.w * z + w * q.z + q.x * y - q.y * x,
+				q.w * w - q.x * x - q.y * y - q.z * z
+			};
+		}
+
+		constexpr Quaternion& operator*=(const Quaternion& q)
+		{
+			*this = *this * q;
+			return *this;
+		}
+#pragma endregion
+
+		static const Quaternion Identity;
+	};
+
+	inline constexpr Quaternion Quaternion::Identity{ 0, 0, 0, 1 };
+}
@@ -3,7 +3,7 @@
 
 namespace dae {
 
-	Renderer::Renderer(SDL_Window* pWindow) :
+	Renderer::Renderer(SDL_Window* pWindow, bool usePackedVertices) :
 		m_pWindow(pWindow)
 	{
 		//Initialize Window
@@ -15,8 +15,14 @@ namespace dae {
 		//Initialize Camera
 		m_pCamera = new Camera(45.f, {0,0,-50.f}, m_AspectRatio);
 
+		//Start loading every asset on the worker pool, the device gets created meanwhile
+		AssetLoader loader{};
+		MeshAssets vehicleAssets{ Mesh::RequestVehicleAssets(loader, "Resources/vehicle.obj", "Resources/vehicle_diffuse.png", "Resources/vehicle_normal.png", "Resources/vehicle_specular.png", "Resources/vehicle_gloss.png", usePackedVertices) };
+		MeshAssets fireAssets{ Mesh::RequestFireAssets(loader, "Resources/fireFX.obj", "Resources/fireFX_diffuse.png", usePackedVertices) };
+
 		//Initialize DirectX pipeline
-		const HRESULT result = InitializeDirectX();
+		HRESULT result{};
+		loader.Measure("DirectX initialization", [&]() { result = InitializeDirectX(); });
 		if (result == S_OK)
 		{
 			m_IsInitialized = true;
@@ -27,10 +33,13 @@ namespace dae {
 			std::cout << "DirectX initialization failed!\n";
 		}
 
-		//Initialize Meshes
-		m_pMeshArr[0] = new Mesh(m_pDevice, "Resources/vehicle.obj", "Resources/vehicle_diffuse.png", "Resources/vehicle_normal.png", "Resources/vehicle_specular.png", "Resources/vehicle_gloss.png", {0,0,50.f});
-		m_pMeshArr[1] = new Mesh(m_pDevice, "Resources/fireFX.obj", "Resources/fireFX_diffuse.png", { 0,0,50.f });
+		//Initialize Meshes: device objects on this thread, as soon as their assets are in
+		vehicleAssets.Wait();
+		loader.Measure("vehicle device objects", [&]() { m_pMeshArr[0] = new Mesh(m_pDevice, vehicleAssets, {0,0,50.f}); });
+		fireAssets.Wait();
+		loader.Measure("fire device objects", [&]() { m_pMeshArr[1] = new Mesh(m_pDevice, fireAssets, { 0,0,50.f }); });
 
+		loader.PrintTimings();
 	}
 
 	Renderer::~Renderer()
@@ -50,6 +59,11 @@ namespace dae {
 		m_pDepthStencilView->Release();
 		m_pRenderTargetView->Release();
 		m_pRenderTargetBuffer->Release();
+		for (ID3D11Query* pQuery : m_pStatisticsQueries)
+		{
+			if (pQuery)
+				pQuery->Release();
+		}
 
 		for (Mesh*& mesh : m_pMeshArr)
 		{
@@ -70,7 +84,7 @@ namespace dae {
 	}
 
 
-	void Renderer::Render() const
+	void Renderer::Render()
 	{
 		if (!m_IsInitialized)
 			return;
@@ -82,17 +96,69 @@ namespace dae {
 		m_pDeviceContext->ClearDepthStencilView(m_pDepthStencilView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.f, 0);
 
 		
-		//2. Set Pipeline + Invoke drawcalls (=Render)
-		for (Mesh* mesh : m_pMeshArr)
+		//2. Set Pipeline + Invoke drawcalls (=Render), with the camera dependent matrices computed once for every mesh.
+		//The camera keeps its camera to world ONB as view matrix, the actual view matrix is its inverse
+		const FrameConstants frameConstants{ FrameConstants::Create(m_pCamera->GetInverseViewMatrix(), m_pCamera->GetViewMatrix(), m_pCamera->GetProjectionMatrix(),
+			static_cast<float>(m_Width), static_cast<float>(m_Height)) };
+		//Pixel shader invocations of this frame, the query it replaces is old enough to be done
+		const uint32_t query{ m_FrameIndex % m_NROFQUERIES };
+		if (m_FrameIndex >= m_NROFQUERIES)
+			ReadStatisticsQuery(query);
+		m_IsQueryDepthPrePass[query] = m_IsDepthPrePass;
+		m_pDeviceContext->Begin(m_pStatisticsQueries[query]);
+
+		m_MeshBounds.Resize(static_cast<uint32_t>(m_pMeshArr.size()));
+		for (uint32_t i = 0; i < m_pMeshArr.size(); ++i)
+		{
+			m_MeshBounds.Set(i, m_pMeshArr[i]->GetWorldBounds());
+		}
+		if (m_IsMeshCulling)
+		{
+			frameConstants.frustum.Cull(m_MeshBounds, m_IsMeshVisible, m_MeshCullStatistics);
+		}
+		else
+		{
+			m_IsMeshVisible.assign(m_pMeshArr.size(), 1);
+			m_MeshCullStatistics = { static_cast<uint32_t>(m_pMeshArr.size()), static_cast<uint32_t>(m_pMeshArr.size()), 0 };
+		}
+
+		//Depth pre-pass: the opaque meshes' depth without pixel shaders, so the pass after it shades every pixel once
+		if (m_IsDepthPrePass)
 		{
-			mesh->Render(m_pDeviceContext, m_pCamera);
+			for (uint32_t i = 0; i < m_pMeshArr.size(); ++i)
+			{
+				if (m_IsMeshVisible[i])
+				{
+					m_pMeshArr[i]->Render(m_pDeviceContext, frameConstants, MeshPass::Depth);
+				}
+			}
+		}
+
+		for (uint32_t i = 0; i < m_pMeshArr.size(); ++i)
+		{
+			if (m_IsMeshVisible[i])
+			{
+				m_pMeshArr[i]->Render(m_pDeviceContext, frameConstants, m_IsDepthPrePass ? MeshPass::ColorAfterDepth : MeshPass::Color);
+			}
 		}
 		
+		m_pDeviceContext->End(m_pStatisticsQueries[query]);
+		++m_FrameIndex;
 
 		//4 Present Backbuffer (Swap)
 		m_pSwapChain->Present(0,0);
 	}
 
+	void Renderer::ReadStatisticsQuery(uint32_t query)
+	{
+		//Still running: skip it, the next frame of the same mode fills in
+		D3D11_QUERY_DATA_PIPELINE_STATISTICS statistics{};
+		if (m_pDeviceContext->GetData(m_pStatisticsQueries[query], &statistics, sizeof(statistics), D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK)
+		{
+			m_ShadedFragments[m_IsQueryDepthPrePass[query]] = statistics.PSInvocations;
+		}
+	}
+
 	Mesh* Renderer::GetVehicleMeshPtr() const
 	{
 		return m_pMeshArr[0];
@@ -103,6 +169,36 @@ namespace dae {
 		return m_pMeshArr[1];
 	}
 
+	void Renderer::ToggleMeshCulling()
+	{
+		m_IsMeshCulling = !m_IsMeshCulling;
+	}
+
+	bool Renderer::GetIsMeshCulling() const
+	{
+		return m_IsMeshCulling;
+	}
+
+	const FrustumCullStatistics& Renderer::GetMeshCullStatistics() const
+	{
+		return m_MeshCullStatistics;
+	}
+
+	void Renderer::ToggleDepthPrePass()
+	{
+		m_IsDepthPrePass = !m_IsDepthPrePass;
+	}
+
+	bool Renderer::GetIsDepthPrePass() const
+	{
+		return m_IsDepthPrePass;
+	}
+
+	uint64_t Renderer::GetShadedFragments(bool isDepthPrePass) const
+	{
+		return m_ShadedFragments[isDepthPrePass];
+	}
+
 
 	HRESULT Renderer::InitializeDirectX()
 	{
@@ -235,6 +331,19 @@ namespace dae {
 		viewport.MaxDepth = 1.f;
 		m_pDeviceContext->RSSetViewports(1, &viewport);
 
+		//Pipeline statistics queries, the shaded fragments per frame
+		D3D11_QUERY_DESC queryDesc{};
+		queryDesc.Query = D3D11_QUERY_PIPELINE_STATISTICS;
+		queryDesc.MiscFlags = 0;
+		for (ID3D11Query*& pQuery : m_pStatisticsQueries)
+		{
+			result = m_pDevice->CreateQuery(&queryDesc, &pQuery);
+			if (FAILED(result))
+			{
+				return result;
+			}
+		}
+
 		return S_OK;
 
 		//INFO
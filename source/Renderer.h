@@ -1,6 +1,7 @@
 #pragma once
 #include "ColorRGB.h"
 #include "DataTypes.h"
+#include "AssetLoader.h"
 #include "Mesh.h"
 #include "Camera.h"
 #include <array>
@@ -12,7 +13,7 @@ namespace dae
 	class Renderer final
 	{
 	public:
-		Renderer(SDL_Window* pWindow);
+		Renderer(SDL_Window* pWindow, bool usePackedVertices = false);
 		~Renderer();
 
 
@@ -29,9 +30,16 @@ namespace dae
 		// Public member functions						
 		//------------------------------------------------
 		void Update(const Timer* pTimer);
-		void Render() const;
+		void Render();
 		Mesh* GetVehicleMeshPtr() const;
 		Mesh* GetFireMeshPtr() const;
+		void ToggleMeshCulling();
+		bool GetIsMeshCulling() const;
+		const FrustumCullStatistics& GetMeshCullStatistics() const;
+		void ToggleDepthPrePass();
+		bool GetIsDepthPrePass() const;
+		//Pixel shader invocations of the latest finished frame drawn with or without the depth pre-pass, the fire's included
+		uint64_t GetShadedFragments(bool isDepthPrePass) const;
 	private:
 
 		//------------------------------------------------
@@ -52,6 +60,22 @@ namespace dae
 
 		std::array<Mesh*, m_NROFMESHES> m_pMeshArr{};
 
+		//Whole meshes tested against the view frustum every frame, only the visible ones are drawn
+		BoundsStream m_MeshBounds{};
+		std::vector<uint8_t> m_IsMeshVisible{};
+		FrustumCullStatistics m_MeshCullStatistics{};
+		bool m_IsMeshCulling{ true };
+
+		//Opaque meshes draw their depth first, then shade only where they are in front
+		bool m_IsDepthPrePass{ false };
+
+		//Pipeline statistics of the last few frames, read back when their slot comes round again so the CPU never waits
+		static const int m_NROFQUERIES{ 3 };
+		std::array<ID3D11Query*, m_NROFQUERIES> m_pStatisticsQueries{};
+		std::array<bool, m_NROFQUERIES> m_IsQueryDepthPrePass{};
+		uint32_t m_FrameIndex{};
+		uint64_t m_ShadedFragments[2]{};
+
 		ID3D11Device* m_pDevice{ nullptr };
 		ID3D11DeviceContext* m_pDeviceContext{ nullptr };
 		IDXGISwapChain* m_pSwapChain{ nullptr };
@@ -66,5 +90,6 @@ namespace dae
 		// Private member functions						
 		//------------------------------------------------
 		HRESULT InitializeDirectX();
+		void ReadStatisticsQuery(uint32_t query);
 	};
 }
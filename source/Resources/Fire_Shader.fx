@@ -3,6 +3,10 @@
 //------------------------------------------------
 
 float4x4 gWorldViewProj : WorldViewProjection;
+
+// Dequantization of QUANTIZED_POSITION vertices: position = offset + stored * scale
+float3 gPositionOffset = float3(0.f, 0.f, 0.f);
+float3 gPositionScale = float3(1.f, 1.f, 1.f);
 Texture2D gDiffuseMap   : DiffuseMap;
 
 //------------------------------------------------
@@ -11,7 +15,11 @@ Texture2D gDiffuseMap   : DiffuseMap;
 
 struct VS_INPUT
 {
+#if defined(QUANTIZED_POSITION)
+	float4 Position		 : POSITION;
+#else
 	float3 Position		 : POSITION;
+#endif
 	float2 TexCoord		 : TEXCOORD;
 };
 
@@ -102,8 +110,14 @@ RasterizerState gNoCullRasterizerState
 
 VS_OUTPUT VS(VS_INPUT input)
 {
+#if defined(QUANTIZED_POSITION)
+	const float3 position = gPositionOffset + input.Position.xyz * gPositionScale;
+#else
+	const float3 position = input.Position;
+#endif
+
 	VS_OUTPUT output = (VS_OUTPUT)0;
-	output.Position = mul(float4(input.Position, 1.f),  gWorldViewProj);
+	output.Position = mul(float4(position, 1.f),  gWorldViewProj);
 	output.TexCoord = input.TexCoord;
 
 	return output;
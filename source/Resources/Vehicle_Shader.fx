@@ -11,6 +11,10 @@ float4x4 gViewInverseMatrix : ViewInverseMatrix;
 float4x4 gWorldViewProj		: WorldViewProjection;
 float4x4 gWorldMatrix		: WorldMatrix;
 
+// Dequantization of QUANTIZED_POSITION vertices: position = offset + stored * scale
+float3 gPositionOffset = float3(0.f, 0.f, 0.f);
+float3 gPositionScale = float3(1.f, 1.f, 1.f);
+
 Texture2D gNormalMap	 : NormalMap;
 Texture2D gDiffuseMap	 : DiffuseMap;
 Texture2D gSpecularMap	 : SpecularMap;
@@ -24,12 +28,31 @@ Texture2D gGlossinessMap : GlossinessMap;
 
 struct VS_INPUT
 {
+#if defined(QUANTIZED_POSITION)
+	float4 Position		 : POSITION;
+#else
 	float3 Position		 : POSITION;
+#endif
+#if defined(OCTAHEDRAL_NORMALS)
+	float2 Normal		 : NORMAL;
+	float2 Tangent		 : TANGENT;
+#else
 	float3 Normal		 : NORMAL;
 	float3 Tangent		 : TANGENT;
+#endif
 	float2 TexCoord		 : TEXCOORD;
 };
 
+// Depth pre-pass: the position alone, from its own tightly packed stream
+struct VS_DEPTH_INPUT
+{
+#if defined(QUANTIZED_POSITION)
+	float4 Position		 : POSITION;
+#else
+	float3 Position		 : POSITION;
+#endif
+};
+
 struct VS_OUTPUT
 {
 	float4 Position		 : SV_POSITION;
@@ -76,6 +99,14 @@ BlendState gBlendState{};
 
 DepthStencilState gDepthStencilState{};
 
+// Shading after the depth pre-pass: only the fragments left in front pass, depth is already written
+DepthStencilState gEqualDepthStencilState
+{
+	DepthEnable = true;
+	DepthWriteMask = zero;
+	DepthFunc = less_equal;
+};
+
 //----------------------------
 // Rasterizer States
 //----------------------------
@@ -102,19 +133,62 @@ RasterizerState gNoCullRasterizerState
 // Vertex Shader					
 //------------------------------------------------
 
+#if defined(QUANTIZED_POSITION)
+float3 DecodePosition(float4 position)
+{
+	return gPositionOffset + position.xyz * gPositionScale;
+}
+#else
+float3 DecodePosition(float3 position)
+{
+	return position;
+}
+#endif
+
+// precise: VS and VS_DEPTH must give bit for bit the same depth for the shading pass's less_equal test
+float4 ProjectPosition(float3 position)
+{
+	precise float4 projected = mul(float4(position, 1.f), gWorldViewProj);
+	return projected;
+}
+
+#if defined(OCTAHEDRAL_NORMALS)
+float3 DecodeOctahedral(float2 encoded)
+{
+	float3 direction = float3(encoded, 1.f - abs(encoded.x) - abs(encoded.y));
+	if (direction.z < 0.f)
+	{
+		direction.xy = (1.f - abs(direction.yx)) * (direction.xy >= 0.f ? 1.f : -1.f);
+	}
+	return direction;
+}
+#else
+float3 DecodeOctahedral(float3 direction)
+{
+	return direction;
+}
+#endif
+
 VS_OUTPUT VS(VS_INPUT input)
 {
+	const float3 position = DecodePosition(input.Position);
+
 	VS_OUTPUT output	= (VS_OUTPUT)0;
-	output.Position		= mul(float4(input.Position, 1.f),  gWorldViewProj);
+	output.Position		= ProjectPosition(position);
 
-	output.WorldPosition = mul(float4(input.Position, 1.f),gWorldMatrix );
-	output.Normal		 = mul(normalize(input.Normal),(float3x3)gWorldMatrix );
-	output.Tangent		 = mul(normalize(input.Tangent), (float3x3)gWorldMatrix );
+	output.WorldPosition = mul(float4(position, 1.f),gWorldMatrix );
+	output.Normal		 = mul(normalize(DecodeOctahedral(input.Normal)),(float3x3)gWorldMatrix );
+	output.Tangent		 = mul(normalize(DecodeOctahedral(input.Tangent)), (float3x3)gWorldMatrix );
 
 	output.TexCoord = input.TexCoord;
 	return output;
 }
 
+float4 VS_DEPTH(VS_DEPTH_INPUT input) : SV_POSITION
+{
+	return ProjectPosition(DecodePosition(input.Position));
+}
+
 //------------------------------------------------
 // Pixel Shaders						
 //------------------------------------------------
@@ -314,3 +388,43 @@ technique11 AnisotropicNoCullTechnique
 		SetPixelShader(CompileShader(ps_5_0, PS_ANISOTROPIC()));
 	}
 }
+
+// Depth pre-pass, no pixel shader: culled like the shading techniques so both passes draw the same triangles
+technique11 DepthBackCullTechnique
+{
+	pass P0
+	{
+		SetRasterizerState(gBackCullRasterizerState);
+		SetDepthStencilState(gDepthStencilState, 0);
+		SetBlendState(gBlendState, float4(0.0f, 0.0f, 0.0f, 0.0f), 0xFFFFFFFF);
+		SetVertexShader(CompileShader(vs_5_0, VS_DEPTH()));
+		SetGeometryShader(NULL);
+		SetPixelShader(NULL);
+	}
+}
+
+technique11 DepthFrontCullTechnique
+{
+	pass P0
+	{
+		SetRasterizerState(gFrontCullRasterizerState);
+		SetDepthStencilState(gDepthStencilState, 0);
+		SetBlendState(gBlendState, float4(0.0f, 0.0f, 0.0f, 0.0f), 0xFFFFFFFF);
+		SetVertexShader(CompileShader(vs_5_0, VS_DEPTH()));
+		SetGeometryShader(NULL);
+		SetPixelShader(NULL);
+	}
+}
+
+technique11 DepthNoCullTechnique
+{
+	pass P0
+	{
+		SetRasterizerState(gNoCullRasterizerState);
+		SetDepthStencilState(gDepthStencilState, 0);
+		SetBlendState(gBlendState, float4(0.0f, 0.0f, 0.0f, 0.0f), 0xFFFFFFFF);
+		SetVertexShader(CompileShader(vs_5_0, VS_DEPTH()));
+		SetGeometryShader(NULL);
+		SetPixelShader(NULL);
+	}
+}
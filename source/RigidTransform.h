@@ -0,0 +1,42 @@
+#pragma once
+#include "Quaternion.h"
+
+namespace dae
+{
+	//Rotation followed by a translation, the row vector matrix ToMatrix() without the cost of general 4x4 math:
+	//the inverse is the conjugate rotation and the translation rotated back
+	struct RigidTransform
+	{
+		Quaternion rotation{};
+		Vector3 translation{};
+
+		constexpr Vector3 TransformPoint(const Vector3& p) const
+		{
+			return rotation.Rotate(p) + translation;
+		}
+
+		constexpr Vector3 TransformVector(const Vector3& v) const
+		{
+			return rotation.Rotate(v);
+		}
+
+		constexpr RigidTransform Inverse() const
+		{
+			const Quaternion inverseRotation{ rotation.Conjugate() };
+			return { inverseRotation, -inverseRotation.Rotate(translation) };
+		}
+
+		constexpr Matrix ToMatrix() const
+		{
+			return { rotation.GetAxisX(), rotation.GetAxisY(), rotation.GetAxisZ(), translation };
+		}
+
+#pragma region Operator Overloads
+		//This transform followed by t, like the matrix product
+		constexpr RigidTransform operator*(const RigidTransform& t) const
+		{
+			return { rotation * t.rotation, t.rotation.Rotate(translation) + t.translation };
+		}
+#pragma endregion
+	};
+}
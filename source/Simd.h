@@ -0,0 +1,36 @@
+#pragma once
+
+//Instruction set of the math kernels, picked at compile time.
+//DAE_SIMD_AVX: 256-bit kernels where they help (/arch:AVX, -mavx), implies DAE_SIMD_SSE.
+//DAE_SIMD_SSE: 128-bit kernels, always available on x64.
+//Define DAE_SIMD_SCALAR to force the plain C++ fallback, e.g. to compare against it
+#if !defined(DAE_SIMD_SCALAR)
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define DAE_SIMD_SSE
+		#include <xmmintrin.h>
+		#include <emmintrin.h>
+	#endif
+
+	#if defined(DAE_SIMD_SSE) && defined(__AVX__)
+		#define DAE_SIMD_AVX
+		#include <immintrin.h>
+	#endif
+#endif
+
+namespace dae
+{
+	namespace Simd
+	{
+		//Name of the active path, for benchmark output
+		constexpr const char* GetInstructionSet()
+		{
+#if defined(DAE_SIMD_AVX)
+			return "AVX";
+#elif defined(DAE_SIMD_SSE)
+			return "SSE";
+#else
+			return "scalar";
+#endif
+		}
+	}
+}
@@ -0,0 +1,777 @@
+#include "pch.h"
+#include "SoftwareRasterizer.h"
+#include "FastMath.h"
+#include "MeshCache.h"
+#include "Simd.h"
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace dae
+{
+	namespace
+	{
+		using Clock = std::chrono::steady_clock;
+		using TriangleRaster::BlockSize;
+
+		//Vehicle_Shader.fx's constants
+		constexpr float Pi{ 3.1415f };
+		constexpr float Shininess{ 25.f };
+		constexpr float LightIntensity{ 7.f };
+		constexpr Vector3 LightDirection{ 0.577f, -0.577f, 0.577f };
+
+		double GetElapsedMs(Clock::time_point start)
+		{
+			return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		}
+
+		inline float SaturateValue(float value)
+		{
+			return std::min(std::max(value, 0.f), 1.f);
+		}
+
+		//1 / sqrt per element, the FastMath batch approximation when it is enabled
+		void ReciprocalSqrt(const float* pValues, uint32_t count, float* pResults)
+		{
+			if constexpr (FastMath::IsEnabled)
+			{
+				FastMath::ReciprocalSqrt(pValues, count, pResults);
+			}
+			else
+			{
+				for (uint32_t i = 0; i < count; ++i)
+					pResults[i] = 1.f / std::sqrt(pValues[i]);
+			}
+		}
+
+		void SpecularPow(const float* pCosines, const float* pExponents, uint32_t count, float* pResults)
+		{
+			if constexpr (FastMath::IsEnabled)
+			{
+				FastMath::SpecularPow(pCosines, pExponents, count, pResults);
+			}
+			else
+			{
+				for (uint32_t i = 0; i < count; ++i)
+					pResults[i] = std::pow(pCosines[i], pExponents[i]);
+			}
+		}
+	}
+
+	SoftwareGeometry SoftwareGeometry::FromMeshCache(const MeshCache& meshCache, uint32_t lod)
+	{
+		SoftwareGeometry geometry{};
+		if (!meshCache.IsValid())
+			return geometry;
+
+		const MeshCacheHeader& header{ meshCache.GetHeader() };
+		const PositionQuantization quantization{ meshCache.GetPositionQuantization() };
+		const char* pVertices{ static_cast<const char*>(meshCache.GetVertexData()) };
+
+		geometry.positions.Resize(header.numVertices);
+		geometry.normals.Resize(header.numVertices);
+		geometry.tangents.Resize(header.numVertices);
+		geometry.uvs.resize(header.numVertices);
+		for (uint32_t i = 0; i < header.numVertices; ++i)
+		{
+			const Vertex_Vehicle vertex{ header.vertexLayout.ReadVertex(pVertices + static_cast<size_t>(i) * header.vertexLayout.stride, quantization) };
+			geometry.positions.Set(i, vertex.position);
+			geometry.normals.Set(i, vertex.normal.SqrMagnitude() > 0.f ? vertex.normal.Normalized() : Vector3{});
+			geometry.tangents.Set(i, vertex.tangent.SqrMagnitude() > 0.f ? vertex.tangent.Normalized() : Vector3{});
+			geometry.uvs[i] = vertex.uv;
+		}
+
+		const MeshLod& level{ header.lods[std::min(lod, std::max(header.numLods, 1u) - 1)] };
+		const uint32_t firstIndex{ header.numLods > 0 ? level.firstIndex : 0 };
+		const uint32_t numIndices{ header.numLods > 0 ? level.numIndices : header.numIndices };
+		geometry.indices.resize(numIndices);
+		for (uint32_t i = 0; i < numIndices; ++i)
+			geometry.indices[i] = meshCache.GetIndex(firstIndex + i);
+
+		return geometry;
+	}
+
+	uint32_t SoftwareGeometry::GetNumVertices() const
+	{
+		return positions.GetCount();
+	}
+
+	uint32_t SoftwareGeometry::GetNumTriangles() const
+	{
+		return static_cast<uint32_t>(indices.size() / 3);
+	}
+
+	void SoftwareRasterizer::ShadeScratch::Resize(uint32_t count)
+	{
+		u.resize(count);
+		v.resize(count);
+		normals.Resize(count);
+		tangents.Resize(count);
+		viewDirections.Resize(count);
+		target.Resize(count);
+		result.Resize(count);
+		alpha.resize(count);
+		inverseLengths.resize(count);
+		inverseViewLengths.resize(count);
+		cosines.resize(count);
+		exponents.resize(count);
+		lambertCosines.resize(count);
+		phongPowers.resize(count);
+		texels.resize(count);
+	}
+
+	SoftwareRasterizer::SoftwareRasterizer(uint32_t width, uint32_t height, uint32_t numThreads)
+	{
+		m_FrameBuffer.Resize(width, height);
+		m_PixelStamps.resize(m_FrameBuffer.GetNumPixels());
+
+		m_NumTilesX = (width + TileSize - 1) / TileSize;
+		m_NumTilesY = (height + TileSize - 1) / TileSize;
+		m_TileBins.resize(m_NumTilesX * m_NumTilesY);
+		m_HierarchicalDepth.Resize(width, height, TileSize);
+
+		if (numThreads == 0)
+			numThreads = std::max(1u, std::thread::hardware_concurrency());
+		if (numThreads > 1)
+			m_pThreadPool = std::make_unique<ThreadPool>(numThreads - 1);
+
+		m_pContexts.resize(numThreads);
+		for (std::unique_ptr<RasterContext>& pContext : m_pContexts)
+		{
+			pContext = std::make_unique<RasterContext>();
+			pContext->scratch.Resize(FragmentBatch::Capacity);
+		}
+	}
+
+	void SoftwareRasterizer::BeginFrame(const FrameConstants& frameConstants, const ColorRGB& clearColor)
+	{
+		m_FrameConstants = frameConstants;
+		m_FrameBuffer.Clear(clearColor);
+		m_HierarchicalDepth.Clear();
+		m_IsHierarchicalDepthActive = m_IsHierarchicalDepth;
+	}
+
+	void SoftwareRasterizer::DrawVehicle(const SoftwareGeometry& geometry, const Matrix& worldMatrix, const VehicleMaterial& material)
+	{
+		m_PixelShader = PixelShader::Vehicle;
+		m_pVehicleMaterial = &material;
+		Draw(geometry, worldMatrix, material.culling);
+	}
+
+	void SoftwareRasterizer::DrawFire(const SoftwareGeometry& geometry, const Matrix& worldMatrix, const FireMaterial& material)
+	{
+		m_PixelShader = PixelShader::Fire;
+		m_pFireMaterial = &material;
+		Draw(geometry, worldMatrix, material.culling);
+	}
+
+	const FrameBuffer& SoftwareRasterizer::GetFrameBuffer() const
+	{
+		return m_FrameBuffer;
+	}
+
+	const SoftwareRasterizerStatistics& SoftwareRasterizer::GetStatistics() const
+	{
+		return m_Statistics;
+	}
+
+	void SoftwareRasterizer::ResetStatistics()
+	{
+		m_Statistics = {};
+	}
+
+	uint32_t SoftwareRasterizer::GetNumThreads() const
+	{
+		return static_cast<uint32_t>(m_pContexts.size());
+	}
+
+	void SoftwareRasterizer::SetHierarchicalDepth(bool isEnabled)
+	{
+		m_IsHierarchicalDepth = isEnabled;
+	}
+
+	void SoftwareRasterizer::SetDepthPrePass(bool isEnabled)
+	{
+		m_IsDepthPrePass = isEnabled;
+	}
+
+	void SoftwareRasterizer::Draw(const SoftwareGeometry& geometry, const Matrix& worldMatrix, cullMode culling)
+	{
+		m_pGeometry = &geometry;
+
+		Clock::time_point start{ Clock::now() };
+		RunVertexStage(geometry, worldMatrix);
+		m_Statistics.vertexMs += GetElapsedMs(start);
+
+		start = Clock::now();
+		RunSetupStage(geometry, culling);
+		m_Statistics.setupMs += GetElapsedMs(start);
+
+		start = Clock::now();
+		BinTriangles();
+		m_Statistics.binMs += GetElapsedMs(start);
+
+		//The fire neither writes depth nor hides anything behind it, only the vehicle gets a pre-pass
+		if (m_IsDepthPrePass && m_PixelShader == PixelShader::Vehicle)
+		{
+			m_RasterPass = RasterPass::Depth;
+			RasterizeTiles();
+			m_RasterPass = RasterPass::ColorAfterDepth;
+		}
+		RasterizeTiles();
+		m_RasterPass = RasterPass::Color;
+
+		m_pGeometry = nullptr;
+	}
+
+	void SoftwareRasterizer::RunVertexStage(const SoftwareGeometry& geometry, const Matrix& worldMatrix)
+	{
+		const uint32_t numVertices{ geometry.GetNumVertices() };
+		m_ScreenPositions.resize(numVertices);
+		BatchTransform::TransformPointsProjected(worldMatrix * m_FrameConstants.viewProjectionMatrix, geometry.positions, m_ScreenPositions.data());
+
+		//Viewport transform: y points down on screen
+		const float halfWidth{ m_FrameBuffer.width * 0.5f };
+		const float halfHeight{ m_FrameBuffer.height * 0.5f };
+		for (Vector4& position : m_ScreenPositions)
+		{
+			position.x = (position.x + 1.f) * halfWidth;
+			position.y = (1.f - position.y) * halfHeight;
+		}
+
+		//Only the vehicle's pixel shader reads world space attributes
+		if (m_PixelShader == PixelShader::Vehicle)
+		{
+			m_WorldPositions.resize(numVertices);
+			BatchTransform::TransformPoints(worldMatrix, geometry.positions, m_WorldPositions.data());
+			BatchTransform::TransformVectors(worldMatrix, geometry.normals, m_WorldNormals);
+			BatchTransform::TransformVectors(worldMatrix, geometry.tangents, m_WorldTangents);
+		}
+	}
+
+	void SoftwareRasterizer::RunSetupStage(const SoftwareGeometry& geometry, cullMode culling)
+	{
+		const uint32_t numTriangles{ geometry.GetNumTriangles() };
+		const int maxPixelX{ static_cast<int>(m_FrameBuffer.width) - 1 };
+		const int maxPixelY{ static_cast<int>(m_FrameBuffer.height) - 1 };
+
+		m_Triangles.clear();
+		m_Triangles.reserve(numTriangles);
+		for (uint32_t triangle = 0; triangle < numTriangles; ++triangle)
+		{
+			TriangleSetup setup{};
+			int32_t fixedX[3]{};
+			int32_t fixedY[3]{};
+			bool isBehindNearPlane{ false };
+			bool isBeyondFarPlane{ true };
+			bool isInGuardBand{ true };
+			for (int corner{ 0 }; corner < 3; ++corner)
+			{
+				const uint32_t vertex{ geometry.indices[triangle * 3 + corner] };
+				const Vector4& position{ m_ScreenPositions[vertex] };
+				setup.vertices[corner] = vertex;
+				setup.z[corner] = position.z;
+				setup.inverseW[corner] = 1.f / position.w;
+
+				//Also catches w <= 0, whose divided z is not meaningful
+				isBehindNearPlane |= !(position.w > 0.f && position.z >= 0.f);
+				isBeyondFarPlane &= position.z > 1.f;
+				isInGuardBand &= RasterTriangle::Snap(position.x, position.y, fixedX[corner], fixedY[corner]);
+			}
+			if (isBehindNearPlane || isBeyondFarPlane || !isInGuardBand)
+				continue;
+
+			//Culling on the snapped vertices, triangles that collapse onto the grid have no area
+			const int64_t area{ RasterTriangle::GetSignedDoubleArea(fixedX, fixedY) };
+			const bool isFacing{ culling == cullMode::noCulling
+				|| (culling == cullMode::backCulling && area > 0)
+				|| (culling == cullMode::frontCulling && area < 0) };
+			if (!isFacing || area == 0)
+				continue;
+
+			//One winding from here on: the edge functions are positive inside
+			if (area < 0)
+			{
+				std::swap(fixedX[1], fixedX[2]);
+				std::swap(fixedY[1], fixedY[2]);
+				std::swap(setup.z[1], setup.z[2]);
+				std::swap(setup.inverseW[1], setup.inverseW[2]);
+				std::swap(setup.vertices[1], setup.vertices[2]);
+			}
+			setup.edges = RasterTriangle::Create(fixedX, fixedY);
+			setup.inverseArea = 1.f / static_cast<float>(setup.edges.doubleArea);
+
+			//Depth is z0 * e0 / area + z1 * e1 / area + z2 * e2 / area of the edge values
+			const RasterTriangle& edges{ setup.edges };
+			const double inverseDoubleArea{ 1.0 / static_cast<double>(edges.doubleArea) };
+			double weightSteps{};
+			for (int corner{ 0 }; corner < 3; ++corner)
+			{
+				setup.depthOffset += setup.z[corner] * static_cast<double>(edges.offset[corner]);
+				setup.depthStepX += setup.z[corner] * static_cast<double>(edges.stepX[corner]);
+				setup.depthStepY += setup.z[corner] * static_cast<double>(edges.stepY[corner]);
+				weightSteps += std::abs(static_cast<double>(edges.stepX[corner]));
+			}
+			setup.depthOffset *= inverseDoubleArea;
+			setup.depthStepX *= inverseDoubleArea;
+			setup.depthStepY *= inverseDoubleArea;
+			weightSteps *= inverseDoubleArea;
+
+			//z is not negative here. Edge values of covered pixels add up to the area less up to three top-left biases
+			setup.farthestZ = std::max(setup.z[0], std::max(setup.z[1], setup.z[2]));
+			setup.nearestZ = static_cast<float>(std::min(setup.z[0], std::min(setup.z[1], setup.z[2])) * std::max(1.0 - 3.0 * inverseDoubleArea, 0.0));
+			//InterpolateRow rounds the edge values at the row start, the steps along the row, the weights and their sums.
+			//Depth is off by about 2^-21 plus 2^-20 of the weights' steps along the row, times 4 to be safe
+			setup.depthError = static_cast<float>(setup.farthestZ * (2.0 + 4.0 * weightSteps) / (1 << 20));
+
+			setup.minX = std::max(setup.edges.minX, 0);
+			setup.minY = std::max(setup.edges.minY, 0);
+			setup.maxX = std::min(setup.edges.maxX, maxPixelX);
+			setup.maxY = std::min(setup.edges.maxY, maxPixelY);
+			if (setup.minX > setup.maxX || setup.minY > setup.maxY)
+				continue;
+
+			m_Triangles.push_back(setup);
+		}
+
+		m_Statistics.numTriangles += numTriangles;
+		m_Statistics.numTrianglesRasterized += static_cast<uint32_t>(m_Triangles.size());
+		m_Statistics.numTrianglesCulled += numTriangles - static_cast<uint32_t>(m_Triangles.size());
+	}
+
+	void SoftwareRasterizer::BinTriangles()
+	{
+		for (std::vector<uint32_t>& bin : m_TileBins)
+			bin.clear();
+
+		for (uint32_t triangle = 0; triangle < static_cast<uint32_t>(m_Triangles.size()); ++triangle)
+		{
+			const TriangleSetup& setup{ m_Triangles[triangle] };
+			const uint32_t minTileX{ static_cast<uint32_t>(setup.minX) / TileSize };
+			const uint32_t minTileY{ static_cast<uint32_t>(setup.minY) / TileSize };
+			const uint32_t maxTileX{ static_cast<uint32_t>(setup.maxX) / TileSize };
+			const uint32_t maxTileY{ static_cast<uint32_t>(setup.maxY) / TileSize };
+
+			for (uint32_t tileY = minTileY; tileY <= maxTileY; ++tileY)
+			{
+				for (uint32_t tileX = minTileX; tileX <= maxTileX; ++tileX)
+					m_TileBins[tileY * m_NumTilesX + tileX].push_back(triangle);
+			}
+		}
+	}
+
+	void SoftwareRasterizer::RasterizeTiles()
+	{
+		for (std::unique_ptr<RasterContext>& pContext : m_pContexts)
+		{
+			pContext->rasterMs = 0.0;
+			pContext->shadeMs = 0.0;
+			pContext->numFragmentsTested = 0;
+			pContext->numFragmentsShaded = 0;
+			pContext->numFragmentsPrePassed = 0;
+			std::fill(std::begin(pContext->numBlocks), std::end(pContext->numBlocks), 0);
+			pContext->numTilesOccluded = 0;
+			pContext->numBlocksOccluded = 0;
+			pContext->numBlocksUnoccluded = 0;
+		}
+
+		//Every thread takes the next tile until none are left, tiles with more triangles take longer but even out
+		const uint32_t numTiles{ static_cast<uint32_t>(m_TileBins.size()) };
+		std::atomic<uint32_t> nextTile{ 0 };
+		const auto rasterizeTiles = [this, numTiles, &nextTile](RasterContext& context)
+		{
+			for (uint32_t tile{ nextTile++ }; tile < numTiles; tile = nextTile++)
+			{
+				if (!m_TileBins[tile].empty())
+					RasterizeTile(context, tile);
+			}
+		};
+
+		std::vector<std::future<void>> workers{};
+		workers.reserve(m_pContexts.size() - 1);
+		for (size_t i = 1; i < m_pContexts.size(); ++i)
+		{
+			RasterContext& context{ *m_pContexts[i] };
+			workers.push_back(m_pThreadPool->Submit([&rasterizeTiles, &context]() { rasterizeTiles(context); }));
+		}
+		rasterizeTiles(*m_pContexts[0]);
+		for (std::future<void>& worker : workers)
+			worker.get();
+
+		for (const std::unique_ptr<RasterContext>& pContext : m_pContexts)
+		{
+			m_Statistics.rasterMs += pContext->rasterMs;
+			m_Statistics.shadeMs += pContext->shadeMs;
+			m_Statistics.numFragmentsTested += pContext->numFragmentsTested;
+			m_Statistics.numFragmentsShaded += pContext->numFragmentsShaded;
+			m_Statistics.numFragmentsPrePassed += pContext->numFragmentsPrePassed;
+			m_Statistics.numBlocksOutside += pContext->numBlocks[static_cast<int>(TriangleRaster::BlockType::Outside)];
+			m_Statistics.numBlocksPartial += pContext->numBlocks[static_cast<int>(TriangleRaster::BlockType::Partial)];
+			m_Statistics.numBlocksInside += pContext->numBlocks[static_cast<int>(TriangleRaster::BlockType::Inside)];
+			m_Statistics.numTilesOccluded += pContext->numTilesOccluded;
+			m_Statistics.numBlocksOccluded += pContext->numBlocksOccluded;
+			m_Statistics.numBlocksUnoccluded += pContext->numBlocksUnoccluded;
+		}
+	}
+
+	void SoftwareRasterizer::RasterizeTile(RasterContext& context, uint32_t tile)
+	{
+		const Clock::time_point start{ Clock::now() };
+		//The batches shaded along the way count as shading
+		const double shadeMs{ context.shadeMs };
+
+		const int minX{ static_cast<int>((tile % m_NumTilesX) * TileSize) };
+		const int minY{ static_cast<int>((tile / m_NumTilesX) * TileSize) };
+		const int maxX{ std::min(minX + static_cast<int>(TileSize), static_cast<int>(m_FrameBuffer.width)) - 1 };
+		const int maxY{ std::min(minY + static_cast<int>(TileSize), static_cast<int>(m_FrameBuffer.height)) - 1 };
+
+		const bool isDepthWritten{ m_PixelShader == PixelShader::Vehicle && m_RasterPass != RasterPass::ColorAfterDepth };
+		const bool isShaded{ m_RasterPass != RasterPass::Depth };
+		const bool isBlended{ m_PixelShader == PixelShader::Fire };
+		//After the pre-pass every fragment is at or behind the depth of its pixel, the front ones pass
+		const bool isEqualPassing{ m_RasterPass == RasterPass::ColorAfterDepth };
+		const auto isOccluded = [isEqualPassing](float nearest, float farthest) { return isEqualPassing ? nearest > farthest : nearest >= farthest; };
+		const uint32_t width{ m_FrameBuffer.width };
+		float* pDepth{ m_FrameBuffer.depth.data() };
+		FragmentBatch& batch{ context.batch };
+		uint64_t numFragmentsTested{};
+		const bool isHierarchicalDepth{ m_IsHierarchicalDepthActive };
+		HierarchicalDepthBuffer& hierarchicalDepth{ m_HierarchicalDepth };
+
+		for (const uint32_t triangle : m_TileBins[tile])
+		{
+			const TriangleSetup& setup{ m_Triangles[triangle] };
+			const RasterTriangle& edges{ setup.edges };
+			const int startX{ std::max(setup.minX, minX) };
+			const int startY{ std::max(setup.minY, minY) };
+			const int endX{ std::min(setup.maxX, maxX) };
+			const int endY{ std::min(setup.maxY, maxY) };
+			const float stepX[3]{ static_cast<float>(edges.stepX[0]), static_cast<float>(edges.stepX[1]), static_cast<float>(edges.stepX[2]) };
+
+			//Behind everything already drawn over the part of the tile it covers
+			if (isHierarchicalDepth && isOccluded(GetDepthBounds(setup, startX, startY, endX, endY).nearest, hierarchicalDepth.tileFarthest[tile]))
+			{
+				++context.numTilesOccluded;
+				continue;
+			}
+
+			//Tiles start on a block, so blocks never straddle two
+			for (int blockY{ startY & ~(BlockSize - 1) }; blockY <= endY; blockY += BlockSize)
+			{
+				const int firstRow{ std::max(startY, blockY) };
+				const int lastRow{ std::min(endY, blockY + BlockSize - 1) };
+
+				for (int blockX{ startX & ~(BlockSize - 1) }; blockX <= endX; blockX += BlockSize)
+				{
+					uint8_t rowMasks[BlockSize]{};
+					const TriangleRaster::BlockType blockType{ TriangleRaster::GetBlockCoverage(edges, blockX, blockY, rowMasks) };
+					++context.numBlocks[static_cast<int>(blockType)];
+					if (blockType == TriangleRaster::BlockType::Outside)
+						continue;
+
+					//Pixels of the block inside the tile and the bounding box
+					const int firstColumn{ std::max(startX, blockX) - blockX };
+					const int lastColumn{ std::min(endX, blockX + BlockSize - 1) - blockX };
+					const uint32_t columnMask{ (0xffu << firstColumn) & (0xffu >> (BlockSize - 1 - lastColumn)) };
+
+					bool isUnoccluded{ false };
+					if (isHierarchicalDepth)
+					{
+						const uint32_t block{ hierarchicalDepth.GetBlock(blockX, blockY) };
+						const DepthBounds bounds{ GetDepthBounds(setup, blockX + firstColumn, firstRow, blockX + lastColumn, lastRow) };
+						if (isOccluded(bounds.nearest, hierarchicalDepth.blockFarthest[block]))
+						{
+							++context.numBlocksOccluded;
+							continue;
+						}
+						isUnoccluded = !isEqualPassing && bounds.farthest < hierarchicalDepth.blockNearest[block];
+						context.numBlocksUnoccluded += isUnoccluded;
+					}
+					bool isBlockWritten{ false };
+					float writtenNearest{ std::numeric_limits<float>::max() };
+					float replacedFarthest{ std::numeric_limits<float>::lowest() };
+
+					for (int row{ firstRow }; row <= lastRow; ++row)
+					{
+						const uint32_t coverage{ (blockType == TriangleRaster::BlockType::Inside ? 0xffu : rowMasks[row - blockY]) & columnMask };
+						if (coverage == 0)
+							continue;
+						numFragmentsTested += std::popcount(coverage);
+
+						const float rowEdges[3]{ static_cast<float>(edges.GetEdgeValue(0, blockX, row)),
+							static_cast<float>(edges.GetEdgeValue(1, blockX, row)), static_cast<float>(edges.GetEdgeValue(2, blockX, row)) };
+						RowAttributes attributes{};
+						InterpolateRow(setup, rowEdges, stepX, attributes);
+
+						const uint32_t rowPixel{ row * width + blockX };
+						for (uint32_t remaining{ coverage }; remaining != 0; remaining &= remaining - 1)
+						{
+							const int column{ std::countr_zero(remaining) };
+							const uint32_t pixel{ rowPixel + column };
+							const float depth{ attributes.depth[column] };
+							if (!isUnoccluded && !(isEqualPassing ? depth <= pDepth[pixel] : depth < pDepth[pixel]))
+								continue;
+							if (isDepthWritten)
+							{
+								writtenNearest = std::min(writtenNearest, depth);
+								replacedFarthest = std::max(replacedFarthest, pDepth[pixel]);
+								pDepth[pixel] = depth;
+								isBlockWritten = true;
+							}
+							if (!isShaded)
+								continue;
+
+							if (isBlended)
+							{
+								if (m_PixelStamps[pixel] == context.stamp)
+									FlushFragments(context);
+								m_PixelStamps[pixel] = context.stamp;
+							}
+
+							const uint32_t fragment{ batch.count++ };
+							batch.pixels[fragment] = pixel;
+							batch.triangles[fragment] = triangle;
+							batch.weights1[fragment] = attributes.weights1[column];
+							batch.weights2[fragment] = attributes.weights2[column];
+							if (batch.count == FragmentBatch::Capacity)
+								FlushFragments(context);
+						}
+					}
+
+					if (isHierarchicalDepth && isBlockWritten)
+						hierarchicalDepth.UpdateBlock(m_FrameBuffer, blockX, blockY, writtenNearest, replacedFarthest);
+				}
+			}
+		}
+
+		//The tile's pixels are done before the thread moves on
+		FlushFragments(context);
+
+		context.numFragmentsTested += numFragmentsTested;
+		if (!isShaded)
+			context.numFragmentsPrePassed += numFragmentsTested;
+		context.rasterMs += GetElapsedMs(start) - (context.shadeMs - shadeMs);
+	}
+
+	SoftwareRasterizer::DepthBounds SoftwareRasterizer::GetDepthBounds(const TriangleSetup& setup, int minX, int minY, int maxX, int maxY)
+	{
+		//Depth is linear on screen: its extremes over the rectangle are at corners, and between the vertices' depths
+		const double nearest{ setup.depthOffset + setup.depthStepX * (setup.depthStepX < 0.0 ? maxX : minX) + setup.depthStepY * (setup.depthStepY < 0.0 ? maxY : minY) };
+		const double farthest{ setup.depthOffset + setup.depthStepX * (setup.depthStepX < 0.0 ? minX : maxX) + setup.depthStepY * (setup.depthStepY < 0.0 ? minY : maxY) };
+		return DepthBounds{ static_cast<float>(std::max(nearest, static_cast<double>(setup.nearestZ))) - setup.depthError,
+			static_cast<float>(std::min(farthest, static_cast<double>(setup.farthestZ))) + setup.depthError };
+	}
+
+	void SoftwareRasterizer::InterpolateRow(const TriangleSetup& setup, const float rowEdges[3], const float stepX[3], RowAttributes& attributes)
+	{
+		//Barycentric weights from the edge values, z / w linear on screen, attributes linear in 1 / w.
+		//Every path does the same operations in the same order, so the image does not depend on the instruction set
+#if defined(DAE_SIMD_AVX)
+		const __m256 lanes{ _mm256_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f) };
+		const __m256 inverseArea{ _mm256_set1_ps(setup.inverseArea) };
+		__m256 weights[3]{};
+		for (int edge{ 0 }; edge < 3; ++edge)
+		{
+			const __m256 value{ _mm256_add_ps(_mm256_set1_ps(rowEdges[edge]), _mm256_mul_ps(_mm256_set1_ps(stepX[edge]), lanes)) };
+			weights[edge] = _mm256_mul_ps(value, inverseArea);
+		}
+
+		const __m256 depth{ _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(weights[0], _mm256_set1_ps(setup.z[0])), _mm256_mul_ps(weights[1], _mm256_set1_ps(setup.z[1]))),
+			_mm256_mul_ps(weights[2], _mm256_set1_ps(setup.z[2]))) };
+		const __m256 perspective0{ _mm256_mul_ps(weights[0], _mm256_set1_ps(setup.inverseW[0])) };
+		const __m256 perspective1{ _mm256_mul_ps(weights[1], _mm256_set1_ps(setup.inverseW[1])) };
+		const __m256 perspective2{ _mm256_mul_ps(weights[2], _mm256_set1_ps(setup.inverseW[2])) };
+		const __m256 inverseSum{ _mm256_div_ps(_mm256_set1_ps(1.f), _mm256_add_ps(_mm256_add_ps(perspective0, perspective1), perspective2)) };
+
+		_mm256_storeu_ps(attributes.depth, depth);
+		_mm256_storeu_ps(attributes.weights1, _mm256_mul_ps(perspective1, inverseSum));
+		_mm256_storeu_ps(attributes.weights2, _mm256_mul_ps(perspective2, inverseSum));
+#elif defined(DAE_SIMD_SSE)
+		const __m128 inverseArea{ _mm_set1_ps(setup.inverseArea) };
+		for (int half{ 0 }; half < BlockSize; half += 4)
+		{
+			const __m128 lanes{ _mm_add_ps(_mm_setr_ps(0.f, 1.f, 2.f, 3.f), _mm_set1_ps(static_cast<float>(half))) };
+			__m128 weights[3]{};
+			for (int edge{ 0 }; edge < 3; ++edge)
+			{
+				const __m128 value{ _mm_add_ps(_mm_set1_ps(rowEdges[edge]), _mm_mul_ps(_mm_set1_ps(stepX[edge]), lanes)) };
+				weights[edge] = _mm_mul_ps(value, inverseArea);
+			}
+
+			const __m128 depth{ _mm_add_ps(_mm_add_ps(_mm_mul_ps(weights[0], _mm_set1_ps(setup.z[0])), _mm_mul_ps(weights[1], _mm_set1_ps(setup.z[1]))),
+				_mm_mul_ps(weights[2], _mm_set1_ps(setup.z[2]))) };
+			const __m128 perspective0{ _mm_mul_ps(weights[0], _mm_set1_ps(setup.inverseW[0])) };
+			const __m128 perspective1{ _mm_mul_ps(weights[1], _mm_set1_ps(setup.inverseW[1])) };
+			const __m128 perspective2{ _mm_mul_ps(weights[2], _mm_set1_ps(setup.inverseW[2])) };
+			const __m128 inverseSum{ _mm_div_ps(_mm_set1_ps(1.f), _mm_add_ps(_mm_add_ps(perspective0, perspective1), perspective2)) };
+
+			_mm_storeu_ps(attributes.depth + half, depth);
+			_mm_storeu_ps(attributes.weights1 + half, _mm_mul_ps(perspective1, inverseSum));
+			_mm_storeu_ps(attributes.weights2 + half, _mm_mul_ps(perspective2, inverseSum));
+		}
+#else
+		for (int column{ 0 }; column < BlockSize; ++column)
+		{
+			float weights[3]{};
+			for (int edge{ 0 }; edge < 3; ++edge)
+				weights[edge] = (rowEdges[edge] + stepX[edge] * static_cast<float>(column)) * setup.inverseArea;
+
+			const float perspective0{ weights[0] * setup.inverseW[0] };
+			const float perspective1{ weights[1] * setup.inverseW[1] };
+			const float perspective2{ weights[2] * setup.inverseW[2] };
+			const float inverseSum{ 1.f / (perspective0 + perspective1 + perspective2) };
+
+			attributes.depth[column] = weights[0] * setup.z[0] + weights[1] * setup.z[1] + weights[2] * setup.z[2];
+			attributes.weights1[column] = perspective1 * inverseSum;
+			attributes.weights2[column] = perspective2 * inverseSum;
+		}
+#endif
+	}
+
+	void SoftwareRasterizer::FlushFragments(RasterContext& context)
+	{
+		if (context.batch.count > 0)
+		{
+			const Clock::time_point start{ Clock::now() };
+			if (m_PixelShader == PixelShader::Vehicle)
+				ShadeVehicle(context);
+			else
+				ShadeFire(context);
+
+			context.numFragmentsShaded += context.batch.count;
+			context.shadeMs += GetElapsedMs(start);
+		}
+
+		context.batch.count = 0;
+		++context.stamp;
+	}
+
+	void SoftwareRasterizer::GetFragmentWeights(const FragmentBatch& batch, uint32_t fragment, uint32_t vertices[3], float weights[3]) const
+	{
+		const TriangleSetup& setup{ m_Triangles[batch.triangles[fragment]] };
+		vertices[0] = setup.vertices[0];
+		vertices[1] = setup.vertices[1];
+		vertices[2] = setup.vertices[2];
+		weights[1] = batch.weights1[fragment];
+		weights[2] = batch.weights2[fragment];
+		weights[0] = 1.f - weights[1] - weights[2];
+	}
+
+	void SoftwareRasterizer::ShadeVehicle(RasterContext& context)
+	{
+		const FragmentBatch& batch{ context.batch };
+		const uint32_t count{ batch.count };
+		const VehicleMaterial& material{ *m_pVehicleMaterial };
+		const std::vector<Vector2>& uvs{ m_pGeometry->uvs };
+		const Vector3& cameraPosition{ m_FrameConstants.cameraPosition };
+		ShadeScratch& scratch{ context.scratch };
+
+		//Interpolation: uv, world normal and tangent (not renormalized, like the hardware), and the view direction
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			uint32_t vertices[3]{};
+			float weights[3]{};
+			GetFragmentWeights(batch, i, vertices, weights);
+
+			scratch.u[i] = weights[0] * uvs[vertices[0]].x + weights[1] * uvs[vertices[1]].x + weights[2] * uvs[vertices[2]].x;
+			scratch.v[i] = weights[0] * uvs[vertices[0]].y + weights[1] * uvs[vertices[1]].y + weights[2] * uvs[vertices[2]].y;
+
+			Vector3 normal{}, tangent{}, worldPosition{};
+			for (int corner{ 0 }; corner < 3; ++corner)
+			{
+				const uint32_t vertex{ vertices[corner] };
+				normal += m_WorldNormals.Get(vertex) * weights[corner];
+				tangent += m_WorldTangents.Get(vertex) * weights[corner];
+				worldPosition += Vector3{ m_WorldPositions[vertex].x, m_WorldPositions[vertex].y, m_WorldPositions[vertex].z } * weights[corner];
+			}
+			scratch.normals.Set(i, normal);
+			scratch.tangents.Set(i, tangent);
+
+			const Vector3 view{ worldPosition - cameraPosition };
+			scratch.viewDirections.Set(i, view);
+			scratch.inverseViewLengths[i] = view.SqrMagnitude();
+		}
+
+		material.pDiffuseMap->Sample(material.sampler, scratch.u.data(), scratch.v.data(), count, scratch.diffuse);
+		material.pNormalMap->Sample(material.sampler, scratch.u.data(), scratch.v.data(), count, scratch.normalSamples);
+		material.pSpecularMap->Sample(material.sampler, scratch.u.data(), scratch.v.data(), count, scratch.specular);
+		material.pGlossinessMap->Sample(material.sampler, scratch.u.data(), scratch.v.data(), count, scratch.glossiness);
+
+		//GetNormal: the sample in [-1, 1] through the tangent space matrix
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const Vector3 normal{ scratch.normals.Get(i) };
+			const Vector3 tangent{ scratch.tangents.Get(i) };
+			const Vector3 binormal{ Vector3::Cross(normal, tangent) };
+			const Vector3 sample{ 2.f * scratch.normalSamples.r[i] - 1.f, 2.f * scratch.normalSamples.g[i] - 1.f, 2.f * scratch.normalSamples.b[i] - 1.f };
+
+			const Vector3 mapped{ tangent * sample.x + binormal * sample.y + normal * sample.z };
+			scratch.normals.Set(i, mapped);
+			scratch.inverseLengths[i] = mapped.SqrMagnitude();
+		}
+		ReciprocalSqrt(scratch.inverseLengths.data(), count, scratch.inverseLengths.data());
+		ReciprocalSqrt(scratch.inverseViewLengths.data(), count, scratch.inverseViewLengths.data());
+
+		//GetPhong's reflection and the Lambert cosine
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const Vector3 normal{ scratch.normals.Get(i) * scratch.inverseLengths[i] };
+			const Vector3 viewDirection{ scratch.viewDirections.Get(i) * scratch.inverseViewLengths[i] };
+
+			const Vector3 reflect{ LightDirection - 2.f * Vector3::Dot(normal, LightDirection) * normal };
+			scratch.cosines[i] = SaturateValue(Vector3::Dot(reflect, -viewDirection));
+			scratch.exponents[i] = scratch.glossiness.r[i] * Shininess;
+			scratch.lambertCosines[i] = SaturateValue(Vector3::Dot(normal, -LightDirection));
+		}
+		SpecularPow(scratch.cosines.data(), scratch.exponents.data(), count, scratch.phongPowers.data());
+
+		//(phong + lambertDiffuse) * lambertCosine, saturated by the conversion to the target format
+		constexpr float DiffuseScale{ LightIntensity / Pi };
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const float power{ scratch.phongPowers[i] };
+			const float lambertCosine{ scratch.lambertCosines[i] };
+			scratch.result.r[i] = (scratch.specular.r[i] * power + scratch.diffuse.r[i] * DiffuseScale) * lambertCosine;
+			scratch.result.g[i] = (scratch.specular.g[i] * power + scratch.diffuse.g[i] * DiffuseScale) * lambertCosine;
+			scratch.result.b[i] = (scratch.specular.b[i] * power + scratch.diffuse.b[i] * DiffuseScale) * lambertCosine;
+		}
+
+		ColorBatch::Pack(scratch.result.r.data(), scratch.result.g.data(), scratch.result.b.data(), count, scratch.texels.data());
+		for (uint32_t i = 0; i < count; ++i)
+			m_FrameBuffer.color[batch.pixels[i]] = scratch.texels[i];
+	}
+
+	void SoftwareRasterizer::ShadeFire(RasterContext& context)
+	{
+		const FragmentBatch& batch{ context.batch };
+		const uint32_t count{ batch.count };
+		const FireMaterial& material{ *m_pFireMaterial };
+		const std::vector<Vector2>& uvs{ m_pGeometry->uvs };
+		ShadeScratch& scratch{ context.scratch };
+
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			uint32_t vertices[3]{};
+			float weights[3]{};
+			GetFragmentWeights(batch, i, vertices, weights);
+
+			scratch.u[i] = weights[0] * uvs[vertices[0]].x + weights[1] * uvs[vertices[1]].x + weights[2] * uvs[vertices[2]].x;
+			scratch.v[i] = weights[0] * uvs[vertices[0]].y + weights[1] * uvs[vertices[1]].y + weights[2] * uvs[vertices[2]].y;
+			scratch.texels[i] = m_FrameBuffer.color[batch.pixels[i]];
+		}
+
+		material.pDiffuseMap->Sample(material.sampler, scratch.u.data(), scratch.v.data(), count, scratch.diffuse, scratch.alpha.data());
+
+		//src_alpha, inv_src_alpha: the target towards the sample by its alpha
+		ColorBatch::Unpack(scratch.texels.data(), count, scratch.target.r.data(), scratch.target.g.data(), scratch.target.b.data());
+		ColorBatch::Lerp(scratch.target.r.data(), scratch.diffuse.r.data(), scratch.alpha.data(), count, scratch.result.r.data());
+		ColorBatch::Lerp(scratch.target.g.data(), scratch.diffuse.g.data(), scratch.alpha.data(), count, scratch.result.g.data());
+		ColorBatch::Lerp(scratch.target.b.data(), scratch.diffuse.b.data(), scratch.alpha.data(), count, scratch.result.b.data());
+
+		ColorBatch::Pack(scratch.result.r.data(), scratch.result.g.data(), scratch.result.b.data(), count, scratch.texels.data());
+		for (uint32_t i = 0; i < count; ++i)
+			m_FrameBuffer.color[batch.pixels[i]] = scratch.texels[i];
+	}
+}
@@ -0,0 +1,297 @@
+#pragma once
+#include "BatchTransform.h"
+#include "FrameBuffer.h"
+#include "FrameConstants.h"
+#include "HierarchicalDepthBuffer.h"
+#include "SoftwareTexture.h"
+#include "ThreadPool.h"
+#include "TriangleRaster.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace dae
+{
+	class MeshCache;
+
+	//One level of detail of a MeshCache decoded to floats, the vertex stage input of the SoftwareRasterizer
+	struct SoftwareGeometry
+	{
+		Vector3Stream positions{};
+		//Normalized like the vertex shader does, zero when the layout stores none
+		Vector3Stream normals{};
+		Vector3Stream tangents{};
+		std::vector<Vector2> uvs{};
+		//Triangle list
+		std::vector<uint32_t> indices{};
+
+		static SoftwareGeometry FromMeshCache(const MeshCache& meshCache, uint32_t lod = 0);
+		uint32_t GetNumVertices() const;
+		uint32_t GetNumTriangles() const;
+	};
+
+	//Inputs of Vehicle_Shader.fx: its four maps and the states the selected technique sets
+	struct VehicleMaterial
+	{
+		const SoftwareTexture* pDiffuseMap{};
+		const SoftwareTexture* pNormalMap{};
+		const SoftwareTexture* pSpecularMap{};
+		const SoftwareTexture* pGlossinessMap{};
+		sampleState sampler{ sampleState::point };
+		cullMode culling{ cullMode::backCulling };
+	};
+
+	//Inputs of Fire_Shader.fx: alpha blended over the target, depth tested but not written
+	struct FireMaterial
+	{
+		const SoftwareTexture* pDiffuseMap{};
+		sampleState sampler{ sampleState::point };
+		cullMode culling{ cullMode::noCulling };
+	};
+
+	//Time per pipeline stage and what went through it, summed over every draw since ResetStatistics.
+	//With the depth pre-pass, raster and the fragment counts include both passes over the vehicle
+	struct SoftwareRasterizerStatistics
+	{
+		double vertexMs{};
+		double setupMs{};
+		//Sorting the triangles into the tiles they overlap
+		double binMs{};
+		//Coverage, depth test and fragment batching, without the shading of the batches.
+		//Raster and shade add up the time of every thread working on the tiles
+		double rasterMs{};
+		double shadeMs{};
+
+		uint32_t numTriangles{};
+		//Facing away, covering no pixel center or crossing the near plane
+		uint32_t numTrianglesCulled{};
+		uint32_t numTrianglesRasterized{};
+		uint64_t numFragmentsTested{};
+		uint64_t numFragmentsShaded{};
+		//Fragments the depth pre-pass depth tested, part of numFragmentsTested
+		uint64_t numFragmentsPrePassed{};
+		//8x8 blocks of the triangles' bounding boxes, see TriangleRaster::BlockType
+		uint64_t numBlocksOutside{};
+		uint64_t numBlocksPartial{};
+		uint64_t numBlocksInside{};
+		//Rejected by the hierarchical depth buffer before any interpolation: a triangle over a whole tile, or a covered 8x8 block
+		uint64_t numTilesOccluded{};
+		uint64_t numBlocksOccluded{};
+		//Covered blocks in front of everything drawn there, their pixels skip the depth test
+		uint64_t numBlocksUnoccluded{};
+	};
+
+	//CPU reference of the hardware pipeline for the two effects: the same vertex transform, culling, D3D fill rules
+	//(pixel centers, top-left edges), less depth test and pixel shader math, into a FrameBuffer.
+	//Fragments that pass the depth test are shaded in batches, a structure of arrays at a time.
+	//Triangles are set up once per draw and binned into TileSize tiles by bounding box. The tiles are rasterized and shaded
+	//in parallel, each by one thread with the triangles in draw order, so the targets need no locks.
+	//Triangles are not clipped: the ones crossing the near plane are culled, the far plane is the depth test.
+	//A hierarchical depth buffer over the tiles and 8x8 blocks rejects occluded triangles and blocks before interpolation.
+	//The optional depth pre-pass rasterizes the vehicle's depth alone first, then shades only the fragments equal to it
+	class SoftwareRasterizer final
+	{
+	public:
+		static constexpr uint32_t TileSize{ 64 };
+
+		//numThreads includes the calling thread, which works on tiles too. 0: one per hardware thread
+		SoftwareRasterizer(uint32_t width, uint32_t height, uint32_t numThreads = 1);
+		~SoftwareRasterizer() = default;
+
+		// -----------------------------------------------
+		// Copy/move constructors and assignment operators
+		// -----------------------------------------------
+		SoftwareRasterizer(const SoftwareRasterizer& other)					= delete;
+		SoftwareRasterizer(SoftwareRasterizer&& other) noexcept				= delete;
+		SoftwareRasterizer& operator=(const SoftwareRasterizer& other)		= delete;
+		SoftwareRasterizer& operator=(SoftwareRasterizer&& other) noexcept	= delete;
+
+		//------------------------------------------------
+		// Public member functions
+		//------------------------------------------------
+		//Clears the targets and keeps the camera for the draws that follow
+		void BeginFrame(const FrameConstants& frameConstants, const ColorRGB& clearColor);
+		void DrawVehicle(const SoftwareGeometry& geometry, const Matrix& worldMatrix, const VehicleMaterial& material);
+		void DrawFire(const SoftwareGeometry& geometry, const Matrix& worldMatrix, const FireMaterial& material);
+
+		const FrameBuffer& GetFrameBuffer() const;
+		const SoftwareRasterizerStatistics& GetStatistics() const;
+		void ResetStatistics();
+		uint32_t GetNumThreads() const;
+		//On by default, the image is the same either way. Takes effect with the next BeginFrame
+		void SetHierarchicalDepth(bool isEnabled);
+		//Off by default. The vehicle's triangles are rasterized twice, a fragment is shaded only where it ends up visible.
+		//The image is the same unless two triangles give a pixel the exact same depth: then the last one drawn shows
+		//instead of the first, like the less_equal test of the hardware's shading pass
+		void SetDepthPrePass(bool isEnabled);
+
+	private:
+		enum class PixelShader
+		{
+			Vehicle,
+			Fire
+		};
+
+		//What RasterizeTile does with the fragments
+		enum class RasterPass
+		{
+			//Less test, the pixel shader's depth write and blending
+			Color,
+			//Less test and depth write, nothing shaded
+			Depth,
+			//Less or equal test against the pre-pass's depth, nothing written but the color
+			ColorAfterDepth
+		};
+
+		//Triangle on screen, vertices ordered so the signed area is positive (clockwise on screen)
+		struct TriangleSetup
+		{
+			RasterTriangle edges{};
+			float z[3]{};
+			float inverseW[3]{};
+			uint32_t vertices[3]{};
+			float inverseArea{};
+			//z / w over the screen in doubles, the same function of the edge values the pixels interpolate
+			double depthOffset{};
+			double depthStepX{};
+			double depthStepY{};
+			//What the interpolated depths can be off by in floats, see GetDepthBounds
+			float depthError{};
+			float nearestZ{};
+			float farthestZ{};
+			//Pixels whose centers the bounding box contains, inclusive and inside the viewport
+			int minX{};
+			int minY{};
+			int maxX{};
+			int maxY{};
+		};
+
+		//Fragments that passed the depth test, waiting to be shaded together
+		struct FragmentBatch
+		{
+			static constexpr uint32_t Capacity{ 1024 };
+
+			uint32_t count{};
+			uint32_t pixels[Capacity]{};
+			uint32_t triangles[Capacity]{};
+			//Perspective correct weights of the second and third vertex
+			float weights1[Capacity]{};
+			float weights2[Capacity]{};
+		};
+
+		//Conservative range of the depth the pixels of a rectangle interpolate, for the hierarchical depth buffer
+		struct DepthBounds
+		{
+			float nearest{};
+			float farthest{};
+		};
+
+		//Depth and perspective correct weights of the second and third vertex for the 8 pixels of a block row
+		struct RowAttributes
+		{
+			float depth[TriangleRaster::BlockSize]{};
+			float weights1[TriangleRaster::BlockSize]{};
+			float weights2[TriangleRaster::BlockSize]{};
+		};
+
+		//Structure of arrays inputs and intermediates of the pixel shaders, one element per batched fragment
+		struct ShadeScratch
+		{
+			std::vector<float> u{};
+			std::vector<float> v{};
+			Vector3Stream normals{};
+			Vector3Stream tangents{};
+			Vector3Stream viewDirections{};
+			ColorRGBStream diffuse{};
+			ColorRGBStream normalSamples{};
+			ColorRGBStream specular{};
+			ColorRGBStream glossiness{};
+			ColorRGBStream target{};
+			ColorRGBStream result{};
+			std::vector<float> alpha{};
+			std::vector<float> inverseLengths{};
+			std::vector<float> inverseViewLengths{};
+			std::vector<float> cosines{};
+			std::vector<float> exponents{};
+			std::vector<float> lambertCosines{};
+			std::vector<float> phongPowers{};
+			std::vector<ColorRGBA8> texels{};
+
+			void Resize(uint32_t count);
+		};
+
+		//What one thread needs to rasterize and shade a tile, nothing in it is shared
+		struct RasterContext
+		{
+			FragmentBatch batch{};
+			ShadeScratch scratch{};
+			uint32_t stamp{ 1 };
+
+			double rasterMs{};
+			double shadeMs{};
+			uint64_t numFragmentsTested{};
+			uint64_t numFragmentsShaded{};
+			uint64_t numFragmentsPrePassed{};
+			uint64_t numBlocks[3]{};
+			uint64_t numTilesOccluded{};
+			uint64_t numBlocksOccluded{};
+			uint64_t numBlocksUnoccluded{};
+		};
+
+		//------------------------------------------------
+		// Member Variables
+		//------------------------------------------------
+		FrameBuffer m_FrameBuffer{};
+		FrameConstants m_FrameConstants{};
+		SoftwareRasterizerStatistics m_Statistics{};
+		HierarchicalDepthBuffer m_HierarchicalDepth{};
+		bool m_IsHierarchicalDepth{ true };
+		//Latched by BeginFrame, the levels are only kept up to date while it is set
+		bool m_IsHierarchicalDepthActive{ true };
+		bool m_IsDepthPrePass{ false };
+
+		//Vertex stage output of the current draw: x and y in pixels, z / w, and w
+		std::vector<Vector4> m_ScreenPositions{};
+		std::vector<Vector4> m_WorldPositions{};
+		Vector3Stream m_WorldNormals{};
+		Vector3Stream m_WorldTangents{};
+		std::vector<TriangleSetup> m_Triangles{};
+
+		//Indices into m_Triangles per tile, row after row, in draw order
+		uint32_t m_NumTilesX{};
+		uint32_t m_NumTilesY{};
+		std::vector<std::vector<uint32_t>> m_TileBins{};
+
+		//One per thread. The caller uses the first, the pool's workers the others
+		std::vector<std::unique_ptr<RasterContext>> m_pContexts{};
+		std::unique_ptr<ThreadPool> m_pThreadPool{};
+		//Flush number of the last batched fragment per pixel: blending needs the previous fragment written first.
+		//Written only by the thread that owns the pixel's tile
+		std::vector<uint32_t> m_PixelStamps{};
+
+		PixelShader m_PixelShader{ PixelShader::Vehicle };
+		RasterPass m_RasterPass{ RasterPass::Color };
+		const SoftwareGeometry* m_pGeometry{ nullptr };
+		const VehicleMaterial* m_pVehicleMaterial{ nullptr };
+		const FireMaterial* m_pFireMaterial{ nullptr };
+
+		//------------------------------------------------
+		// Private member functions
+		//------------------------------------------------
+		void Draw(const SoftwareGeometry& geometry, const Matrix& worldMatrix, cullMode culling);
+		void RunVertexStage(const SoftwareGeometry& geometry, const Matrix& worldMatrix);
+		void RunSetupStage(const SoftwareGeometry& geometry, cullMode culling);
+		void BinTriangles();
+		void RasterizeTiles();
+		void RasterizeTile(RasterContext& context, uint32_t tile);
+		//Pixels minX to maxX, minY to maxY, inclusive
+		static DepthBounds GetDepthBounds(const TriangleSetup& setup, int minX, int minY, int maxX, int maxY);
+		//rowEdges: the edge values at the row's first pixel, stepX: their change per pixel
+		static void InterpolateRow(const TriangleSetup& setup, const float rowEdges[3], const float stepX[3], RowAttributes& attributes);
+		void FlushFragments(RasterContext& context);
+		void ShadeVehicle(RasterContext& context);
+		void ShadeFire(RasterContext& context);
+		//The vertices of a batched fragment's triangle and its three perspective correct weights
+		void GetFragmentWeights(const FragmentBatch& batch, uint32_t fragment, uint32_t vertices[3], float weights[3]) const;
+	};
+}
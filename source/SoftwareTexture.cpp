@@ -0,0 +1,162 @@
+#include "pch.h"
+#include "SoftwareTexture.h"
+#include <cmath>
+
+namespace dae
+{
+	namespace
+	{
+		constexpr float ChannelScale{ 1.f / 255.f };
+
+		//Gathered texels and filter weights of one Sample call. Per thread so rasterizer threads can sample concurrently
+		struct SampleScratch
+		{
+			std::vector<ColorRGBA8> texels[4]{};
+			ColorRGBStream colors[4]{};
+			std::vector<float> weightsX{};
+			std::vector<float> weightsY{};
+
+			void Resize(uint32_t count, uint32_t numTaps)
+			{
+				for (uint32_t tap = 0; tap < numTaps; ++tap)
+				{
+					texels[tap].resize(count);
+					colors[tap].Resize(count);
+				}
+				weightsX.resize(count);
+				weightsY.resize(count);
+			}
+		};
+
+		thread_local SampleScratch g_Scratch{};
+
+		//Wrap addressing: the fraction of a coordinate, in [0, 1)
+		inline float Wrap(float coordinate)
+		{
+			return coordinate - std::floor(coordinate);
+		}
+	}
+
+	SoftwareTexture::SoftwareTexture(uint32_t width, uint32_t height, std::vector<ColorRGBA8> texels)
+		: m_Width{ width }
+		, m_Height{ height }
+		, m_Texels{ std::move(texels) }
+	{
+		if (m_Texels.size() != static_cast<size_t>(width) * height)
+		{
+			m_Width = 0;
+			m_Height = 0;
+			m_Texels.clear();
+		}
+	}
+
+	uint32_t SoftwareTexture::GetWidth() const
+	{
+		return m_Width;
+	}
+
+	uint32_t SoftwareTexture::GetHeight() const
+	{
+		return m_Height;
+	}
+
+	const ColorRGBA8* SoftwareTexture::GetTexels() const
+	{
+		return m_Texels.data();
+	}
+
+	bool SoftwareTexture::IsValid() const
+	{
+		return !m_Texels.empty();
+	}
+
+	void SoftwareTexture::Sample(sampleState state, const float* pU, const float* pV, uint32_t count, ColorRGBStream& result, float* pAlpha) const
+	{
+		result.Resize(count);
+		if (!IsValid())
+		{
+			//Like an unbound shader resource: black and transparent
+			std::fill(result.r.begin(), result.r.end(), 0.f);
+			std::fill(result.g.begin(), result.g.end(), 0.f);
+			std::fill(result.b.begin(), result.b.end(), 0.f);
+			if (pAlpha)
+				std::fill(pAlpha, pAlpha + count, 0.f);
+			return;
+		}
+
+		if (state == sampleState::point)
+			SamplePoint(pU, pV, count, result, pAlpha);
+		else
+			SampleLinear(pU, pV, count, result, pAlpha);
+	}
+
+	void SoftwareTexture::SamplePoint(const float* pU, const float* pV, uint32_t count, ColorRGBStream& result, float* pAlpha) const
+	{
+		SampleScratch& scratch{ g_Scratch };
+		scratch.Resize(count, 1);
+
+		const float width{ static_cast<float>(m_Width) };
+		const float height{ static_cast<float>(m_Height) };
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			//A fraction just below 1 can round up to the texture size
+			const uint32_t x{ std::min(static_cast<uint32_t>(Wrap(pU[i]) * width), m_Width - 1) };
+			const uint32_t y{ std::min(static_cast<uint32_t>(Wrap(pV[i]) * height), m_Height - 1) };
+			scratch.texels[0][i] = m_Texels[y * m_Width + x];
+		}
+
+		ColorBatch::Unpack(scratch.texels[0].data(), count, result);
+		if (pAlpha)
+		{
+			for (uint32_t i = 0; i < count; ++i)
+				pAlpha[i] = static_cast<float>(scratch.texels[0][i].a) * ChannelScale;
+		}
+	}
+
+	void SoftwareTexture::SampleLinear(const float* pU, const float* pV, uint32_t count, ColorRGBStream& result, float* pAlpha) const
+	{
+		SampleScratch& scratch{ g_Scratch };
+		scratch.Resize(count, 4);
+
+		const float width{ static_cast<float>(m_Width) };
+		const float height{ static_cast<float>(m_Height) };
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			//Texel centers sit at half coordinates: the left tap is the one at or before u * width - 0.5, wrapped
+			const float x{ Wrap(pU[i]) * width - 0.5f };
+			const float y{ Wrap(pV[i]) * height - 0.5f };
+			const float left{ std::floor(x) };
+			const float top{ std::floor(y) };
+			scratch.weightsX[i] = x - left;
+			scratch.weightsY[i] = y - top;
+
+			const uint32_t x0{ left < 0.f ? m_Width - 1 : std::min(static_cast<uint32_t>(left), m_Width - 1) };
+			const uint32_t y0{ top < 0.f ? m_Height - 1 : std::min(static_cast<uint32_t>(top), m_Height - 1) };
+			const uint32_t x1{ x0 + 1 == m_Width ? 0 : x0 + 1 };
+			const uint32_t y1{ y0 + 1 == m_Height ? 0 : y0 + 1 };
+
+			scratch.texels[0][i] = m_Texels[y0 * m_Width + x0];
+			scratch.texels[1][i] = m_Texels[y0 * m_Width + x1];
+			scratch.texels[2][i] = m_Texels[y1 * m_Width + x0];
+			scratch.texels[3][i] = m_Texels[y1 * m_Width + x1];
+		}
+
+		for (uint32_t tap = 0; tap < 4; ++tap)
+			ColorBatch::Unpack(scratch.texels[tap].data(), count, scratch.colors[tap]);
+
+		//Horizontal pairs first, then between the rows
+		ColorBatch::Lerp(scratch.colors[0], scratch.colors[1], scratch.weightsX.data(), scratch.colors[0]);
+		ColorBatch::Lerp(scratch.colors[2], scratch.colors[3], scratch.weightsX.data(), scratch.colors[2]);
+		ColorBatch::Lerp(scratch.colors[0], scratch.colors[2], scratch.weightsY.data(), result);
+
+		if (pAlpha)
+		{
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				const float top{ Lerpf(static_cast<float>(scratch.texels[0][i].a), static_cast<float>(scratch.texels[1][i].a), scratch.weightsX[i]) };
+				const float bottom{ Lerpf(static_cast<float>(scratch.texels[2][i].a), static_cast<float>(scratch.texels[3][i].a), scratch.weightsX[i]) };
+				pAlpha[i] = Lerpf(top, bottom, scratch.weightsY[i]) * ChannelScale;
+			}
+		}
+	}
+}
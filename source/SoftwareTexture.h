@@ -0,0 +1,42 @@
+#pragma once
+#include "ColorBatch.h"
+#include "DataTypes.h"
+#include <cstdint>
+#include <vector>
+
+namespace dae
+{
+	//CPU copy of a texture for the software rasterizer, RGBA8 texels row after row.
+	//Samples like the effects' samplers: wrap addressing, texel centers at half coordinates
+	class SoftwareTexture final
+	{
+	public:
+		SoftwareTexture() = default;
+		SoftwareTexture(uint32_t width, uint32_t height, std::vector<ColorRGBA8> texels);
+
+		//------------------------------------------------
+		// Public member functions
+		//------------------------------------------------
+		uint32_t GetWidth() const;
+		uint32_t GetHeight() const;
+		const ColorRGBA8* GetTexels() const;
+		bool IsValid() const;
+
+		//count samples at once into result, and alpha into pAlpha when given. Anisotropic filtering samples like linear
+		void Sample(sampleState state, const float* pU, const float* pV, uint32_t count, ColorRGBStream& result, float* pAlpha = nullptr) const;
+
+	private:
+		//------------------------------------------------
+		// Member Variables
+		//------------------------------------------------
+		uint32_t m_Width{};
+		uint32_t m_Height{};
+		std::vector<ColorRGBA8> m_Texels{};
+
+		//------------------------------------------------
+		// Private member functions
+		//------------------------------------------------
+		void SamplePoint(const float* pU, const float* pV, uint32_t count, ColorRGBStream& result, float* pAlpha) const;
+		void SampleLinear(const float* pU, const float* pV, uint32_t count, ColorRGBStream& result, float* pAlpha) const;
+	};
+}
@@ -8,8 +8,20 @@
 namespace dae
 {
 	Texture::Texture(ID3D11Device* pDeviceInput, const char* filePath)
+		: Texture(pDeviceInput, IMG_Load(filePath))
 	{
-		m_pSurface = IMG_Load(filePath);
+	}
+
+	Texture::Texture(ID3D11Device* pDeviceInput, SDL_Surface* pSurface)
+		: m_pSurface{ pSurface }
+	{
+		//Both the GPU copy and Sample read the pixels as ColorRGBA8
+		if (m_pSurface->format->format != SDL_PIXELFORMAT_RGBA32)
+		{
+			SDL_Surface* pConverted{ SDL_ConvertSurfaceFormat(m_pSurface, SDL_PIXELFORMAT_RGBA32, 0) };
+			SDL_FreeSurface(m_pSurface);
+			m_pSurface = pConverted;
+		}
 
 		D3D11_TEXTURE2D_DESC desc;
 		desc.Width = m_pSurface->w;
@@ -58,34 +70,29 @@ namespace dae
 
 	ColorRGB Texture::Sample(const Vector2& uv) const
 	{
-		//TODO
-		//Sample the correct texel for the given uv
-		const float uvX{ Saturate(uv.x) };
-		const float uvY{ Saturate(uv.y) };
-
-		uint32_t* m_pSurfacePixels{ (uint32_t*)m_pSurface->pixels };
-
-		ColorRGB color{};
-
-		Uint8 r{};
-		Uint8 g{};
-		Uint8 b{};
-
-		float width { static_cast<float>(m_pSurface->w) };
-		float height{ static_cast<float>(m_pSurface->h) };
-
-		uint32_t px{ static_cast<uint32_t>( width * uvX) },
-				 py{ static_cast<uint32_t>(height * uvY) };
-
-		SDL_GetRGB(m_pSurfacePixels[px + (py * m_pSurface->w)], m_pSurface->format, &r, &g, &b);
+		return GetTexel(uv.x, uv.y).ToColor();
+	}
 
-		color.r = static_cast<float>(r);
-		color.g = static_cast<float>(g);
-		color.b = static_cast<float>(b);
+	SoftwareTexture Texture::CreateSoftwareTexture() const
+	{
+		const uint32_t width{ static_cast<uint32_t>(m_pSurface->w) };
+		const uint32_t height{ static_cast<uint32_t>(m_pSurface->h) };
+		std::vector<ColorRGBA8> texels(static_cast<size_t>(width) * height);
+		for (uint32_t y = 0; y < height; ++y)
+		{
+			const uint8_t* pRow{ static_cast<const uint8_t*>(m_pSurface->pixels) + y * m_pSurface->pitch };
+			std::copy_n(reinterpret_cast<const ColorRGBA8*>(pRow), width, texels.data() + y * width);
+		}
+		return SoftwareTexture{ width, height, std::move(texels) };
+	}
 
-		color /= 255.f;
+	ColorRGBA8 Texture::GetTexel(float u, float v) const
+	{
+		const int px{ std::min(static_cast<int>(m_pSurface->w * Saturate(u)), m_pSurface->w - 1) };
+		const int py{ std::min(static_cast<int>(m_pSurface->h * Saturate(v)), m_pSurface->h - 1) };
 
-		return color;
+		const uint8_t* pRow{ static_cast<const uint8_t*>(m_pSurface->pixels) + py * m_pSurface->pitch };
+		return reinterpret_cast<const ColorRGBA8*>(pRow)[px];
 	}
 
 	ID3D11ShaderResourceView* Texture::GetResourceViewTexturePtr()
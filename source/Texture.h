@@ -3,6 +3,7 @@
 #include <SDL_surface.h>
 #include <string>
 #include "ColorRGB.h"
+#include "SoftwareTexture.h"
 
 namespace dae
 {
@@ -12,6 +13,8 @@ namespace dae
 	{
 	public:
 		Texture(ID3D11Device* pDeviceInput, const char* filePath);
+		//Takes ownership of an already decoded surface, see AssetLoader::DecodeImage
+		Texture(ID3D11Device* pDeviceInput, SDL_Surface* pSurface);
 		~Texture();
 
 		// -----------------------------------------------
@@ -26,9 +29,13 @@ namespace dae
 		// Public member functions						
 		//------------------------------------------------
 		ColorRGB Sample(const Vector2& uv) const;
+		//Copy of the pixels for the software rasterizer
+		SoftwareTexture CreateSoftwareTexture() const;
 		ID3D11ShaderResourceView* GetResourceViewTexturePtr();
 
 	private:
+		ColorRGBA8 GetTexel(float u, float v) const;
+
 		//------------------------------------------------
 		// Member Variables						
 		//------------------------------------------------
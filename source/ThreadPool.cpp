@@ -0,0 +1,57 @@
+#include "pch.h"
+#include "ThreadPool.h"
+
+namespace dae
+{
+	ThreadPool::ThreadPool(uint32_t numThreads)
+	{
+		if (numThreads == 0)
+			numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+		m_Workers.reserve(numThreads);
+		for (uint32_t i = 0; i < numThreads; ++i)
+		{
+			m_Workers.emplace_back([this]() { RunWorker(); });
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			const std::lock_guard<std::mutex> lock{ m_Mutex };
+			m_IsStopping = true;
+		}
+		m_Condition.notify_all();
+
+		for (std::thread& worker : m_Workers)
+		{
+			worker.join();
+		}
+	}
+
+	uint32_t ThreadPool::GetNumThreads() const
+	{
+		return static_cast<uint32_t>(m_Workers.size());
+	}
+
+	void ThreadPool::RunWorker()
+	{
+		while (true)
+		{
+			std::function<void()> task{};
+			{
+				std::unique_lock<std::mutex> lock{ m_Mutex };
+				m_Condition.wait(lock, [this]() { return m_IsStopping || !m_Tasks.empty(); });
+
+				//Drain the queue before stopping so no future is left without a value
+				if (m_Tasks.empty())
+					return;
+
+				task = std::move(m_Tasks.front());
+				m_Tasks.pop();
+			}
+
+			task();
+		}
+	}
+}
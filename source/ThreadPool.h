@@ -0,0 +1,67 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace dae
+{
+	//Fixed set of worker threads running submitted tasks in FIFO order.
+	//The destructor finishes every queued task before joining
+	class ThreadPool final
+	{
+	public:
+		//0 threads: one per hardware thread
+		explicit ThreadPool(uint32_t numThreads = 0);
+		~ThreadPool();
+
+		// -----------------------------------------------
+		// Copy/move constructors and assignment operators
+		// -----------------------------------------------
+		ThreadPool(const ThreadPool& other)					= delete;
+		ThreadPool(ThreadPool&& other) noexcept				= delete;
+		ThreadPool& operator=(const ThreadPool& other)		= delete;
+		ThreadPool& operator=(ThreadPool&& other) noexcept	= delete;
+
+		//------------------------------------------------
+		// Public member functions
+		//------------------------------------------------
+		//The future holds the result, or the exception the task threw
+		template <typename Function>
+		std::future<std::invoke_result_t<std::decay_t<Function>>> Submit(Function&& function)
+		{
+			using Result = std::invoke_result_t<std::decay_t<Function>>;
+
+			//std::function needs a copyable target, packaged_task is move-only
+			auto pTask{ std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function)) };
+			std::future<Result> future{ pTask->get_future() };
+			{
+				const std::lock_guard<std::mutex> lock{ m_Mutex };
+				m_Tasks.emplace([pTask]() { (*pTask)(); });
+			}
+			m_Condition.notify_one();
+			return future;
+		}
+
+		uint32_t GetNumThreads() const;
+
+	private:
+		//------------------------------------------------
+		// Member Variables
+		//------------------------------------------------
+		std::vector<std::thread> m_Workers{};
+		std::queue<std::function<void()>> m_Tasks{};
+		std::mutex m_Mutex{};
+		std::condition_variable m_Condition{};
+		bool m_IsStopping{ false };
+
+		//------------------------------------------------
+		// Private member functions
+		//------------------------------------------------
+		void RunWorker();
+	};
+}
@@ -0,0 +1,162 @@
+#include "pch.h"
+#include "TriangleRaster.h"
+#include "Simd.h"
+#include <cmath>
+
+namespace dae
+{
+	namespace
+	{
+		//std::floor is a library call without SSE4.1, and the guard band keeps values far inside the int range
+		inline int32_t FloorToInt(float value)
+		{
+			const int32_t truncated{ static_cast<int32_t>(value) };
+			return truncated - (static_cast<float>(truncated) > value);
+		}
+	}
+
+	bool RasterTriangle::Snap(float x, float y, int32_t& fixedX, int32_t& fixedY)
+	{
+		//Written so NaN fails too
+		if (!(std::abs(x) < GuardBand && std::abs(y) < GuardBand))
+			return false;
+
+		fixedX = FloorToInt(x * SubpixelScale + 0.5f);
+		fixedY = FloorToInt(y * SubpixelScale + 0.5f);
+		return true;
+	}
+
+	int64_t RasterTriangle::GetSignedDoubleArea(const int32_t x[3], const int32_t y[3])
+	{
+		return static_cast<int64_t>(x[1] - x[0]) * (y[2] - y[0]) - static_cast<int64_t>(y[1] - y[0]) * (x[2] - x[0]);
+	}
+
+	RasterTriangle RasterTriangle::Create(const int32_t x[3], const int32_t y[3])
+	{
+		constexpr int32_t Scale{ 1 << SubpixelBits };
+		constexpr int32_t HalfPixel{ Scale / 2 };
+
+		RasterTriangle triangle{};
+		triangle.doubleArea = GetSignedDoubleArea(x, y);
+
+		for (int edge{ 0 }; edge < 3; ++edge)
+		{
+			const int from{ (edge + 1) % 3 };
+			const int to{ (edge + 2) % 3 };
+			const int32_t dx{ x[to] - x[from] };
+			const int32_t dy{ y[to] - y[from] };
+
+			//Top-left rule: centers exactly on an edge belong to the triangle for a top edge (horizontal, inside below it)
+			//or a left edge (inside to its right). For clockwise triangles on screen that is an edge going up, or going right
+			//Written without branches, edge directions are as good as random
+			const int32_t isNotTopLeft{ static_cast<int32_t>(dy > 0) | (static_cast<int32_t>(dy == 0) & static_cast<int32_t>(dx <= 0)) };
+
+			//dx * (py - fromY) - dy * (px - fromX) at the pixel center px = x * Scale + HalfPixel
+			triangle.stepX[edge] = -dy * Scale;
+			triangle.stepY[edge] = dx * Scale;
+			triangle.offset[edge] = static_cast<int64_t>(dx) * (HalfPixel - y[from]) - static_cast<int64_t>(dy) * (HalfPixel - x[from]) - isNotTopLeft;
+		}
+
+		//Pixel centers inside the snapped bounds, the shifts round towards minus infinity
+		const int32_t minX{ std::min(x[0], std::min(x[1], x[2])) };
+		const int32_t minY{ std::min(y[0], std::min(y[1], y[2])) };
+		const int32_t maxX{ std::max(x[0], std::max(x[1], x[2])) };
+		const int32_t maxY{ std::max(y[0], std::max(y[1], y[2])) };
+		triangle.minX = (minX - HalfPixel + Scale - 1) >> SubpixelBits;
+		triangle.minY = (minY - HalfPixel + Scale - 1) >> SubpixelBits;
+		triangle.maxX = (maxX - HalfPixel) >> SubpixelBits;
+		triangle.maxY = (maxY - HalfPixel) >> SubpixelBits;
+
+		return triangle;
+	}
+
+	int64_t RasterTriangle::GetEdgeValue(int edge, int pixelX, int pixelY) const
+	{
+		return offset[edge] + static_cast<int64_t>(stepX[edge]) * pixelX + static_cast<int64_t>(stepY[edge]) * pixelY;
+	}
+
+	namespace TriangleRaster
+	{
+		BlockType GetBlockCoverage(const RasterTriangle& triangle, int blockX, int blockY, uint8_t pRowMasks[BlockSize])
+		{
+			constexpr int Last{ BlockSize - 1 };
+
+			//Edges crossing the block: their values fit 32 bits there, at most 7 steps either way from 0
+			int32_t values[3]{};
+			int32_t stepsX[3]{};
+			int32_t stepsY[3]{};
+			int numCrossing{ 0 };
+
+			for (int edge{ 0 }; edge < 3; ++edge)
+			{
+				const int64_t corner{ triangle.GetEdgeValue(edge, blockX, blockY) };
+				const int64_t spanX{ static_cast<int64_t>(triangle.stepX[edge]) * Last };
+				const int64_t spanY{ static_cast<int64_t>(triangle.stepY[edge]) * Last };
+				const int64_t minValue{ corner + std::min<int64_t>(spanX, 0) + std::min<int64_t>(spanY, 0) };
+				const int64_t maxValue{ corner + std::max<int64_t>(spanX, 0) + std::max<int64_t>(spanY, 0) };
+
+				if (maxValue < 0)
+					return BlockType::Outside;
+				if (minValue >= 0)
+					continue;
+
+				values[numCrossing] = static_cast<int32_t>(corner);
+				stepsX[numCrossing] = triangle.stepX[edge];
+				stepsY[numCrossing] = triangle.stepY[edge];
+				++numCrossing;
+			}
+
+			if (numCrossing == 0)
+				return BlockType::Inside;
+
+#if defined(DAE_SIMD_SSE)
+			//Left and right half of the row per crossing edge, stepped down a row at a time
+			__m128i left[3]{}, right[3]{}, down[3]{};
+			for (int edge{ 0 }; edge < numCrossing; ++edge)
+			{
+				const int32_t stepX{ stepsX[edge] };
+				left[edge] = _mm_add_epi32(_mm_set1_epi32(values[edge]), _mm_setr_epi32(0, stepX, stepX * 2, stepX * 3));
+				right[edge] = _mm_add_epi32(left[edge], _mm_set1_epi32(stepX * 4));
+				down[edge] = _mm_set1_epi32(stepsY[edge]);
+			}
+
+			const __m128i minusOne{ _mm_set1_epi32(-1) };
+			for (int row{ 0 }; row < BlockSize; ++row)
+			{
+				__m128i isLeftInside{ _mm_cmpgt_epi32(left[0], minusOne) };
+				__m128i isRightInside{ _mm_cmpgt_epi32(right[0], minusOne) };
+				for (int edge{ 1 }; edge < numCrossing; ++edge)
+				{
+					isLeftInside = _mm_and_si128(isLeftInside, _mm_cmpgt_epi32(left[edge], minusOne));
+					isRightInside = _mm_and_si128(isRightInside, _mm_cmpgt_epi32(right[edge], minusOne));
+				}
+				pRowMasks[row] = static_cast<uint8_t>(_mm_movemask_ps(_mm_castsi128_ps(isLeftInside)) | (_mm_movemask_ps(_mm_castsi128_ps(isRightInside)) << 4));
+
+				for (int edge{ 0 }; edge < numCrossing; ++edge)
+				{
+					left[edge] = _mm_add_epi32(left[edge], down[edge]);
+					right[edge] = _mm_add_epi32(right[edge], down[edge]);
+				}
+			}
+#else
+			for (int row{ 0 }; row < BlockSize; ++row)
+			{
+				uint32_t mask{ 0xff };
+				for (int edge{ 0 }; edge < numCrossing; ++edge)
+				{
+					int32_t value{ values[edge] };
+					for (int column{ 0 }; column < BlockSize; ++column)
+					{
+						mask &= ~(static_cast<uint32_t>(value < 0) << column);
+						value += stepsX[edge];
+					}
+					values[edge] += stepsY[edge];
+				}
+				pRowMasks[row] = static_cast<uint8_t>(mask);
+			}
+#endif
+
+			return BlockType::Partial;
+		}
+	}
+}
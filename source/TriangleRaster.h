@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+
+namespace dae
+{
+	//Triangle snapped to a 1/16 pixel grid with its edge functions in integers: triangles sharing an edge cover every pixel
+	//center exactly once, however the edges are stepped. Edge k is opposite vertex k, its value at a pixel center is vertex k's
+	//barycentric weight times doubleArea, minus one on edges that are not top-left. Covered where all three are >= 0
+	struct RasterTriangle
+	{
+		static constexpr int SubpixelBits{ 4 };
+		static constexpr float SubpixelScale{ 1 << SubpixelBits };
+		//Vertices further from the origin, in pixels, would overflow the fixed point math. Triangles reaching that far need clipping
+		static constexpr float GuardBand{ 8192.f };
+
+		//Edge value change per pixel to the right and down
+		int32_t stepX[3]{};
+		int32_t stepY[3]{};
+		//Edge values at the center of pixel (0, 0)
+		int64_t offset[3]{};
+		//Positive, in 1/256 square pixels
+		int64_t doubleArea{};
+		//Pixels whose centers the bounding box contains, inclusive, not clipped to the viewport
+		int minX{};
+		int minY{};
+		int maxX{};
+		int maxY{};
+
+		//Rounds to the grid. False when the point is outside the guard band or not a number
+		static bool Snap(float x, float y, int32_t& fixedX, int32_t& fixedY);
+		//Positive for triangles that are clockwise on screen (y down), 0 for degenerate ones
+		static int64_t GetSignedDoubleArea(const int32_t x[3], const int32_t y[3]);
+		//Snapped vertices with a positive area
+		static RasterTriangle Create(const int32_t x[3], const int32_t y[3]);
+
+		int64_t GetEdgeValue(int edge, int pixelX, int pixelY) const;
+	};
+
+	//Half-space rasterization of 8x8 pixel blocks: one test of the edge functions at the block corners rejects or accepts
+	//the whole block, only blocks an edge crosses are evaluated per pixel
+	namespace TriangleRaster
+	{
+		constexpr int BlockSize{ 8 };
+
+		enum class BlockType : uint8_t
+		{
+			Outside,	//no pixel center covered
+			Partial,	//coverage per row in the masks
+			Inside		//every pixel center covered
+		};
+
+		//The block whose top left pixel is blockX, blockY (multiples of BlockSize). For partial blocks bit i of pRowMasks[row]
+		//is pixel (blockX + i, blockY + row). The 8 pixel rows are stepped incrementally, 4 pixels per instruction with SSE
+		//(see Simd.h; AVX has no 256-bit integer operations), only for the edges that cross the block
+		BlockType GetBlockCoverage(const RasterTriangle& triangle, int blockX, int blockY, uint8_t pRowMasks[BlockSize]);
+	}
+}
@@ -2,6 +2,8 @@
 #include "pch.h"
 #include <fstream>
 #include "Math.h"
+#include "DataTypes.h"
+#include "ObjVertexKey.h"
 
 namespace dae
 {
@@ -23,6 +25,8 @@ namespace dae
 			vertices.clear();
 			indices.clear();
 
+			ObjVertexMap weldedVertices{};
+
 			std::string sCommand;
 			// start a while iteration ending when the end of file is reached (ios::eof)
 			while (!file.eof())
@@ -65,15 +69,14 @@ namespace dae
 					//add the material index as attibute to the attribute array
 					//
 					// Faces or triangles
-					Vertex_In vertex{};
-					size_t iPosition, iTexCoord, iNormal;
-
+					// Corners that reference the same position/uv/normal triple are welded into one shared vertex
 					uint32_t tempIndices[3];
 					for (size_t iFace = 0; iFace < 3; iFace++)
 					{
+						ObjVertexKey key{};
+
 						// OBJ format uses 1-based arrays
-						file >> iPosition;
-						vertex.position = positions[iPosition - 1];
+						file >> key.position;
 
 						if ('/' == file.peek())//is next in buffer ==  '/' ?
 						{
@@ -82,8 +85,7 @@ namespace dae
 							if ('/' != file.peek())
 							{
 								// Optional texture coordinate
-								file >> iTexCoord;
-								vertex.uv = UVs[iTexCoord - 1];
+								file >> key.texCoord;
 							}
 
 							if ('/' == file.peek())
@@ -91,14 +93,24 @@ namespace dae
 								file.ignore();
 
 								// Optional vertex normal
-								file >> iNormal;
-								vertex.normal = normals[iNormal - 1];
+								file >> key.normal;
 							}
 						}
 
-						vertices.push_back(vertex);
-						tempIndices[iFace] = uint32_t(vertices.size()) - 1;
-						//indices.push_back(uint32_t(vertices.size()) - 1);
+						const auto [it, isNew] { weldedVertices.try_emplace(key, uint32_t(vertices.size())) };
+						if (isNew)
+						{
+							Vertex_In vertex{};
+							vertex.position = positions[key.position - 1];
+							if (key.texCoord)
+								vertex.uv = UVs[key.texCoord - 1];
+							if (key.normal)
+								vertex.normal = normals[key.normal - 1];
+
+							vertices.push_back(vertex);
+						}
+
+						tempIndices[iFace] = it->second;
 					}
 
 					indices.push_back(tempIndices[0]);
@@ -135,7 +147,13 @@ namespace dae
 				const Vector3 edge1 = p2 - p0;
 				const Vector2 diffX = Vector2(uv1.x - uv0.x, uv2.x - uv0.x);
 				const Vector2 diffY = Vector2(uv1.y - uv0.y, uv2.y - uv0.y);
-				float r = 1.f / Vector2::Cross(diffX, diffY);
+				const float uvArea = Vector2::Cross(diffX, diffY);
+
+				//Degenerate uv triangles would spread inf/NaN into every face sharing the welded vertex
+				if (uvArea == 0.f)
+					continue;
+
+				float r = 1.f / uvArea;
 
 				Vector3 tangent = (edge0 * diffY.y - edge1 * diffY.x) * r;
 				vertices[index0].tangent += tangent;
@@ -146,7 +164,10 @@ namespace dae
 			//Create the Tangents (reject)
 			for (auto& v : vertices)
 			{
-				v.tangent = Vector3::Reject(v.tangent, v.normal).Normalized();
+				//Vertices that only touch degenerate uv triangles keep a zero tangent instead of NaN
+				const Vector3 tangent{ Vector3::Reject(v.tangent, v.normal) };
+				if (tangent.SqrMagnitude() > 0.f)
+					v.tangent = tangent.Normalized();
 
 				if(flipAxisAndWinding)
 				{
@@ -0,0 +1,410 @@
+#include "pch.h"
+#include "VertexLayout.h"
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace dae
+{
+	namespace
+	{
+		const float* GetSource(const Vertex_Vehicle& vertex, VertexSemantic semantic)
+		{
+			switch (semantic)
+			{
+			case VertexSemantic::Position:
+				return &vertex.position.x;
+			case VertexSemantic::Normal:
+				return &vertex.normal.x;
+			case VertexSemantic::Tangent:
+				return &vertex.tangent.x;
+			case VertexSemantic::TexCoord:
+				return &vertex.uv.x;
+			default:
+				return nullptr;
+			}
+		}
+
+		float* GetDestination(Vertex_Vehicle& vertex, VertexSemantic semantic)
+		{
+			return const_cast<float*>(GetSource(vertex, semantic));
+		}
+
+		uint16_t ToUnorm16(float value)
+		{
+			return static_cast<uint16_t>(std::lround(Saturate(value) * 65535.f));
+		}
+
+		float FromUnorm16(uint16_t value)
+		{
+			return static_cast<float>(value) / 65535.f;
+		}
+
+		//D3D maps both -32768 and -32767 to -1
+		float FromSnorm16(int16_t value)
+		{
+			return std::max(static_cast<float>(value) / 32767.f, -1.f);
+		}
+
+		float SignNotZero(float value)
+		{
+			return value >= 0.f ? 1.f : -1.f;
+		}
+	}
+
+	PositionQuantization PositionQuantization::FromBounds(const Vector3& boundsMin, const Vector3& boundsMax)
+	{
+		PositionQuantization quantization{};
+		quantization.offset = boundsMin;
+
+		//Flat axes keep a unit scale so decoding never divides by zero
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			const float extent{ boundsMax[axis] - boundsMin[axis] };
+			quantization.scale[axis] = extent > 0.f ? extent : 1.f;
+		}
+
+		return quantization;
+	}
+
+	void VertexLayout::AddAttribute(VertexSemantic semantic, VertexFormat format)
+	{
+		assert(numAttributes < MaxAttributes && "VertexLayout is full");
+
+		attributes[numAttributes] = VertexAttribute{ semantic, format, static_cast<uint16_t>(stride) };
+		++numAttributes;
+		stride += GetFormatSize(format);
+	}
+
+	bool VertexLayout::operator==(const VertexLayout& other) const
+	{
+		if (stride != other.stride || numAttributes != other.numAttributes)
+			return false;
+
+		for (uint32_t i = 0; i < numAttributes; ++i)
+		{
+			if (attributes[i].semantic != other.attributes[i].semantic
+				|| attributes[i].format != other.attributes[i].format
+				|| attributes[i].offset != other.attributes[i].offset)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	const VertexAttribute* VertexLayout::FindAttribute(VertexSemantic semantic) const
+	{
+		for (uint32_t i = 0; i < numAttributes; ++i)
+		{
+			if (attributes[i].semantic == semantic)
+				return &attributes[i];
+		}
+
+		return nullptr;
+	}
+
+	bool VertexLayout::HasQuantizedPosition() const
+	{
+		const VertexAttribute* pPosition{ FindAttribute(VertexSemantic::Position) };
+		return pPosition && pPosition->format == VertexFormat::Unorm16x4;
+	}
+
+	bool VertexLayout::HasOctahedralNormals() const
+	{
+		const VertexAttribute* pNormal{ FindAttribute(VertexSemantic::Normal) };
+		return pNormal && pNormal->format == VertexFormat::OctahedralSnorm16x2;
+	}
+
+	void VertexLayout::WriteVertex(const Vertex_Vehicle& vertex, void* pDestination, const PositionQuantization& quantization) const
+	{
+		char* pBytes{ static_cast<char*>(pDestination) };
+
+		for (uint32_t i = 0; i < numAttributes; ++i)
+		{
+			const VertexAttribute& attribute{ attributes[i] };
+			const float* pSource{ GetSource(vertex, attribute.semantic) };
+			char* pAttribute{ pBytes + attribute.offset };
+
+			switch (attribute.format)
+			{
+			case VertexFormat::Float2:
+			case VertexFormat::Float3:
+				std::memcpy(pAttribute, pSource, GetFormatSize(attribute.format));
+				break;
+			case VertexFormat::Half2:
+			{
+				const uint16_t packed[2]{ VertexPacking::FloatToHalf(pSource[0]), VertexPacking::FloatToHalf(pSource[1]) };
+				std::memcpy(pAttribute, packed, sizeof(packed));
+				break;
+			}
+			case VertexFormat::Unorm16x2:
+			{
+				const uint16_t packed[2]{ ToUnorm16(pSource[0]), ToUnorm16(pSource[1]) };
+				std::memcpy(pAttribute, packed, sizeof(packed));
+				break;
+			}
+			case VertexFormat::Unorm16x4:
+			{
+				uint16_t packed[4]{};
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					packed[axis] = ToUnorm16((pSource[axis] - quantization.offset[axis]) / quantization.scale[axis]);
+				}
+				std::memcpy(pAttribute, packed, sizeof(packed));
+				break;
+			}
+			case VertexFormat::OctahedralSnorm16x2:
+			{
+				int16_t packed[2]{};
+				VertexPacking::EncodeOctahedral(Vector3{ pSource[0], pSource[1], pSource[2] }, packed);
+				std::memcpy(pAttribute, packed, sizeof(packed));
+				break;
+			}
+			default:
+				break;
+			}
+		}
+	}
+
+	Vertex_Vehicle VertexLayout::ReadVertex(const void* pSource, const PositionQuantization& quantization) const
+	{
+		const char* pBytes{ static_cast<const char*>(pSource) };
+		Vertex_Vehicle vertex{};
+
+		for (uint32_t i = 0; i < numAttributes; ++i)
+		{
+			const VertexAttribute& attribute{ attributes[i] };
+			float* pDestination{ GetDestination(vertex, attribute.semantic) };
+			const char* pAttribute{ pBytes + attribute.offset };
+
+			switch (attribute.format)
+			{
+			case VertexFormat::Float2:
+			case VertexFormat::Float3:
+				std::memcpy(pDestination, pAttribute, GetFormatSize(attribute.format));
+				break;
+			case VertexFormat::Half2:
+			{
+				uint16_t packed[2]{};
+				std::memcpy(packed, pAttribute, sizeof(packed));
+				pDestination[0] = VertexPacking::HalfToFloat(packed[0]);
+				pDestination[1] = VertexPacking::HalfToFloat(packed[1]);
+				break;
+			}
+			case VertexFormat::Unorm16x2:
+			{
+				uint16_t packed[2]{};
+				std::memcpy(packed, pAttribute, sizeof(packed));
+				pDestination[0] = FromUnorm16(packed[0]);
+				pDestination[1] = FromUnorm16(packed[1]);
+				break;
+			}
+			case VertexFormat::Unorm16x4:
+			{
+				uint16_t packed[4]{};
+				std::memcpy(packed, pAttribute, sizeof(packed));
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					pDestination[axis] = quantization.offset[axis] + FromUnorm16(packed[axis]) * quantization.scale[axis];
+				}
+				break;
+			}
+			case VertexFormat::OctahedralSnorm16x2:
+			{
+				int16_t packed[2]{};
+				std::memcpy(packed, pAttribute, sizeof(packed));
+				const Vector3 direction{ VertexPacking::DecodeOctahedral(packed) };
+				pDestination[0] = direction.x;
+				pDestination[1] = direction.y;
+				pDestination[2] = direction.z;
+				break;
+			}
+			default:
+				break;
+			}
+		}
+
+		return vertex;
+	}
+
+	uint32_t VertexLayout::GetFormatSize(VertexFormat format)
+	{
+		switch (format)
+		{
+		case VertexFormat::Float2:
+			return 2 * sizeof(float);
+		case VertexFormat::Float3:
+			return 3 * sizeof(float);
+		case VertexFormat::Half2:
+		case VertexFormat::Unorm16x2:
+		case VertexFormat::OctahedralSnorm16x2:
+			return 2 * sizeof(uint16_t);
+		case VertexFormat::Unorm16x4:
+			return 4 * sizeof(uint16_t);
+		default:
+			return 0;
+		}
+	}
+
+	VertexLayout VertexLayout::CreateVehicleLayout()
+	{
+		VertexLayout layout{};
+		layout.AddAttribute(VertexSemantic::Position, VertexFormat::Float3);
+		layout.AddAttribute(VertexSemantic::Normal, VertexFormat::Float3);
+		layout.AddAttribute(VertexSemantic::Tangent, VertexFormat::Float3);
+		layout.AddAttribute(VertexSemantic::TexCoord, VertexFormat::Float2);
+		return layout;
+	}
+
+	VertexLayout VertexLayout::CreateFireLayout()
+	{
+		VertexLayout layout{};
+		layout.AddAttribute(VertexSemantic::Position, VertexFormat::Float3);
+		layout.AddAttribute(VertexSemantic::TexCoord, VertexFormat::Float2);
+		return layout;
+	}
+
+	VertexLayout VertexLayout::CreatePackedVehicleLayout(VertexFormat uvFormat)
+	{
+		VertexLayout layout{};
+		layout.AddAttribute(VertexSemantic::Position, VertexFormat::Unorm16x4);
+		layout.AddAttribute(VertexSemantic::Normal, VertexFormat::OctahedralSnorm16x2);
+		layout.AddAttribute(VertexSemantic::Tangent, VertexFormat::OctahedralSnorm16x2);
+		layout.AddAttribute(VertexSemantic::TexCoord, uvFormat);
+		return layout;
+	}
+
+	VertexLayout VertexLayout::CreatePackedFireLayout(VertexFormat uvFormat)
+	{
+		VertexLayout layout{};
+		layout.AddAttribute(VertexSemantic::Position, VertexFormat::Unorm16x4);
+		layout.AddAttribute(VertexSemantic::TexCoord, uvFormat);
+		return layout;
+	}
+
+	namespace VertexPacking
+	{
+		uint16_t FloatToHalf(float value)
+		{
+			uint32_t bits{};
+			std::memcpy(&bits, &value, sizeof(float));
+
+			const uint32_t sign{ (bits >> 16) & 0x8000 };
+			const int32_t exponent{ static_cast<int32_t>((bits >> 23) & 0xFF) - 127 + 15 };
+			uint32_t mantissa{ bits & 0x7FFFFF };
+
+			if ((bits & 0x7FFFFFFF) > 0x7F800000)
+				return static_cast<uint16_t>(sign | 0x7E00);
+			if (exponent >= 31)
+				return static_cast<uint16_t>(sign | 0x7C00);
+
+			//Round to nearest even in both the normal and the subnormal range
+			if (exponent <= 0)
+			{
+				if (exponent < -10)
+					return static_cast<uint16_t>(sign);
+
+				mantissa |= 0x800000;
+				const uint32_t shift{ static_cast<uint32_t>(14 - exponent) };
+				const uint32_t halfway{ 1u << (shift - 1) };
+				const uint32_t remainder{ mantissa & ((1u << shift) - 1) };
+
+				uint32_t half{ mantissa >> shift };
+				if (remainder > halfway || (remainder == halfway && (half & 1)))
+					++half;
+
+				return static_cast<uint16_t>(sign | half);
+			}
+
+			uint32_t half{ (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13) };
+			const uint32_t remainder{ mantissa & 0x1FFF };
+			if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+				++half; //a carry into the exponent is still the correctly rounded value
+
+			return static_cast<uint16_t>(sign | half);
+		}
+
+		float HalfToFloat(uint16_t value)
+		{
+			const uint32_t sign{ static_cast<uint32_t>(value & 0x8000) << 16 };
+			const uint32_t exponent{ (value >> 10) & 0x1Fu };
+			const uint32_t mantissa{ value & 0x3FFu };
+
+			if (exponent == 0)
+			{
+				const float subnormal{ std::ldexp(static_cast<float>(mantissa), -24) };
+				return sign ? -subnormal : subnormal;
+			}
+
+			const uint32_t bits{ exponent == 31
+				? sign | 0x7F800000 | (mantissa << 13)
+				: sign | ((exponent + 112) << 23) | (mantissa << 13) };
+
+			float result{};
+			std::memcpy(&result, &bits, sizeof(float));
+			return result;
+		}
+
+		void EncodeOctahedral(const Vector3& direction, int16_t encoded[2])
+		{
+			const float length{ std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z) };
+			if (length == 0.f)
+			{
+				encoded[0] = 0;
+				encoded[1] = 0;
+				return;
+			}
+
+			float x{ direction.x / length };
+			float y{ direction.y / length };
+			if (direction.z < 0.f)
+			{
+				const float foldedX{ (1.f - std::abs(y)) * SignNotZero(x) };
+				const float foldedY{ (1.f - std::abs(x)) * SignNotZero(y) };
+				x = foldedX;
+				y = foldedY;
+			}
+
+			//Try the four snorm neighbours of the projected point and keep the one closest in angle
+			const Vector3 normalized{ direction / direction.Magnitude() };
+			const float floorX{ std::floor(Clamp(x, -1.f, 1.f) * 32767.f) };
+			const float floorY{ std::floor(Clamp(y, -1.f, 1.f) * 32767.f) };
+
+			float bestCosine{ -2.f };
+			for (int i = 0; i < 4; ++i)
+			{
+				const int16_t candidate[2]
+				{
+					static_cast<int16_t>(Clamp(floorX + (i & 1), -32767.f, 32767.f)),
+					static_cast<int16_t>(Clamp(floorY + (i >> 1), -32767.f, 32767.f))
+				};
+
+				const float cosine{ Vector3::Dot(DecodeOctahedral(candidate), normalized) };
+				if (cosine > bestCosine)
+				{
+					bestCosine = cosine;
+					encoded[0] = candidate[0];
+					encoded[1] = candidate[1];
+				}
+			}
+		}
+
+		Vector3 DecodeOctahedral(const int16_t encoded[2])
+		{
+			Vector3 direction{ FromSnorm16(encoded[0]), FromSnorm16(encoded[1]), 0.f };
+			direction.z = 1.f - std::abs(direction.x) - std::abs(direction.y);
+
+			if (direction.z < 0.f)
+			{
+				const float foldedX{ (1.f - std::abs(direction.y)) * SignNotZero(direction.x) };
+				const float foldedY{ (1.f - std::abs(direction.x)) * SignNotZero(direction.y) };
+				direction.x = foldedX;
+				direction.y = foldedY;
+			}
+
+			return direction / direction.Magnitude();
+		}
+	}
+}
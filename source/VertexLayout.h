@@ -0,0 +1,84 @@
+#pragma once
+#include "DataTypes.h"
+
+namespace dae
+{
+	enum class VertexSemantic : uint8_t
+	{
+		Position,
+		Normal,
+		Tangent,
+		TexCoord
+	};
+
+	enum class VertexFormat : uint8_t
+	{
+		Float2,
+		Float3,
+		Half2,					//16-bit floats
+		Unorm16x2,				//16-bit fixed point in [0, 1], values outside are clamped
+		Unorm16x4,				//position quantized to the mesh bounds, w is padding
+		OctahedralSnorm16x2		//unit vector folded onto an octahedron, 16-bit snorm per axis
+	};
+
+	struct VertexAttribute
+	{
+		VertexSemantic semantic{};
+		VertexFormat format{};
+		uint16_t offset{};
+	};
+
+	//Maps positions to the [0, 1] range Unorm16x4 stores: position = offset + stored * scale
+	struct PositionQuantization
+	{
+		Vector3 offset{};
+		Vector3 scale{ 1.f, 1.f, 1.f };
+
+		static PositionQuantization FromBounds(const Vector3& boundsMin, const Vector3& boundsMax);
+	};
+
+	//Describes how one vertex is laid out in a vertex buffer, plain data so it can be stored in binary mesh files
+	struct VertexLayout
+	{
+		static constexpr uint32_t MaxAttributes{ 8 };
+
+		uint32_t stride{};
+		uint32_t numAttributes{};
+		VertexAttribute attributes[MaxAttributes]{};
+
+		void AddAttribute(VertexSemantic semantic, VertexFormat format);
+		bool operator==(const VertexLayout& other) const;
+
+		const VertexAttribute* FindAttribute(VertexSemantic semantic) const;
+		bool HasQuantizedPosition() const;
+		bool HasOctahedralNormals() const;
+
+		//Encodes the attributes of vertex this layout stores into pDestination (stride bytes)
+		void WriteVertex(const Vertex_Vehicle& vertex, void* pDestination, const PositionQuantization& quantization = {}) const;
+		//CPU decode path, attributes the layout does not store stay zero
+		Vertex_Vehicle ReadVertex(const void* pSource, const PositionQuantization& quantization = {}) const;
+
+		static uint32_t GetFormatSize(VertexFormat format);
+
+		//position, normal, tangent, uv: matches Vehicle_Shader.fx
+		static VertexLayout CreateVehicleLayout();
+		//position, uv: matches Fire_Shader.fx
+		static VertexLayout CreateFireLayout();
+
+		//20 instead of 44 bytes: quantized position, octahedral normal and tangent, 16-bit uv.
+		//Unorm16x2 uvs are only lossless enough for meshes whose uvs stay in [0, 1]
+		static VertexLayout CreatePackedVehicleLayout(VertexFormat uvFormat = VertexFormat::Half2);
+		//12 instead of 20 bytes
+		static VertexLayout CreatePackedFireLayout(VertexFormat uvFormat = VertexFormat::Half2);
+	};
+
+	namespace VertexPacking
+	{
+		uint16_t FloatToHalf(float value);
+		float HalfToFloat(uint16_t value);
+
+		//Picks the snorm16 pair that decodes closest to the (normalized) input rather than plain rounding
+		void EncodeOctahedral(const Vector3& direction, int16_t encoded[2]);
+		Vector3 DecodeOctahedral(const int16_t encoded[2]);
+	}
+}
@@ -17,9 +17,13 @@ void ShutDown(SDL_Window* pWindow)
 
 int main(int argc, char* args[])
 {
-	//Unreferenced parameters
-	(void)argc;
-	(void)args;
+	//--packed-vertices: 20 byte quantized vertices instead of full floats (see VertexLayout)
+	bool usePackedVertices{ false };
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::string{ args[i] } == "--packed-vertices")
+			usePackedVertices = true;
+	}
 
 	//Create window + surfaces
 	SDL_Init(SDL_INIT_VIDEO);
@@ -38,7 +42,7 @@ int main(int argc, char* args[])
 
 	//Initialize "framework"
 	const auto pTimer = new Timer();
-	const auto pRenderer = new Renderer(pWindow);
+	const auto pRenderer = new Renderer(pWindow, usePackedVertices);
 	//enum class sampleState
 	//{
 	//	point,
@@ -103,6 +107,66 @@ int main(int argc, char* args[])
 						break;
 					}
 				}
+				if (e.key.keysym.scancode == SDL_SCANCODE_F5)
+				{
+					pRenderer->ToggleDepthPrePass();
+
+					if (pRenderer->GetIsDepthPrePass())
+					{
+						std::cout << "Depth Pre-Pass Enabled\n";
+					}
+					else
+					{
+						std::cout << "Depth Pre-Pass Disabled\n";
+					}
+				}
+				if (e.key.keysym.scancode == SDL_SCANCODE_F6)
+				{
+					pRenderer->ToggleMeshCulling();
+
+					if (pRenderer->GetIsMeshCulling())
+					{
+						std::cout << "Mesh Frustum Culling Enabled\n";
+					}
+					else
+					{
+						std::cout << "Mesh Frustum Culling Disabled\n";
+					}
+				}
+				if (e.key.keysym.scancode == SDL_SCANCODE_F7)
+				{
+					pRenderer->GetVehicleMeshPtr()->ToggleMeshletCulling();
+					pRenderer->GetFireMeshPtr()->ToggleMeshletCulling();
+
+					if (pRenderer->GetVehicleMeshPtr()->GetIsMeshletCulling())
+					{
+						std::cout << "Meshlet Culling Enabled\n";
+					}
+					else
+					{
+						std::cout << "Meshlet Culling Disabled\n";
+					}
+				}
+				if (e.key.keysym.scancode == SDL_SCANCODE_F8)
+				{
+					pRenderer->GetVehicleMeshPtr()->ToggleLodSelection();
+					pRenderer->GetFireMeshPtr()->ToggleLodSelection();
+
+					const Mesh* pVehicle{ pRenderer->GetVehicleMeshPtr() };
+					if (pVehicle->GetIsLodSelection())
+					{
+						std::cout << "LOD Selection Enabled, vehicle triangles per LOD:";
+						for (uint32_t lod = 0; lod < pVehicle->GetNumLods(); ++lod)
+						{
+							std::cout << " " << pVehicle->GetLod(lod).numIndices / 3;
+						}
+						std::cout << "\n";
+					}
+					else
+					{
+						std::cout << "LOD Selection Disabled\n";
+					}
+				}
 				if (e.key.keysym.scancode == SDL_SCANCODE_F9)
 				{
 					pRenderer->GetVehicleMeshPtr()->GetEffectPtr()->ToggleCullingMode();
@@ -140,6 +204,26 @@ int main(int argc, char* args[])
 		{
 			printTimer = 0.f;
 			std::cout << "dFPS: " << pTimer->GetdFPS() << std::endl;
+
+			const Mesh* pVehicle{ pRenderer->GetVehicleMeshPtr() };
+			if (pVehicle->GetIsLodSelection())
+			{
+				std::cout << "Vehicle LOD: " << pVehicle->GetCurrentLod() << " (" << pVehicle->GetLod(pVehicle->GetCurrentLod()).numIndices / 3 << " triangles)\n";
+			}
+
+			const FrustumCullStatistics& meshStatistics{ pRenderer->GetMeshCullStatistics() };
+			std::cout << "Meshes: " << meshStatistics.numTested << " tested, " << meshStatistics.numVisible << " visible, " << meshStatistics.numCulled << " culled\n";
+
+			//The mode not in use keeps its last frame, toggle F5 to compare
+			std::cout << "Shaded fragments: " << pRenderer->GetShadedFragments(false) << " without depth pre-pass, "
+				<< pRenderer->GetShadedFragments(true) << " with\n";
+
+			if (pRenderer->GetVehicleMeshPtr()->GetIsMeshletCulling())
+			{
+				const MeshletCullStatistics& statistics{ pRenderer->GetVehicleMeshPtr()->GetMeshletStatistics() };
+				std::cout << "Meshlets: " << statistics.numTested << " tested, " << statistics.numFrustumCulled << " frustum culled, "
+					<< statistics.numBackFacingCulled << " back-facing culled, " << statistics.numTrianglesSubmitted << "/" << statistics.numTrianglesTotal << " triangles\n";
+			}
 		}
 	}
 	pTimer->Stop();